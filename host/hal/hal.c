@@ -0,0 +1,434 @@
+#define _GNU_SOURCE
+#include "hal.h"
+#include "klib.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "smp.h"
+#include "ata.h"
+#include "pit.h"
+#include "idle.h"
+#include "task.h"
+#include "reaper.h"
+#include "task_rings.h"
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// ============================================================================
+// KPRINTF
+// ============================================================================
+
+static volatile int kprintf_quiet = 0;
+
+// Вырезать теги цвета %[X] (консоль ядра) - остаётся обычный printf формат
+static void hal_strip_colors(const char* format, char* out, size_t size) {
+    size_t n = 0;
+    while (*format && n + 1 < size) {
+        if (format[0] == '%' && format[1] == '[') {
+            const char* end = strchr(format, ']');
+            if (end) {
+                format = end + 1;
+                continue;
+            }
+        }
+        out[n++] = *format++;
+    }
+    out[n] = 0;
+}
+
+int kprintf(const char* format, ...) {
+    if (kprintf_quiet) {
+        return 0;
+    }
+
+    char clean[1024];
+    hal_strip_colors(format, clean, sizeof(clean));
+
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(clean, args);
+    va_end(args);
+    return written;
+}
+
+void kprintf_set_quiet(int quiet) {
+    kprintf_quiet = quiet;
+    fflush(stdout);
+}
+
+int ksnprintf(char* buf, size_t size, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return written;
+}
+
+void kputchar(char c) {
+    if (!kprintf_quiet) {
+        putchar(c);
+    }
+}
+
+int kputnl(void) {
+    kputchar('\n');
+    return 1;
+}
+
+void panic(const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    fprintf(stderr, "\nKERNEL PANIC: ");
+    vfprintf(stderr, message, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    fflush(stdout);
+    abort();
+}
+
+char* utoa64(uint64_t value, char* str, int base) {
+    snprintf(str, 24, base == 16 ? "%lx" : "%lu", value);
+    return str;
+}
+
+void delay(uint32_t milliseconds) {
+    usleep(milliseconds * 1000);
+}
+
+// ============================================================================
+// SPINLOCKS
+// ============================================================================
+
+void spinlock_init(spinlock_t* lock) {
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+void spin_lock(spinlock_t* lock) {
+    while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED)) {
+            cpu_pause();
+        }
+    }
+}
+
+void spin_unlock(spinlock_t* lock) {
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+bool spin_trylock(spinlock_t* lock) {
+    return !__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE);
+}
+
+// ============================================================================
+// MEMORY (kmalloc / PMM / VMM)
+// ============================================================================
+
+void* kmalloc(size_t size) {
+    return malloc(size);
+}
+
+void kfree(void* ptr) {
+    free(ptr);
+}
+
+void* pmm_alloc(size_t pages) {
+    return aligned_alloc(PMM_PAGE_SIZE, pages * PMM_PAGE_SIZE);
+}
+
+void* pmm_alloc_zero(size_t pages) {
+    void* addr = pmm_alloc(pages);
+    if (addr) {
+        memset(addr, 0, pages * PMM_PAGE_SIZE);
+    }
+    return addr;
+}
+
+void pmm_free(void* addr, size_t pages) {
+    (void)pages;
+    free(addr);
+}
+
+static vmm_context_t hal_kernel_context;
+
+vmm_context_t* vmm_get_kernel_context(void) {
+    return &hal_kernel_context;
+}
+
+void* vmm_alloc_pages(vmm_context_t* ctx, size_t page_count, uint64_t flags) {
+    (void)ctx;
+    (void)flags;
+    return pmm_alloc_zero(page_count);
+}
+
+void vmm_free_pages(vmm_context_t* ctx, void* virt_addr, size_t page_count) {
+    (void)ctx;
+    pmm_free(virt_addr, page_count);
+}
+
+// Один адресный контекст процесса: virt == phys, всё user RW
+uintptr_t vmm_virt_to_phys(vmm_context_t* ctx, uintptr_t virt_addr) {
+    (void)ctx;
+    return virt_addr;
+}
+
+uint64_t vmm_get_page_flags(vmm_context_t* ctx, uintptr_t virt_addr) {
+    (void)ctx;
+    return virt_addr ? VMM_FLAGS_USER_RW : 0;
+}
+
+// Нет PTE - pin только проверяет флаги, unpin нечего снимать
+uintptr_t vmm_pin_page(vmm_context_t* ctx, uintptr_t virt_addr, uint64_t required_flags) {
+    if ((vmm_get_page_flags(ctx, virt_addr) & required_flags) != required_flags) {
+        return 0;
+    }
+    return virt_addr;
+}
+
+void vmm_unpin_page(vmm_context_t* ctx, uintptr_t virt_addr) {
+    (void)ctx;
+    (void)virt_addr;
+}
+
+void* vmalloc(size_t size) {
+    return calloc(1, size);
+}
+
+// ============================================================================
+// SMP - pthread на каждое "ядро"
+// ============================================================================
+
+static uint32_t hal_cpus = 1;
+static __thread uint32_t hal_cpu_index = 0;   // main = BSP
+
+typedef struct {
+    uint32_t cpu;
+    smp_entry_t entry;
+    void* arg;
+} HalCpuStart;
+
+static HalCpuStart hal_cpu_start[SMP_MAX_CPUS];
+
+void hal_set_cpu_count(uint32_t count) {
+    if (count < 1) {
+        count = 1;
+    }
+    hal_cpus = count < SMP_MAX_CPUS ? count : SMP_MAX_CPUS;
+}
+
+uint32_t hal_cpu_count(void) {
+    return hal_cpus;
+}
+
+uint32_t smp_get_cpu_count(void) {
+    return hal_cpus;
+}
+
+uint32_t smp_current_cpu(void) {
+    return hal_cpu_index;
+}
+
+static void* hal_cpu_thread(void* arg) {
+    HalCpuStart* start = (HalCpuStart*)arg;
+    hal_cpu_index = start->cpu;
+    start->entry(start->arg);
+    return 0;
+}
+
+int smp_start_cpu(uint32_t cpu, smp_entry_t entry, void* arg) {
+    if (cpu == 0 || cpu >= hal_cpus || hal_cpu_start[cpu].entry) {
+        return 0;
+    }
+
+    HalCpuStart* start = &hal_cpu_start[cpu];
+    start->cpu = cpu;
+    start->entry = entry;
+    start->arg = arg;
+
+    pthread_t thread;
+    if (pthread_create(&thread, 0, hal_cpu_thread, start) != 0) {
+        start->entry = 0;
+        return 0;
+    }
+    pthread_detach(thread);
+    return 1;
+}
+
+// ============================================================================
+// IDLE - futex вместо MONITOR/MWAIT и HLT + IPI
+// ============================================================================
+
+IdleWaiter* idle_stage_waiters[EVENTDRIVEN_MAX_STAGES];
+
+static long hal_futex(volatile uint32_t* word, int op, uint32_t value) {
+    return syscall(SYS_futex, (uint32_t*)word, op, value, 0, 0, 0);
+}
+
+static void hal_pit_start(void);
+
+void idle_init(void) {
+    kprintf("[IDLE] Sleep mode: futex (host)\n");
+    hal_pit_start();
+}
+
+void idle_waiter_init(IdleWaiter* waiter) {
+    waiter->doorbell = 0;
+    waiter->sleeping = 0;
+    waiter->doorbells_sent = 0;
+    waiter->apic_id = smp_current_cpu();
+}
+
+void idle_wake(IdleWaiter* waiter) {
+    if (!atomic_cas_u32(&waiter->sleeping, 1, 0)) {
+        return;
+    }
+
+    atomic_increment_u64(&waiter->doorbell);
+    hal_futex(&waiter->sleeping, FUTEX_WAKE_PRIVATE, 1);
+    atomic_increment_u64(&waiter->doorbells_sent);
+}
+
+void idle_prepare(IdleWaiter* waiter) {
+    atomic_store_u32(&waiter->sleeping, 1);
+    MEMORY_BARRIER();
+}
+
+uint64_t idle_sleep(IdleWaiter* waiter, int* notified) {
+    uint64_t start = rdtsc();
+
+    // Futex сам перепроверяет sleeping == 1 под своим lock - doorbell
+    // между prepare и sleep не теряется
+    if (atomic_load_u32(&waiter->sleeping)) {
+        hal_futex(&waiter->sleeping, FUTEX_WAIT_PRIVATE, 1);
+    }
+
+    // Флаг снимает idle_wake: если он ещё стоит, futex вернулся сам (EINTR)
+    *notified = !atomic_cas_u32(&waiter->sleeping, 1, 0);
+    return rdtsc() - start;
+}
+
+void idle_cancel(IdleWaiter* waiter) {
+    atomic_store_u32(&waiter->sleeping, 0);
+}
+
+void idle_print_stats(const char* name, IdleStats* stats) {
+    uint64_t total = rdtsc() - stats->start_tsc;
+    kprintf("[IDLE:%s] sleeps=%lu wakeups=%lu residency=%lu%%\n",
+            name, stats->sleeps, stats->wakeups,
+            total ? stats->idle_cycles * 100 / total : 0);
+}
+
+// ============================================================================
+// PIT / ATA
+// ============================================================================
+
+#define HAL_PIT_FREQUENCY   1000
+
+uint64_t hal_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t pit_get_ticks(void) {
+    return hal_time_ns() / (1000000000ULL / HAL_PIT_FREQUENCY);
+}
+
+uint32_t pit_get_frequency(void) {
+    return HAL_PIT_FREQUENCY;
+}
+
+// "IRQ0": поток раз в tick делает то же, что обработчик таймера в idt.c
+static void* hal_pit_thread(void* arg) {
+    (void)arg;
+    struct timespec tick = { 0, 1000000000L / HAL_PIT_FREQUENCY };
+    for (;;) {
+        nanosleep(&tick, 0);
+        task_rings_timer_tick();
+        reaper_timer_tick();
+    }
+    return 0;
+}
+
+static void hal_pit_start(void) {
+    pthread_t thread;
+    if (pthread_create(&thread, 0, hal_pit_thread, 0) == 0) {
+        pthread_detach(thread);
+    }
+}
+
+// exists = 0: tagfs_init() форматирует RAM storage
+ATADevice ata_primary_master;
+ATADevice ata_primary_slave;
+
+int ata_read_block(uint32_t block_num, uint8_t* buffer) {
+    (void)block_num;
+    (void)buffer;
+    return -1;
+}
+
+int ata_write_block(uint32_t block_num, const uint8_t* buffer) {
+    (void)block_num;
+    (void)buffer;
+    return -1;
+}
+
+// ============================================================================
+// TASKS - один процесс, без планировщика
+// ============================================================================
+
+uint64_t task_get_current_id(void) {
+    return HAL_TASK_ID;
+}
+
+Task* task_spawn(const char* name, void* entry_point, uint8_t energy) {
+    (void)name;
+    (void)entry_point;
+    (void)energy;
+    return 0;
+}
+
+int task_kill(uint64_t task_id) {
+    (void)task_id;
+    return -1;
+}
+
+int task_sleep(uint64_t task_id, uint64_t milliseconds) {
+    (void)task_id;
+    (void)milliseconds;
+    return -1;
+}
+
+int task_wake(uint64_t task_id) {
+    (void)task_id;
+    return -1;
+}
+
+int task_pause(uint64_t task_id) {
+    (void)task_id;
+    return -1;
+}
+
+int task_resume(uint64_t task_id) {
+    (void)task_id;
+    return -1;
+}
+
+int task_boost(uint64_t task_id, uint8_t extra_energy) {
+    (void)task_id;
+    (void)extra_energy;
+    return -1;
+}
+
+int task_throttle(uint64_t task_id, uint8_t reduction) {
+    (void)task_id;
+    (void)reduction;
+    return -1;
+}
+
+int task_wake_event(uint64_t task_id) {
+    (void)task_id;
+    return -1;
+}
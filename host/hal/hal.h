@@ -0,0 +1,33 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include "ktypes.h"
+
+// ============================================================================
+// HOST HAL - event-driven core как обычный Linux процесс
+// ============================================================================
+//
+// Что подменяет hal.c (остальное - исходники src/ без изменений):
+//   klib        kprintf -> stdout, kmalloc -> malloc, spinlocks
+//   pmm / vmm   страницы -> aligned_alloc (обнулённые, как pmm_alloc_zero)
+//   smp         "ядро" = pthread, smp_current_cpu() = номер потока
+//   idle        вместо MONITOR/MWAIT/HLT - futex на IdleWaiter.sleeping
+//   pit         1000 ticks/sec по CLOCK_MONOTONIC, IRQ0 - поток (task_rings / reaper tick)
+//   ata         диска нет - TagFS поднимается в RAM mode
+//   task        планировщика нет - один "процесс" HAL_TASK_ID
+//
+// Поток main - BSP (cpu 0), стадии pipeline eventdriven_system_start()
+// раскладывает по cpu 1..hal_cpu_count()-1, как на AP.
+//
+// ============================================================================
+
+#define HAL_TASK_ID     1
+
+// До eventdriven_system_start(): сколько "ядер" (включая BSP, 1..SMP_MAX_CPUS)
+void hal_set_cpu_count(uint32_t count);
+uint32_t hal_cpu_count(void);
+
+// Монотонное время (для events/sec и таймаутов host-driver'а)
+uint64_t hal_time_ns(void);
+
+#endif // HAL_H
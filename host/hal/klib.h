@@ -0,0 +1,54 @@
+#ifndef KLIB_H
+#define KLIB_H
+
+// ============================================================================
+// HOST HAL: klib.h -> libc + pthreads
+// ============================================================================
+//
+// Тот же API, что у src/lib/kernel/klib.h, для файлов event-driven core,
+// собранных под Linux (make host-bench / host-test):
+//   kprintf     -> stdout (теги цвета %[X] вырезаются)
+//   kmalloc     -> malloc
+//   spinlock_t  -> test-and-set на atomics ядра (lock xchg работает и в ring 3)
+// Строки и память - из libc. Реализация - host/hal/hal.c.
+//
+// ============================================================================
+
+#include "ktypes.h"
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+
+// ========== Min/Max ==========
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define ALIGN_UP(addr, align) (((addr) + (align) - 1) & ~((align) - 1))
+#define ALIGN_DOWN(addr, align) ((addr) & ~((align) - 1))
+
+typedef struct {
+    uint32_t locked;
+} spinlock_t;
+
+// ========== Память ==========
+void* kmalloc(size_t size);
+void kfree(void* ptr);
+
+// ========== Вывод ==========
+__attribute__((noreturn)) void panic(const char* message, ...);
+int kprintf(const char* format, ...);
+void kprintf_set_quiet(int quiet);
+int ksnprintf(char* buf, size_t size, const char* fmt, ...);
+void kputchar(char c);
+int kputnl(void);
+
+// ========== Синхронизация ==========
+void spinlock_init(spinlock_t* lock);
+void spin_lock(spinlock_t* lock);
+void spin_unlock(spinlock_t* lock);
+bool spin_trylock(spinlock_t* lock);
+
+// ========== Числа ==========
+char* utoa64(uint64_t value, char* str, int base);
+void delay(uint32_t milliseconds);
+
+#endif // KLIB_H
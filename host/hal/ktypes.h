@@ -0,0 +1,17 @@
+#ifndef KTYPES_H
+#define KTYPES_H
+
+// ============================================================================
+// HOST HAL: ktypes.h -> libc (сборка event-driven core под Linux)
+// ============================================================================
+//
+// Подменяет src/lib/kernel/ktypes.h: host/hal стоит в -I раньше src.
+//
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#endif // KTYPES_H
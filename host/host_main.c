@@ -0,0 +1,1386 @@
+#define _GNU_SOURCE
+#include "hal.h"
+#include "eventdriven_system.h"
+#include "core/ringbuffer.h"
+#include "core/task_rings.h"
+#include "center/center.h"
+#include "center/chain.h"
+#include "core/user_buffers.h"
+#include "core/credits.h"
+#include "core/idle.h"
+#include "guide/reaper.h"
+#include "decks/deck_interface.h"
+#include "payload/payload_arena.h"
+#include "storage/tagfs.h"
+#include "demo/pipeline_bench.h"
+#include "pmm.h"
+#include "klib.h"
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// ============================================================================
+// HOST DRIVER - event-driven core под Linux (make host-bench / host-test)
+// ============================================================================
+//
+//   boxos-host [-c cores] [-v] bench [events] [depth]
+//       ring throughput на настоящих потоках (1..N producers одновременно,
+//       каждый на своём CPU) + pipeline_bench по всем смесям
+//   boxos-host [-c cores] [-v] stress
+//       многопоточные проверки: MPMC ring (exactly-once, порядок каждого
+//       producer; захваченный consumer'ом слот занят для кредитов), весь pipeline (каждое событие - ровно один ответ) и
+//       SQ/CQ пары задач (ответ - только в CQ своей пары, с ID, известным
+//       submitter'у после commit), цепочки
+//       open -> read -> close (ровно один ответ на цепочку, fd не теряются),
+//       open -> write -> close (CHAIN_FD close получает fd, а не байты),
+//       пул Storage workers (параллельный open нового файла создаёт его
+//       один раз),
+//       read/write через зарегистрированный буфер (без payload arena),
+//       перегрузка CQ (сверх кредитов - BUSY, ни одна стадия не встаёт),
+//       дедлайны (потерянные entries - ровно один TIMEOUT, кредит и slot
+//       возвращены), испорченная задачей CQ (её ответы отброшены, другие
+//       пары не замечают), событие в SQ без idle_notify (спящий Receiver
+//       будит tick)
+//
+// cores - "ядра" HAL, включая BSP (поток main); по умолчанию все online CPU.
+// stress возвращает 1 при первой же ошибке.
+//
+// ============================================================================
+
+#define HOST_RING_EVENTS        1000000
+#define HOST_RING_MAX_PRODUCERS 8
+#define HOST_STRESS_RING_EVENTS 200000      // На producer
+#define HOST_STRESS_CONSUMERS   2
+#define HOST_STRESS_SUBMITTERS  3
+#define HOST_STRESS_EVENTS      20000       // На submitter
+#define HOST_STRESS_INFLIGHT    128
+#define HOST_STALL_NS           10000000000ULL
+#define HOST_STRESS_FILE        "host-stress"   // FILE_STAT по RAM-mode TagFS
+
+static int host_verbose = 0;
+
+// ============================================================================
+// RING WORKERS
+// ============================================================================
+
+typedef struct {
+    EventRingBuffer* ring;
+    uint32_t producer;
+    uint64_t count;
+    volatile uint32_t* go;
+} HostProducer;
+
+typedef struct {
+    EventRingBuffer* ring;
+    uint32_t producers;
+    volatile uint64_t* consumed;    // Общий счётчик всех consumers
+    uint64_t total;
+    uint8_t* seen;                  // [producer * count + seq], 0 = не было
+    uint64_t per_producer;
+    volatile uint32_t* go;
+    uint64_t order_errors;
+    uint64_t duplicates;
+} HostConsumer;
+
+// Ring полон / пуст: pause, а каждые HOST_RING_YIELD_SPINS - отдать CPU.
+// Потоков больше, чем CPU, - иначе поток, ждущий соседа, доедает свой
+// квант, и bench меряет планировщик, а не ring
+#define HOST_RING_YIELD_SPINS   64
+
+static inline void host_ring_backoff(uint32_t* spins) {
+    cpu_pause();
+    if (++*spins % HOST_RING_YIELD_SPINS == 0) {
+        sched_yield();
+    }
+}
+
+// Поток bench'а - на свой CPU: producers правда конкурируют за tail
+static void host_pin_thread(pthread_t thread, uint32_t index) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 2) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % (uint32_t)online, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+// data[0..3] = producer, data[8..15] = seq
+static void* host_ring_producer(void* arg) {
+    HostProducer* p = (HostProducer*)arg;
+    Event event;
+    event_init(&event, EVENT_PROC_GETPID, 1);
+    *(uint32_t*)event.data = p->producer;
+
+    while (!atomic_load_u32(p->go)) {
+        cpu_pause();
+    }
+
+    uint32_t spins = 0;
+    for (uint64_t seq = 0; seq < p->count; seq++) {
+        *(uint64_t*)(event.data + 8) = seq;
+        while (!event_ring_push(p->ring, &event)) {
+            host_ring_backoff(&spins);
+        }
+    }
+    return 0;
+}
+
+static void* host_ring_consumer(void* arg) {
+    HostConsumer* c = (HostConsumer*)arg;
+    uint64_t next[HOST_RING_MAX_PRODUCERS] = {0};
+    Event event;
+
+    while (!atomic_load_u32(c->go)) {
+        cpu_pause();
+    }
+
+    uint32_t spins = 0;
+    while (atomic_load_u64(c->consumed) < c->total) {
+        if (!event_ring_pop(c->ring, &event)) {
+            host_ring_backoff(&spins);
+            continue;
+        }
+        atomic_increment_u64(c->consumed);
+
+        uint32_t producer = *(uint32_t*)event.data;
+        uint64_t seq = *(uint64_t*)(event.data + 8);
+
+        // Один consumer видит события каждого producer по возрастанию seq
+        if (producer >= c->producers || seq < next[producer]) {
+            c->order_errors++;
+            continue;
+        }
+        next[producer] = seq + 1;
+
+        if (c->seen && __atomic_exchange_n(&c->seen[producer * c->per_producer + seq], 1,
+                                           __ATOMIC_RELAXED)) {
+            c->duplicates++;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    uint64_t ns;
+    uint64_t cycles;
+    uint64_t order_errors;
+    uint64_t duplicates;
+    uint64_t missing;
+} HostRingResult;
+
+// pin - каждый поток на свой CPU (consumers первыми), иначе решает Linux
+static void host_ring_run(uint32_t mode, uint32_t producers, uint32_t consumers,
+                          uint64_t per_producer, int check, int pin, HostRingResult* result) {
+    EventRingBuffer* ring = (EventRingBuffer*)pmm_alloc_zero(
+        (sizeof(EventRingBuffer) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE);
+    event_ring_init_mode(ring, mode);
+
+    uint64_t total = per_producer * producers;
+    uint8_t* seen = check ? (uint8_t*)calloc(total, 1) : 0;
+    volatile uint32_t go = 0;
+    volatile uint64_t consumed = 0;
+
+    HostProducer prod[HOST_RING_MAX_PRODUCERS];
+    HostConsumer cons[HOST_STRESS_CONSUMERS];
+    pthread_t threads[HOST_RING_MAX_PRODUCERS + HOST_STRESS_CONSUMERS];
+    uint32_t started = 0;
+
+    for (uint32_t c = 0; c < consumers; c++) {
+        cons[c] = (HostConsumer){ ring, producers, &consumed, total, seen, per_producer, &go, 0, 0 };
+        pthread_create(&threads[started], 0, host_ring_consumer, &cons[c]);
+        if (pin) {
+            host_pin_thread(threads[started], started);
+        }
+        started++;
+    }
+    for (uint32_t p = 0; p < producers; p++) {
+        prod[p] = (HostProducer){ ring, p, per_producer, &go };
+        pthread_create(&threads[started], 0, host_ring_producer, &prod[p]);
+        if (pin) {
+            host_pin_thread(threads[started], started);
+        }
+        started++;
+    }
+
+    uint64_t start_ns = hal_time_ns();
+    uint64_t start = rdtsc();
+    atomic_store_u32(&go, 1);
+
+    for (uint32_t t = 0; t < started; t++) {
+        pthread_join(threads[t], 0);
+    }
+
+    result->cycles = rdtsc() - start;
+    result->ns = hal_time_ns() - start_ns;
+    result->order_errors = 0;
+    result->duplicates = 0;
+    result->missing = 0;
+
+    for (uint32_t c = 0; c < consumers; c++) {
+        result->order_errors += cons[c].order_errors;
+        result->duplicates += cons[c].duplicates;
+    }
+    for (uint64_t i = 0; seen && i < total; i++) {
+        result->missing += !seen[i];
+    }
+
+    free(seen);
+    pmm_free(ring, 0);
+}
+
+// ============================================================================
+// BENCH
+// ============================================================================
+
+// MPMC под настоящей конкуренцией: 1..N producers одновременно, каждый на
+// своём CPU, consumer - на отдельном (demo/ring_bench.c чередует producers
+// на одном ядре и меряет только стоимость операций). N = cores - 1, не
+// меньше 2; cpus < threads - прогон oversubscribed, цифры - не contention
+static void host_ring_bench(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t max_producers = hal_cpu_count() > 3 ? hal_cpu_count() - 1 : 2;
+    if (max_producers > HOST_RING_MAX_PRODUCERS) {
+        max_producers = HOST_RING_MAX_PRODUCERS;
+    }
+
+    HostRingResult r;
+    host_ring_run(RING_MODE_SPSC, 1, 1, HOST_RING_EVENTS, 0, 1, &r);
+    printf("BENCH ring mode=spsc producers=1 threads=2 cpus=%ld ops=%lu cycles_per_op=%lu "
+           "ops_per_sec=%lu order_errors=%lu\n",
+           online, (uint64_t)HOST_RING_EVENTS, r.cycles / HOST_RING_EVENTS,
+           r.ns ? (uint64_t)HOST_RING_EVENTS * 1000000000 / r.ns : 0, r.order_errors);
+
+    for (uint32_t producers = 1; producers <= max_producers; producers++) {
+        uint64_t per_producer = HOST_RING_EVENTS / producers;
+        host_ring_run(RING_MODE_MPMC, producers, 1, per_producer, 0, 1, &r);
+
+        uint64_t ops = per_producer * producers;
+        printf("BENCH ring mode=mpmc producers=%u threads=%u cpus=%ld ops=%lu cycles_per_op=%lu "
+               "ops_per_sec=%lu order_errors=%lu%s\n",
+               producers, producers + 1, online, ops, r.cycles / ops,
+               r.ns ? ops * (uint64_t)1000000000 / r.ns : 0, r.order_errors,
+               (long)producers + 1 > online ? " oversubscribed" : "");
+    }
+}
+
+static int host_bench(uint64_t events, uint32_t depth) {
+    static const char* mixes[] = { "getpid", "ticks", "stat", "probe", "mix" };
+    int status = 0;
+
+    host_ring_bench();
+
+    for (uint32_t i = 0; i < sizeof(mixes) / sizeof(mixes[0]); i++) {
+        if (pipeline_bench_run(events, depth, mixes[i]) != 0) {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// ============================================================================
+// STRESS
+// ============================================================================
+
+static int host_check(const char* name, int ok, const char* detail) {
+    printf("[HOST] %-28s %s%s%s\n", name, ok ? "OK" : "FAIL", detail ? " " : "", detail ? detail : "");
+    return ok ? 0 : 1;
+}
+
+static int host_ring_stress(void) {
+    uint32_t producers = hal_cpu_count() > 3 ? hal_cpu_count() - 2 : 2;
+    if (producers > 4) {
+        producers = 4;
+    }
+
+    HostRingResult r;
+    host_ring_run(RING_MODE_MPMC, producers, HOST_STRESS_CONSUMERS,
+                  HOST_STRESS_RING_EVENTS, 1, 0, &r);
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(%u producers, %u consumers: order=%lu dup=%lu missing=%lu)",
+             producers, HOST_STRESS_CONSUMERS, r.order_errors, r.duplicates, r.missing);
+    return host_check("ring mpmc exactly-once", !r.order_errors && !r.duplicates && !r.missing,
+                      detail);
+}
+
+// Consumer захватил слот и "завис": слот остаётся занятым для admission,
+// пока его не освободят, даже если следующие уже освобождены
+static ResponseRingBuffer host_freed_ring;
+
+static int host_response_freed_check(void) {
+    ResponseRingBuffer* ring = &host_freed_ring;
+    response_ring_init_mode(ring, RING_MODE_MPMC);
+
+    Response response;
+    response_init(&response, 1, EVENT_STATUS_SUCCESS);
+    for (uint32_t i = 0; i < RING_BUFFER_SIZE; i++) {
+        response_ring_push(ring, &response);
+    }
+
+    uint64_t stalled = 0;
+    response_ring_peek_slot(ring, &stalled);
+    for (uint32_t i = 1; i < RING_BUFFER_SIZE / 2; i++) {
+        response_ring_pop(ring, &response);
+    }
+    uint64_t held = response_ring_used(ring);
+    int blocked = response_ring_reserve(ring, &(uint64_t){0}) == 0;
+
+    response_ring_release(ring, stalled);
+    uint64_t after = response_ring_used(ring);
+
+    int ok = held == RING_BUFFER_SIZE && blocked && after == RING_BUFFER_SIZE / 2;
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(used while held=%lu/%u, after release=%lu)",
+             held, RING_BUFFER_SIZE, after);
+    return host_check("response ring freed frontier", ok, detail);
+}
+
+typedef struct {
+    uint32_t submitter;
+    volatile uint64_t* submitted;
+    volatile uint64_t* completed;
+} HostSubmitter;
+
+static void* host_pipeline_submitter(void* arg) {
+    static const uint32_t types[] = {
+        EVENT_PROC_GETPID, EVENT_TIMER_GETTICKS, EVENT_FILE_STAT, EVENT_SYS_PROBE
+    };
+    HostSubmitter* s = (HostSubmitter*)arg;
+    EventRingBuffer* ring = global_event_system.user_to_kernel_ring;
+    Event event;
+
+    for (uint64_t i = 0; i < HOST_STRESS_EVENTS; i++) {
+        while (atomic_load_u64(s->submitted) - atomic_load_u64(s->completed) >= HOST_STRESS_INFLIGHT) {
+            cpu_pause();
+        }
+
+        uint32_t type = types[(i + s->submitter) % (sizeof(types) / sizeof(types[0]))];
+        event_init(&event, type, s->submitter + 1);
+        if (type == EVENT_FILE_STAT) {
+            strcpy((char*)event.data, HOST_STRESS_FILE);
+        }
+        while (!event_ring_push(ring, &event)) {
+            cpu_pause();
+        }
+        atomic_increment_u64(s->submitted);
+        idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+    }
+    return 0;
+}
+
+// Открытая адресация по event_id: каждый ответ - ровно один раз
+static int host_seen_insert(uint64_t* table, uint64_t mask, uint64_t id) {
+    for (uint64_t i = (id * 0x9E3779B97F4A7C15ULL) & mask; ; i = (i + 1) & mask) {
+        if (table[i] == id) {
+            return 0;
+        }
+        if (table[i] == 0) {
+            table[i] = id;
+            return 1;
+        }
+    }
+}
+
+static int host_pipeline_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    Tag tags[1];
+    strcpy(tags[0].key, "name");
+    strcpy(tags[0].value, HOST_STRESS_FILE);
+    tagfs_create_file(tags, 1, 0, TAGFS_CAP_DEFAULT, TAGFS_ACCESS_PUBLIC);
+
+    uint64_t total = (uint64_t)HOST_STRESS_SUBMITTERS * HOST_STRESS_EVENTS;
+    uint64_t mask = 1;
+    while (mask < total * 2) {
+        mask <<= 1;
+    }
+    uint64_t* seen = (uint64_t*)calloc(mask, sizeof(uint64_t));
+    mask--;
+
+    volatile uint64_t submitted = 0;
+    volatile uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t duplicates = 0;
+
+    HostSubmitter subs[HOST_STRESS_SUBMITTERS];
+    pthread_t threads[HOST_STRESS_SUBMITTERS];
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        subs[s] = (HostSubmitter){ s, &submitted, &completed };
+        pthread_create(&threads[s], 0, host_pipeline_submitter, &subs[s]);
+    }
+
+    Response response;
+    uint64_t last_progress = hal_time_ns();
+    while (completed < total) {
+        eventdriven_process_one_iteration();
+
+        if (!response_ring_pop(global_event_system.kernel_to_user_ring, &response)) {
+            if (hal_time_ns() - last_progress > HOST_STALL_NS) {
+                break;
+            }
+            continue;
+        }
+
+        if (response.status != EVENT_STATUS_SUCCESS) {
+            errors++;
+        }
+        if (!host_seen_insert(seen, mask, response.event_id)) {
+            duplicates++;
+        }
+        payload_arena_release(response.payload_offset);
+        atomic_increment_u64(&completed);
+        last_progress = hal_time_ns();
+    }
+
+    kprintf_set_quiet(0);
+
+    int ok = completed == total && !errors && !duplicates;
+    if (ok) {
+        for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+            pthread_join(threads[s], 0);
+        }
+    }
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(%u submitters: responses=%lu/%lu errors=%lu dup=%lu)",
+             HOST_STRESS_SUBMITTERS, completed, total, errors, duplicates);
+    free(seen);
+    return host_check("pipeline one response/event", ok, detail);
+}
+
+// ============================================================================
+// TASK RINGS - у каждого submitter своя SQ/CQ пара
+// ============================================================================
+
+#define HOST_TASK_ID_BASE       100
+// In-flight на пару: вместе - как у host_pipeline_stress (payload arena -
+// 64 блока, каждый FILE_STAT занимает блок до release)
+#define HOST_TASK_INFLIGHT      (HOST_STRESS_INFLIGHT / HOST_STRESS_SUBMITTERS)
+
+typedef struct {
+    uint32_t ring_id;
+    uint64_t* ids;                      // event_id ответов из своей CQ
+    uint64_t first_id;                  // event_ring_event_id первого слота
+    uint64_t received;
+    uint64_t errors;
+    uint64_t foreign;                   // ID ответа не тот, что submitter знал после commit
+} HostTaskRings;
+
+static void* host_task_rings_submitter(void* arg) {
+    static const uint32_t types[] = {
+        EVENT_PROC_GETPID, EVENT_TIMER_GETTICKS, EVENT_FILE_STAT, EVENT_SYS_PROBE
+    };
+    HostTaskRings* t = (HostTaskRings*)arg;
+    TaskRingPair* rings = task_rings_get(t->ring_id);
+    uint64_t submitted = 0;
+    uint64_t last_progress = hal_time_ns();
+
+    while (t->received < HOST_STRESS_EVENTS && hal_time_ns() - last_progress < HOST_STALL_NS) {
+        // SQ: этот поток - единственный producer, событие строится в слоте
+        uint64_t pos;
+        Event* slot;
+        if (submitted < HOST_STRESS_EVENTS && submitted - t->received < HOST_TASK_INFLIGHT &&
+            (slot = event_ring_reserve(&rings->sq, &pos))) {
+            uint32_t type = types[(submitted + t->ring_id) % (sizeof(types) / sizeof(types[0]))];
+            event_init(slot, type, 0);  // user_id = 0 прошёл бы только через пару
+            if (type == EVENT_FILE_STAT) {
+                strcpy((char*)slot->data, HOST_STRESS_FILE);
+            }
+            event_ring_commit(&rings->sq, pos);
+            if (submitted++ == 0) {
+                t->first_id = event_ring_event_id(&rings->sq, pos);
+            }
+            idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+        }
+
+        Response response;
+        while (response_ring_pop(&rings->cq, &response)) {
+            if (response.status != EVENT_STATUS_SUCCESS) {
+                t->errors++;
+            }
+            // ID подряд по позициям SQ: ответ - на одно из своих событий
+            if (response.event_id - t->first_id >= submitted) {
+                t->foreign++;
+            }
+            payload_arena_release(response.payload_offset);
+            t->ids[t->received++] = response.event_id;
+            last_progress = hal_time_ns();
+        }
+        cpu_pause();
+    }
+    return 0;
+}
+
+static void* host_task_rings_pump(void* arg) {
+    volatile int* done = (volatile int*)arg;
+    while (!*done) {
+        eventdriven_process_one_iteration();
+    }
+    return 0;
+}
+
+static int host_task_rings_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    HostTaskRings tasks[HOST_STRESS_SUBMITTERS];
+    pthread_t threads[HOST_STRESS_SUBMITTERS];
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        tasks[s] = (HostTaskRings){ task_rings_register(HOST_TASK_ID_BASE + s),
+                                    (uint64_t*)calloc(HOST_STRESS_EVENTS, sizeof(uint64_t)),
+                                    0, 0, 0, 0 };
+        pthread_create(&threads[s], 0, host_task_rings_submitter, &tasks[s]);
+    }
+
+    // Синхронный режим: pipeline крутит отдельный поток (BSP в SMP только ждёт)
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        pthread_join(threads[s], 0);
+    }
+    done = 1;
+    pthread_join(pump, 0);
+
+    uint64_t total = (uint64_t)HOST_STRESS_SUBMITTERS * HOST_STRESS_EVENTS;
+    uint64_t mask = 1;
+    while (mask < total * 2) {
+        mask <<= 1;
+    }
+    uint64_t* seen = (uint64_t*)calloc(mask, sizeof(uint64_t));
+    mask--;
+
+    uint64_t received = 0;
+    uint64_t errors = 0;
+    uint64_t duplicates = 0;
+    uint64_t foreign = 0;
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        for (uint64_t i = 0; i < tasks[s].received; i++) {
+            if (!host_seen_insert(seen, mask, tasks[s].ids[i])) {
+                duplicates++;
+            }
+        }
+        received += tasks[s].received;
+        errors += tasks[s].errors;
+        foreign += tasks[s].foreign;
+        task_rings_unregister(HOST_TASK_ID_BASE + s);
+        free(tasks[s].ids);
+    }
+    free(seen);
+
+    // Ни одного ответа не ушло в глобальный ring
+    Response stray;
+    uint64_t strays = 0;
+    while (response_ring_pop(global_event_system.kernel_to_user_ring, &stray)) {
+        strays++;
+    }
+
+    kprintf_set_quiet(0);
+
+    int ok = tasks[0].ring_id != TASK_RING_GLOBAL && received == total && !errors &&
+             !duplicates && !foreign && !strays;
+    char detail[160];
+    snprintf(detail, sizeof(detail),
+             "(%u pairs: responses=%lu/%lu errors=%lu dup=%lu foreign=%lu global=%lu)",
+             HOST_STRESS_SUBMITTERS, received, total, errors, duplicates, foreign, strays);
+    return host_check("task rings own CQ only", ok, detail);
+}
+
+// ============================================================================
+// CHAINS - open -> read -> close одной цепочкой (center/chain.h)
+// ============================================================================
+
+#define HOST_CHAIN_COUNT        2000        // Больше fd table: утечка fd = ошибки open
+#define HOST_CHAIN_INFLIGHT     16
+#define HOST_CHAIN_BROKEN_EVERY 8           // Каждая 8-я: read без CHAIN_FD падает
+
+typedef struct {
+    uint32_t ring_id;
+    uint64_t completed;                 // Цепочка дошла до close, payload read в ответе
+    uint64_t failed;                    // Ответ упавшего read с fd открытого файла
+    uint64_t closed;                    // Ответ на close, которым закрыт этот fd
+    uint64_t errors;
+} HostChains;
+
+static void host_chain_push(EventRingBuffer* sq, uint32_t type, uint32_t flags,
+                            int32_t fd, uint64_t size) {
+    uint64_t pos;
+    Event* slot;
+    while (!(slot = event_ring_reserve(sq, &pos))) {
+        cpu_pause();
+    }
+    event_init(slot, type, 0);
+    slot->flags = flags;
+    if (type == EVENT_FILE_OPEN) {
+        strcpy((char*)slot->data, HOST_STRESS_FILE);
+    } else {
+        *(int32_t*)slot->data = fd;
+        *(uint64_t*)(slot->data + 4) = size;
+    }
+    event_ring_commit(sq, pos);
+}
+
+static void* host_chain_submitter(void* arg) {
+    HostChains* c = (HostChains*)arg;
+    EventRingBuffer* sq = &task_rings_get(c->ring_id)->sq;
+    ResponseRingBuffer* cq = &task_rings_get(c->ring_id)->cq;
+    uint64_t submitted = 0;
+    uint64_t closes = 0;
+    uint64_t last_progress = hal_time_ns();
+
+    while (c->completed + c->closed + c->errors < HOST_CHAIN_COUNT + closes &&
+           hal_time_ns() - last_progress < HOST_STALL_NS) {
+        if (submitted < HOST_CHAIN_COUNT &&
+            submitted - c->completed - c->failed - c->errors < HOST_CHAIN_INFLIGHT) {
+            int broken = (submitted % HOST_CHAIN_BROKEN_EVERY) == 0;
+            host_chain_push(sq, EVENT_FILE_OPEN, EVENT_FLAG_LINK, 0, 0);
+            host_chain_push(sq, EVENT_FILE_READ,
+                            EVENT_FLAG_LINK | (broken ? 0 : EVENT_FLAG_CHAIN_FD), -1, 64);
+            host_chain_push(sq, EVENT_FILE_CLOSE, EVENT_FLAG_CHAIN_FD, 0, 0);
+            submitted++;
+            idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+        }
+
+        Response response;
+        while (response_ring_pop(cq, &response)) {
+            int64_t fd = *(int64_t*)response.result;
+            if (response.status == EVENT_STATUS_SUCCESS &&
+                response.payload_offset != RESPONSE_PAYLOAD_NONE) {
+                c->completed++;
+            } else if (response.status == EVENT_STATUS_SUCCESS) {
+                c->closed++;
+            } else if (response.result_size == sizeof(uint64_t) && fd > 0) {
+                // fd вернул упавший read - закрыть его отдельным событием
+                c->failed++;
+                host_chain_push(sq, EVENT_FILE_CLOSE, 0, (int32_t)fd, 0);
+                closes++;
+                idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+            } else {
+                c->errors++;
+            }
+            payload_arena_release(response.payload_offset);
+            last_progress = hal_time_ns();
+        }
+        cpu_pause();
+    }
+    return 0;
+}
+
+static int host_chain_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    HostChains c = { task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS), 0, 0, 0, 0 };
+    ChainStats before = chain_stats;
+
+    volatile int done = 0;
+    pthread_t submitter, pump;
+    pthread_create(&submitter, 0, host_chain_submitter, &c);
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+    pthread_join(submitter, 0);
+    done = 1;
+    pthread_join(pump, 0);
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS);
+
+    kprintf_set_quiet(0);
+
+    uint64_t broken = (HOST_CHAIN_COUNT + HOST_CHAIN_BROKEN_EVERY - 1) / HOST_CHAIN_BROKEN_EVERY;
+    uint64_t chains = chain_stats.chains - before.chains;
+    uint64_t cancelled = chain_stats.cancelled - before.cancelled;
+    int ok = c.ring_id != TASK_RING_GLOBAL && !c.errors &&
+             c.completed == HOST_CHAIN_COUNT - broken && c.failed == broken &&
+             c.closed == broken && chains == HOST_CHAIN_COUNT && cancelled == broken;
+    char detail[160];
+    snprintf(detail, sizeof(detail),
+             "(%u chains: completed=%lu failed=%lu closed=%lu errors=%lu cancelled=%lu)",
+             HOST_CHAIN_COUNT, c.completed, c.failed, c.closed, c.errors, cancelled);
+    return host_check("chains one response/chain", ok, detail);
+}
+
+// open -> write -> close: inline результат write (байты) не должен попасть
+// в CHAIN_FD close. Цепочек больше fd table - утёкший fd ломает open
+#define HOST_CHAIN_WRITES       (2 * 256)
+
+static int host_chain_write_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    uint32_t ring_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 7);
+    TaskRingPair* rings = task_rings_get(ring_id);
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    uint64_t closed = 0;
+    uint64_t errors = 0;
+    for (uint64_t i = 0; i < HOST_CHAIN_WRITES; i++) {
+        host_chain_push(&rings->sq, EVENT_FILE_OPEN, EVENT_FLAG_LINK, 0, 0);
+        host_chain_push(&rings->sq, EVENT_FILE_WRITE, EVENT_FLAG_LINK | EVENT_FLAG_CHAIN_FD, -1, 8);
+        host_chain_push(&rings->sq, EVENT_FILE_CLOSE, EVENT_FLAG_CHAIN_FD, 0, 0);
+        idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+        Response response;
+        uint64_t start = hal_time_ns();
+        int popped;
+        while (!(popped = response_ring_pop(&rings->cq, &response)) &&
+               hal_time_ns() - start < HOST_STALL_NS) {
+            cpu_pause();
+        }
+        if (!popped) {
+            errors++;
+            break;
+        }
+        if (response.status == EVENT_STATUS_SUCCESS) {
+            closed++;
+        } else {
+            errors++;
+        }
+        payload_arena_release(response.payload_offset);
+    }
+
+    done = 1;
+    pthread_join(pump, 0);
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 7);
+
+    kprintf_set_quiet(0);
+
+    int ok = ring_id != TASK_RING_GLOBAL && closed == HOST_CHAIN_WRITES && !errors;
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(%u chains: closed=%lu errors=%lu)",
+             HOST_CHAIN_WRITES, closed, errors);
+    return host_check("chains write keeps fd", ok, detail);
+}
+
+// Задача ушла посреди сборки: task_rings_unregister освобождает слот пула и
+// возвращает кредиты звеньев
+static int host_chain_orphan_check(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    uint64_t task_id = HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 12;
+    uint32_t ring_id = task_rings_register(task_id);
+    TaskRingPair* rings = task_rings_get(ring_id);
+    ChainStats before = chain_stats;
+    uint64_t processed = center_stats.events_processed;
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    host_chain_push(&rings->sq, EVENT_FILE_OPEN, EVENT_FLAG_LINK, 0, 0);
+    host_chain_push(&rings->sq, EVENT_FILE_READ, EVENT_FLAG_LINK | EVENT_FLAG_CHAIN_FD, -1, 64);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+    // Оба звена у Center - сборка ждёт завершающее звено, которого не будет
+    uint64_t start = hal_time_ns();
+    while (center_stats.events_processed < processed + 2 && hal_time_ns() - start < HOST_STALL_NS) {
+        cpu_pause();
+    }
+    usleep(20000);
+
+    task_rings_unregister(task_id);
+    done = 1;
+    pthread_join(pump, 0);
+
+    kprintf_set_quiet(0);
+
+    uint64_t orphaned = chain_stats.orphaned - before.orphaned;
+    uint64_t cancelled = chain_stats.cancelled - before.cancelled;
+    uint64_t inflight = credit_rings[ring_id].inflight;
+    int ok = ring_id != TASK_RING_GLOBAL && orphaned == 1 && cancelled == 2 && inflight == 0;
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(orphaned=%lu cancelled=%lu inflight=%lu)",
+             orphaned, cancelled, inflight);
+    return host_check("chains freed on unregister", ok, detail);
+}
+
+// ============================================================================
+// STORAGE POOL - handlers Storage на нескольких workers параллельно
+// ============================================================================
+
+// Все submitters открывают один и тот же ещё не существующий файл: open =
+// поиск + создание, файл должен появиться ровно один раз
+#define HOST_STORAGE_OPENS      300     // Цепочек open -> close на submitter
+#define HOST_STORAGE_FILE       "host-storage-shared"
+
+typedef struct {
+    uint32_t task_id;
+    uint64_t closed;
+    uint64_t errors;
+} HostStorageSubmitter;
+
+static void* host_storage_submitter(void* arg) {
+    HostStorageSubmitter* t = (HostStorageSubmitter*)arg;
+    TaskRingPair* rings = task_rings_get(task_rings_register(t->task_id));
+    if (!rings) {
+        t->errors++;
+        return 0;
+    }
+
+    for (uint64_t i = 0; i < HOST_STORAGE_OPENS; i++) {
+        uint64_t pos;
+        Event* slot;
+        while (!(slot = event_ring_reserve(&rings->sq, &pos))) {
+            cpu_pause();
+        }
+        event_init(slot, EVENT_FILE_OPEN, 0);
+        slot->flags = EVENT_FLAG_LINK;
+        strcpy((char*)slot->data, HOST_STORAGE_FILE);
+        event_ring_commit(&rings->sq, pos);
+
+        host_chain_push(&rings->sq, EVENT_FILE_CLOSE, EVENT_FLAG_CHAIN_FD, 0, 0);
+        idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+        Response response;
+        uint64_t start = hal_time_ns();
+        int popped;
+        while (!(popped = response_ring_pop(&rings->cq, &response)) &&
+               hal_time_ns() - start < HOST_STALL_NS) {
+            cpu_pause();
+        }
+        if (!popped) {
+            t->errors++;
+            break;
+        }
+        if (response.status == EVENT_STATUS_SUCCESS) {
+            t->closed++;
+        } else {
+            t->errors++;
+        }
+        payload_arena_release(response.payload_offset);
+    }
+
+    task_rings_unregister(t->task_id);
+    return 0;
+}
+
+static int host_storage_pool_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    DeckContext* storage = deck_get_context(DECK_PREFIX_STORAGE);
+    uint64_t before[DECK_MAX_WORKERS];
+    for (uint32_t i = 0; i < storage->stats.worker_count; i++) {
+        before[i] = storage->stats.workers[i].events_processed;
+    }
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    HostStorageSubmitter tasks[HOST_STRESS_SUBMITTERS];
+    pthread_t threads[HOST_STRESS_SUBMITTERS];
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        tasks[s] = (HostStorageSubmitter){ HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 8 + s, 0, 0 };
+        pthread_create(&threads[s], 0, host_storage_submitter, &tasks[s]);
+    }
+
+    uint64_t closed = 0;
+    uint64_t errors = 0;
+    for (uint32_t s = 0; s < HOST_STRESS_SUBMITTERS; s++) {
+        pthread_join(threads[s], 0);
+        closed += tasks[s].closed;
+        errors += tasks[s].errors;
+    }
+    done = 1;
+    pthread_join(pump, 0);
+
+    kprintf_set_quiet(0);
+
+    Tag name;
+    strcpy(name.key, "name");
+    strcpy(name.value, HOST_STORAGE_FILE);
+    uint64_t inodes[4];
+    uint32_t files = 0;
+    tagfs_query_single(&name, inodes, &files, 4);
+
+    // Каждый worker пула что-то обработал (сам или кражей)
+    uint32_t idle_workers = 0;
+    for (uint32_t i = 0; i < storage->stats.worker_count; i++) {
+        if (storage->stats.workers[i].events_processed == before[i]) {
+            idle_workers++;
+        }
+    }
+
+    int ok = closed == HOST_STRESS_SUBMITTERS * HOST_STORAGE_OPENS && !errors && files == 1 &&
+             !idle_workers;
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(%u workers: closed=%lu errors=%lu files=%u idle=%u)",
+             storage->stats.worker_count, closed, errors, files, idle_workers);
+    return host_check("storage pool, one create", ok, detail);
+}
+
+// ============================================================================
+// USER BUFFERS - FILE_WRITE / FILE_READ через зарегистрированный буфер
+// ============================================================================
+
+#define HOST_FIXED_FILE         "host-fixed"
+#define HOST_FIXED_SIZE         (3 * PMM_PAGE_SIZE + 1000)  // Через страницы, >> Event.data (RAM TagFS мала)
+#define HOST_FIXED_SHIFT        100                         // Буфер не с начала страницы
+
+// Одно событие через пару ring_id, ждём его ответ (pipeline крутит pump)
+static int host_fixed_call(uint32_t ring_id, uint32_t type, uint32_t flags,
+                           const void* data, uint32_t size, Response* response) {
+    TaskRingPair* rings = task_rings_get(ring_id);
+    uint64_t pos;
+    Event* slot;
+    while (!(slot = event_ring_reserve(&rings->sq, &pos))) {
+        cpu_pause();
+    }
+    event_init(slot, type, 0);
+    slot->flags = flags;
+    memcpy(slot->data, data, size);
+    event_ring_commit(&rings->sq, pos);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+    uint64_t start = hal_time_ns();
+    while (!response_ring_pop(&rings->cq, response)) {
+        if (hal_time_ns() - start > HOST_STALL_NS) {
+            return 0;
+        }
+        cpu_pause();
+    }
+    payload_arena_release(response->payload_offset);
+    return response->status == EVENT_STATUS_SUCCESS;
+}
+
+// [fd:4][size:8][buffer id:4][buffer offset:8]
+static uint64_t host_fixed_io(uint32_t ring_id, uint32_t type, int32_t fd, uint32_t id,
+                              uint64_t size, Response* response) {
+    uint8_t data[24];
+    uint64_t offset = 0;
+    memcpy(data, &fd, 4);
+    memcpy(data + 4, &size, 8);
+    memcpy(data + 12, &id, 4);
+    memcpy(data + 16, &offset, 8);
+    if (!host_fixed_call(ring_id, type, EVENT_FLAG_FIXED_BUF, data, sizeof(data), response)) {
+        return 0;
+    }
+    return *(uint64_t*)response->result;
+}
+
+static int host_user_buffers_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    uint32_t ring_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 1);
+    uint64_t pages = (HOST_FIXED_SHIFT + HOST_FIXED_SIZE + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+    uint8_t* memory = (uint8_t*)pmm_alloc_zero(pages);
+    uint8_t* buffer = memory + HOST_FIXED_SHIFT;
+    for (uint64_t i = 0; i < HOST_FIXED_SIZE; i++) {
+        buffer[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    Response response;
+    uint64_t reg[2] = { HOST_FIXED_SIZE, (uint64_t)(uintptr_t)buffer };
+    host_fixed_call(ring_id, EVENT_MEMORY_REGISTER, 0, reg, sizeof(reg), &response);
+    uint32_t id = (uint32_t)*(uint64_t*)response.result;
+
+    uint64_t arena_before = payload_arena_stats.allocations;
+    host_fixed_call(ring_id, EVENT_FILE_OPEN, 0, HOST_FIXED_FILE, sizeof(HOST_FIXED_FILE), &response);
+    int32_t fd = (int32_t)*(uint64_t*)response.result;
+    uint64_t written = host_fixed_io(ring_id, EVENT_FILE_WRITE, fd, id, HOST_FIXED_SIZE, &response);
+    host_fixed_call(ring_id, EVENT_FILE_CLOSE, 0, &fd, sizeof(fd), &response);
+
+    memset(buffer, 0, HOST_FIXED_SIZE);
+    host_fixed_call(ring_id, EVENT_FILE_OPEN, 0, HOST_FIXED_FILE, sizeof(HOST_FIXED_FILE), &response);
+    fd = (int32_t)*(uint64_t*)response.result;
+    uint64_t read = host_fixed_io(ring_id, EVENT_FILE_READ, fd, id, HOST_FIXED_SIZE, &response);
+    uint64_t arena_used = payload_arena_stats.allocations - arena_before;
+
+    uint64_t mismatches = 0;
+    for (uint64_t i = 0; i < HOST_FIXED_SIZE; i++) {
+        mismatches += buffer[i] != (uint8_t)(i * 7 + 3);
+    }
+
+    // После unregister буфер недоступен: ошибка, а не копия в чужую память
+    int unregistered = host_fixed_call(ring_id, EVENT_MEMORY_UNREGISTER, 0, &id, sizeof(id), &response);
+    host_fixed_io(ring_id, EVENT_FILE_READ, fd, id, 16, &response);
+    int stale_rejected = response.status != EVENT_STATUS_SUCCESS &&
+                         response.error_code == USER_BUFFER_ERROR_ID;
+    host_fixed_call(ring_id, EVENT_FILE_CLOSE, 0, &fd, sizeof(fd), &response);
+
+    done = 1;
+    pthread_join(pump, 0);
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 1);
+    pmm_free(memory, pages);
+
+    kprintf_set_quiet(0);
+
+    int ok = id != USER_BUFFER_NONE && written == HOST_FIXED_SIZE && read == HOST_FIXED_SIZE &&
+             !mismatches && !arena_used && unregistered && stale_rejected;
+    char detail[160];
+    snprintf(detail, sizeof(detail),
+             "(buffer %u: written=%lu read=%lu/%u mismatches=%lu arena=%lu stale=%s)",
+             id, written, read, HOST_FIXED_SIZE, mismatches, arena_used,
+             stale_rejected ? "rejected" : "ACCEPTED");
+    return host_check("user buffers direct I/O", ok, detail);
+}
+
+// ============================================================================
+// CREDITS - submitter забирает ответы, только когда SQ полна
+// ============================================================================
+
+#define HOST_CREDIT_EVENTS      20000
+
+typedef struct {
+    uint32_t ring_id;
+    uint64_t submitted;
+    uint64_t success;
+    uint64_t busy;
+    uint64_t errors;
+    uint64_t full;                      // Раз SQ заполнилась (EAGAIN)
+} HostCredits;
+
+static void* host_credits_submitter(void* arg) {
+    HostCredits* c = (HostCredits*)arg;
+    TaskRingPair* rings = task_rings_get(c->ring_id);
+    uint64_t last_progress = hal_time_ns();
+    int waiting = 0;
+
+    while (c->success + c->busy + c->errors < HOST_CREDIT_EVENTS &&
+           hal_time_ns() - last_progress < HOST_STALL_NS) {
+        uint64_t pos;
+        Event* slot;
+        if (c->submitted < HOST_CREDIT_EVENTS && (slot = event_ring_reserve(&rings->sq, &pos))) {
+            event_init(slot, EVENT_SYS_PROBE, 0);  // Не коалесцируется
+            event_ring_commit(&rings->sq, pos);
+            c->submitted++;
+            waiting = 0;
+            idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+            continue;
+        }
+        if (c->submitted < HOST_CREDIT_EVENTS && !waiting) {
+            c->full++;
+            waiting = 1;
+        }
+
+        // SQ полна (или всё отправлено): только теперь разгружаем CQ
+        Response response;
+        while (response_ring_pop(&rings->cq, &response)) {
+            if (response.status == EVENT_STATUS_SUCCESS) {
+                c->success++;
+            } else if (response.status == EVENT_STATUS_BUSY) {
+                c->busy++;
+            } else {
+                c->errors++;
+            }
+            payload_arena_release(response.payload_offset);
+            last_progress = hal_time_ns();
+        }
+        cpu_pause();
+    }
+    return 0;
+}
+
+static int host_credits_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    HostCredits c = { task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 2),
+                      0, 0, 0, 0, 0 };
+    uint64_t overflows = credit_stats.overflows;
+
+    volatile int done = 0;
+    pthread_t submitter, pump;
+    pthread_create(&submitter, 0, host_credits_submitter, &c);
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+    pthread_join(submitter, 0);
+    done = 1;
+    pthread_join(pump, 0);
+
+    uint64_t inflight = credit_rings[c.ring_id].inflight;
+    uint64_t peak = credit_rings[c.ring_id].peak;
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 2);
+    overflows = credit_stats.overflows - overflows;
+
+    kprintf_set_quiet(0);
+
+    int ok = c.ring_id != TASK_RING_GLOBAL && c.success + c.busy == HOST_CREDIT_EVENTS &&
+             c.busy && !c.errors && !inflight && peak <= CREDITS_PER_RING && !overflows;
+    char detail[160];
+    snprintf(detail, sizeof(detail),
+             "(%u events: ok=%lu busy=%lu errors=%lu sq-full=%lu peak=%lu/%u overflows=%lu)",
+             HOST_CREDIT_EVENTS, c.success, c.busy, c.errors, c.full, peak, CREDITS_PER_RING,
+             overflows);
+    return host_check("credits busy, no stall", ok, detail);
+}
+
+// ============================================================================
+// REAPER - entries, чей hand-off потерян, отвечают TIMEOUT по дедлайну
+// ============================================================================
+
+#define HOST_REAPER_LOST        64
+#define HOST_REAPER_EVENTS      2000
+#define HOST_REAPER_TIMEOUT_MS  5
+#define HOST_REAPER_ID_BASE     (0xFFF0ULL << 48)  // Не пересекается с id Receiver'а
+
+// Entry как после Center, но без guide_route_entry: её никто не держит
+static void host_reaper_lose(uint32_t ring_id, uint64_t id) {
+    Event event;
+    event_init(&event, EVENT_DEV_READ, 0);
+    event.id = id;
+    event.flags = event_ring_id_flags(ring_id) | event_timeout_flags(HOST_REAPER_TIMEOUT_MS);
+    event.timestamp = rdtsc();
+
+    credits_acquire(ring_id);
+    RoutingEntry* entry = routing_table_reserve(global_event_system.routing_table, id);
+    routing_entry_init(entry, id, &event);
+    routing_entry_hold_init(entry);
+    entry->created_at = rdtsc();
+    entry->deadline = reaper_deadline(&event);
+    routing_table_publish(entry);
+    routing_entry_leave(entry, routing_entry_handle(entry));
+}
+
+static int host_reaper_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    uint32_t ring_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 3);
+    TaskRingPair* rings = task_rings_get(ring_id);
+    uint64_t entries_before = global_event_system.routing_table->total_entries;
+    uint64_t reaped_before = reaper_stats.per_type[EVENT_DEV_READ];
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    for (uint64_t i = 0; i < HOST_REAPER_LOST; i++) {
+        host_reaper_lose(ring_id, HOST_REAPER_ID_BASE + i);
+    }
+
+    // Обычные события идут мимо: дедлайн по умолчанию их не трогает.
+    // In-flight ограничен - потерянные entries держат кредиты, BUSY не нужен
+    uint64_t submitted = 0, success = 0, timeouts = 0, errors = 0;
+    uint64_t last_progress = hal_time_ns();
+    while (success + timeouts + errors < HOST_REAPER_LOST + HOST_REAPER_EVENTS &&
+           hal_time_ns() - last_progress < HOST_STALL_NS) {
+        uint64_t pos;
+        Event* slot;
+        if (submitted < HOST_REAPER_EVENTS && submitted - success - errors < HOST_TASK_INFLIGHT &&
+            (slot = event_ring_reserve(&rings->sq, &pos))) {
+            event_init(slot, EVENT_SYS_PROBE, 0);
+            event_ring_commit(&rings->sq, pos);
+            submitted++;
+            idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+        }
+
+        Response response;
+        while (response_ring_pop(&rings->cq, &response)) {
+            if (response.event_id >= HOST_REAPER_ID_BASE && response.status == EVENT_STATUS_TIMEOUT) {
+                timeouts++;
+            } else if (response.event_id < HOST_REAPER_ID_BASE &&
+                       response.status == EVENT_STATUS_SUCCESS) {
+                success++;
+            } else {
+                errors++;
+            }
+            payload_arena_release(response.payload_offset);
+            last_progress = hal_time_ns();
+        }
+        cpu_pause();
+    }
+
+    done = 1;
+    pthread_join(pump, 0);
+
+    uint64_t reaped = reaper_stats.per_type[EVENT_DEV_READ] - reaped_before;
+    uint64_t inflight = credit_rings[ring_id].inflight;
+    uint64_t entries = global_event_system.routing_table->total_entries - entries_before;
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 3);
+
+    kprintf_set_quiet(0);
+
+    int ok = ring_id != TASK_RING_GLOBAL && timeouts == HOST_REAPER_LOST &&
+             success == HOST_REAPER_EVENTS && !errors && reaped == HOST_REAPER_LOST &&
+             !inflight && !entries;
+    char detail[160];
+    snprintf(detail, sizeof(detail),
+             "(lost=%u: timeouts=%lu reaped=%lu ok=%lu/%u errors=%lu inflight=%lu entries=%ld)",
+             HOST_REAPER_LOST, timeouts, reaped, success, HOST_REAPER_EVENTS, errors, inflight,
+             (int64_t)entries);
+    return host_check("reaper timeouts", ok, detail);
+}
+
+// ============================================================================
+// BROKEN CQ - задача портит head/seq своей CQ, ядро не должно встать
+// ============================================================================
+
+#define HOST_BROKEN_LOST        16
+#define HOST_BROKEN_EVENTS      1000
+
+static int host_broken_cq_stress(void) {
+    kprintf_set_quiet(!host_verbose);
+
+    uint32_t broken_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 4);
+    uint32_t ring_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 5);
+    TaskRingPair* broken = task_rings_get(broken_id);
+    uint64_t entries_before = global_event_system.routing_table->total_entries;
+
+    volatile int done = 0;
+    pthread_t pump;
+    pthread_create(&pump, 0, host_task_rings_pump, (void*)&done);
+
+    // Ответы на эти entries дадут Execution (reaper) уже после порчи CQ
+    for (uint64_t i = 0; i < HOST_BROKEN_LOST; i++) {
+        host_reaper_lose(broken_id, HOST_REAPER_ID_BASE + HOST_REAPER_LOST + i);
+    }
+    broken->cq.head = broken->cq.tail + 12345;
+    memset((void*)broken->cq.seq, 0xA5, sizeof(broken->cq.seq));
+
+    Response response;
+    uint64_t success = 0;
+    for (uint64_t i = 0; i < HOST_BROKEN_EVENTS; i++) {
+        success += host_fixed_call(ring_id, EVENT_SYS_PROBE, 0, 0, 0, &response);
+    }
+
+    uint64_t start = hal_time_ns();
+    while (credit_rings[broken_id].inflight && hal_time_ns() - start < HOST_STALL_NS) {
+        cpu_pause();
+    }
+
+    done = 1;
+    pthread_join(pump, 0);
+
+    uint64_t inflight = credit_rings[broken_id].inflight;
+    uint64_t dropped = task_ring_slots[broken_id].cq_dropped;
+    uint32_t marked = task_ring_slots[broken_id].cq_broken;
+    uint64_t entries = global_event_system.routing_table->total_entries - entries_before;
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 4);
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 5);
+
+    kprintf_set_quiet(0);
+
+    int ok = broken_id != TASK_RING_GLOBAL && ring_id != TASK_RING_GLOBAL && marked &&
+             dropped == HOST_BROKEN_LOST && !inflight && success == HOST_BROKEN_EVENTS && !entries;
+    char detail[160];
+    snprintf(detail, sizeof(detail), "(dropped=%lu/%u inflight=%lu other pair ok=%lu/%u entries=%ld)",
+             dropped, HOST_BROKEN_LOST, inflight, success, HOST_BROKEN_EVENTS, (int64_t)entries);
+    return host_check("broken CQ isolated", ok, detail);
+}
+
+// ============================================================================
+// SQ DOORBELL - задача не зовёт idle_notify, Receiver спит
+// ============================================================================
+
+#define HOST_DOORBELL_WAIT_NS   (1000ULL * 1000 * 1000)
+
+static int host_sq_doorbell_stress(void) {
+    IdleWaiter* receiver = idle_stage_waiters[EVENTDRIVEN_STAGE_RECEIVER];
+    if (!receiver) {
+        return host_check("task SQ timer doorbell", 1, "(sync mode: Receiver never sleeps)");
+    }
+
+    kprintf_set_quiet(!host_verbose);
+
+    uint32_t ring_id = task_rings_register(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 6);
+    TaskRingPair* rings = task_rings_get(ring_id);
+    uint64_t wakeups = task_rings_state.timer_wakeups;
+
+    uint64_t start = hal_time_ns();
+    while (!atomic_load_u32(&receiver->sleeping) && hal_time_ns() - start < HOST_STALL_NS) {
+        usleep(100);
+    }
+    int slept = atomic_load_u32(&receiver->sleeping) != 0;
+
+    // Как задача в ring 3: слот SQ и commit, без idle_notify
+    uint64_t pos;
+    Event* slot = event_ring_reserve(&rings->sq, &pos);
+    event_init(slot, EVENT_SYS_PROBE, 0);
+    event_ring_commit(&rings->sq, pos);
+
+    Response response;
+    int answered = 0;
+    start = hal_time_ns();
+    while (!(answered = response_ring_pop(&rings->cq, &response)) &&
+           hal_time_ns() - start < HOST_DOORBELL_WAIT_NS) {
+        usleep(100);
+    }
+    uint64_t waited = (hal_time_ns() - start) / 1000;
+    wakeups = task_rings_state.timer_wakeups - wakeups;
+    task_rings_unregister(HOST_TASK_ID_BASE + HOST_STRESS_SUBMITTERS + 6);
+
+    kprintf_set_quiet(0);
+
+    int ok = ring_id != TASK_RING_GLOBAL && slept && answered &&
+             response.status == EVENT_STATUS_SUCCESS && wakeups;
+    char detail[128];
+    snprintf(detail, sizeof(detail), "(receiver slept=%d answered=%d in %lu us, tick wakeups=%lu)",
+             slept, answered, waited, wakeups);
+    return host_check("task SQ timer doorbell", ok, detail);
+}
+
+static int host_stress(void) {
+    int failed = 0;
+    failed += host_ring_stress();
+    failed += host_response_freed_check();
+    failed += host_pipeline_stress();
+    failed += host_task_rings_stress();
+    failed += host_chain_stress();
+    failed += host_chain_write_stress();
+    failed += host_chain_orphan_check();
+    failed += host_storage_pool_stress();
+    failed += host_user_buffers_stress();
+    failed += host_credits_stress();
+    failed += host_reaper_stress();
+    failed += host_broken_cq_stress();
+    failed += host_sq_doorbell_stress();
+
+    printf("[HOST] stress: %s\n", failed ? "FAILED" : "PASSED");
+    return failed ? 1 : 0;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void host_usage(void) {
+    fprintf(stderr, "usage: boxos-host [-c cores] [-v] bench [events] [depth] | stress\n");
+}
+
+int main(int argc, char** argv) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t cores = online > 0 ? (uint32_t)online : 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:v")) != -1) {
+        if (opt == 'c') {
+            cores = (uint32_t)atoi(optarg);
+        } else if (opt == 'v') {
+            host_verbose = 1;
+        } else {
+            host_usage();
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        host_usage();
+        return 2;
+    }
+
+    const char* mode = argv[optind];
+    setvbuf(stdout, 0, _IOLBF, 0);
+    hal_set_cpu_count(cores);
+
+    // Init печатает сотни строк - только с -v
+    kprintf_set_quiet(!host_verbose);
+    eventdriven_system_init();
+    eventdriven_system_start();
+    kprintf_set_quiet(0);
+
+    printf("[HOST] pipeline on %u worker threads (%u cores)\n",
+           global_event_system.worker_cores, hal_cpu_count());
+
+    if (strcmp(mode, "bench") == 0) {
+        uint64_t events = optind + 1 < argc ? (uint64_t)atol(argv[optind + 1]) : PIPELINE_BENCH_EVENTS;
+        uint32_t depth = optind + 2 < argc ? (uint32_t)atoi(argv[optind + 2]) : PIPELINE_BENCH_DEPTH;
+        return host_bench(events, depth);
+    }
+    if (strcmp(mode, "stress") == 0) {
+        return host_stress();
+    }
+
+    host_usage();
+    return 2;
+}
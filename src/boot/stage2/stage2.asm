@@ -28,9 +28,9 @@
 ; === CONSTANTS ===
 KERNEL_LOAD_ADDR      equ 0x10000
 KERNEL_SECTOR_START   equ 10
-KERNEL_SECTOR_COUNT   equ 320          ; FIXED: Sync with Makefile (320 sectors)
-KERNEL_SIZE_BYTES     equ 163840       ; FIXED: 320 * 512 = 163840 bytes
-KERNEL_END_ADDR       equ 0x38000      ; FIXED: 0x10000 + 163840 = 0x38000
+KERNEL_SECTOR_COUNT   equ 640          ; Sync with Makefile (KERNEL_SECTORS)
+KERNEL_SIZE_BYTES     equ 327680       ; 640 * 512 = 327680 bytes
+KERNEL_END_ADDR       equ 0x60000      ; 0x10000 + 327680 = 0x60000
 
 PAGE_TABLE_BASE       equ 0x500000      ; MOVED: Above kernel BSS (was 0x70000)
 E820_MAP_ADDR         equ 0x500         ; Low memory (safe after BIOS data area)
@@ -453,7 +453,7 @@ load_kernel_simple:
     jc .use_chs          ; Если не поддерживается, используем CHS
 
     ; Используем INT 13h Extensions (LBA)
-    ; Загружаем 266 секторов (133KB) начиная с LBA 10
+    ; Загружаем 640 секторов (320KB) начиная с LBA 10
 
     ; Часть 1: 127 секторов
     mov si, dap1
@@ -469,12 +469,33 @@ load_kernel_simple:
     int 0x13
     jc .disk_error
 
-    ; Часть 3: 26 секторов (remaining: 280 - 127 - 127 = 26)
+    ; Часть 3: 127 секторов
     mov si, dap3
     mov ah, 0x42
     mov dl, 0x80
     int 0x13
     jc .disk_error
+
+    ; Часть 4: 127 секторов
+    mov si, dap4
+    mov ah, 0x42
+    mov dl, 0x80
+    int 0x13
+    jc .disk_error
+
+    ; Часть 5: 127 секторов
+    mov si, dap5
+    mov ah, 0x42
+    mov dl, 0x80
+    int 0x13
+    jc .disk_error
+
+    ; Часть 6: 5 секторов (640 - 5 * 127 = 5)
+    mov si, dap6
+    mov ah, 0x42
+    mov dl, 0x80
+    int 0x13
+    jc .disk_error
     jmp .check_kernel
 
 .use_chs:
@@ -794,10 +815,13 @@ gdt_descriptor:
     dd gdt_start                  ; Base address (32-bit в 16-bit режиме)
 
 ; ===== DAP STRUCTURES FOR INT 13h EXTENSIONS (LBA MODE) =====
-; FIXED: Total: 320 sectors = 160KB (sync with Makefile)
+; Total: 640 sectors = 320KB (sync with Makefile)
 ; Part 1: 127 sectors (max single read) → 0x10000
 ; Part 2: 127 sectors                  → 0x1FE00
-; Part 3:  66 sectors (320-127-127)    → 0x2FC00
+; Part 3: 127 sectors                  → 0x2FC00
+; Part 4: 127 sectors                  → 0x3FA00
+; Part 5: 127 sectors                  → 0x4F800
+; Part 6:   5 sectors (640-5*127)      → 0x5F600
 align 4
 dap1:
     db 0x10             ; DAP size (16 bytes)
@@ -820,11 +844,38 @@ align 4
 dap3:
     db 0x10             ; DAP size (16 bytes)
     db 0                ; Reserved
-    dw 66               ; FIXED: Sector count: 66 (320 - 127 - 127 = 66)
+    dw 127              ; Sector count: 127
     dw 0x0000           ; Offset
     dw 0x2FC0           ; Segment (0x2FC0:0x0000 = 0x2FC00 physical)
     dq 264              ; Starting LBA sector: 264 (10 + 127 + 127)
 
+align 4
+dap4:
+    db 0x10             ; DAP size (16 bytes)
+    db 0                ; Reserved
+    dw 127              ; Sector count: 127
+    dw 0x0000           ; Offset
+    dw 0x3FA0           ; Segment (0x3FA0:0x0000 = 0x3FA00 physical)
+    dq 391              ; Starting LBA sector: 391 (10 + 3 * 127)
+
+align 4
+dap5:
+    db 0x10             ; DAP size (16 bytes)
+    db 0                ; Reserved
+    dw 127              ; Sector count: 127
+    dw 0x0000           ; Offset
+    dw 0x4F80           ; Segment (0x4F80:0x0000 = 0x4F800 physical)
+    dq 518              ; Starting LBA sector: 518 (10 + 4 * 127)
+
+align 4
+dap6:
+    db 0x10             ; DAP size (16 bytes)
+    db 0                ; Reserved
+    dw 5                ; Sector count: 5 (640 - 5 * 127 = 5)
+    dw 0x0000           ; Offset
+    dw 0x5F60           ; Segment (0x5F60:0x0000 = 0x5F600 physical)
+    dq 645              ; Starting LBA sector: 645 (10 + 5 * 127)
+
 ; ===== MESSAGES =====
 msg_stage2_start      db 'BoxKernel Stage2 Started', 13, 10, 0
 msg_a20_enabled       db '[OK] A20 line enabled', 13, 10, 0
@@ -833,8 +884,8 @@ msg_e820_success      db '[OK] E820 memory map created', 13, 10, 0
 msg_e820_fail         db '[WARN] E820 failed, using fallback', 13, 10, 0
 msg_memory_fallback   db '[OK] Fallback memory detection', 13, 10, 0
 msg_memory_error      db '[ERROR] Memory detection failed!', 13, 10, 0
-msg_loading_kernel    db 'Loading kernel (320 sectors)...', 13, 10, 0
-msg_kernel_loaded     db '[OK] Kernel loaded (160KB)', 13, 10, 0
+msg_loading_kernel    db 'Loading kernel (640 sectors)...', 13, 10, 0
+msg_kernel_loaded     db '[OK] Kernel loaded (320KB)', 13, 10, 0
 msg_kernel_empty      db '[WARN] Kernel appears empty', 13, 10, 0
 msg_disk_error        db '[ERROR] Disk read failed!', 13, 10, 0
 msg_long_mode_ok      db '[OK] CPU supports 64-bit mode', 13, 10, 0
@@ -3,7 +3,7 @@
 #include "tss.h"
 
 // GDT таблица (7 записей: null, kernel code, kernel data, user code, user data, TSS low, TSS high)
-static gdt_entry_t gdt[7];
+static gdt_entry_t gdt[GDT_ENTRY_COUNT];
 static gdt_descriptor_t gdt_desc;
 static tss_t kernel_tss;
 
@@ -99,6 +99,26 @@ void gdt_set_tss_entry(int index, uint64_t base, uint64_t limit) {
     kprintf("[GDT] Second entry: 0x%016llx\n", *second_entry);
 }
 
+void gdt_init_cpu(gdt_entry_t* table, gdt_descriptor_t* desc, void* tss, uint64_t tss_limit) {
+    // Сегменты те же, что у BSP; отличается только TSS дескриптор
+    // (busy-флаг TSS не даёт двум ядрам загрузить один и тот же TSS)
+    memcpy(table, gdt, 5 * sizeof(gdt_entry_t));
+
+    uint64_t base = (uint64_t)tss;
+    table[5].limit_low = tss_limit & 0xFFFF;
+    table[5].base_low = base & 0xFFFF;
+    table[5].base_middle = (base >> 16) & 0xFF;
+    table[5].access = 0x89;
+    table[5].granularity = ((tss_limit >> 16) & 0x0F);
+    table[5].base_high = (base >> 24) & 0xFF;
+    *(uint64_t*)&table[6] = (base >> 32);
+
+    desc->limit = sizeof(gdt) - 1;
+    desc->base = (uint64_t)table;
+
+    gdt_load_asm((uint64_t)desc);
+}
+
 void gdt_load(void) {
     kprintf("[GDT] Loading GDT at 0x%p (limit: %d)...\n", (void*)gdt_desc.base, gdt_desc.limit);
     
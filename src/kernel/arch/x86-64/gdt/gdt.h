@@ -10,6 +10,9 @@
 #define GDT_USER_DATA     0x20
 #define GDT_TSS           0x28
 
+// null, kernel code/data, user code/data, TSS (2 записи)
+#define GDT_ENTRY_COUNT   7
+
 // Структура GDT записи
 typedef struct {
     uint16_t limit_low;
@@ -52,4 +55,7 @@ void gdt_set_tss_entry(int index, uint64_t base, uint64_t limit);
 void gdt_load(void);
 void gdt_test(void);
 
+// SMP: собственная копия GDT (со своим TSS) для AP ядра + загрузка
+void gdt_init_cpu(gdt_entry_t* table, gdt_descriptor_t* desc, void* tss, uint64_t tss_limit);
+
 #endif // GDT_H
\ No newline at end of file
@@ -71,6 +71,18 @@ void tss_init(void) {
     kprintf("[TSS] %[S]TSS loaded successfully!%[D]\n");
 }
 
+void tss_init_cpu(tss_t* tss, uint64_t rsp0, uint8_t* ist_stacks) {
+    memset(tss, 0, sizeof(tss_t));
+    tss->rsp0 = rsp0;
+
+    // Те же IST индексы, что и у BSP (IDT общий для всех ядер)
+    for (int i = 0; i < 7; i++) {
+        *(&tss->ist1 + i) = (uint64_t)ist_stacks + (i + 1) * IST_STACK_SIZE - 16;
+    }
+
+    tss->iomap_base = sizeof(tss_t);
+}
+
 void tss_set_rsp0(uint64_t rsp0) {
     kernel_tss.rsp0 = rsp0;
     kprintf("[TSS] RSP0 updated to 0x%p\n", (void*)rsp0);
@@ -49,6 +49,9 @@ void tss_set_rsp0(uint64_t rsp0);
 void tss_load(void);
 void tss_test(void);
 
+// SMP: TSS для AP ядра (ist_stacks = 7 * IST_STACK_SIZE байт)
+void tss_init_cpu(tss_t* tss, uint64_t rsp0, uint8_t* ist_stacks);
+
 // Получение указателей на IST стеки
 uint64_t tss_get_ist_stack(int ist_num);
 
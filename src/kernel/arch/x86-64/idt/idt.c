@@ -7,6 +7,9 @@
 #include "task.h" // Task scheduler
 #include "keyboard.h" // Keyboard driver
 #include "vmm.h"  // VMM for page fault handling
+#include "lapic.h" // SMP doorbell IPI
+#include "reaper.h" // Event deadlines
+#include "task_rings.h" // Task SQ doorbell
 
 static idt_entry_t idt[IDT_ENTRIES];
 static idt_descriptor_t idt_desc;
@@ -76,8 +79,11 @@ void idt_init(void) {
         idt_set_entry(i, (uint64_t)isr_table[i], GDT_KERNEL_CODE, IDT_TYPE_INTERRUPT_GATE, 0);
     }
     
-    // Оставшиеся записи (48-255) пока пустые - будут вызывать General Protection Fault
-    for (int i = 48; i < IDT_ENTRIES; i++) {
+    // IPI doorbell (48) - для AP ядер, спящих в HLT
+    idt_set_entry(IPI_DOORBELL, (uint64_t)isr_table[IPI_DOORBELL], GDT_KERNEL_CODE, IDT_TYPE_INTERRUPT_GATE, 0);
+
+    // Оставшиеся записи (49-255) пока пустые - будут вызывать General Protection Fault
+    for (int i = 49; i < IDT_ENTRIES; i++) {
         idt_set_entry(i, (uint64_t)isr_table[13], GDT_KERNEL_CODE, IDT_TYPE_INTERRUPT_GATE, 0); // GPF handler
     }
     
@@ -197,6 +203,12 @@ void exception_handler(interrupt_frame_t* frame) {
 
 // Обработчик аппаратных прерываний (ИСПРАВЛЕНО)
 void irq_handler(interrupt_frame_t* frame) {
+    // Doorbell только будит ядро из hlt - работа в его polling loop
+    if (frame->vector == IPI_DOORBELL) {
+        lapic_eoi();
+        return;
+    }
+
     uint8_t irq = frame->vector - 32;
     
     if (irq < 16) {
@@ -209,9 +221,15 @@ void irq_handler(interrupt_frame_t* frame) {
             // Increment PIT tick counter
             pit_tick();
 
+            // Задачи пишут в SQ без syscall: спящий Receiver будит tick
+            task_rings_timer_tick();
+
             // Run task scheduler (switch tasks if needed)
             task_scheduler_tick();
 
+            // Просроченные события: будим Guide (guide/reaper.h)
+            reaper_timer_tick();
+
             // Таймер - уменьшили частоту логирования
             if (irq_count[0] % 1000 == 0) {  // Каждые ~55 секунд вместо 5.5
                 uint64_t minutes = irq_count[0] > 1100 ? irq_count[0] / 1100 : 0;
@@ -50,6 +50,9 @@
 #define IRQ_ATA_PRIMARY 46  // IRQ 14
 #define IRQ_ATA_SECONDARY 47 // IRQ 15
 
+// Local APIC IPI (не через PIC, EOI в LAPIC)
+#define IPI_DOORBELL    48  // Будит AP ядро из HLT (eventdriven idle)
+
 // Структура IDT записи (64-bit)
 typedef struct {
     uint16_t offset_low;    // Offset биты 0-15
@@ -87,6 +87,9 @@ IRQ 13, 45      ; FPU
 IRQ 14, 46      ; ATA Primary
 IRQ 15, 47      ; ATA Secondary
 
+; Local APIC IPI (вектор 48)
+IRQ 16, 48      ; SMP idle doorbell
+
 ; Общий обработчик прерываний
 isr_common:
     ; Сохраняем все регистры в том же порядке что и в struct
@@ -171,4 +174,5 @@ isr_table:
     dq isr16, isr17, isr18, isr19, isr20, isr21, isr22, isr23
     dq isr24, isr25, isr26, isr27, isr28, isr29, isr30, isr31
     dq irq0, irq1, irq2, irq3, irq4, irq5, irq6, irq7
-    dq irq8, irq9, irq10, irq11, irq12, irq13, irq14, irq15
\ No newline at end of file
+    dq irq8, irq9, irq10, irq11, irq12, irq13, irq14, irq15
+    dq irq16
\ No newline at end of file
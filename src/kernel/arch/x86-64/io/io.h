@@ -53,6 +53,18 @@ static inline void mmio_write64(uintptr_t addr, uint64_t value) {
     *((volatile uint64_t*)addr) = value;
 }
 
+// ========== MSR ==========
+
+static inline uint64_t rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile ("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
 // ========== Interrupt Control ==========
 
 static inline void cli(void) {
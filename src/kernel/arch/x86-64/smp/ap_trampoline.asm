@@ -0,0 +1,118 @@
+; ============================================================================
+; AP TRAMPOLINE for BoxOS SMP bring-up
+; ============================================================================
+; Копируется smp_init() по адресу SMP_TRAMPOLINE_ADDR (0x7000) и
+; исполняется AP ядром после INIT-SIPI-SIPI (CS=0x0700, IP=0):
+;   real mode -> protected mode -> long mode -> smp_ap_main(cpu)
+;
+; Код не position-independent: все адреса считаются через TR() от базы
+; копии. Параметры (CR3, EFER, стек, entry, cpu) заполняет BSP перед
+; стартом каждого AP в ap_trampoline_params.
+; ============================================================================
+
+TRAMPOLINE_BASE     equ 0x7000          ; Sync with SMP_TRAMPOLINE_ADDR (smp.h)
+
+%define TR(x) (TRAMPOLINE_BASE + (x) - ap_trampoline_start)
+
+section .text
+
+global ap_trampoline_start
+global ap_trampoline_params
+global ap_trampoline_end
+
+[BITS 16]
+ap_trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    ; Временная GDT (32-bit code/data + 64-bit code)
+    lgdt [TR(ap_gdt_desc)]
+
+    mov eax, cr0
+    or eax, 1                           ; PE
+    mov cr0, eax
+
+    jmp dword 0x08:TR(ap_protected_mode)
+
+[BITS 32]
+ap_protected_mode:
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    ; PAE
+    mov eax, cr4
+    or eax, (1 << 5)
+    mov cr4, eax
+
+    ; Page tables ядра (те же, что у BSP; лежат ниже 4GB)
+    mov eax, [TR(ap_param_cr3)]
+    mov cr3, eax
+
+    ; EFER как у BSP (LME + NXE, если включён)
+    mov ecx, 0xC0000080
+    mov eax, [TR(ap_param_efer)]
+    xor edx, edx
+    wrmsr
+
+    mov eax, cr0
+    or eax, 0x80000001                  ; PG | PE
+    mov cr0, eax
+
+    jmp 0x18:TR(ap_long_mode)
+
+[BITS 64]
+ap_long_mode:
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+    xor ax, ax
+    mov fs, ax
+    mov gs, ax
+
+    mov rsp, [TR(ap_param_stack)]
+    xor rbp, rbp
+
+    ; smp_ap_main(SmpCpu* cpu) - не возвращается
+    mov rdi, [TR(ap_param_cpu)]
+    mov rax, [TR(ap_param_entry)]
+    call rax
+
+.hang:
+    cli
+    hlt
+    jmp .hang
+
+; ============================================================================
+; Временная GDT
+; ============================================================================
+align 16
+ap_gdt:
+    dq 0                                ; 0x00: null
+    dq 0x00CF9A000000FFFF               ; 0x08: 32-bit code
+    dq 0x00CF92000000FFFF               ; 0x10: data
+    dq 0x00AF9A000000FFFF               ; 0x18: 64-bit code
+ap_gdt_end:
+
+ap_gdt_desc:
+    dw ap_gdt_end - ap_gdt - 1
+    dd TR(ap_gdt)
+
+; ============================================================================
+; Параметры (layout = ApTrampolineParams в smp.h)
+; ============================================================================
+align 8
+ap_trampoline_params:
+ap_param_cr3:       dq 0
+ap_param_efer:      dq 0
+ap_param_stack:     dq 0
+ap_param_entry:     dq 0
+ap_param_cpu:       dq 0
+
+ap_trampoline_end:
@@ -0,0 +1,73 @@
+#include "lapic.h"
+#include "io.h"
+#include "vmm.h"
+#include "klib.h"
+
+static uintptr_t lapic_base = 0;
+
+static inline uint32_t lapic_read(uint32_t reg) {
+    return mmio_read32(lapic_base + reg);
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value) {
+    mmio_write32(lapic_base + reg, value);
+}
+
+void lapic_init(void) {
+    uint64_t msr = rdmsr(IA32_APIC_BASE_MSR);
+    lapic_base = (uintptr_t)(msr & IA32_APIC_BASE_MASK);
+
+    // Identity map покрывает только RAM - MMIO окно APIC мапим отдельно (uncached)
+    vmm_context_t* ctx = vmm_get_kernel_context();
+    if (!vmm_is_mapped(ctx, lapic_base)) {
+        vmm_map_result_t result = vmm_map_page(ctx, lapic_base, lapic_base,
+                                               VMM_FLAGS_KERNEL_RW | VMM_FLAG_CACHE_DISABLE);
+        if (!result.success) {
+            panic("[LAPIC] Failed to map MMIO at 0x%p: %s", (void*)lapic_base, result.error_msg);
+        }
+    }
+
+    if (!(msr & IA32_APIC_BASE_ENABLE)) {
+        wrmsr(IA32_APIC_BASE_MSR, msr | IA32_APIC_BASE_ENABLE);
+    }
+
+    lapic_enable();
+
+    kprintf("[LAPIC] Base 0x%p, BSP APIC ID %u\n", (void*)lapic_base, lapic_id());
+}
+
+void lapic_enable(void) {
+    lapic_write(LAPIC_REG_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+}
+
+uint32_t lapic_id(void) {
+    return lapic_read(LAPIC_REG_ID) >> 24;
+}
+
+static void lapic_send_ipi(uint32_t apic_id, uint32_t icr_low) {
+    lapic_write(LAPIC_REG_ESR, 0);
+    lapic_write(LAPIC_REG_ICR_HIGH, apic_id << 24);
+    lapic_write(LAPIC_REG_ICR_LOW, icr_low);
+
+    // Ждём, пока IPI уйдёт (delivery status)
+    while (lapic_read(LAPIC_REG_ICR_LOW) & LAPIC_ICR_PENDING) {
+        pause();
+    }
+}
+
+void lapic_send_init(uint32_t apic_id) {
+    lapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL | LAPIC_ICR_ASSERT);
+}
+
+void lapic_send_startup(uint32_t apic_id, uint8_t vector) {
+    // Вектор = физическая страница trampoline (адрес >> 12)
+    lapic_send_ipi(apic_id, LAPIC_ICR_STARTUP | vector);
+}
+
+void lapic_send_fixed(uint32_t apic_id, uint8_t vector) {
+    lapic_send_ipi(apic_id, LAPIC_ICR_ASSERT | vector);
+}
+
+void lapic_eoi(void) {
+    lapic_write(LAPIC_REG_EOI, 0);
+}
@@ -0,0 +1,46 @@
+#ifndef LAPIC_H
+#define LAPIC_H
+
+#include "ktypes.h"
+
+// ============================================================================
+// LOCAL APIC (xAPIC, MMIO) - нужен только для IPI при старте AP ядер
+// ============================================================================
+//
+// Прерывания устройств по-прежнему идут через 8259 PIC на BSP.
+// AP ядра работают с выключенными прерываниями (polling pipeline).
+//
+// ============================================================================
+
+#define IA32_APIC_BASE_MSR      0x1B
+#define IA32_APIC_BASE_ENABLE   (1ULL << 11)
+#define IA32_APIC_BASE_MASK     0xFFFFF000ULL
+
+// Регистры (смещения от базы)
+#define LAPIC_REG_ID            0x020
+#define LAPIC_REG_EOI           0x0B0
+#define LAPIC_REG_SVR           0x0F0
+#define LAPIC_REG_ESR           0x280
+#define LAPIC_REG_ICR_LOW       0x300
+#define LAPIC_REG_ICR_HIGH      0x310
+
+#define LAPIC_SVR_ENABLE        0x100
+#define LAPIC_SPURIOUS_VECTOR   0xFF
+
+// ICR
+#define LAPIC_ICR_INIT          0x00000500
+#define LAPIC_ICR_STARTUP       0x00000600
+#define LAPIC_ICR_PENDING       0x00001000
+#define LAPIC_ICR_ASSERT        0x00004000
+#define LAPIC_ICR_LEVEL         0x00008000
+
+// Функции
+void lapic_init(void);          // BSP: map MMIO + enable
+void lapic_enable(void);        // Каждое ядро: software enable через SVR
+uint32_t lapic_id(void);
+void lapic_send_init(uint32_t apic_id);
+void lapic_send_startup(uint32_t apic_id, uint8_t vector);
+void lapic_send_fixed(uint32_t apic_id, uint8_t vector);
+void lapic_eoi(void);
+
+#endif // LAPIC_H
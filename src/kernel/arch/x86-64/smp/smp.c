@@ -0,0 +1,204 @@
+#include "smp.h"
+#include "lapic.h"
+#include "cpu.h"
+#include "idt.h"
+#include "fpu.h"
+#include "pmm.h"
+#include "io.h"
+#include "klib.h"
+
+#define EFER_MSR    0xC0000080
+#define EFER_LME    (1ULL << 8)
+#define EFER_LMA    (1ULL << 10)
+
+// Из ap_trampoline.asm
+extern uint8_t ap_trampoline_start[];
+extern uint8_t ap_trampoline_params[];
+extern uint8_t ap_trampoline_end[];
+
+static SmpCpu smp_cpus[SMP_MAX_CPUS];
+static uint32_t smp_cpu_count = 1;
+static uint8_t smp_apic_to_cpu[256];     // xAPIC ID -> логический номер
+
+static ApTrampolineParams* smp_trampoline_params(void) {
+    return (ApTrampolineParams*)(SMP_TRAMPOLINE_ADDR +
+                                 (ap_trampoline_params - ap_trampoline_start));
+}
+
+// ~1us на итерацию: запись в POST порт 0x80 (прерывания ещё выключены,
+// PIT тики не идут)
+static void smp_udelay(uint32_t us) {
+    while (us--) {
+        outb(0x80, 0);
+    }
+}
+
+// ============================================================================
+// AP ENTRY (вызывается из trampoline уже в long mode, на своём стеке)
+// ============================================================================
+
+static void smp_ap_main(SmpCpu* cpu) {
+    gdt_init_cpu(cpu->gdt, &cpu->gdt_desc, &cpu->tss, sizeof(tss_t) - 1);
+    tss_load();
+    idt_load();
+    enable_fpu();
+    lapic_enable();
+
+    memory_barrier();
+    cpu->online = 1;
+
+    // Ждём работу от BSP (прерывания выключены - только polling)
+    while (!cpu->entry) {
+        pause();
+    }
+    memory_barrier();
+
+    cpu->entry(cpu->arg);
+
+    // Работа не должна возвращаться - паркуем ядро
+    kprintf("[SMP] %[W]CPU %u: entry returned, halting%[D]\n", cpu->index);
+    while (1) {
+        cli();
+        hlt();
+    }
+}
+
+// ============================================================================
+// AP BRING-UP
+// ============================================================================
+
+static int smp_boot_ap(SmpCpu* cpu) {
+    uint8_t* stack = pmm_alloc_zero(SMP_AP_STACK_PAGES);
+    uint8_t* ist_stacks = pmm_alloc_zero(7 * IST_STACK_SIZE / PMM_PAGE_SIZE);
+    if (!stack || !ist_stacks) {
+        kprintf("[SMP] %[E]Out of memory for CPU %u stacks%[D]\n", cpu->index);
+        return 0;
+    }
+
+    cpu->stack_top = (uint64_t)stack + SMP_AP_STACK_PAGES * PMM_PAGE_SIZE;
+    tss_init_cpu(&cpu->tss, cpu->stack_top, ist_stacks);
+
+    ApTrampolineParams* params = smp_trampoline_params();
+    params->stack = cpu->stack_top;
+    params->entry = (uint64_t)smp_ap_main;
+    params->cpu = (uint64_t)cpu;
+    memory_barrier();
+
+    // INIT - 10ms - SIPI - 200us - SIPI (Intel MP spec)
+    lapic_send_init(cpu->apic_id);
+    smp_udelay(10000);
+
+    for (int sipi = 0; sipi < 2 && !cpu->online; sipi++) {
+        lapic_send_startup(cpu->apic_id, SMP_TRAMPOLINE_VECTOR);
+        smp_udelay(200);
+    }
+
+    for (uint32_t us = 0; us < SMP_AP_BOOT_TIMEOUT_US && !cpu->online; us++) {
+        smp_udelay(1);
+    }
+
+    if (!cpu->online) {
+        // Возвращаем ядро в wait-for-SIPI, чтобы оно не стартовало позже
+        // со стеком/параметрами следующего AP
+        lapic_send_init(cpu->apic_id);
+        pmm_free(stack, SMP_AP_STACK_PAGES);
+        pmm_free(ist_stacks, 7 * IST_STACK_SIZE / PMM_PAGE_SIZE);
+        return 0;
+    }
+
+    return 1;
+}
+
+void smp_init(void) {
+    uint32_t cores = cpu_get_core_count();
+    if (cores > SMP_MAX_CPUS) {
+        cores = SMP_MAX_CPUS;
+    }
+
+    smp_cpus[0].index = 0;
+    smp_cpus[0].online = 1;
+    smp_cpu_count = 1;
+
+    if (cores <= 1) {
+        kprintf("[SMP] Single core - APs not started\n");
+        return;
+    }
+
+    kprintf("[SMP] Starting up to %u application processors...\n", cores - 1);
+
+    lapic_init();
+    uint32_t bsp_apic_id = lapic_id();
+    smp_cpus[0].apic_id = bsp_apic_id;
+
+    // Trampoline в low memory (SIPI вектор = номер 4KB страницы < 1MB)
+    memcpy((void*)SMP_TRAMPOLINE_ADDR, ap_trampoline_start,
+           ap_trampoline_end - ap_trampoline_start);
+
+    uint64_t cr3;
+    asm volatile("mov %%cr3, %0" : "=r"(cr3));
+
+    ApTrampolineParams* params = smp_trampoline_params();
+    params->cr3 = cr3;
+    params->efer = (rdmsr(EFER_MSR) & ~EFER_LMA) | EFER_LME;
+
+    for (uint32_t apic_id = 0; apic_id < cores; apic_id++) {
+        if (apic_id == bsp_apic_id) {
+            continue;
+        }
+
+        SmpCpu* cpu = &smp_cpus[smp_cpu_count];
+        memset(cpu, 0, sizeof(SmpCpu));
+        cpu->index = smp_cpu_count;
+        cpu->apic_id = apic_id;
+
+        if (smp_boot_ap(cpu)) {
+            smp_apic_to_cpu[apic_id & 0xFF] = (uint8_t)cpu->index;
+            kprintf("[SMP] CPU %u online (APIC ID %u)\n", cpu->index, apic_id);
+            smp_cpu_count++;
+        } else {
+            kprintf("[SMP] %[W]APIC ID %u did not respond%[D]\n", apic_id);
+        }
+    }
+
+    kprintf("[SMP] %[S]%u CPUs online%[D]\n", smp_cpu_count);
+}
+
+// ============================================================================
+// WORK ASSIGNMENT
+// ============================================================================
+
+uint32_t smp_get_cpu_count(void) {
+    return smp_cpu_count;
+}
+
+uint32_t smp_current_cpu(void) {
+    if (smp_cpu_count <= 1) {
+        return 0;  // Local APIC не инициализирован - только BSP
+    }
+    return smp_apic_to_cpu[lapic_id() & 0xFF];
+}
+
+int smp_start_cpu(uint32_t cpu, smp_entry_t entry, void* arg) {
+    if (cpu == 0 || cpu >= smp_cpu_count || !entry) {
+        return 0;
+    }
+
+    SmpCpu* target = &smp_cpus[cpu];
+    if (!target->online || target->entry) {
+        return 0;
+    }
+
+    target->arg = arg;
+    memory_barrier();
+    target->entry = entry;
+    return 1;
+}
+
+void smp_print_info(void) {
+    kprintf("[SMP] %u CPUs online\n", smp_cpu_count);
+    for (uint32_t i = 0; i < smp_cpu_count; i++) {
+        kprintf("[SMP]   CPU %u: APIC ID %u, %s\n", i, smp_cpus[i].apic_id,
+                i == 0 ? "BSP (shell, interrupts)" :
+                smp_cpus[i].entry ? "busy" : "idle");
+    }
+}
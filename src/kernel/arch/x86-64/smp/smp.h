@@ -0,0 +1,70 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "ktypes.h"
+#include "gdt.h"
+#include "tss.h"
+
+// ============================================================================
+// SMP - запуск AP ядер (INIT-SIPI-SIPI через Local APIC)
+// ============================================================================
+//
+// BSP (ядро 0) остаётся за shell, прерываниями и user tasks.
+// Каждое AP получает свой GDT/TSS/стек, общий IDT и page tables ядра,
+// после чего ждёт работу: smp_start_cpu(cpu, entry, arg).
+//
+// APIC ID перебираются 0..cpu_get_core_count()-1 (так их раздают QEMU и
+// большинство firmware). Ядро, не ответившее за SMP_AP_BOOT_TIMEOUT_US,
+// просто не попадает в smp_get_cpu_count().
+//
+// ============================================================================
+
+#define SMP_MAX_CPUS             16
+#define SMP_TRAMPOLINE_ADDR      0x7000     // Sync with ap_trampoline.asm (ниже stage1/stage2)
+#define SMP_TRAMPOLINE_VECTOR    (SMP_TRAMPOLINE_ADDR >> 12)
+#define SMP_AP_STACK_PAGES       4          // 16KB kernel стек на AP
+#define SMP_AP_BOOT_TIMEOUT_US   100000     // 100ms на старт одного AP
+
+typedef void (*smp_entry_t)(void* arg);
+
+// Параметры для trampoline (layout = ap_trampoline_params)
+typedef struct {
+    uint64_t cr3;
+    uint64_t efer;
+    uint64_t stack;
+    uint64_t entry;
+    uint64_t cpu;
+} __attribute__((packed)) ApTrampolineParams;
+
+typedef struct {
+    uint32_t index;                 // Логический номер (0 = BSP)
+    uint32_t apic_id;
+    volatile uint32_t online;
+
+    // Работа, назначенная ядру (0 = idle)
+    volatile smp_entry_t entry;
+    void* volatile arg;
+
+    // Per-core дескрипторы
+    gdt_entry_t gdt[GDT_ENTRY_COUNT];
+    gdt_descriptor_t gdt_desc;
+    tss_t tss;
+    uint64_t stack_top;
+} SmpCpu;
+
+// Запуск всех AP (после GDT/IDT/TSS/VMM). AP ждут работу в idle loop
+void smp_init(void);
+
+// Количество online ядер (включая BSP)
+uint32_t smp_get_cpu_count(void);
+
+// Логический номер текущего ядра (0 = BSP). Читает Local APIC ID (MMIO),
+// поэтому per-core данные стадии берут раз на burst, а не на событие
+uint32_t smp_current_cpu(void);
+
+// Назначить работу AP ядру (cpu >= 1). 0 = ядро недоступно/занято
+int smp_start_cpu(uint32_t cpu, smp_entry_t entry, void* arg);
+
+void smp_print_info(void);
+
+#endif // SMP_H
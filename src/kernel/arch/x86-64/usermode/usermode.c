@@ -3,6 +3,10 @@
 #include "vmm.h"
 #include "pmm.h"
 #include "task.h"
+#include "task_rings.h"
+#include "idle.h"
+#include "completion.h"
+#include "eventdriven_system.h"
 #include "gdt.h"
 
 // ============================================================================
@@ -12,10 +16,15 @@
 // User mode task extension (stored in task->args for user tasks)
 typedef struct {
     UserModeContext context;
-    uint64_t* user_page_table;
+    vmm_context_t* vmm_context;    // Адресное пространство задачи
+    uint64_t* user_page_table;     // = vmm_context->pml4_phys (CR3)
     void* user_stack;
     uint64_t user_stack_size;
 
+    // SQ/CQ пара задачи (core/task_rings.h), TASK_RING_GLOBAL = общий ring
+    uint32_t ring_id;
+    uintptr_t rings_user_addr;
+
     // Event tracking for rate limiting
     uint64_t last_event_times[USER_EVENT_BURST_LIMIT];
     uint32_t event_index;
@@ -27,6 +36,8 @@ typedef struct {
 static spinlock_t usermode_lock = {0};
 static bool usermode_initialized = false;
 
+static void usermode_setup_rings(Task* task, UserModeTaskData* user_data);
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -75,18 +86,21 @@ Task* usermode_create_task(const char* name, void* entry_point,
     user_data->context.cpu_quota = 1000000;  // CPU time units
     user_data->context.io_quota = 10000;     // I/O operations
 
-    // Create user page table (separate from kernel)
-    user_data->user_page_table = (uint64_t*)usermode_create_page_table();
-    if (!user_data->user_page_table) {
+    // Create user address space (kernel upper half shared, user half empty)
+    user_data->vmm_context = vmm_create_context();
+    if (!user_data->vmm_context) {
+        kprintf("[USERMODE] ERROR: Failed to create address space\n");
         kfree(user_data);
         return NULL;
     }
+    user_data->user_page_table = (uint64_t*)user_data->vmm_context->pml4_phys;
 
     // Create user stack (4KB for now, can grow)
     user_data->user_stack_size = 4096;
     user_data->user_stack = usermode_create_stack((uint64_t)user_data->user_page_table,
                                                    user_data->user_stack_size);
     if (!user_data->user_stack) {
+        vmm_destroy_context(user_data->vmm_context);
         kfree(user_data);
         return NULL;
     }
@@ -94,6 +108,7 @@ Task* usermode_create_task(const char* name, void* entry_point,
     // Create kernel task (this will be upgraded to Ring 3)
     Task* task = task_spawn_with_args(name, entry_point, user_data, energy);
     if (!task) {
+        vmm_destroy_context(user_data->vmm_context);
         kfree(user_data);
         return NULL;
     }
@@ -102,6 +117,9 @@ Task* usermode_create_task(const char* name, void* entry_point,
     task->user_mode = true;  // Ring 3 task
     task->page_table = (uint64_t)user_data->user_page_table;
 
+    // Own SQ/CQ pair: no contention with other tasks on the global ring
+    usermode_setup_rings(task, user_data);
+
     kprintf("[USERMODE] Created user task '%s' for user '%s'\n", name, username);
     kprintf("[USERMODE]   Memory limit: %lu KB\n", user_data->context.memory_limit / 1024);
     kprintf("[USERMODE]   Permissions: 0x%x\n", user_data->context.permissions);
@@ -109,6 +127,79 @@ Task* usermode_create_task(const char* name, void* entry_point,
     return task;
 }
 
+// ============================================================================
+// EVENT RINGS - shared memory SQ/CQ pair
+// ============================================================================
+
+// Kernel side uses the pair through the identity map, the task through the
+// same physical pages mapped into its own context
+static void usermode_setup_rings(Task* task, UserModeTaskData* user_data) {
+    user_data->ring_id = task_rings_register(task->task_id);
+    if (user_data->ring_id == TASK_RING_GLOBAL) {
+        return;  // Falls back to the global ring
+    }
+
+    TaskRingPair* rings = task_rings_get(user_data->ring_id);
+    size_t size = TASK_RINGS_PAGES * PMM_PAGE_SIZE;
+    uintptr_t virt = vmm_find_free_region(user_data->vmm_context, size,
+                                          TASK_RINGS_USER_BASE, VMM_USER_STACK_TOP);
+    vmm_map_result_t result = {0};
+    if (virt) {
+        result = vmm_map_pages(user_data->vmm_context, virt, (uintptr_t)rings,
+                               TASK_RINGS_PAGES, VMM_FLAGS_USER_RW);
+    }
+    if (!result.success) {
+        kprintf("[USERMODE] WARNING: Failed to map event rings for task '%s' - using global ring\n",
+                task->name);
+        task_rings_unregister(task->task_id);
+        user_data->ring_id = TASK_RING_GLOBAL;
+        return;
+    }
+
+    user_data->rings_user_addr = virt;
+    task_ring_slots[user_data->ring_id].user_addr = virt;
+    task_ring_slots[user_data->ring_id].context = user_data->vmm_context;
+
+    kprintf("[USERMODE]   Event rings: pair %u at %p (%lu pages)\n",
+            user_data->ring_id, (void*)virt, (uint64_t)TASK_RINGS_PAGES);
+}
+
+// ============================================================================
+// USER MODE TASK TEARDOWN
+// ============================================================================
+
+// Порядок фиксирован: task_rings_unregister снимает буферы задачи
+// (user_buffers_release_ring - in-flight копии дождались, pin'ы сняты), и
+// только потом контекст разрушается. Страницы пары принадлежат slot'у
+// task_rings, а не задаче - их отображение снимается до vmm_destroy_context,
+// иначе она отдала бы их PMM
+void usermode_destroy_task(Task* task) {
+    if (!task || !task->user_mode || !task->args) return;
+
+    UserModeTaskData* user_data = (UserModeTaskData*)task->args;
+
+    task_rings_unregister(task->task_id);
+
+    if (user_data->rings_user_addr) {
+        vmm_unmap_pages(user_data->vmm_context, user_data->rings_user_addr, TASK_RINGS_PAGES);
+        user_data->rings_user_addr = 0;
+    }
+
+    vmm_destroy_context(user_data->vmm_context);
+    user_data->vmm_context = NULL;
+    user_data->user_page_table = NULL;
+
+    task->args = NULL;
+    kfree(user_data);
+}
+
+uintptr_t usermode_get_rings(Task* task) {
+    if (!task || !task->args) return 0;
+
+    UserModeTaskData* user_data = (UserModeTaskData*)task->args;
+    return user_data->rings_user_addr;
+}
+
 // ============================================================================
 // PAGE TABLE MANAGEMENT
 // ============================================================================
@@ -275,6 +366,52 @@ int usermode_revoke_permission(Task* task, uint32_t permission) {
 // EVENT-BASED COMMUNICATION (Instead of Syscalls!)
 // ============================================================================
 
+// SQ задачи: своя пара или глобальный ring (пары не досталось)
+static EventRingBuffer* usermode_sq(Task* task) {
+    UserModeTaskData* user_data = (UserModeTaskData*)task->args;
+    TaskRingPair* rings = task_rings_get(user_data->ring_id);
+    return rings ? &rings->sq : eventdriven_get_user_to_kernel_ring();
+}
+
+// Ответ на event_id среди ещё не забранных из CQ задачи (или глобального
+// response ring). Ответ остаётся в ring - его забирает consumer задачи
+static bool usermode_find_response(Task* task, uint64_t event_id, Response* out) {
+    UserModeTaskData* user_data = (UserModeTaskData*)task->args;
+    ResponseRingBuffer* cq;
+    uint64_t tail;
+
+    TaskRingPair* rings = task_rings_get(user_data->ring_id);
+    if (rings) {
+        cq = &rings->cq;
+        tail = atomic_load_u64(&task_ring_slots[user_data->ring_id].cq_tail);  // Kernel копия
+    } else {
+        cq = eventdriven_get_kernel_to_user_ring();
+        tail = atomic_load_u64(&cq->tail);
+    }
+
+    // head пары пишет задача - смотрим не дальше одного круга от tail
+    uint64_t head = atomic_load_u64(&cq->head);
+    if (tail - head > RING_BUFFER_SIZE) {
+        head = tail - RING_BUFFER_SIZE;
+    }
+
+    for (uint64_t pos = head; pos != tail; pos++) {
+        // MPMC: позиция захвачена producer'ом, но ещё не опубликована
+        if (cq->mode == RING_MODE_MPMC &&
+            atomic_load_u64(&cq->seq[pos & RING_BUFFER_MASK]) != pos + 1) {
+            continue;
+        }
+        Response* response = &cq->responses[pos & RING_BUFFER_MASK];
+        if (response->event_id == event_id) {
+            if (out) {
+                memcpy(out, response, sizeof(Response));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 uint64_t usermode_send_event(Task* task, uint64_t deck_id,
                              uint64_t event_type, void* data, uint64_t size) {
     if (!usermode_can_send_event(task)) {
@@ -282,21 +419,40 @@ uint64_t usermode_send_event(Task* task, uint64_t deck_id,
         return 0;
     }
 
+    if (size > EVENT_DATA_SIZE) {
+        kprintf("[USERMODE] Task '%s' event payload too large (%lu bytes)\n", task->name, size);
+        return 0;
+    }
+
+    // Событие строится прямо в слоте SQ задачи, как у eventapi: ID назначит
+    // Receiver, но он следует из позиции слота (core/events.h)
+    EventRingBuffer* sq = usermode_sq(task);
+    uint64_t pos;
+    Event* slot = event_ring_reserve(sq, &pos);
+    if (!slot) {
+        kprintf("[USERMODE] Task '%s' event ring full\n", task->name);
+        return 0;
+    }
+
+    event_init(slot, (EventType)event_type, task->task_id);
+    if (size) {
+        memcpy(slot->data, data, size);
+    }
+    event_ring_commit(sq, pos);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
     // Record event for rate limiting
     usermode_record_event(task);
 
-    // Send event to kernel deck via event-driven system
-    // This is implemented in eventdriven_system.c
-
     UserModeContext* ctx = usermode_get_context(task);
     if (ctx) {
         ctx->event_count++;
     }
 
-    // Generate event ID
-    uint64_t event_id = task->task_id << 32 | ctx->event_count;
+    uint64_t event_id = event_ring_event_id(sq, pos);
 
-    kprintf("[USERMODE] Task '%s' sent event 0x%llx to deck %llu\n",
+    // Маршрут выбирает Center по типу события - deck_id только для лога
+    kprintf("[USERMODE] Task '%s' sent event 0x%lx to deck %lu\n",
             task->name, event_id, deck_id);
 
     return event_id;
@@ -304,31 +460,43 @@ uint64_t usermode_send_event(Task* task, uint64_t deck_id,
 
 int usermode_wait_response(Task* task, uint64_t event_id,
                            void* response_buf, uint64_t* size_out) {
-    // Put task to sleep until response arrives
-    // Event-driven system will wake task when deck responds
+    if (!task || !task->args || event_id == 0) {
+        return -1;
+    }
 
-    kprintf("[USERMODE] Task '%s' waiting for response to event 0x%llx\n",
-            task->name, event_id);
+    Response response;
+    while (!usermode_find_response(task, event_id, &response)) {
+        // Completion wakeup (execution/completion.h)
+        uint32_t wait = completion_wait_register(task->task_id, &event_id, 1, 1);
+        if (wait == COMPLETION_NONE) {
+            task_scheduler_yield();  // Нет места под wait - проверим после других задач
+            continue;
+        }
 
-    // Sleep task
-    task->state = TASK_STATE_WAITING_EVENT;
+        // Ответ мог прийти до регистрации - его signal уже прошёл мимо
+        if (usermode_find_response(task, event_id, &response)) {
+            completion_wait_cancel(wait);
+            break;
+        }
+
+        if (task_block_event(task) == 0) {
+            task_scheduler_yield();
+        }
+    }
 
+    if (response_buf) {
+        memcpy(response_buf, &response, sizeof(Response));
+    }
+    if (size_out) {
+        *size_out = sizeof(Response);
+    }
     return 0;
 }
 
 bool usermode_response_ready(Task* task, uint64_t event_id) {
-    // Check task's message queue for response
-    if (!task->message_queue) return false;
-
-    // Search message queue for event_id
-    for (uint32_t i = 0; i < task->message_queue->count; i++) {
-        uint32_t idx = (task->message_queue->head + i) % TASK_MESSAGE_QUEUE_SIZE;
-        if (task->message_queue->messages[idx].message_type == event_id) {
-            return true;
-        }
-    }
+    if (!task || !task->args) return false;
 
-    return false;
+    return usermode_find_response(task, event_id, 0);
 }
 
 // ============================================================================
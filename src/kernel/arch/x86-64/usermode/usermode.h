@@ -75,6 +75,14 @@ bool usermode_is_user_task(Task* task);
 // Get user context for task
 UserModeContext* usermode_get_context(Task* task);
 
+// Free the task's address space (task_kill): SQ/CQ pair and registered
+// buffers are released first, then the context is destroyed
+void usermode_destroy_task(Task* task);
+
+// User address of the task's SQ/CQ pair (TaskRingPair, core/task_rings.h);
+// 0 = task submits through the global ring
+uintptr_t usermode_get_rings(Task* task);
+
 // ============================================================================
 // USER MODE MEMORY - For Setting Up User Space
 // ============================================================================
@@ -115,13 +123,16 @@ int usermode_revoke_permission(Task* task, uint32_t permission);
 // EVENT-BASED COMMUNICATION (Instead of Syscalls!)
 // ============================================================================
 
-// User task sends event to kernel deck
-// This is the ONLY way user code communicates with kernel
-// Returns: event_id for tracking response
+// User task sends event to kernel deck (task's own SQ, or the global ring
+// if it has no pair). Called in the task's context - it is the SQ producer.
+// Returns: the real pipeline event_id (0 = throttled / ring full)
 uint64_t usermode_send_event(Task* task, uint64_t deck_id,
                              uint64_t event_type, void* data, uint64_t size);
 
-// Wait for event response (puts task to sleep until response arrives)
+// Block the task until the response for event_id is in its CQ (completion
+// wakeup, execution/completion.h). Copies the Response record into
+// response_buf; the response stays in the CQ for the task's consumer
+// (payload release - eventapi_release_response). 0 = done, -1 = bad args
 int usermode_wait_response(Task* task, uint64_t event_id,
                            void* response_buf, uint64_t* size_out);
 
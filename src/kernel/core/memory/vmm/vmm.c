@@ -263,8 +263,15 @@ static void vmm_free_user_space_tables(vmm_context_t* ctx) {
                     if (!(pt_entry & VMM_FLAG_PRESENT)) continue;
 
                     uintptr_t phys = vmm_pte_to_phys(pt_entry);
-                    // Free single physical page
-                    pmm_free((void*)phys, 1);
+                    if (vmm_pte_to_pins(pt_entry)) {
+                        // Буфер не снят до разрушения контекста: frame ещё
+                        // может читать / писать ядро - утечка вместо reuse
+                        kprintf("[VMM] WARNING: leaking pinned frame 0x%p of destroyed context\n",
+                                (void*)phys);
+                    } else {
+                        // Free single physical page
+                        pmm_free((void*)phys, 1);
+                    }
 
                     // Clear PT entry to be clean (not strictly required since we'll free PT)
                     pt->entries[p1] = 0;
@@ -434,17 +441,8 @@ vmm_map_result_t vmm_map_pages(vmm_context_t* ctx, uintptr_t virt_addr,
     return result;
 }
 
-bool vmm_unmap_page(vmm_context_t* ctx, uintptr_t virt_addr) {
-    if (!ctx || !vmm_is_page_aligned(virt_addr)) return false;
-
-    spin_lock(&ctx->lock);
-
-    pte_t* pte = vmm_get_pte(ctx, virt_addr); // noalloc
-    if (!pte || !(*pte & VMM_FLAG_PRESENT)) {
-        spin_unlock(&ctx->lock);
-        return false;
-    }
-
+// Снять present PTE (ctx->lock взят): статистика + очистка, без TLB flush
+static void vmm_clear_pte_locked(vmm_context_t* ctx, pte_t* pte) {
     // Update statistics (only counts, do not free physical pages here)
     uint64_t flags = vmm_pte_to_flags(*pte);
     if (flags & VMM_FLAG_USER) {
@@ -465,6 +463,27 @@ bool vmm_unmap_page(vmm_context_t* ctx, uintptr_t virt_addr) {
 
     // Clear the PTE
     *pte = 0;
+}
+
+bool vmm_unmap_page(vmm_context_t* ctx, uintptr_t virt_addr) {
+    if (!ctx || !vmm_is_page_aligned(virt_addr)) return false;
+
+    spin_lock(&ctx->lock);
+
+    pte_t* pte = vmm_get_pte(ctx, virt_addr); // noalloc
+    if (!pte || !(*pte & VMM_FLAG_PRESENT)) {
+        spin_unlock(&ctx->lock);
+        return false;
+    }
+
+    // Pinned - отображение живёт до последнего unpin
+    if (vmm_pte_to_pins(*pte)) {
+        spin_unlock(&ctx->lock);
+        kprintf("[VMM] WARNING: refusing to unmap pinned page 0x%p\n", (void*)virt_addr);
+        return false;
+    }
+
+    vmm_clear_pte_locked(ctx, pte);
 
     spin_unlock(&ctx->lock);
 
@@ -581,26 +600,33 @@ void vmm_free_pages(vmm_context_t* ctx, void* virt_addr, size_t page_count) {
 
     uintptr_t virt_base = (uintptr_t)virt_addr;
 
-    // Collect physical addresses
-    uintptr_t* phys_addrs = kmalloc(page_count * sizeof(uintptr_t));
-    if (phys_addrs) {
-        for (size_t i = 0; i < page_count; i++) {
-            phys_addrs[i] = vmm_virt_to_phys(ctx, virt_base + i * VMM_PAGE_SIZE);
+    // Проверка pin'ов и снятие - под одним ctx->lock: pin между ними не
+    // вклинится. Хоть одна pinned страница - отказ целиком
+    spin_lock(&ctx->lock);
+
+    for (size_t i = 0; i < page_count; i++) {
+        pte_t* pte = vmm_get_pte(ctx, virt_base + i * VMM_PAGE_SIZE); // noalloc
+        if (pte && (*pte & VMM_FLAG_PRESENT) && vmm_pte_to_pins(*pte)) {
+            spin_unlock(&ctx->lock);
+            vmm_set_error("Pages are pinned");
+            kprintf("[VMM] WARNING: refusing to free %zu pages at 0x%p: page %zu is pinned\n",
+                    page_count, virt_addr, i);
+            return;
         }
     }
 
-    // Unmap virtual pages (does not free physical)
-    vmm_unmap_pages(ctx, virt_base, page_count);
+    for (size_t i = 0; i < page_count; i++) {
+        uintptr_t virt = virt_base + i * VMM_PAGE_SIZE;
+        pte_t* pte = vmm_get_pte(ctx, virt); // noalloc
+        if (!pte || !(*pte & VMM_FLAG_PRESENT)) continue;
 
-    // Free physical pages
-    if (phys_addrs) {
-        for (size_t i = 0; i < page_count; i++) {
-            if (phys_addrs[i]) {
-                pmm_free((void*)phys_addrs[i], 1);
-            }
-        }
-        kfree(phys_addrs);
+        uintptr_t phys = vmm_pte_to_phys(*pte);
+        vmm_clear_pte_locked(ctx, pte);
+        vmm_flush_tlb_page(virt);
+        pmm_free((void*)phys, 1);
     }
+
+    spin_unlock(&ctx->lock);
 }
 
 // ========== KERNEL HEAP (vmalloc) ==========
@@ -748,6 +774,44 @@ uint64_t vmm_get_page_flags(vmm_context_t* ctx, uintptr_t virt_addr) {
     return flags;
 }
 
+// ========== PINNING ==========
+uintptr_t vmm_pin_page(vmm_context_t* ctx, uintptr_t virt_addr, uint64_t required_flags) {
+    if (!ctx) return 0;
+
+    spin_lock(&ctx->lock);
+
+    pte_t* pte = vmm_get_pte(ctx, virt_addr); // noalloc
+    if (!pte || !(*pte & VMM_FLAG_PRESENT) ||
+        (vmm_pte_to_flags(*pte) & required_flags) != required_flags ||
+        vmm_pte_to_pins(*pte) == VMM_PTE_PIN_MAX) {
+        spin_unlock(&ctx->lock);
+        return 0;
+    }
+
+    // Software bits - MMU их не видит, TLB flush не нужен
+    *pte += 1ULL << VMM_PTE_PIN_SHIFT;
+    uintptr_t phys = vmm_pte_to_phys(*pte) + (virt_addr & VMM_PAGE_OFFSET_MASK);
+
+    spin_unlock(&ctx->lock);
+    return phys;
+}
+
+void vmm_unpin_page(vmm_context_t* ctx, uintptr_t virt_addr) {
+    if (!ctx) return;
+
+    spin_lock(&ctx->lock);
+
+    pte_t* pte = vmm_get_pte(ctx, virt_addr); // noalloc
+    if (pte && (*pte & VMM_FLAG_PRESENT) && vmm_pte_to_pins(*pte)) {
+        *pte -= 1ULL << VMM_PTE_PIN_SHIFT;
+        spin_unlock(&ctx->lock);
+        return;
+    }
+
+    spin_unlock(&ctx->lock);
+    kprintf("[VMM] WARNING: unpin of page 0x%p that is not pinned\n", (void*)virt_addr);
+}
+
 // ========== UTILITIES ==========
 uintptr_t vmm_find_free_region(vmm_context_t* ctx, size_t size, uintptr_t start, uintptr_t end) {
     if (!ctx || size == 0 || start >= end) return 0;
@@ -815,7 +879,8 @@ bool vmm_protect(vmm_context_t* ctx, uintptr_t virt_addr, size_t size, uint64_t
         // Ensure present bit remains set unless new_flags explicitly clears it
         uint64_t flags_to_set = (new_flags & VMM_PTE_FLAGS_MASK);
         if (!(flags_to_set & VMM_FLAG_PRESENT)) flags_to_set |= VMM_FLAG_PRESENT;
-        *pte = vmm_make_pte(phys_addr, flags_to_set);
+        // Pin'ы переживают смену прав
+        *pte = vmm_make_pte(phys_addr, flags_to_set) | (*pte & VMM_PTE_PIN_MASK);
 
         vmm_flush_tlb_page(current_addr);
         current_addr += VMM_PAGE_SIZE;
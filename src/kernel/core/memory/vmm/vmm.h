@@ -40,6 +40,13 @@
 #define VMM_PTE_ADDR_MASK       0x000FFFFFFFFFF000ULL
 #define VMM_PTE_FLAGS_MASK      0x8000000000000FFFULL
 
+// Software bits 52..58 (MMU их игнорирует): счётчик pin'ов страницы.
+// Pinned frame держит ядро (core/user_buffers.h): vmm_unmap_page и
+// vmm_free_pages его не снимают, vmm_destroy_context не отдаёт PMM
+#define VMM_PTE_PIN_SHIFT       52
+#define VMM_PTE_PIN_MASK        (0x7FULL << VMM_PTE_PIN_SHIFT)
+#define VMM_PTE_PIN_MAX         0x7FULL
+
 // Virtual address indices
 #define VMM_PML4_INDEX(addr)    (((addr) >> 39) & 0x1FF)
 #define VMM_PDPT_INDEX(addr)    (((addr) >> 30) & 0x1FF)
@@ -112,6 +119,12 @@ uintptr_t vmm_virt_to_phys(vmm_context_t* ctx, uintptr_t virt_addr);
 bool vmm_is_mapped(vmm_context_t* ctx, uintptr_t virt_addr);
 uint64_t vmm_get_page_flags(vmm_context_t* ctx, uintptr_t virt_addr);
 
+// Pinning: физический адрес страницы, если стоят все required_flags (0 - не
+// отображена, нет флагов или счётчик полон). Каждый pin - ровно один unpin,
+// и все unpin - до vmm_destroy_context
+uintptr_t vmm_pin_page(vmm_context_t* ctx, uintptr_t virt_addr, uint64_t required_flags);
+void vmm_unpin_page(vmm_context_t* ctx, uintptr_t virt_addr);
+
 // Kernel heap (vmalloc equivalent)
 void* vmalloc(size_t size);
 void* vzalloc(size_t size);  // Zero-initialized
@@ -199,6 +212,11 @@ static inline uint64_t vmm_pte_to_flags(pte_t pte) {
     return pte & VMM_PTE_FLAGS_MASK;
 }
 
+// Pin count from PTE
+static inline uint64_t vmm_pte_to_pins(pte_t pte) {
+    return (pte & VMM_PTE_PIN_MASK) >> VMM_PTE_PIN_SHIFT;
+}
+
 // Create PTE from physical address and flags
 static inline pte_t vmm_make_pte(uintptr_t phys_addr, uint64_t flags) {
     return (phys_addr & VMM_PTE_ADDR_MASK) | (flags & VMM_PTE_FLAGS_MASK);
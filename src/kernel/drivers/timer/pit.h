@@ -33,6 +33,9 @@ void pit_tick(void);
 // Get current tick count (updated by IRQ 0 handler)
 uint64_t pit_get_ticks(void);
 
+// Get frequency in Hz (ticks per second set by pit_init)
+uint32_t pit_get_frequency(void);
+
 // Sleep for specified number of milliseconds (busy wait)
 void pit_sleep_ms(uint32_t milliseconds);
 
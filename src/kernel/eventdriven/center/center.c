@@ -16,39 +16,63 @@ void center_init(void) {
     center_stats.routes_created = 0;
     center_stats.routing_errors = 0;
     center_stats.security_denied = 0;
+    memset((void*)center_stats.lanes, 0, sizeof(center_stats.lanes));
 
-    kprintf("[CENTER] Initialized (with Security checks)\n");
+    policy_init();
+    coalesce_init();
+    chain_init();
+
+    uint32_t bad_type = event_registry_validate();
+    if (bad_type) {
+        panic("[CENTER] Invalid event_registry route for event type %u", bad_type);
+    }
+
+    kprintf("[CENTER] Initialized (with Security checks, %u event types in registry)\n",
+            event_registry_count());
 }
 
 // ============================================================================
-// MAIN LOOP
+// BURST PROCESSING
 // ============================================================================
 
-void center_run(EventRingBuffer* from_receiver_ring, RoutingTable* routing_table, ResponseRingBuffer* kernel_to_user_ring) {
-    kprintf("[CENTER] Starting main loop...\n");
+uint64_t center_drain_burst(EventRingBuffer** from_receiver_rings, RoutingTable* routing_table,
+                            ResponseRingBuffer* kernel_to_user_ring, uint64_t max) {
+    uint64_t total = 0;
+    PolicyCache* policy_cache = policy_cache_local();  // Раз на burst (чтение APIC ID)
+    LatencyShard* latency = latency_shard(EVENTDRIVEN_STAGE_CENTER);
 
-    Event event;
-    uint64_t iterations = 0;
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        EventRingBuffer* ring = from_receiver_rings[lane];
+        CenterLaneStats* stats = &center_stats.lanes[lane];
 
-    while (1) {
-        // Получаем событие от Receiver
-        if (event_ring_pop(from_receiver_ring, &event)) {
-            // Обрабатываем: определяем маршрут и создаём routing entry
-            // center_process_event() увеличит счетчик внутри
-            center_process_event(&event, routing_table, kernel_to_user_ring);
-
-            // NOTE: Guide будет polling routing table и обнаружит новый entry
-        } else {
-            // Буфер пуст
-            cpu_pause();
+        uint64_t depth = event_ring_count(ring);
+        if (depth == 0) {
+            continue;
+        }
+        if (depth > stats->max_depth) {
+            stats->max_depth = depth;
         }
 
-        // Периодическая статистика
-        iterations++;
-        if (iterations % 10000000 == 0) {
-            center_print_stats();
+        uint64_t quota = max >> lane;
+        uint64_t pos;
+        uint64_t n = event_ring_peek_batch(ring, quota ? quota : 1, &pos);
+
+        uint64_t now = rdtsc();
+        for (uint64_t i = 0; i < n; i++) {
+            Event* event = event_ring_slot(ring, pos + i);
+            if (event->type != EVENT_NONE) {
+                stats->wait_cycles += now - event->timestamp;
+                stats->events++;
+                latency_record(latency, event->type, LATENCY_SLOT_FIRST, now - event->timestamp);
+            }
+            center_process_event(event, routing_table, kernel_to_user_ring, policy_cache, latency, now);
         }
+
+        event_ring_release_batch(ring, pos, n);
+        total += n;
     }
+
+    return total;
 }
 
 // ============================================================================
@@ -61,4 +85,14 @@ void center_print_stats(void) {
             center_stats.routes_created,
             center_stats.routing_errors,
             center_stats.security_denied);
+    policy_print_stats();
+    coalesce_print_stats();
+    chain_print_stats();
+
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        CenterLaneStats* stats = &center_stats.lanes[lane];
+        kprintf("[CENTER]   lane %s: events=%lu max_depth=%lu avg_wait=%lu cycles\n",
+                event_lane_name(lane), stats->events, stats->max_depth,
+                stats->events ? stats->wait_cycles / stats->events : 0);
+    }
 }
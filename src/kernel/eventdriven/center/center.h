@@ -4,6 +4,16 @@
 #include "../core/events.h"
 #include "../core/ringbuffer.h"
 #include "../routing/routing_table.h"
+#include "../routing/event_registry.h"
+#include "../security/policy.h"
+#include "../core/latency.h"
+#include "../core/task_rings.h"
+#include "../core/credits.h"
+#include "coalesce.h"
+#include "chain.h"
+#include "../guide/guide.h"
+#include "../guide/reaper.h"
+#include "../execution/completion.h"
 #include "klib.h"
 
 // ============================================================================
@@ -13,19 +23,33 @@
 // Функции (НОВАЯ АРХИТЕКТУРА v1):
 // 1. Получает событие от Receiver
 // 2. Проверяет Security ПЕРЕД маршрутизацией
-// 3. Анализирует тип события
-// 4. Определяет маршрут через 4 deck (массив префиксов)
-// 5. Создаёт RoutingEntry в routing table
-// 6. Уведомляет Guide о новом событии
+// 3. Берёт готовый маршрут типа из event_registry (без switch)
+// 4. Маршрут - через 4 deck (массив префиксов)
+// 5. Склеивает in-flight дубликаты read-only запросов (coalesce.h)
+//    и собирает связанные события в цепочки (chain.h)
+// 6. Создаёт RoutingEntry в routing table
+// 7. Уведомляет Guide о новом событии
 //
 // ============================================================================
 
+// Максимум событий, забираемых за одно пробуждение (burst).
+// Lane l получает до CENTER_BURST_SIZE >> l слотов за проход: realtime
+// обслуживается первым и чаще, bulk не голодает
+#define CENTER_BURST_SIZE 32
+
 // Статистика
+typedef struct {
+    volatile uint64_t events;
+    volatile uint64_t wait_cycles;      // Receiver timestamp -> Center (ожидание в ring lane)
+    volatile uint64_t max_depth;        // Наибольшая очередь lane, увиденная Center
+} CenterLaneStats;
+
 typedef struct {
     volatile uint64_t events_processed;
     volatile uint64_t routes_created;
     volatile uint64_t routing_errors;
     volatile uint64_t security_denied;  // События отклоненные Security
+    CenterLaneStats lanes[EVENT_LANE_COUNT];
 } CenterStats;
 
 extern CenterStats center_stats;
@@ -40,209 +64,143 @@ void center_init(void);
 // SECURITY CHECK - Проверка безопасности ПЕРЕД маршрутизацией
 // ============================================================================
 
-// Возвращает 1 если разрешено, 0 если отказано
-static inline int security_check_event(Event* event) {
-    switch (event->type) {
-        // ===== MEMORY OPERATIONS =====
-        case EVENT_MEMORY_ALLOC:
-        case EVENT_MEMORY_MAP: {
-            uint64_t size = *(uint64_t*)event->data;
-            // Не разрешаем аллокации > 1GB
-            if (size > (1ULL << 30)) {
-                kprintf("[CENTER:SECURITY] Denied: memory allocation too large (%lu bytes) for user %lu\n",
-                        size, event->user_id);
-                return 0;
-            }
-            return 1;
-        }
-
-        // ===== FILE OPERATIONS =====
-        case EVENT_FILE_OPEN:
-        case EVENT_FILE_READ:
-        case EVENT_FILE_WRITE: {
-            const char* path = (const char*)event->data;
-            // Запрещаем доступ к /etc/shadow
-            if (strcmp(path, "/etc/shadow") == 0) {
-                kprintf("[CENTER:SECURITY] Denied: access to %s for user %lu\n",
-                        path, event->user_id);
-                return 0;
-            }
-            return 1;
-        }
+// Возвращает 1 если разрешено, 0 если отказано.
+// Вердикт - из policy engine (security/policy.h): per-core кэш
+// (user, type, object class), на промахе - скомпилированная decision table
+static inline int security_check_event(PolicyCache* policy_cache, Event* event) {
+    return policy_check_event(policy_cache, event);
+}
 
-        // ===== NETWORK OPERATIONS =====
-        case EVENT_NET_SOCKET:
-        case EVENT_NET_CONNECT:
-        case EVENT_NET_SEND:
-        case EVENT_NET_RECV:
-            // TODO: реальная проверка прав на сеть
-            return 1;
+// ============================================================================
+// ROUTE DETERMINATION - Маршрут берётся готовым из event_registry
+// ============================================================================
 
-        // ===== PROCESS OPERATIONS =====
-        case EVENT_PROC_CREATE:
-        case EVENT_PROC_KILL:
-        case EVENT_PROC_SIGNAL:
-            // TODO: реальная проверка прав на процессы
-            return 1;
+// Заполняет массив prefixes (и depends для route DAG) маршрутом типа.
+// Тип уже проверен Receiver'ом (event_registry[type].valid)
+static inline void center_determine_route(EventType type, uint8_t prefixes[MAX_ROUTING_STEPS],
+                                          uint8_t depends[MAX_ROUTING_STEPS]) {
+    const EventTypeInfo* info = event_registry_lookup(type);
 
-        // Все остальные операции разрешены по умолчанию
-        default:
-            return 1;
+    for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
+        prefixes[i] = info->steps[i].prefix;    // Неиспользуемые шаги = DECK_PREFIX_NONE
+        depends[i] = info->steps[i].depends;
     }
 }
 
 // ============================================================================
-// ROUTE DETERMINATION - Определение маршрута на основе типа события
+// EVENT PROCESSING
 // ============================================================================
 
-// Заполняет массив prefixes на основе типа события
-// НОВАЯ АРХИТЕКТУРА: только 4 deck вместо 10
-static inline void center_determine_route(EventType type, uint8_t prefixes[MAX_ROUTING_STEPS]) {
-    // Очищаем массив
-    for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
-        prefixes[i] = DECK_PREFIX_NONE;
+// Отправляет ответ Center'а (DENIED, INVALID) - строится прямо в слоте
+// response ring; событие из SQ задачи - в CQ её пары, core/task_rings.h
+static inline int center_send_status(Event* event, ResponseRingBuffer* kernel_to_user_ring,
+                                     EventStatus status, uint32_t error_code) {
+    // Слот под ответ зарезервирован кредитом события (core/credits.h)
+    CreditResponse slot;
+    Response* response = credits_reserve_response(event->flags, kernel_to_user_ring, &slot);
+    if (response) {
+        response_init(response, event->id, status);
+        response->timestamp = rdtsc();
+        response->error_code = error_code;
+
+        credits_commit_response(&slot);
     }
 
-    // Определяем маршрут на основе типа события
-    switch (type) {
-        // ===== STORAGE DECK: Memory Operations =====
-        case EVENT_MEMORY_ALLOC:
-        case EVENT_MEMORY_FREE:
-        case EVENT_MEMORY_MAP:
-            prefixes[0] = DECK_PREFIX_STORAGE;
-            break;
-
-        // ===== STORAGE DECK: File Operations =====
-        case EVENT_FILE_OPEN:
-        case EVENT_FILE_CLOSE:
-        case EVENT_FILE_READ:
-        case EVENT_FILE_WRITE:
-        case EVENT_FILE_STAT:
-        // TagFS operations
-        case EVENT_FILE_CREATE_TAGGED:
-        case EVENT_FILE_QUERY:
-        case EVENT_FILE_TAG_ADD:
-        case EVENT_FILE_TAG_REMOVE:
-        case EVENT_FILE_TAG_GET:
-            prefixes[0] = DECK_PREFIX_STORAGE;
-            break;
-
-        // ===== OPERATIONS DECK: Process Operations =====
-        case EVENT_PROC_CREATE:
-        case EVENT_PROC_EXIT:
-        case EVENT_PROC_KILL:
-        case EVENT_PROC_WAIT:
-        case EVENT_PROC_GETPID:
-        case EVENT_PROC_SIGNAL:
-            prefixes[0] = DECK_PREFIX_OPERATIONS;
-            break;
-
-        // ===== OPERATIONS DECK: IPC Operations =====
-        case EVENT_IPC_SEND:
-        case EVENT_IPC_RECV:
-        case EVENT_IPC_SHM_CREATE:
-        case EVENT_IPC_SHM_ATTACH:
-        case EVENT_IPC_PIPE_CREATE:
-            prefixes[0] = DECK_PREFIX_OPERATIONS;
-            break;
-
-        // ===== HARDWARE DECK: Timer Operations =====
-        case EVENT_TIMER_CREATE:
-        case EVENT_TIMER_CANCEL:
-        case EVENT_TIMER_SLEEP:
-        case EVENT_TIMER_GETTICKS:
-            prefixes[0] = DECK_PREFIX_HARDWARE;
-            break;
-
-        // ===== HARDWARE DECK: Device Operations =====
-        case EVENT_DEV_OPEN:
-        case EVENT_DEV_IOCTL:
-        case EVENT_DEV_READ:
-        case EVENT_DEV_WRITE:
-            prefixes[0] = DECK_PREFIX_HARDWARE;
-            break;
-
-        // ===== NETWORK DECK: Network Operations (stub в v1) =====
-        case EVENT_NET_SOCKET:
-        case EVENT_NET_CONNECT:
-        case EVENT_NET_SEND:
-        case EVENT_NET_RECV:
-            prefixes[0] = DECK_PREFIX_NETWORK;
-            break;
+    // Задача может спать в eventapi_wait_response на этом событии - будим
+    // и тогда, когда сломанная CQ пары ответ не взяла
+    completion_signal(event->id);
+    return 1;
+}
 
-        default:
-            // Неизвестный тип - отправим в OPERATIONS
-            kprintf("[CENTER] Unknown event type %d, routing to OPERATIONS\n", type);
-            prefixes[0] = DECK_PREFIX_OPERATIONS;
-            break;
-    }
+static inline int center_send_denied(Event* event, ResponseRingBuffer* kernel_to_user_ring) {
+    return center_send_status(event, kernel_to_user_ring, EVENT_STATUS_DENIED, 1);  // Security violation
 }
 
-// ============================================================================
-// EVENT PROCESSING
-// ============================================================================
+// Обрабатывает событие: проверяет security, создаёт routing entry прямо в таблице.
+// event - слот receiver→center ring (zero-copy): единственная копия события
+// делается в RoutingEntry.event_copy. now - когда Center забрал burst
+// (начало стадии CENTER в latency histograms).
+static inline int center_process_event(Event* event, RoutingTable* routing_table, ResponseRingBuffer* kernel_to_user_ring,
+                                       PolicyCache* policy_cache, LatencyShard* latency, uint64_t now) {
+    if (event->type == EVENT_NONE) {
+        return 0;  // Слот отменён Receiver'ом (event_ring_cancel)
+    }
 
-// Обрабатывает событие: проверяет security, создаёт routing entry и добавляет в таблицу
-static inline int center_process_event(Event* event, RoutingTable* routing_table, ResponseRingBuffer* kernel_to_user_ring) {
     atomic_increment_u64((volatile uint64_t*)&center_stats.events_processed);
 
     // 1. SECURITY CHECK - ПЕРЕД маршрутизацией!
-    if (!security_check_event(event)) {
+    if (!security_check_event(policy_cache, event)) {
         atomic_increment_u64((volatile uint64_t*)&center_stats.security_denied);
         kprintf("[CENTER] Event %lu DENIED by security\n", event->id);
 
         // FIXED: Отправляем error response обратно в user space
-        Response error_response;
-        response_init(&error_response, event->id, EVENT_STATUS_DENIED);
-        error_response.timestamp = rdtsc();
-        error_response.error_code = 1;  // Security violation
-
-        // Отправляем в response ring
-        // FIXED: Добавлен timeout
-        uint64_t timeout = 1000000;
-        while (!response_ring_push(kernel_to_user_ring, &error_response)) {
-            cpu_pause();
-            if (--timeout == 0) {
-                kprintf("[CENTER] ERROR: Response ring buffer timeout for event %lu\n", event->id);
-                return 0;  // Не смогли отправить ответ
-            }
-        }
-
+        chain_deny(event);
+        center_send_denied(event, kernel_to_user_ring);
         return 0;
     }
 
-    // 2. Определяем маршрут
-    uint8_t prefixes[MAX_ROUTING_STEPS];
-    center_determine_route(event->type, prefixes);
-
-    // 3. Создаём routing entry
-    RoutingEntry entry;
-    routing_entry_init(&entry, event->id, event);
-
-    // Копируем префиксы
-    for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
-        entry.prefixes[i] = prefixes[i];
+    // 2. Цепочки: звенья копятся до завершающего, в pipeline уходит первое
+    uint32_t chain = CHAIN_NONE;
+    uint32_t chain_error = 0;
+    Event* submitted = event;  // На него ответ, если цепочку не принять
+    switch (chain_collect(event, &chain, &chain_error)) {
+        case CHAIN_HELD:
+        case CHAIN_DROPPED:
+            return 1;
+        case CHAIN_FAILED:
+            center_send_status(event, kernel_to_user_ring, EVENT_STATUS_INVALID, chain_error);
+            return 0;
+        case CHAIN_READY:
+            event = chain_link(chain, 0);
+            break;
+        default:
+            break;
     }
 
-    entry.created_at = rdtsc();
-    entry.state = EVENT_STATUS_PROCESSING;
+    // 3. Coalescing: дубликат in-flight read-only запроса ждёт ответ лидера
+    //    (звенья цепочки - никогда: их результат зависит от соседей)
+    uint64_t coalesce_key = 0;
+    if (chain == CHAIN_NONE && coalesce_try_attach(event, &coalesce_key)) {
+        return 1;
+    }
 
-    // 4. Добавляем в routing table
-    if (!routing_table_insert(routing_table, &entry)) {
-        // Не удалось добавить (таблица полна?)
+    // 4. Резервируем entry прямо в routing table
+    RoutingEntry* entry = routing_table_reserve(routing_table, event->id);
+    if (!entry) {
+        // Таблица полна - перегрузка: BUSY (кредит вернётся), а не тишина
         atomic_increment_u64((volatile uint64_t*)&center_stats.routing_errors);
+        if (chain != CHAIN_NONE) {
+            chain_cancel(chain);
+        }
+        center_send_status(submitted, kernel_to_user_ring, EVENT_STATUS_BUSY, 0);
         return 0;
     }
 
+    // 5. Заполняем entry на месте и определяем маршрут. Center держит
+    //    entry (reaper её не тронет) до hand-off в guide_route_entry
+    routing_entry_init(entry, event->id, event);
+    routing_entry_hold_init(entry);
+    entry->chain_slot = chain;
+    center_determine_route(event->type, entry->prefixes, entry->depends);
+    entry->created_at = rdtsc();
+    entry->deadline = reaper_deadline(event);
+    latency_record(latency, event->type, LATENCY_SLOT_SECOND, entry->created_at - now);
+    coalesce_register(entry, coalesce_key);  // До route: дальше дубликаты ждут её
+
+    // 6. Публикуем (для lookup/отмены) и сразу отдаём первому deck
+    routing_table_publish(entry);
     atomic_increment_u64((volatile uint64_t*)&center_stats.routes_created);
+
+    guide_route_entry(entry);
     return 1;
 }
 
-// ============================================================================
-// MAIN LOOP
-// ============================================================================
-
-void center_run(EventRingBuffer* from_receiver_ring, RoutingTable* routing_table, ResponseRingBuffer* kernel_to_user_ring);
+// Обрабатывает события из Receiver rings lanes (from_receiver_rings[EVENT_LANE_COUNT])
+// на месте, по приоритету lanes: lane l - до max >> l слотов, слоты каждой
+// lane освобождаются одним обновлением head. Возвращает количество
+// обработанных слотов.
+uint64_t center_drain_burst(EventRingBuffer** from_receiver_rings, RoutingTable* routing_table,
+                            ResponseRingBuffer* kernel_to_user_ring, uint64_t max);
 
 // ============================================================================
 // STATS
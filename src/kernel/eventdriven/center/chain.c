@@ -0,0 +1,455 @@
+#include "chain.h"
+#include "center.h"
+#include "../payload/payload_arena.h"
+#include "../core/credits.h"
+#include "pmm.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+#define CHAIN_STATE_FREE        0
+#define CHAIN_STATE_ASSEMBLING  1       // Center копит звенья
+#define CHAIN_STATE_RUNNING     2       // Звенья идут через decks
+#define CHAIN_STATE_BROKEN      3       // Сборка сломана: слот держит отправителя
+
+// Отправители со сломанной сборкой: их звенья с LINK отменяются молча до
+// завершающего звена. Сломанная сборка остаётся на своём слоте
+// (CHAIN_STATE_BROKEN); список - для поломок без слота (пул исчерпан,
+// Security отклонила первое звено), затем свободный слот пула. Когда нет
+// ни того, ни другого, помечается весь ring (chain_broken_rings)
+#define CHAIN_BROKEN_MAX        16
+
+typedef struct {
+    uint64_t source;
+    uint32_t ring_id;
+} ChainBroken;
+
+ChainStats chain_stats;
+
+static EventChain* chain_pool = 0;              // [CHAIN_POOL_SIZE], из PMM
+static uint32_t chain_free = CHAIN_NONE;
+static spinlock_t chain_lock;                   // Center vs Execution (free) vs task_rings_unregister
+
+// Сборку меняет Center под chain_lock (и task_rings_unregister - звенья
+// ушедшей задачи); без lock читается только быстрый путь
+static volatile uint32_t chain_assembling = 0;  // Слотов в ASSEMBLING / BROKEN
+static ChainBroken chain_broken[CHAIN_BROKEN_MAX];
+static volatile uint32_t chain_broken_count = 0;
+
+// Ring, отправитель которого сломал сборку, но записать его некуда: до
+// завершающего звена с ring все события вне собираемых цепочек отклоняются
+// (CHAIN_ERROR_NO_SLOT) - хвост сломанной цепочки не запустится как новая.
+// Пара задачи - один отправитель, там это точно
+static volatile uint32_t chain_broken_rings = 0;
+
+_Static_assert(TASK_RINGS_MAX < 32, "chain_broken_rings is a 32-bit ring mask");
+
+#define CHAIN_PAGES ((CHAIN_POOL_SIZE * sizeof(EventChain) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void chain_init(void) {
+    memset(&chain_stats, 0, sizeof(chain_stats));
+    spinlock_init(&chain_lock);
+
+    if (!chain_pool) {
+        chain_pool = (EventChain*)pmm_alloc_zero(CHAIN_PAGES);
+        if (!chain_pool) {
+            panic("[CHAIN] Out of memory for chain pool");
+        }
+    }
+
+    for (uint32_t i = 0; i < CHAIN_POOL_SIZE; i++) {
+        chain_pool[i].state = CHAIN_STATE_FREE;
+        chain_pool[i].next_free = (i + 1 < CHAIN_POOL_SIZE) ? i + 1 : CHAIN_NONE;
+    }
+    chain_free = 0;
+    chain_assembling = 0;
+    chain_broken_count = 0;
+    chain_broken_rings = 0;
+}
+
+// ============================================================================
+// POOL
+// ============================================================================
+
+// chain_lock взят
+static uint32_t chain_alloc_locked(void) {
+    uint32_t slot = chain_free;
+    if (slot != CHAIN_NONE) {
+        chain_free = chain_pool[slot].next_free;
+    }
+    return slot;
+}
+
+static void chain_release_locked(uint32_t slot) {
+    chain_pool[slot].state = CHAIN_STATE_FREE;
+    chain_pool[slot].next_free = chain_free;
+    chain_free = slot;
+}
+
+static void chain_release(uint32_t slot) {
+    spin_lock(&chain_lock);
+    chain_release_locked(slot);
+    spin_unlock(&chain_lock);
+}
+
+Event* chain_link(uint32_t slot, uint32_t index) {
+    return &chain_pool[slot].links[index];
+}
+
+// Звенья, отменённые без ответа, возвращают кредиты ring (core/credits.h)
+static void chain_drop_links(EventChain* chain, uint64_t count) {
+    atomic_fetch_add_u64(&chain_stats.cancelled, count);
+    credits_release(chain->ring_id, count);
+}
+
+// ============================================================================
+// ASSEMBLY (Center)
+// ============================================================================
+
+// Отправитель: SQ пары задачи или user_id на глобальном ring
+static inline uint64_t chain_source(Event* event) {
+    return ((uint64_t)event_ring_id(event->flags) << 56) ^ event->user_id;
+}
+
+// Слот в сборке (ASSEMBLING или BROKEN) отправителя source
+static uint32_t chain_find_assembling(uint64_t source) {
+    for (uint32_t i = 0; i < CHAIN_POOL_SIZE; i++) {
+        uint32_t state = chain_pool[i].state;
+        if ((state == CHAIN_STATE_ASSEMBLING || state == CHAIN_STATE_BROKEN) &&
+            chain_pool[i].source == source) {
+            return i;
+        }
+    }
+    return CHAIN_NONE;
+}
+
+// 1 = отправитель в списке сломанных (звено надо отменить). Завершающее
+// звено снимает отправителя со списка
+static int chain_broken_take(uint64_t source, int linked) {
+    for (uint32_t i = 0; i < chain_broken_count; i++) {
+        if (chain_broken[i].source == source) {
+            if (!linked) {
+                chain_broken[i] = chain_broken[--chain_broken_count];
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Запомнить сломанную сборку без своего слота: список, свободный слот
+// пула, в крайнем случае весь ring
+static void chain_mark_broken(Event* event) {
+    uint32_t ring_id = event_ring_id(event->flags);
+    if (chain_broken_count < CHAIN_BROKEN_MAX) {
+        chain_broken[chain_broken_count].source = chain_source(event);
+        chain_broken[chain_broken_count].ring_id = ring_id;
+        chain_broken_count++;
+        return;
+    }
+
+    uint32_t slot = chain_alloc_locked();
+    if (slot != CHAIN_NONE) {
+        EventChain* marker = &chain_pool[slot];
+        marker->source = chain_source(event);
+        marker->ring_id = ring_id;
+        marker->count = 0;
+        marker->state = CHAIN_STATE_BROKEN;
+        chain_assembling++;
+        return;
+    }
+
+    chain_broken_rings |= 1u << ring_id;
+}
+
+// Сборка не удалась на звене event: собранные звенья отменяются, а если
+// за event ещё идут звенья (LINK) - отменятся и они (chain_lock взят)
+static void chain_break(uint32_t slot, Event* event) {
+    int linked = (event->flags & EVENT_FLAG_LINK) != 0;
+    if (slot != CHAIN_NONE) {
+        EventChain* chain = &chain_pool[slot];
+        chain_drop_links(chain, chain->count);
+        chain->count = 0;
+        if (linked) {
+            chain->state = CHAIN_STATE_BROKEN;  // Слот ждёт завершающее звено
+        } else {
+            chain_assembling--;
+            chain_release_locked(slot);
+        }
+    } else if (linked) {
+        chain_mark_broken(event);
+    }
+    atomic_increment_u64(&chain_stats.broken);
+}
+
+// Звено event отменено без ответа - его кредит свободен
+static int chain_drop_event(Event* event) {
+    atomic_increment_u64(&chain_stats.cancelled);
+    credits_release(event_ring_id(event->flags), 1);
+    return CHAIN_DROPPED;
+}
+
+// chain_lock взят
+static int chain_collect_locked(Event* event, int linked, uint32_t* slot, uint32_t* error) {
+    uint64_t source = chain_source(event);
+    if (chain_broken_count && chain_broken_take(source, linked)) {
+        return chain_drop_event(event);
+    }
+
+    uint32_t index = chain_assembling ? chain_find_assembling(source) : CHAIN_NONE;
+    if (index != CHAIN_NONE && chain_pool[index].state == CHAIN_STATE_BROKEN) {
+        if (!linked) {
+            chain_assembling--;
+            chain_release_locked(index);
+        }
+        return chain_drop_event(event);
+    }
+
+    uint32_t ring_bit = 1u << event_ring_id(event->flags);
+    if (index == CHAIN_NONE && (chain_broken_rings & ring_bit)) {
+        // Возможно, хвост сборки, которую некуда было записать
+        if (!linked) {
+            chain_broken_rings &= ~ring_bit;
+        }
+        atomic_increment_u64(&chain_stats.broken);
+        *error = CHAIN_ERROR_NO_SLOT;
+        return CHAIN_FAILED;
+    }
+
+    if (index == CHAIN_NONE) {
+        if (!linked) {
+            return CHAIN_PASS;  // Одиночное событие
+        }
+        index = chain_alloc_locked();
+        if (index == CHAIN_NONE) {
+            chain_break(CHAIN_NONE, event);
+            *error = CHAIN_ERROR_NO_SLOT;
+            return CHAIN_FAILED;
+        }
+
+        EventChain* fresh = &chain_pool[index];
+        fresh->source = source;
+        fresh->ring_id = event_ring_id(event->flags);
+        fresh->lane = event_lane(event->flags);
+        fresh->count = 0;
+        fresh->state = CHAIN_STATE_ASSEMBLING;
+        chain_assembling++;
+    }
+
+    EventChain* chain = &chain_pool[index];
+
+    // Lanes Center разбирает по приоритету: звенья из разных lanes пришли
+    // бы не по порядку
+    if (event_lane(event->flags) != chain->lane || chain->count == CHAIN_MAX_LINKS) {
+        *error = chain->count == CHAIN_MAX_LINKS ? CHAIN_ERROR_TOO_LONG : CHAIN_ERROR_LANE;
+        chain_break(index, event);
+        return CHAIN_FAILED;
+    }
+
+    chain->links[chain->count++] = *event;
+    if (linked) {
+        return CHAIN_HELD;
+    }
+
+    // Завершающее звено: цепочка уходит в pipeline одной entry
+    chain_assembling--;
+    chain->state = CHAIN_STATE_RUNNING;
+    chain->next = 1;
+    chain->carry = 0;
+    chain->payload_offset = RESPONSE_PAYLOAD_NONE;
+    chain->payload_size = 0;
+    atomic_increment_u64(&chain_stats.chains);
+
+    *slot = index;
+    return CHAIN_READY;
+}
+
+int chain_collect(Event* event, uint32_t* slot, uint32_t* error) {
+    int linked = (event->flags & EVENT_FLAG_LINK) != 0;
+
+    // Быстрый путь: ни одной цепочки в сборке
+    if (!linked && !chain_assembling && !chain_broken_count && !chain_broken_rings) {
+        return CHAIN_PASS;
+    }
+
+    spin_lock(&chain_lock);
+    int result = chain_collect_locked(event, linked, slot, error);
+    spin_unlock(&chain_lock);
+    return result;
+}
+
+void chain_deny(Event* event) {
+    int linked = (event->flags & EVENT_FLAG_LINK) != 0;
+    if (!linked && !chain_assembling && !chain_broken_count && !chain_broken_rings) {
+        return;
+    }
+
+    spin_lock(&chain_lock);
+
+    uint64_t source = chain_source(event);
+    uint32_t index = chain_assembling ? chain_find_assembling(source) : CHAIN_NONE;
+    uint32_t ring_bit = 1u << event_ring_id(event->flags);
+    if (chain_broken_count && chain_broken_take(source, linked)) {
+        // Цепочка уже сломана
+    } else if (index != CHAIN_NONE && chain_pool[index].state == CHAIN_STATE_BROKEN) {
+        if (!linked) {
+            chain_assembling--;
+            chain_release_locked(index);
+        }
+    } else if (index == CHAIN_NONE && (chain_broken_rings & ring_bit)) {
+        if (!linked) {
+            chain_broken_rings &= ~ring_bit;
+        }
+    } else if (index != CHAIN_NONE || linked) {
+        chain_break(index, event);
+    }
+
+    spin_unlock(&chain_lock);
+}
+
+void chain_release_ring(uint32_t ring_id) {
+    spin_lock(&chain_lock);
+
+    for (uint32_t i = 0; i < CHAIN_POOL_SIZE; i++) {
+        EventChain* chain = &chain_pool[i];
+        if ((chain->state == CHAIN_STATE_ASSEMBLING || chain->state == CHAIN_STATE_BROKEN) &&
+            chain->ring_id == ring_id) {
+            chain_drop_links(chain, chain->count);
+            chain_assembling--;
+            chain_release_locked(i);
+            atomic_increment_u64(&chain_stats.orphaned);
+        }
+    }
+
+    for (uint32_t i = 0; i < chain_broken_count;) {
+        if (chain_broken[i].ring_id == ring_id) {
+            chain_broken[i] = chain_broken[--chain_broken_count];
+        } else {
+            i++;
+        }
+    }
+    chain_broken_rings &= ~(1u << ring_id);
+
+    spin_unlock(&chain_lock);
+}
+
+void chain_cancel(uint32_t slot) {
+    // Завершающее звено получит ответ от Center - остальные отменяются
+    chain_drop_links(&chain_pool[slot], chain_pool[slot].count - 1);
+    chain_release(slot);
+}
+
+// ============================================================================
+// EXECUTION
+// ============================================================================
+
+// Inline результат звена - как его взял бы collect_results (0 = нет)
+static uint64_t chain_inline_result(RoutingEntry* entry) {
+    for (int i = MAX_ROUTING_STEPS - 1; i >= 0; i--) {
+        if (entry->deck_results[i]) {
+            return (uint64_t)entry->deck_results[i];
+        }
+    }
+    return 0;
+}
+
+// carry - только fd: его даёт FILE_OPEN, успешный FILE_CLOSE того же fd
+// снимает. Inline результаты остальных звеньев (байты WRITE / READ в
+// fixed буфер) подставились бы в CHAIN_FD вместо открытого файла
+static void chain_track_fd(EventChain* chain, RoutingEntry* entry) {
+    uint32_t type = entry->event_copy.type;
+    if (type == EVENT_FILE_OPEN) {
+        uint64_t fd = chain_inline_result(entry);
+        if (fd) {
+            chain->carry = fd;
+        }
+    } else if (type == EVENT_FILE_CLOSE &&
+               *(int32_t*)entry->event_copy.data == (int32_t)chain->carry) {
+        chain->carry = 0;
+    }
+}
+
+int chain_advance(RoutingEntry* entry) {
+    uint32_t slot = entry->chain_slot;
+    EventChain* chain = &chain_pool[slot];
+    atomic_increment_u64(&chain_stats.links);
+
+    // Payload звена держит цепочка: следующее звено может вернуть свой
+    if (entry->payload_offset != RESPONSE_PAYLOAD_NONE) {
+        payload_arena_release(chain->payload_offset);
+        chain->payload_offset = entry->payload_offset;
+        chain->payload_size = entry->payload_size;
+        entry->payload_offset = RESPONSE_PAYLOAD_NONE;
+    }
+    if (!entry->abort_flag) {
+        chain_track_fd(chain, entry);
+    }
+
+    if (!entry->abort_flag && chain->next < chain->count) {
+        // Звено без ответа - его кредит свободен
+        credits_release(event_ring_id(entry->event_copy.flags), 1);
+
+        // Следующее звено - в ту же entry (event_id = ID первого звена,
+        // под ним entry лежит в routing table)
+        Event* link = &chain->links[chain->next++];
+        routing_entry_init(entry, entry->event_id, link);
+        entry->chain_slot = slot;
+        if (link->flags & EVENT_FLAG_CHAIN_FD) {
+            *(int32_t*)entry->event_copy.data = (int32_t)chain->carry;
+        }
+
+        center_determine_route(link->type, entry->prefixes, entry->depends);
+        entry->created_at = rdtsc();
+        entry->deadline = reaper_deadline(link);  // Свой дедлайн у каждого звена
+        routing_table_publish(entry);
+        guide_route_entry(entry);
+        return 1;
+    }
+
+    if (entry->abort_flag) {
+        atomic_increment_u64(&chain_stats.failed);
+        chain_drop_links(chain, chain->count - chain->next);
+        // Упавшее звено отдаёт открытый цепочкой fd - иначе его не закрыть
+        if (chain->carry && !chain_inline_result(entry)) {
+            entry->deck_results[MAX_ROUTING_STEPS - 1] = (void*)chain->carry;
+        }
+    } else {
+        atomic_increment_u64(&chain_stats.completed);
+    }
+
+    // Ответ цепочки несёт payload, если его дало хоть одно звено
+    // (у упавшего звена payload нет - collect_results отдаст inline)
+    if (chain->payload_offset != RESPONSE_PAYLOAD_NONE) {
+        if (!entry->abort_flag && entry->payload_offset == RESPONSE_PAYLOAD_NONE) {
+            entry->payload_offset = chain->payload_offset;
+            entry->payload_size = chain->payload_size;
+        } else {
+            payload_arena_release(chain->payload_offset);
+        }
+    }
+
+    entry->chain_slot = CHAIN_NONE;
+    chain_release(slot);
+    return 0;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void chain_print_stats(void) {
+    kprintf("[CHAIN] Stats: chains=%lu links=%lu completed=%lu failed=%lu cancelled=%lu broken=%lu orphaned=%lu\n",
+            chain_stats.chains,
+            chain_stats.links,
+            chain_stats.completed,
+            chain_stats.failed,
+            chain_stats.cancelled,
+            chain_stats.broken,
+            chain_stats.orphaned);
+}
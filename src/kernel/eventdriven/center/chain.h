@@ -0,0 +1,102 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include "../core/events.h"
+#include "klib.h"
+
+// ============================================================================
+// EVENT CHAINS - "open, read, close" одним проходом через ядро
+// ============================================================================
+//
+// Звенья с EVENT_FLAG_LINK (core/events.h) Center не маршрутизирует сразу,
+// а собирает в EventChain своего отправителя (ring id + user_id). Звено без
+// LINK завершает цепочку - тогда Center создаёт ОДНУ RoutingEntry на первое
+// звено (RoutingEntry.chain_slot).
+//
+// Execution, получив звено, не отвечает, а зовёт chain_advance(): следующее
+// звено копируется в ту же entry (EVENT_FLAG_CHAIN_FD подставляет fd
+// последнего FILE_OPEN звена) и снова уходит в decks. Ответ (event_id звена) отправляется
+// только на последнее или упавшее звено, остальные звенья отменяются.
+//
+// Payload результат (FILE_READ) переживает следующие звенья и уходит в
+// ответ цепочки. Упавшее звено без своего результата получает inline fd,
+// открытый цепочкой и ещё не закрытый ею, - закрыть его сам user.
+//
+// Сборку ведёт только Center (один consumer lanes), выполнение - Execution;
+// общие пул цепочек и состояние сборки (lock, как у coalesce): собираемые
+// цепочки ушедшей задачи снимает task_rings_unregister.
+//
+// ============================================================================
+
+#define CHAIN_MAX_LINKS     8           // Звеньев в цепочке
+#define CHAIN_POOL_SIZE     64          // Цепочек одновременно (собираемых + in-flight)
+#define CHAIN_NONE          ROUTING_CHAIN_NONE
+
+// Код ошибки (Response.error_code, status INVALID) звена, сломавшего сборку
+#define CHAIN_ERROR_TOO_LONG    1       // Больше CHAIN_MAX_LINKS звеньев
+#define CHAIN_ERROR_NO_SLOT     2       // Пул цепочек исчерпан
+#define CHAIN_ERROR_LANE        3       // Звено пришло в другой lane
+
+// Результат chain_collect для Center
+#define CHAIN_PASS          0           // Не звено цепочки - обычный путь
+#define CHAIN_HELD          1           // Звено сохранено, ждём следующее
+#define CHAIN_READY         2           // Цепочка собрана: маршрутизировать *slot
+#define CHAIN_DROPPED       3           // Цепочка сломана раньше - звено отменено
+#define CHAIN_FAILED        4           // Звено сломало сборку: ответить ошибкой *error
+
+typedef struct {
+    Event links[CHAIN_MAX_LINKS];
+    uint64_t source;                    // Отправитель (ring id + user_id)
+    uint64_t carry;                     // fd последнего FILE_OPEN (0 = нет / закрыт)
+    uint32_t payload_offset;            // Payload предыдущих звеньев (или NONE)
+    uint32_t payload_size;
+    uint32_t count;                     // Собрано звеньев
+    uint32_t next;                      // Следующее звено к выполнению
+    uint32_t ring_id;                   // Ring отправителя (кредиты звеньев)
+    uint32_t lane;
+    uint32_t state;                     // CHAIN_STATE_*
+    uint32_t next_free;
+} EventChain;
+
+typedef struct {
+    volatile uint64_t chains;           // Собранных цепочек
+    volatile uint64_t links;            // Выполненных звеньев
+    volatile uint64_t completed;        // Дошли до последнего звена
+    volatile uint64_t failed;           // Звено упало - остаток отменён
+    volatile uint64_t cancelled;        // Отменённых звеньев
+    volatile uint64_t broken;           // Сборка не удалась (длина, пул, lane)
+    volatile uint64_t orphaned;         // Собираемых цепочек ушедшей задачи
+} ChainStats;
+
+extern ChainStats chain_stats;
+
+void chain_init(void);
+
+// Center: разобрать событие (после Security). Для CHAIN_READY *slot -
+// собранная цепочка (маршрутизировать chain_link(slot, 0)), для
+// CHAIN_FAILED *error - код для ответа INVALID на это событие
+int chain_collect(Event* event, uint32_t* slot, uint32_t* error);
+
+// Center: звено отклонено Security - цепочка его отправителя сломана
+void chain_deny(Event* event);
+
+// task_rings_unregister: задача ушла - собираемые и сломанные сборки ring
+// освобождаются (кредиты звеньев возвращаются), следующий владелец пары
+// начинает с чистого листа. Цепочки, уже идущие через decks, доходят сами
+void chain_release_ring(uint32_t ring_id);
+
+// Звено index цепочки slot
+Event* chain_link(uint32_t slot, uint32_t index);
+
+// Center: собранную цепочку не удалось маршрутизировать - отменить все
+// звенья, кроме завершающего (на него Center отвечает BUSY)
+void chain_cancel(uint32_t slot);
+
+// Execution: звено entry завершено. 1 = следующее звено уже в decks (ответа
+// нет), 0 = цепочка закончилась (последнее или упавшее звено) - entry
+// готова к ответу, цепочка освобождена
+int chain_advance(RoutingEntry* entry);
+
+void chain_print_stats(void);
+
+#endif // CHAIN_H
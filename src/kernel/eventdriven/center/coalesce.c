@@ -0,0 +1,252 @@
+#include "coalesce.h"
+#include "../routing/routing_pool.h"
+#include "pmm.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+typedef struct {
+    uint64_t key;                       // 0 = slot свободен
+    RoutingHandle leader;
+    uint32_t head;                      // Waiters (FIFO): ответы уходят в порядке прихода
+    uint32_t tail;
+} CoalesceSlot;
+
+CoalesceStats coalesce_stats;
+
+static CoalesceSlot coalesce_slots[COALESCE_SLOTS];
+static CoalesceWaiter* coalesce_waiters = 0;    // [COALESCE_MAX_WAITERS], из PMM
+static uint32_t coalesce_free = COALESCE_NONE;
+static spinlock_t coalesce_lock;                // Center (attach/register) vs Execution (detach)
+
+#define COALESCE_PAGES(size) (((size) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void coalesce_init(void) {
+    memset(&coalesce_stats, 0, sizeof(coalesce_stats));
+    memset(coalesce_slots, 0, sizeof(coalesce_slots));
+    spinlock_init(&coalesce_lock);
+
+    if (!coalesce_waiters) {
+        coalesce_waiters = (CoalesceWaiter*)pmm_alloc_zero(
+            COALESCE_PAGES(COALESCE_MAX_WAITERS * sizeof(CoalesceWaiter)));
+        if (!coalesce_waiters) {
+            panic("[COALESCE] Out of memory for waiters");
+        }
+    }
+
+    for (uint32_t i = 0; i < COALESCE_MAX_WAITERS; i++) {
+        coalesce_waiters[i].next = (i + 1 < COALESCE_MAX_WAITERS) ? i + 1 : COALESCE_NONE;
+    }
+    coalesce_free = 0;
+}
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+static inline uint64_t coalesce_mix(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    hash *= 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 29);
+}
+
+// 0 = тип не coalescable
+static uint64_t coalesce_key(Event* event) {
+    uint8_t coalesce = event_registry_lookup(event->type)->coalesce;
+    if (coalesce == EVENT_COALESCE_NONE) {
+        return 0;
+    }
+
+    uint64_t hash = coalesce_mix(0, event->type);
+    if (coalesce & EVENT_COALESCE_PER_USER) {
+        hash = coalesce_mix(hash, event->user_id);
+    }
+
+    switch (coalesce & EVENT_COALESCE_KEY_MASK) {
+        case EVENT_COALESCE_PATH:
+            for (int i = 0; i < EVENT_DATA_SIZE && event->data[i]; i++) {
+                hash = coalesce_mix(hash, event->data[i]);
+            }
+            break;
+
+        case EVENT_COALESCE_U64:
+            hash = coalesce_mix(hash, *(uint64_t*)event->data);
+            break;
+
+        default:
+            break;  // EVENT_COALESCE_TYPE: payload не важен
+    }
+
+    return hash | 1;
+}
+
+// Hash совпал - сверяем сами данные ключа с событием лидера
+static int coalesce_same_request(Event* leader, Event* event) {
+    if (leader->type != event->type) {
+        return 0;
+    }
+
+    uint8_t coalesce = event_registry_lookup(event->type)->coalesce;
+    if ((coalesce & EVENT_COALESCE_PER_USER) && leader->user_id != event->user_id) {
+        return 0;
+    }
+
+    switch (coalesce & EVENT_COALESCE_KEY_MASK) {
+        case EVENT_COALESCE_PATH:
+            return strncmp((const char*)leader->data, (const char*)event->data, EVENT_DATA_SIZE) == 0;
+
+        case EVENT_COALESCE_U64:
+            return *(uint64_t*)leader->data == *(uint64_t*)event->data;
+
+        default:
+            return 1;
+    }
+}
+
+// ============================================================================
+// CENTER SIDE
+// ============================================================================
+
+int coalesce_try_attach(Event* event, uint64_t* key) {
+    *key = coalesce_key(event);
+    if (*key == 0) {
+        return 0;
+    }
+
+    CoalesceSlot* slot = &coalesce_slots[*key & (COALESCE_SLOTS - 1)];
+
+    spin_lock(&coalesce_lock);
+
+    if (slot->key != *key) {
+        spin_unlock(&coalesce_lock);
+        return 0;  // Лидера нет (или slot у другого ключа - register это увидит)
+    }
+
+    RoutingEntry* leader = routing_pool_resolve(slot->leader);
+    if (!leader || !coalesce_same_request(&leader->event_copy, event)) {
+        spin_unlock(&coalesce_lock);
+        return 0;
+    }
+
+    uint32_t index = coalesce_free;
+    if (index == COALESCE_NONE) {
+        spin_unlock(&coalesce_lock);
+        coalesce_stats.waiters_full++;
+        *key = 0;  // Slot занят лидером - регистрировать нечего
+        return 0;
+    }
+    coalesce_free = coalesce_waiters[index].next;
+
+    CoalesceWaiter* waiter = &coalesce_waiters[index];
+    waiter->event_id = event->id;
+    waiter->timestamp = event->timestamp;
+    waiter->flags = event->flags;
+    waiter->next = COALESCE_NONE;
+
+    if (slot->tail == COALESCE_NONE) {
+        slot->head = index;
+    } else {
+        coalesce_waiters[slot->tail].next = index;
+    }
+    slot->tail = index;
+
+    spin_unlock(&coalesce_lock);
+
+    atomic_increment_u64(&coalesce_stats.coalesced);
+    atomic_increment_u64(&coalesce_stats.per_type[event->type & (EVENT_REGISTRY_SIZE - 1)]);
+    return 1;
+}
+
+void coalesce_register(RoutingEntry* entry, uint64_t key) {
+    if (key == 0) {
+        return;
+    }
+
+    uint32_t index = key & (COALESCE_SLOTS - 1);
+    CoalesceSlot* slot = &coalesce_slots[index];
+
+    spin_lock(&coalesce_lock);
+
+    if (slot->key != 0) {
+        spin_unlock(&coalesce_lock);
+        coalesce_stats.slot_busy++;
+        return;
+    }
+
+    slot->key = key;
+    slot->leader = routing_entry_handle(entry);
+    slot->head = COALESCE_NONE;
+    slot->tail = COALESCE_NONE;
+    entry->coalesce_slot = index;
+
+    spin_unlock(&coalesce_lock);
+
+    coalesce_stats.leaders++;
+}
+
+// ============================================================================
+// EXECUTION SIDE
+// ============================================================================
+
+uint32_t coalesce_detach(RoutingEntry* entry) {
+    uint32_t index = entry->coalesce_slot;
+    if (index == COALESCE_NONE) {
+        return COALESCE_NONE;
+    }
+
+    CoalesceSlot* slot = &coalesce_slots[index];
+
+    // После снятия slot новые дубликаты пойдут своим проходом pipeline
+    spin_lock(&coalesce_lock);
+    uint32_t head = slot->head;
+    slot->key = 0;
+    slot->leader = ROUTING_HANDLE_NONE;
+    slot->head = COALESCE_NONE;
+    slot->tail = COALESCE_NONE;
+    spin_unlock(&coalesce_lock);
+
+    entry->coalesce_slot = COALESCE_NONE;
+    return head;
+}
+
+CoalesceWaiter* coalesce_waiter(uint32_t index) {
+    return &coalesce_waiters[index];
+}
+
+void coalesce_release_waiters(uint32_t head) {
+    if (head == COALESCE_NONE) {
+        return;
+    }
+
+    uint32_t tail = head;
+    while (coalesce_waiters[tail].next != COALESCE_NONE) {
+        tail = coalesce_waiters[tail].next;
+    }
+
+    spin_lock(&coalesce_lock);
+    coalesce_waiters[tail].next = coalesce_free;
+    coalesce_free = head;
+    spin_unlock(&coalesce_lock);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void coalesce_print_stats(void) {
+    kprintf("[COALESCE] Stats: leaders=%lu coalesced=%lu slot_busy=%lu waiters_full=%lu\n",
+            coalesce_stats.leaders, coalesce_stats.coalesced,
+            coalesce_stats.slot_busy, coalesce_stats.waiters_full);
+
+    for (uint32_t type = 0; type < EVENT_REGISTRY_SIZE; type++) {
+        if (coalesce_stats.per_type[type]) {
+            kprintf("[COALESCE]   type %u: coalesced=%lu\n", type, coalesce_stats.per_type[type]);
+        }
+    }
+}
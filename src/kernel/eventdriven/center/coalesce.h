@@ -0,0 +1,71 @@
+#ifndef COALESCE_H
+#define COALESCE_H
+
+#include "../core/events.h"
+#include "../routing/event_registry.h"
+#include "klib.h"
+
+// ============================================================================
+// COALESCING - один проход pipeline на одинаковые read-only запросы
+// ============================================================================
+//
+// Для типов с event_registry[type].coalesce != NONE Center считает ключ
+// (type + payload по виду ключа) и ищет in-flight лидера с тем же ключом:
+//   - нашёлся: событие не создаёт RoutingEntry, а становится waiter'ом
+//     лидера (event_id + timestamp в пуле waiters)
+//   - нет: entry события становится лидером (RoutingEntry.coalesce_slot)
+//
+// Execution, завершая лидера, забирает список waiters (coalesce_detach) и
+// рассылает каждому копию ответа лидера со своим event_id; payload
+// копируется - каждый consumer освобождает свой.
+//
+// Таблица лидеров - direct-mapped по hash ключа: занятый чужим ключом
+// slot просто отключает coalescing для события. Совпадение hash
+// подтверждается сравнением payload с event_copy лидера.
+//
+// ============================================================================
+
+#define COALESCE_SLOTS          64
+#define COALESCE_MAX_WAITERS    256
+#define COALESCE_NONE           ROUTING_COALESCE_NONE   // Индекс "нет slot/waiter"
+
+_Static_assert((COALESCE_SLOTS & (COALESCE_SLOTS - 1)) == 0,
+               "COALESCE_SLOTS must be power of 2");
+
+typedef struct {
+    uint64_t event_id;
+    uint64_t timestamp;                 // Receiver timestamp (для latency)
+    uint32_t flags;                     // Event.flags: CQ, в которую уйдёт ответ
+    uint32_t next;                      // COALESCE_NONE = конец списка
+} CoalesceWaiter;
+
+typedef struct {
+    volatile uint64_t leaders;          // Entries, ставшие лидерами
+    volatile uint64_t coalesced;        // Событий, ответ на которые пришёл от лидера
+    volatile uint64_t slot_busy;        // Slot занят другим ключом
+    volatile uint64_t waiters_full;     // Пул waiters исчерпан
+    volatile uint64_t per_type[EVENT_REGISTRY_SIZE];  // coalesced по EventType
+} CoalesceStats;
+
+extern CoalesceStats coalesce_stats;
+
+void coalesce_init(void);
+
+// Center: присоединить событие к in-flight лидеру. 1 = событие стало
+// waiter'ом (RoutingEntry не нужна). Иначе *key = ключ для
+// coalesce_register (0 = тип не coalescable)
+int coalesce_try_attach(Event* event, uint64_t* key);
+
+// Center: entry становится лидером своего ключа (если slot свободен)
+void coalesce_register(RoutingEntry* entry, uint64_t key);
+
+// Execution: снять лидера, вернуть голову списка waiters (COALESCE_NONE = нет)
+uint32_t coalesce_detach(RoutingEntry* entry);
+
+// Execution: waiter по индексу и возврат всего списка в пул
+CoalesceWaiter* coalesce_waiter(uint32_t index);
+void coalesce_release_waiters(uint32_t head);
+
+void coalesce_print_stats(void);
+
+#endif // COALESCE_H
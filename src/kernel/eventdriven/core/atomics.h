@@ -70,17 +70,29 @@ static inline uint64_t atomic_increment_u64(volatile uint64_t* ptr) {
     return result + 1;  // xadd возвращает старое значение
 }
 
+// -1 обязательно 64-битная: int -1 попадает в регистр как 0xFFFFFFFF
 static inline uint64_t atomic_decrement_u64(volatile uint64_t* ptr) {
     uint64_t result;
     __asm__ volatile(
         "lock; xaddq %0, %1"
         : "=r" (result), "+m" (*ptr)
-        : "0" (-1)
+        : "0" ((uint64_t)-1)
         : "memory", "cc"
     );
     return result - 1;
 }
 
+// Атомарно прибавляет value, возвращает СТАРОЕ значение
+static inline uint64_t atomic_fetch_add_u64(volatile uint64_t* ptr, uint64_t value) {
+    __asm__ volatile(
+        "lock; xaddq %0, %1"
+        : "+r" (value), "+m" (*ptr)
+        :
+        : "memory", "cc"
+    );
+    return value;
+}
+
 static inline uint32_t atomic_increment_u32(volatile uint32_t* ptr) {
     uint32_t result;
     __asm__ volatile(
@@ -92,6 +104,17 @@ static inline uint32_t atomic_increment_u32(volatile uint32_t* ptr) {
     return result + 1;
 }
 
+static inline uint32_t atomic_decrement_u32(volatile uint32_t* ptr) {
+    uint32_t result;
+    __asm__ volatile(
+        "lock; xaddl %0, %1"
+        : "=r" (result), "+m" (*ptr)
+        : "0" (-1)
+        : "memory", "cc"
+    );
+    return result - 1;
+}
+
 // ============================================================================
 // COMPARE-AND-SWAP (CAS) - Основа lock-free алгоритмов
 // ============================================================================
@@ -131,6 +154,15 @@ static inline uint64_t atomic_cas_u64_val(volatile uint64_t* ptr, uint64_t expec
     return prev;
 }
 
+// Атомарный OR, возвращает СТАРОЕ значение (lock or старое не отдаёт)
+static inline uint32_t atomic_fetch_or_u32(volatile uint32_t* ptr, uint32_t bits) {
+    uint32_t old;
+    do {
+        old = *ptr;
+    } while (!atomic_cas_u32(ptr, old, old | bits));
+    return old;
+}
+
 // ============================================================================
 // ATOMIC EXCHANGE
 // ============================================================================
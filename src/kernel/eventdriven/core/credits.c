@@ -0,0 +1,155 @@
+#include "credits.h"
+#include "../execution/completion.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+CreditRing credit_rings[TASK_RINGS_MAX + 1];
+CreditStats credit_stats;
+
+static ResponseRingBuffer* credits_fallback = 0;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void credits_init(ResponseRingBuffer* fallback) {
+    memset(credit_rings, 0, sizeof(credit_rings));
+    memset(&credit_stats, 0, sizeof(credit_stats));
+    credits_fallback = fallback;
+
+    kprintf("[CREDITS] Initialized (%u credits + %u BUSY slots per CQ)\n",
+            CREDITS_PER_RING, CREDITS_BUSY_SLOTS);
+}
+
+// ============================================================================
+// ADMISSION (Receiver)
+// ============================================================================
+
+// Занятые слоты CQ: ответы в ней + ответы, которые ещё придут.
+// CQ пары считается по kernel tail (task_rings_cq_count)
+static inline uint64_t credits_used(uint32_t ring_id) {
+    uint64_t queued = task_rings_get(ring_id) ? task_rings_cq_count(ring_id)
+                                              : response_ring_used(credits_fallback);
+    return atomic_load_u64(&credit_rings[ring_id].inflight) + queued;
+}
+
+uint64_t credits_room(uint32_t ring_id) {
+    uint64_t used = credits_used(ring_id);
+    if (used >= RING_BUFFER_SIZE) {
+        atomic_increment_u64(&credit_rings[ring_id].deferred);
+        return 0;
+    }
+    return RING_BUFFER_SIZE - used;
+}
+
+int credits_acquire(uint32_t ring_id) {
+    CreditRing* ring = &credit_rings[ring_id];
+    if (credits_used(ring_id) >= CREDITS_PER_RING) {
+        return 0;
+    }
+
+    uint64_t inflight = atomic_increment_u64(&ring->inflight);
+    atomic_increment_u64(&ring->admitted);
+
+    // Receiver'ов может быть несколько (MPMC SQ) - max через CAS
+    uint64_t peak = atomic_load_u64(&ring->peak);
+    while (inflight > peak) {
+        uint64_t seen = atomic_cas_u64_val(&ring->peak, peak, inflight);
+        if (seen == peak) {
+            break;
+        }
+        peak = seen;
+    }
+    return 1;
+}
+
+void credits_reject(uint32_t ring_id, uint64_t event_id) {
+    int pair = task_rings_get(ring_id) != 0;
+    uint64_t pos;
+    Response* response = pair ? task_rings_cq_reserve(ring_id, &pos)
+                              : response_ring_reserve(credits_fallback, &pos);
+    if (!response) {
+        // credits_room уже учёл это событие - сюда попадает только
+        // сломанная CQ пары
+        atomic_increment_u64(&credit_stats.overflows);
+        atomic_increment_u64(&credit_rings[ring_id].dropped);
+        return;
+    }
+
+    response_init(response, event_id, EVENT_STATUS_BUSY);
+    response->timestamp = rdtsc();
+    if (pair) {
+        task_rings_cq_commit(ring_id, pos);
+    } else {
+        response_ring_commit(credits_fallback, pos);
+    }
+    atomic_increment_u64(&credit_rings[ring_id].busy);
+    completion_signal(event_id);
+}
+
+// ============================================================================
+// RESPONSES (Center / Execution)
+// ============================================================================
+
+Response* credits_reserve_response(uint32_t flags, ResponseRingBuffer* fallback,
+                                   CreditResponse* slot) {
+    slot->ring_id = event_ring_id(flags);
+    if (task_rings_get(slot->ring_id)) {
+        slot->ring = 0;
+        Response* response = task_rings_cq_reserve(slot->ring_id, &slot->pos);
+        if (!response) {
+            atomic_increment_u64(&credit_rings[slot->ring_id].dropped);
+            credits_release(slot->ring_id, 1);
+        }
+        return response;
+    }
+
+    // Глобальный ring: кредит гарантирует свободный слот - admission считает
+    // и слоты, которые MPMC consumer захватил, но ещё не освободил
+    // (response_ring_used). Промах - нарушенный инвариант кредитов
+    slot->ring = fallback;
+    Response* response = response_ring_reserve(slot->ring, &slot->pos);
+    if (!response) {
+        panic("[CREDITS] Response ring full despite credit (ring %u, inflight=%lu)",
+              slot->ring_id, credit_rings[slot->ring_id].inflight);
+    }
+    return response;
+}
+
+void credits_commit_response(CreditResponse* slot) {
+    if (slot->ring) {
+        response_ring_commit(slot->ring, slot->pos);
+    } else {
+        task_rings_cq_commit(slot->ring_id, slot->pos);
+    }
+    credits_release(slot->ring_id, 1);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void credits_print_stats(void) {
+    uint64_t admitted = 0, busy = 0, deferred = 0, dropped = 0;
+    for (uint32_t id = 0; id <= TASK_RINGS_MAX; id++) {
+        admitted += credit_rings[id].admitted;
+        busy += credit_rings[id].busy;
+        deferred += credit_rings[id].deferred;
+        dropped += credit_rings[id].dropped;
+    }
+
+    kprintf("[CREDITS] Stats: admitted=%lu busy=%lu deferred=%lu dropped=%lu overflows=%lu\n",
+            admitted, busy, deferred, dropped, credit_stats.overflows);
+
+    for (uint32_t id = 0; id <= TASK_RINGS_MAX; id++) {
+        CreditRing* ring = &credit_rings[id];
+        if (ring->admitted || ring->busy) {
+            kprintf("[CREDITS]   ring %u: inflight=%lu/%u peak=%lu busy=%lu deferred=%lu dropped=%lu\n",
+                    id, ring->inflight, CREDITS_PER_RING, ring->peak, ring->busy, ring->deferred,
+                    ring->dropped);
+        }
+    }
+}
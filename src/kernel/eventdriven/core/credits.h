@@ -0,0 +1,86 @@
+#ifndef CREDITS_H
+#define CREDITS_H
+
+#include "events.h"
+#include "ringbuffer.h"
+#include "task_rings.h"
+
+// ============================================================================
+// CREDITS - admission по свободным слотам CQ отправителя
+// ============================================================================
+//
+// У каждого ring (глобальный 0, пары задач 1..TASK_RINGS_MAX) - кредиты на
+// in-flight события. Receiver берёт кредит на каждое принятое событие;
+// кредит возвращает тот, кто положил ответ в CQ (Center - DENIED / INVALID /
+// BUSY, Execution - ответ и ответы waiters), или тот, кто событие отменил
+// без ответа (звенья цепочки).
+//
+// Инвариант: in-flight + ответов в CQ <= RING_BUFFER_SIZE. Кредит = слот CQ,
+// зарезервированный заранее, поэтому Center и Execution никогда не ждут
+// места под ответ - стадии не встают вслед за медленным consumer'ом.
+//
+//   занято < CREDITS_PER_RING         событие принято (кредит)
+//   занято < RING_BUFFER_SIZE         сразу ответ EVENT_STATUS_BUSY (EAGAIN)
+//   иначе                             Receiver не трогает SQ: она заполнится,
+//                                     и eventapi вернёт EVENTAPI_EAGAIN
+//
+// ============================================================================
+
+#define CREDITS_BUSY_SLOTS      32      // Слоты CQ только под ответы BUSY
+#define CREDITS_PER_RING        (RING_BUFFER_SIZE - CREDITS_BUSY_SLOTS)
+
+typedef struct {
+    volatile uint64_t inflight;         // Взятые кредиты
+    volatile uint64_t admitted;
+    volatile uint64_t busy;             // Ответов BUSY
+    volatile uint64_t deferred;         // Проходов, когда CQ полна - SQ не тронута
+    volatile uint64_t peak;             // Максимум inflight
+    volatile uint64_t dropped;          // Ответов отброшено: CQ пары сломана задачей
+} CreditRing;
+
+typedef struct {
+    volatile uint64_t overflows;        // BUSY не влез в сломанную CQ пары
+} CreditStats;
+
+extern CreditRing credit_rings[TASK_RINGS_MAX + 1];
+extern CreditStats credit_stats;
+
+// fallback - глобальный kernel → user ring (CQ ring id 0)
+void credits_init(ResponseRingBuffer* fallback);
+
+// Receiver: сколько событий ring можно забрать из SQ (принять или BUSY)
+uint64_t credits_room(uint32_t ring_id);
+
+// Receiver: 1 = кредит взят, событие идёт дальше; 0 = ответить BUSY
+int credits_acquire(uint32_t ring_id);
+
+// Receiver: ответ EVENT_STATUS_BUSY на событие без кредита
+void credits_reject(uint32_t ring_id, uint64_t event_id);
+
+// Вернуть count кредитов ring (ответ в CQ или отмена без ответа)
+static inline void credits_release(uint32_t ring_id, uint64_t count) {
+    if (count) {
+        atomic_fetch_add_u64(&credit_rings[ring_id].inflight, (uint64_t)0 - count);
+    }
+}
+
+// Слот под ответ, взятый credits_reserve_response
+typedef struct {
+    ResponseRingBuffer* ring;           // 0 = CQ пары ring_id (task_rings_cq_*)
+    uint32_t ring_id;
+    uint64_t pos;
+} CreditResponse;
+
+// Center / Execution: слот под ответ события с флагами flags - в CQ его
+// пары или в fallback (глобальный ring, всегда есть место). 0 - только
+// CQ пары, сломанная задачей (task_rings.h): ответ отброшен, кредит уже
+// возвращён, completion_signal - за вызывающим
+Response* credits_reserve_response(uint32_t flags, ResponseRingBuffer* fallback,
+                                   CreditResponse* slot);
+
+// Опубликовать ответ и вернуть кредит события
+void credits_commit_response(CreditResponse* slot);
+
+void credits_print_stats(void);
+
+#endif // CREDITS_H
@@ -14,6 +14,8 @@ typedef enum {
     EVENT_MEMORY_ALLOC = 1,
     EVENT_MEMORY_FREE = 2,
     EVENT_MEMORY_MAP = 3,
+    EVENT_MEMORY_REGISTER = 4,       // Зарегистрировать user буфер (core/user_buffers.h)
+    EVENT_MEMORY_UNREGISTER = 5,
 
     // File operations
     EVENT_FILE_OPEN = 10,
@@ -62,6 +64,9 @@ typedef enum {
     EVENT_IPC_SHM_ATTACH = 63,
     EVENT_IPC_PIPE_CREATE = 64,
 
+    // System / diagnostics
+    EVENT_SYS_PROBE = 70,            // Fan-out во все decks (проверка route DAG)
+
     EVENT_MAX = 255
 } EventType;
 
@@ -76,7 +81,8 @@ typedef enum {
     EVENT_STATUS_ERROR = 3,
     EVENT_STATUS_INVALID = 4,
     EVENT_STATUS_DENIED = 5,
-    EVENT_STATUS_TIMEOUT = 6
+    EVENT_STATUS_TIMEOUT = 6,           // Дедлайн истёк до ответа (guide/reaper.h)
+    EVENT_STATUS_BUSY = 7               // Нет кредитов ring (core/credits.h) - повторить позже
 } EventStatus;
 
 // ============================================================================
@@ -113,10 +119,149 @@ typedef struct __attribute__((packed)) {
 _Static_assert(sizeof(Event) == 256, "Event must be exactly 256 bytes");
 
 // ============================================================================
-// RESPONSE STRUCTURE - Ответ от kernel к user (4096 байт)
+// EVENT ID - [ring:16][seq:48]
+// ============================================================================
+//
+// ID назначает Receiver: ring = ring id источника + 1 (ID никогда не 0),
+// seq - номер события в этом ring, он же позиция слота в SQ. Счётчик у
+// каждого ring свой, и двигает его единственный consumer - Receivers на
+// разных ядрах не делят ни одной записи. Submitter знает позицию своего
+// слота, поэтому ID известен ему сразу после commit (event_ring_event_id)
+
+#define EVENT_ID_RING_SHIFT     48
+#define EVENT_ID_SEQ_MASK       ((1ULL << EVENT_ID_RING_SHIFT) - 1)
+
+static inline uint64_t event_id_make(uint32_t ring_id, uint64_t seq) {
+    return ((uint64_t)(ring_id + 1) << EVENT_ID_RING_SHIFT) | (seq & EVENT_ID_SEQ_MASK);
+}
+
+// Ring, из которого пришло событие
+static inline uint32_t event_id_ring(uint64_t event_id) {
+    return (uint32_t)(event_id >> EVENT_ID_RING_SHIFT) - 1;
+}
+
+// ============================================================================
+// QOS LANES - Event.flags выбирает lane (приоритет) события
 // ============================================================================
+//
+// Receiver раскладывает события по отдельным receiver→center rings, Center
+// забирает из lanes по приоритету, deck workers - по lane и deficit round
+// robin по user_id внутри lane. Без флагов событие идёт в INTERACTIVE.
+
+#define EVENT_FLAG_REALTIME     (1u << 0)   // Короткие запросы, критичные к latency
+#define EVENT_FLAG_BULK         (1u << 1)   // Массовые операции (файловый I/O)
+#define EVENT_FLAGS_LANE_MASK   (EVENT_FLAG_REALTIME | EVENT_FLAG_BULK)
+
+// Индекс lane = приоритет (0 - высший)
+#define EVENT_LANE_REALTIME     0
+#define EVENT_LANE_INTERACTIVE  1
+#define EVENT_LANE_BULK         2
+#define EVENT_LANE_COUNT        3
+
+static inline uint32_t event_lane(uint32_t flags) {
+    if (flags & EVENT_FLAG_REALTIME) {
+        return EVENT_LANE_REALTIME;
+    }
+    if (flags & EVENT_FLAG_BULK) {
+        return EVENT_LANE_BULK;
+    }
+    return EVENT_LANE_INTERACTIVE;
+}
 
-#define RESPONSE_DATA_SIZE 4064
+static inline uint32_t event_lane_flags(uint32_t lane) {
+    switch (lane) {
+        case EVENT_LANE_REALTIME: return EVENT_FLAG_REALTIME;
+        case EVENT_LANE_BULK:     return EVENT_FLAG_BULK;
+        default:                  return 0;
+    }
+}
+
+static inline const char* event_lane_name(uint32_t lane) {
+    switch (lane) {
+        case EVENT_LANE_REALTIME:    return "realtime";
+        case EVENT_LANE_INTERACTIVE: return "interactive";
+        case EVENT_LANE_BULK:        return "bulk";
+        default:                     return "?";
+    }
+}
+
+// ============================================================================
+// CHAINS - связанные события (center/chain.h)
+// ============================================================================
+//
+// EVENT_FLAG_LINK: следующее событие того же отправителя (ring + user_id,
+// та же lane) - звено той же цепочки. Последнее звено - без LINK. Ядро
+// выполняет звенья по очереди, ответ получает только последнее (или
+// упавшее) звено, остальные после ошибки отменяются.
+// EVENT_FLAG_CHAIN_FD: перед выполнением data[0..3] (int fd - так его
+// читают FILE_READ / FILE_WRITE / FILE_CLOSE) заменяется fd последнего
+// FILE_OPEN звена цепочки. Результаты остальных звеньев (байты WRITE / READ)
+// его не затирают.
+
+#define EVENT_FLAG_LINK         (1u << 2)
+#define EVENT_FLAG_CHAIN_FD     (1u << 3)
+
+// ============================================================================
+// FIXED BUFFERS - FILE_READ / FILE_WRITE через зарегистрированный буфер
+// ============================================================================
+//
+// EVENT_FLAG_FIXED_BUF: данные не в payload arena / Event.data, а в буфере,
+// зарегистрированном EVENT_MEMORY_REGISTER (core/user_buffers.h).
+// data: [fd:4][size:8][buffer id:4][buffer offset:8], inline результат -
+// сколько байт прочитано / записано.
+
+#define EVENT_FLAG_FIXED_BUF    (1u << 4)
+
+// ============================================================================
+// DEADLINE - Event.flags[23:8]: таймаут события в ms (guide/reaper.h)
+// ============================================================================
+//
+// 0 - таймаут типа по умолчанию (event_registry .timeout_ms), 1..65534 -
+// свой, EVENT_TIMEOUT_NONE - без дедлайна. Событие, не дошедшее до
+// Execution к дедлайну, получает ответ EVENT_STATUS_TIMEOUT, а его
+// RoutingEntry освобождается.
+
+#define EVENT_TIMEOUT_SHIFT         8
+#define EVENT_FLAGS_TIMEOUT_MASK    (0xFFFFu << EVENT_TIMEOUT_SHIFT)
+#define EVENT_TIMEOUT_NONE          0xFFFF
+
+static inline uint32_t event_timeout_ms(uint32_t flags) {
+    return (flags & EVENT_FLAGS_TIMEOUT_MASK) >> EVENT_TIMEOUT_SHIFT;
+}
+
+static inline uint32_t event_timeout_flags(uint32_t ms) {
+    return (ms > EVENT_TIMEOUT_NONE ? EVENT_TIMEOUT_NONE : ms) << EVENT_TIMEOUT_SHIFT;
+}
+
+// ============================================================================
+// RING ID - Event.flags[31:24]: из какой SQ пришло событие
+// ============================================================================
+//
+// Ставит только Receiver (значение из user памяти затирается): 0 -
+// глобальный user→kernel ring, иначе - пара задачи (core/task_rings.h),
+// в CQ которой уйдёт ответ.
+
+#define EVENT_RING_SHIFT        24
+#define EVENT_FLAGS_RING_MASK   (0xFFu << EVENT_RING_SHIFT)
+
+static inline uint32_t event_ring_id(uint32_t flags) {
+    return (flags & EVENT_FLAGS_RING_MASK) >> EVENT_RING_SHIFT;
+}
+
+static inline uint32_t event_ring_id_flags(uint32_t ring_id) {
+    return (ring_id << EVENT_RING_SHIFT) & EVENT_FLAGS_RING_MASK;
+}
+
+// ============================================================================
+// RESPONSE STRUCTURE - Компактная completion-запись kernel → user (64 байта)
+// ============================================================================
+//
+// Маленькие результаты (fd, адрес, счётчик байт...) лежат inline в result[].
+// Большие (данные файла, stat, результаты query) deck кладёт в payload arena
+// (payload/payload_arena.h), а в Response передаётся только смещение.
+// Consumer обязан освободить payload (eventapi_release_response).
+
+#define RESPONSE_INLINE_SIZE 32
 
 typedef struct __attribute__((packed)) {
     // === METADATA (32 bytes) ===
@@ -124,20 +269,26 @@ typedef struct __attribute__((packed)) {
     uint64_t timestamp;       // Timestamp завершения
     uint32_t status;          // EventStatus
     uint32_t error_code;      // Код ошибки (если status == ERROR)
-    uint64_t result_size;     // Размер результата в байтах
+    uint32_t result_size;     // Размер результата в байтах (inline или payload)
+    uint32_t payload_offset;  // Смещение в payload arena (PAYLOAD_OFFSET_NONE = inline)
 
-    // === RESULT (4064 bytes) ===
-    uint8_t result[RESPONSE_DATA_SIZE];  // Результат операции
+    // === INLINE RESULT (32 bytes) ===
+    uint8_t result[RESPONSE_INLINE_SIZE];  // Результат операции (если влезает)
 } Response;
 
 // Compile-time проверка размера
-_Static_assert(sizeof(Response) == 4096, "Response must be exactly 4096 bytes");
+_Static_assert(sizeof(Response) == 64, "Response must be exactly 64 bytes");
+
+// Response.payload_offset для inline результата (совпадает с PAYLOAD_OFFSET_NONE)
+#define RESPONSE_PAYLOAD_NONE 0xFFFFFFFF
 
 // ============================================================================
 // ROUTING ENTRY - Запись в таблице маршрутизации
 // ============================================================================
 
 #define MAX_ROUTING_STEPS 8
+#define ROUTING_COALESCE_NONE 0xFFFFFFFF
+#define ROUTING_CHAIN_NONE 0xFFFFFFFF
 
 typedef struct {
     uint64_t event_id;                    // ID события
@@ -145,18 +296,45 @@ typedef struct {
 
     // Prefix routing system
     uint8_t prefixes[MAX_ROUTING_STEPS];  // Массив префиксов (маршрут)
+    uint8_t depends[MAX_ROUTING_STEPS];   // Шаг i ждёт шаги из битовой маски depends[i]
     volatile uint8_t current_index;       // Текущая позиция в маршруте
 
     // Результаты от каждого deck
     void* deck_results[MAX_ROUTING_STEPS];
-    uint64_t deck_timestamps[MAX_ROUTING_STEPS];
+    uint64_t deck_timestamps[MAX_ROUTING_STEPS];  // [prefix - 1]: hand-off в deck, после - завершение
 
     // Метаданные
     uint64_t created_at;                  // Timestamp создания
-    volatile uint32_t completion_flags;   // Битовые флаги завершения decks
+    uint64_t deadline;                    // PIT tick (guide/reaper.h), 0 = без дедлайна
+    uint64_t completed_at;                // Guide отдал entry в Execution
+    volatile uint32_t completion_flags;   // Битовые флаги завершения decks (join волны)
+    volatile uint32_t wave_steps;         // Шаги текущей волны (параллельные ветки)
+    volatile uint32_t wave_decks;         // Decks текущей волны: волна завершена, когда
+                                          // completion_flags покрывает wave_decks
+    uint32_t max_wave;                    // Максимум веток в одной волне (>1 = fan-out)
     volatile uint32_t state;              // Состояние обработки
     volatile uint32_t abort_flag;         // Флаг прерывания (например, при отказе Security)
     uint32_t error_code;                  // Код ошибки
+
+    // Out-of-line результат (payload arena), если deck его создал
+    uint32_t payload_offset;              // RESPONSE_PAYLOAD_NONE = нет payload
+    uint32_t payload_size;
+
+    // Coalescing: slot лидера (center/coalesce.h), ROUTING_COALESCE_NONE = не лидер
+    uint32_t coalesce_slot;
+
+    // Цепочка (center/chain.h), ROUTING_CHAIN_NONE = одиночное событие.
+    // event_id entry - ID первого звена, event_copy - текущее звено
+    uint32_t chain_slot;
+
+    // Положение в routing pool (chunk * 64 + bit) и поколение slot'а -
+    // из них строится RoutingHandle. Ставит pool, routing_entry_init не трогает
+    uint32_t pool_slot;
+    volatile uint32_t generation;
+
+    // Кто сейчас работает с entry (routing_pool.h, HOLD). Как и deadline,
+    // routing_entry_init не трогает: звено цепочки перевзводит держатель
+    volatile uint64_t hold;
 } RoutingEntry;
 
 // ============================================================================
@@ -181,11 +359,13 @@ static inline void response_init(Response* r, uint64_t event_id, EventStatus sta
     r->status = status;
     r->error_code = 0;
     r->result_size = 0;
+    r->payload_offset = RESPONSE_PAYLOAD_NONE;
     r->timestamp = 0;
 
-    // Очищаем результат
-    for (int i = 0; i < RESPONSE_DATA_SIZE; i++) {
-        r->result[i] = 0;
+    // Очищаем inline результат (4 x 8 байт)
+    uint64_t* inline_result = (uint64_t*)r->result;
+    for (int i = 0; i < RESPONSE_INLINE_SIZE / 8; i++) {
+        inline_result[i] = 0;
     }
 }
 
@@ -201,14 +381,23 @@ static inline void routing_entry_init(RoutingEntry* entry, uint64_t event_id, Ev
 
     entry->current_index = 0;
     entry->completion_flags = 0;
+    entry->wave_steps = 0;
+    entry->wave_decks = 0;
+    entry->max_wave = 0;
     entry->state = EVENT_STATUS_PENDING;
     entry->created_at = 0;  // Будет установлен timestamp
+    entry->completed_at = 0;
     entry->abort_flag = 0;  // Нет ошибок
     entry->error_code = 0;
+    entry->payload_offset = RESPONSE_PAYLOAD_NONE;
+    entry->payload_size = 0;
+    entry->coalesce_slot = ROUTING_COALESCE_NONE;
+    entry->chain_slot = ROUTING_CHAIN_NONE;
 
     // Очищаем префиксы и результаты
     for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
         entry->prefixes[i] = DECK_PREFIX_NONE;
+        entry->depends[i] = 0;
         entry->deck_results[i] = 0;
         entry->deck_timestamps[i] = 0;
     }
@@ -234,8 +423,27 @@ static inline uint8_t routing_entry_get_next_prefix(RoutingEntry* entry) {
     return DECK_PREFIX_NONE;
 }
 
+// Шаг deck'а в текущей волне (один deck - не больше одного шага в волне),
+// -1 если такого нет
+static inline int routing_entry_wave_step(RoutingEntry* entry, uint8_t prefix) {
+    for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
+        if ((entry->wave_steps & (1u << i)) && entry->prefixes[i] == prefix) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 // Затирает префикс (вызывается deck после завершения обработки)
 static inline void routing_entry_clear_prefix(RoutingEntry* entry, uint8_t prefix) {
+    // В route DAG deck может встречаться и в более поздних шагах -
+    // затираем именно шаг текущей волны
+    int step = routing_entry_wave_step(entry, prefix);
+    if (step >= 0) {
+        entry->prefixes[step] = DECK_PREFIX_NONE;
+        return;
+    }
+
     for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
         if (entry->prefixes[i] == prefix) {
             entry->prefixes[i] = DECK_PREFIX_NONE;
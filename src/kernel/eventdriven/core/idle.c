@@ -0,0 +1,94 @@
+#include "idle.h"
+#include "cpu.h"
+#include "lapic.h"
+#include "io.h"
+#include "klib.h"
+
+IdleWaiter* idle_stage_waiters[EVENTDRIVEN_MAX_STAGES];
+
+static int idle_use_mwait = 0;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void idle_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    cpu_cpuid(0x00000001, 0, &eax, &ebx, &ecx, &edx);
+    idle_use_mwait = (ecx >> 3) & 1;  // MONITOR/MWAIT
+
+    kprintf("[IDLE] Sleep mode: %s\n",
+            idle_use_mwait ? "MONITOR/MWAIT" : "HLT + IPI doorbell");
+}
+
+// Вызывается на ядре-владельце (нужен его APIC ID для IPI)
+void idle_waiter_init(IdleWaiter* waiter) {
+    waiter->doorbell = 0;
+    waiter->sleeping = 0;
+    waiter->doorbells_sent = 0;
+    waiter->apic_id = lapic_id();
+}
+
+// ============================================================================
+// PRODUCER
+// ============================================================================
+
+void idle_wake(IdleWaiter* waiter) {
+    // Один doorbell на сон: будит тот, кто снял флаг
+    if (!atomic_cas_u32(&waiter->sleeping, 1, 0)) {
+        return;
+    }
+
+    atomic_increment_u64(&waiter->doorbell);  // Будит MWAIT
+    if (!idle_use_mwait) {
+        lapic_send_fixed(waiter->apic_id, IDLE_DOORBELL_VECTOR);
+    }
+    atomic_increment_u64(&waiter->doorbells_sent);
+}
+
+// ============================================================================
+// CONSUMER
+// ============================================================================
+
+void idle_prepare(IdleWaiter* waiter) {
+    if (idle_use_mwait) {
+        // Line взводится ДО флага: doorbell после этого точно разбудит mwait
+        __asm__ volatile("monitor" : : "a"(&waiter->doorbell), "c"(0), "d"(0));
+    }
+    atomic_store_u32(&waiter->sleeping, 1);
+    MEMORY_BARRIER();
+}
+
+uint64_t idle_sleep(IdleWaiter* waiter, int* notified) {
+    uint64_t start = rdtsc();
+
+    // sleeping == 0: producer уже позвонил между prepare и sleep
+    if (atomic_load_u32(&waiter->sleeping)) {
+        if (idle_use_mwait) {
+            __asm__ volatile("mwait" : : "a"(0), "c"(0) : "memory");
+        } else {
+            // sti откладывает прерывание на одну инструкцию - IPI,
+            // пришедший до hlt, разбудит именно hlt
+            __asm__ volatile("sti\n\thlt\n\tcli" : : : "memory");
+        }
+    }
+
+    // Флаг снимает idle_wake: если он ещё стоит, разбудило другое прерывание
+    *notified = !atomic_cas_u32(&waiter->sleeping, 1, 0);
+    return rdtsc() - start;
+}
+
+void idle_cancel(IdleWaiter* waiter) {
+    atomic_store_u32(&waiter->sleeping, 0);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void idle_print_stats(const char* name, IdleStats* stats) {
+    uint64_t total = rdtsc() - stats->start_tsc;
+    kprintf("[IDLE:%s] sleeps=%lu wakeups=%lu residency=%lu%%\n",
+            name, stats->sleeps, stats->wakeups,
+            total ? stats->idle_cycles * 100 / total : 0);
+}
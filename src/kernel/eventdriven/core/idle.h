@@ -0,0 +1,80 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "ktypes.h"
+#include "atomics.h"
+
+// ============================================================================
+// ADAPTIVE IDLE - для polling стадий pipeline на AP ядрах
+// ============================================================================
+//
+// Пустой проход стадии: spin с pause до IDLE_SPIN_CYCLES, затем сон:
+//   - MONITOR/MWAIT на doorbell line ядра (если CPUID.1:ECX.MONITOR)
+//   - иначе sti; hlt, будит IPI на IDLE_DOORBELL_VECTOR
+//
+// Producer после публикации работы вызывает idle_notify(stage): пока
+// consumer не объявил sleeping, это один load. Doorbell (запись в line и,
+// для HLT, IPI) отправляется только спящему ядру.
+//
+// Порядок (Dekker, mfence с обеих сторон):
+//   consumer: monitor; sleeping = 1; mfence; ещё проход; mwait/hlt
+//   producer: publish; mfence; if (sleeping) doorbell
+//
+// ============================================================================
+
+// Id стадий pipeline (индекс в idle_stage_waiters)
+#define EVENTDRIVEN_STAGE_RECEIVER      0
+#define EVENTDRIVEN_STAGE_CENTER        1
+#define EVENTDRIVEN_STAGE_GUIDE         2
+#define EVENTDRIVEN_STAGE_EXECUTION     3
+#define EVENTDRIVEN_STAGE_DECK_WORKERS  4   // + (prefix - 1) * DECK_MAX_WORKERS + worker
+#define EVENTDRIVEN_MAX_STAGES          20
+
+#define IDLE_SPIN_CYCLES        200000  // ~50-100us spin до сна (TSC cycles)
+#define IDLE_DOORBELL_VECTOR    48      // = IPI_DOORBELL (idt.h), сразу после PIC IRQ
+
+// Ожидающее ядро (одно на AP, общее для всех его стадий)
+typedef struct {
+    volatile uint64_t doorbell;         // Monitored line
+    volatile uint32_t sleeping;
+    uint32_t apic_id;
+    volatile uint64_t doorbells_sent;
+} __attribute__((aligned(64))) IdleWaiter;
+
+typedef struct {
+    volatile uint64_t sleeps;
+    volatile uint64_t wakeups;          // Сон прерван doorbell'ом (idle_notify / tick)
+    volatile uint64_t idle_cycles;      // Residency: TSC cycles во сне
+    volatile uint64_t start_tsc;
+} IdleStats;
+
+// Ядро каждой стадии (0 = синхронный режим, будить некого)
+extern IdleWaiter* idle_stage_waiters[EVENTDRIVEN_MAX_STAGES];
+
+void idle_init(void);
+void idle_waiter_init(IdleWaiter* waiter);
+void idle_wake(IdleWaiter* waiter);
+
+// Consumer: объявить сон (после этого - ещё один проход по очередям)
+void idle_prepare(IdleWaiter* waiter);
+// Consumer: очереди пусты - спать до doorbell. Возвращает cycles во сне;
+// *notified = 1, если разбудил doorbell (а не другое прерывание)
+uint64_t idle_sleep(IdleWaiter* waiter, int* notified);
+// Consumer: работа нашлась при повторном проходе
+void idle_cancel(IdleWaiter* waiter);
+
+void idle_print_stats(const char* name, IdleStats* stats);
+
+// Producer: работа для stage опубликована
+static inline void idle_notify(uint32_t stage) {
+    IdleWaiter* waiter = idle_stage_waiters[stage];
+    if (!waiter) {
+        return;
+    }
+    MEMORY_BARRIER();
+    if (waiter->sleeping) {
+        idle_wake(waiter);
+    }
+}
+
+#endif // IDLE_H
@@ -0,0 +1,179 @@
+#include "latency.h"
+#include "../decks/deck_interface.h"
+#include "pmm.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+static LatencyShard* latency_shards[EVENTDRIVEN_MAX_STAGES];
+static spinlock_t latency_alloc_lock;
+
+#define LATENCY_PAGES (((sizeof(LatencyShard)) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+// ============================================================================
+// SHARDS
+// ============================================================================
+
+LatencyShard* latency_shard(uint32_t writer) {
+    if (writer >= EVENTDRIVEN_MAX_STAGES) {
+        return 0;
+    }
+
+    LatencyShard* shard = latency_shards[writer];
+    if (shard) {
+        return shard;
+    }
+
+    // Первая запись писателя - выделяем (lock только на этот редкий путь)
+    spin_lock(&latency_alloc_lock);
+    shard = latency_shards[writer];
+    if (!shard) {
+        shard = (LatencyShard*)pmm_alloc_zero(LATENCY_PAGES);
+        latency_shards[writer] = shard;
+    }
+    spin_unlock(&latency_alloc_lock);
+    return shard;
+}
+
+void latency_reset(void) {
+    for (uint32_t writer = 0; writer < EVENTDRIVEN_MAX_STAGES; writer++) {
+        if (latency_shards[writer]) {
+            memset(latency_shards[writer], 0, sizeof(LatencyShard));
+        }
+    }
+}
+
+// ============================================================================
+// MERGE
+// ============================================================================
+
+static void latency_merge(LatencyHistogram* out, uint32_t writer, uint32_t type, uint32_t slot) {
+    LatencyShard* shard = latency_shards[writer];
+    if (!shard) {
+        return;
+    }
+
+    LatencyHistogram* hist = &shard->hist[type][slot];
+    if (hist->count == 0) {
+        return;
+    }
+
+    for (uint32_t b = 0; b < LATENCY_BUCKETS; b++) {
+        out->buckets[b] += hist->buckets[b];
+    }
+    out->count += hist->count;
+    out->total += hist->total;
+    if (hist->max > out->max) {
+        out->max = hist->max;
+    }
+}
+
+// Стадия = слот одного писателя (Center, Execution) или всех workers deck'а
+static void latency_collect_into(LatencyHistogram* out, uint32_t type, uint32_t stage) {
+    if (stage == LATENCY_STAGE_RECEIVER_WAIT || stage == LATENCY_STAGE_CENTER) {
+        latency_merge(out, EVENTDRIVEN_STAGE_CENTER, type, stage - LATENCY_STAGE_RECEIVER_WAIT);
+        return;
+    }
+    if (stage == LATENCY_STAGE_EXECUTION || stage == LATENCY_STAGE_END_TO_END) {
+        latency_merge(out, EVENTDRIVEN_STAGE_EXECUTION, type, stage - LATENCY_STAGE_EXECUTION);
+        return;
+    }
+
+    uint32_t slot = stage >= LATENCY_STAGE_SERVICE ? LATENCY_SLOT_SECOND : LATENCY_SLOT_FIRST;
+    uint32_t deck = stage - (slot ? LATENCY_STAGE_SERVICE : LATENCY_STAGE_QUEUE);
+    for (uint32_t w = 0; w < DECK_MAX_WORKERS; w++) {
+        latency_merge(out, EVENTDRIVEN_STAGE_DECK_WORKERS + deck * DECK_MAX_WORKERS + w, type, slot);
+    }
+}
+
+void latency_collect(LatencyHistogram* out, uint32_t type, uint32_t stage) {
+    memset(out, 0, sizeof(*out));
+    latency_collect_into(out, type, stage);
+}
+
+void latency_collect_all(LatencyHistogram* out, uint32_t stage) {
+    memset(out, 0, sizeof(*out));
+    for (uint32_t type = 0; type < LATENCY_MAX_TYPES; type++) {
+        latency_collect_into(out, type, stage);
+    }
+}
+
+// Верхняя граница bucket'а (последний bucket открыт - его закрывает max)
+static uint64_t latency_bucket_limit(uint32_t bucket) {
+    if (bucket == 0) {
+        return (1ULL << LATENCY_MIN_SHIFT) - 1;
+    }
+
+    uint32_t msb = LATENCY_MIN_SHIFT + ((bucket - 1) >> LATENCY_SUB_BITS);
+    uint64_t sub = (bucket - 1) & ((1u << LATENCY_SUB_BITS) - 1);
+    uint64_t step = 1ULL << (msb - LATENCY_SUB_BITS);
+    return (1ULL << msb) + (sub + 1) * step - 1;
+}
+
+uint64_t latency_percentile(const LatencyHistogram* hist, uint32_t percent) {
+    uint64_t rank = (hist->count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for (uint32_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            uint64_t limit = latency_bucket_limit(b);
+            return (b == LATENCY_BUCKETS - 1 || limit > hist->max) ? hist->max : limit;
+        }
+    }
+    return hist->max;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+const char* latency_stage_name(uint32_t stage) {
+    static const char* names[LATENCY_STAGE_COUNT] = {
+        "receiver-wait", "center",
+        "queue:ops", "queue:storage", "queue:hardware", "queue:network",
+        "service:ops", "service:storage", "service:hardware", "service:network",
+        "execution", "end-to-end",
+    };
+    return stage < LATENCY_STAGE_COUNT ? names[stage] : "?";
+}
+
+void latency_print(void) {
+    uint32_t printed = 0;
+    LatencyHistogram hist;
+
+    kprintf("[LATENCY] Cycles per stage: count p50 p90 p99 max\n");
+
+    for (uint32_t type = 0; type < LATENCY_MAX_TYPES; type++) {
+        int header = 0;
+
+        for (uint32_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+            latency_collect(&hist, type, stage);
+            if (hist.count == 0) {
+                continue;
+            }
+
+            if (!header) {
+                if (type == 0) {
+                    kprintf("[LATENCY] type other:\n");
+                } else {
+                    kprintf("[LATENCY] type %u:\n", type);
+                }
+                header = 1;
+            }
+
+            kprintf("[LATENCY]   %-16s %8lu %10lu %10lu %10lu %10lu\n",
+                    latency_stage_name(stage), hist.count,
+                    latency_percentile(&hist, 50), latency_percentile(&hist, 90),
+                    latency_percentile(&hist, 99), hist.max);
+        }
+
+        printed += header;
+    }
+
+    if (!printed) {
+        kprintf("[LATENCY] No samples yet\n");
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "ktypes.h"
+#include "events.h"
+#include "idle.h"
+
+// ============================================================================
+// LATENCY HISTOGRAMS - латентность стадий pipeline по каждому EventType
+// ============================================================================
+//
+// Стадии (TSC cycles):
+//   RECEIVER_WAIT  Receiver timestamp -> Center забрал burst
+//   CENTER         Center забрал burst -> entry создана (security, route)
+//   QUEUE[deck]    Guide отдал entry в deck -> worker начал handler
+//   SERVICE[deck]  handler deck'а
+//   EXECUTION      Guide отдал entry в Execution -> Response в ring
+//   END_TO_END     Receiver timestamp -> Response в ring
+//
+// Histogram - log-buckets в стиле HDR: 2 sub-bucket на степень двойки
+// (точность ~25%), всё, что короче 2^LATENCY_MIN_SHIFT, - в bucket 0.
+//
+// Писатель - стадия pipeline (EVENTDRIVEN_STAGE_*: Center, Execution,
+// каждый deck worker). Стадия крутится на одном ядре, так что shard пишет
+// только оно - без atomics и без общих cache lines. Каждый писатель
+// заполняет две свои стадии (LATENCY_SLOT_*), shell сливает shards при
+// печати. Shard выделяется из PMM при первой записи.
+//
+// ============================================================================
+
+#define LATENCY_MIN_SHIFT       4
+#define LATENCY_SUB_BITS        1
+#define LATENCY_BUCKETS         64
+#define LATENCY_MAX_TYPES       72      // EventType выше - в строку 0 ("other")
+
+_Static_assert(EVENT_SYS_PROBE < LATENCY_MAX_TYPES, "latency table must cover every event type");
+
+typedef enum {
+    LATENCY_STAGE_RECEIVER_WAIT = 0,
+    LATENCY_STAGE_CENTER,
+    LATENCY_STAGE_QUEUE,                // + (deck prefix - 1)
+    LATENCY_STAGE_SERVICE = LATENCY_STAGE_QUEUE + 4,
+    LATENCY_STAGE_EXECUTION = LATENCY_STAGE_SERVICE + 4,
+    LATENCY_STAGE_END_TO_END,
+    LATENCY_STAGE_COUNT
+} LatencyStage;
+
+// Две стадии каждого писателя
+#define LATENCY_SLOT_FIRST      0       // RECEIVER_WAIT / QUEUE / EXECUTION
+#define LATENCY_SLOT_SECOND     1       // CENTER / SERVICE / END_TO_END
+
+typedef struct {
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t total;                     // Сумма - для среднего
+    uint64_t max;
+} LatencyHistogram;
+
+typedef struct {
+    LatencyHistogram hist[LATENCY_MAX_TYPES][2];
+} LatencyShard;
+
+// Shard писателя (EVENTDRIVEN_STAGE_*), 0 = нет памяти. Брать раз на burst
+LatencyShard* latency_shard(uint32_t writer);
+
+static inline uint32_t latency_bucket(uint64_t cycles) {
+    if (cycles < (1ULL << LATENCY_MIN_SHIFT)) {
+        return 0;
+    }
+
+    uint32_t msb = 63 - __builtin_clzll(cycles);
+    uint32_t sub = (uint32_t)(cycles >> (msb - LATENCY_SUB_BITS)) & ((1u << LATENCY_SUB_BITS) - 1);
+    uint32_t bucket = ((msb - LATENCY_MIN_SHIFT) << LATENCY_SUB_BITS) + sub + 1;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static inline void latency_record(LatencyShard* shard, uint32_t type, uint32_t slot, uint64_t cycles) {
+    if (!shard) {
+        return;
+    }
+    if (type >= LATENCY_MAX_TYPES) {
+        type = 0;
+    }
+
+    LatencyHistogram* hist = &shard->hist[type][slot];
+    hist->buckets[latency_bucket(cycles)]++;
+    hist->count++;
+    hist->total += cycles;
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+}
+
+const char* latency_stage_name(uint32_t stage);
+
+// Слить shards стадии по одному типу / по всем типам
+void latency_collect(LatencyHistogram* out, uint32_t type, uint32_t stage);
+void latency_collect_all(LatencyHistogram* out, uint32_t stage);
+
+// Верхняя граница bucket'а, где лежит percent% значений (не больше max)
+uint64_t latency_percentile(const LatencyHistogram* hist, uint32_t percent);
+
+// p50/p90/p99/max по каждому типу и стадии (все shards)
+void latency_print(void);
+
+// Обнулить все shards (записи, идущие в этот момент, могут уцелеть)
+void latency_reset(void);
+
+#endif // LATENCY_H
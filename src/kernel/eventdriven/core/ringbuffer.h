@@ -7,7 +7,22 @@
 
 // ============================================================================
 // RING BUFFER - Lock-free SPSC (Single Producer Single Consumer)
+//               + bounded MPMC вариант (Vyukov, per-slot sequence counters)
 // ============================================================================
+//
+// Каждый ring выбирает режим при инициализации (event_ring_init_mode):
+//   RING_MODE_SPSC - один producer, один consumer. Самый быстрый путь:
+//                    head/tail двигаются простым store, без lock-префикса.
+//   RING_MODE_MPMC - любое число producers/consumers. Позиция захватывается
+//                    CAS на tail/head, готовность слота определяется его
+//                    sequence counter'ом:
+//                      seq == pos       -> слот свободен, можно писать
+//                      seq == pos + 1   -> слот заполнен, можно читать
+//                      seq == pos + SIZE -> слот освобождён для следующего круга
+//
+// event_ring_push/pop (и response_*) диспатчат по ring->mode, поэтому
+// вызывающему коду не нужно знать, какой режим выбран. Явные варианты
+// _spsc/_mpmc доступны для горячих путей, где режим известен заранее.
 
 // Размер буфера - ДОЛЖЕН быть степенью 2 для быстрого % через &
 // Уменьшено до 256 для экономии памяти (от 18MB до ~1.2MB)
@@ -18,6 +33,19 @@
 _Static_assert((RING_BUFFER_SIZE & (RING_BUFFER_SIZE - 1)) == 0,
                "RING_BUFFER_SIZE must be power of 2");
 
+// Режимы ring buffer
+#define RING_MODE_SPSC  0
+#define RING_MODE_MPMC  1
+
+// Копирование слотов по 8 байт (Event и Response кратны 8)
+static inline void ring_copy_qwords(void* dst, const void* src, uint64_t size) {
+    const uint64_t* s = (const uint64_t*)src;
+    uint64_t* d = (uint64_t*)dst;
+    for (uint64_t i = 0; i < size / 8; i++) {
+        d[i] = s[i];
+    }
+}
+
 // ============================================================================
 // EVENT RING BUFFER - Для передачи Event структур
 // ============================================================================
@@ -27,6 +55,11 @@ typedef struct {
     volatile uint64_t head __attribute__((aligned(64)));  // Consumer index
     volatile uint64_t tail __attribute__((aligned(64)));  // Producer index
 
+    // Режим (read-mostly, отдельная cache line) + sequence counters для MPMC
+    uint32_t mode __attribute__((aligned(64)));
+    uint64_t id_base;       // SQ: event_id_make(ring id, 0) - ID по позиции слота
+    volatile uint64_t seq[RING_BUFFER_SIZE] __attribute__((aligned(64)));
+
     // Буфер событий
     Event events[RING_BUFFER_SIZE] __attribute__((aligned(64)));
 } EventRingBuffer;
@@ -39,20 +72,120 @@ typedef struct {
     volatile uint64_t head __attribute__((aligned(64)));
     volatile uint64_t tail __attribute__((aligned(64)));
 
+    // MPMC: все позиции ниже freed прочитаны и освобождены (head лишь
+    // захвачен - consumer может ещё копировать). Для admission по кредитам
+    volatile uint64_t freed __attribute__((aligned(64)));
+
+    uint32_t mode __attribute__((aligned(64)));
+    volatile uint64_t seq[RING_BUFFER_SIZE] __attribute__((aligned(64)));
+
     Response responses[RING_BUFFER_SIZE] __attribute__((aligned(64)));
 } ResponseRingBuffer;
 
+
+// ============================================================================
+// MPMC CORE - захват позиции по sequence counter'ам
+// ============================================================================
+//
+// Общий код для Event/Response rings и DeckQueue (guide.h).
+// size - размер очереди (степень 2), подставляется константой при inline.
+
+// Захватить позицию для записи. Возвращает 1 и позицию в *out_pos,
+// или 0 если ring полон. После записи слота вызвать ring_mpmc_publish().
+static inline int ring_mpmc_claim_push(volatile uint64_t* tail, volatile uint64_t* seq,
+                                       uint64_t size, uint64_t* out_pos) {
+    uint64_t pos = atomic_load_u64(tail);
+
+    for (;;) {
+        uint64_t slot_seq = atomic_load_u64(&seq[pos & (size - 1)]);
+        int64_t dif = (int64_t)(slot_seq - pos);
+
+        if (dif == 0) {
+            // Слот свободен - пытаемся забрать позицию
+            uint64_t prev = atomic_cas_u64_val(tail, pos, pos + 1);
+            if (prev == pos) {
+                *out_pos = pos;
+                return 1;
+            }
+            pos = prev;  // Другой producer успел раньше
+        } else if (dif < 0) {
+            return 0;    // Слот ещё не прочитан с прошлого круга - полон
+        } else {
+            pos = atomic_load_u64(tail);
+        }
+    }
+}
+
+// Захватить позицию для чтения. Возвращает 1 и позицию в *out_pos,
+// или 0 если ring пуст. После чтения слота вызвать ring_mpmc_release().
+static inline int ring_mpmc_claim_pop(volatile uint64_t* head, volatile uint64_t* seq,
+                                      uint64_t size, uint64_t* out_pos) {
+    uint64_t pos = atomic_load_u64(head);
+
+    for (;;) {
+        uint64_t slot_seq = atomic_load_u64(&seq[pos & (size - 1)]);
+        int64_t dif = (int64_t)(slot_seq - (pos + 1));
+
+        if (dif == 0) {
+            uint64_t prev = atomic_cas_u64_val(head, pos, pos + 1);
+            if (prev == pos) {
+                *out_pos = pos;
+                return 1;
+            }
+            pos = prev;
+        } else if (dif < 0) {
+            return 0;    // Producer ещё не опубликовал слот - пусто
+        } else {
+            pos = atomic_load_u64(head);
+        }
+    }
+}
+
+// Слот записан - делаем его видимым для consumers
+static inline void ring_mpmc_publish(volatile uint64_t* seq, uint64_t size, uint64_t pos) {
+    COMPILER_BARRIER();  // x86 TSO: store данных не переупорядочится после store seq
+    atomic_store_u64(&seq[pos & (size - 1)], pos + 1);
+}
+
+// Слот прочитан - отдаём его producers следующего круга
+static inline void ring_mpmc_release(volatile uint64_t* seq, uint64_t size, uint64_t pos) {
+    COMPILER_BARRIER();
+    atomic_store_u64(&seq[pos & (size - 1)], pos + size);
+}
+
+static inline void ring_mpmc_init_seq(volatile uint64_t* seq, uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) {
+        atomic_store_u64(&seq[i], i);
+    }
+}
+
 // ============================================================================
 // EVENT RING BUFFER OPERATIONS
 // ============================================================================
 
-// Инициализация
-static inline void event_ring_init(EventRingBuffer* ring) {
+// Инициализация с выбором режима (RING_MODE_SPSC / RING_MODE_MPMC)
+static inline void event_ring_init_mode(EventRingBuffer* ring, uint32_t mode) {
     atomic_store_u64(&ring->head, 0);
     atomic_store_u64(&ring->tail, 0);
+    ring->mode = mode;
+    if (mode == RING_MODE_MPMC) {
+        ring_mpmc_init_seq(ring->seq, RING_BUFFER_SIZE);
+    }
+}
+
+// Инициализация (по умолчанию SPSC)
+static inline void event_ring_init(EventRingBuffer* ring) {
+    event_ring_init_mode(ring, RING_MODE_SPSC);
+}
+
+// ID, который Receiver назначит событию из слота pos (events.h): submitter
+// узнаёт его сразу после reserve, не дожидаясь Receiver
+static inline uint64_t event_ring_event_id(EventRingBuffer* ring, uint64_t pos) {
+    return ring->id_base | (pos & EVENT_ID_SEQ_MASK);
 }
 
 // Получить количество доступных событий для чтения
+// (для MPMC - приблизительно: учитывает захваченные, но ещё не опубликованные слоты)
 static inline uint64_t event_ring_count(EventRingBuffer* ring) {
     uint64_t tail = atomic_load_u64(&ring->tail);
     uint64_t head = atomic_load_u64(&ring->head);
@@ -77,8 +210,8 @@ static inline int event_ring_is_full(EventRingBuffer* ring) {
 // PRODUCER OPERATIONS (USER SPACE)
 // ============================================================================
 
-// Push event в ring buffer (возвращает 1 если успех, 0 если буфер полон)
-static inline int event_ring_push(EventRingBuffer* ring, Event* event) {
+// SPSC push (возвращает 1 если успех, 0 если буфер полон)
+static inline int event_ring_push_spsc(EventRingBuffer* ring, Event* event) {
     uint64_t current_tail = atomic_load_u64(&ring->tail);
     uint64_t current_head = atomic_load_u64(&ring->head);
 
@@ -90,15 +223,8 @@ static inline int event_ring_push(EventRingBuffer* ring, Event* event) {
     // Вычисляем индекс через битовую маску (быстрее чем %)
     uint64_t index = current_tail & RING_BUFFER_MASK;
 
-    // Копируем событие в буфер
-    Event* slot = &ring->events[index];
-
-    // Копируем по 8 байт (оптимизация)
-    uint64_t* src = (uint64_t*)event;
-    uint64_t* dst = (uint64_t*)slot;
-    for (int i = 0; i < sizeof(Event) / 8; i++) {
-        dst[i] = src[i];
-    }
+    // Копируем событие в буфер (по 8 байт)
+    ring_copy_qwords(&ring->events[index], event, sizeof(Event));
 
     // Memory barrier для гарантии видимости записи
     COMPILER_BARRIER();
@@ -109,12 +235,33 @@ static inline int event_ring_push(EventRingBuffer* ring, Event* event) {
     return 1;  // Успех
 }
 
+// MPMC push - безопасен для любого числа producers
+static inline int event_ring_push_mpmc(EventRingBuffer* ring, Event* event) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_push(&ring->tail, ring->seq, RING_BUFFER_SIZE, &pos)) {
+        return 0;  // Буфер полон
+    }
+
+    ring_copy_qwords(&ring->events[pos & RING_BUFFER_MASK], event, sizeof(Event));
+    ring_mpmc_publish(ring->seq, RING_BUFFER_SIZE, pos);
+
+    return 1;
+}
+
+// Push event в ring buffer (режим выбран при init)
+static inline int event_ring_push(EventRingBuffer* ring, Event* event) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return event_ring_push_mpmc(ring, event);
+    }
+    return event_ring_push_spsc(ring, event);
+}
+
 // ============================================================================
 // CONSUMER OPERATIONS (KERNEL SPACE)
 // ============================================================================
 
-// Pop event из ring buffer (возвращает 1 если успех, 0 если буфер пуст)
-static inline int event_ring_pop(EventRingBuffer* ring, Event* out_event) {
+// SPSC pop (возвращает 1 если успех, 0 если буфер пуст)
+static inline int event_ring_pop_spsc(EventRingBuffer* ring, Event* out_event) {
     uint64_t current_head = atomic_load_u64(&ring->head);
     uint64_t current_tail = atomic_load_u64(&ring->tail);
 
@@ -126,15 +273,8 @@ static inline int event_ring_pop(EventRingBuffer* ring, Event* out_event) {
     // Вычисляем индекс
     uint64_t index = current_head & RING_BUFFER_MASK;
 
-    // Копируем событие из буфера
-    Event* slot = &ring->events[index];
-
-    // Копируем по 8 байт
-    uint64_t* src = (uint64_t*)slot;
-    uint64_t* dst = (uint64_t*)out_event;
-    for (int i = 0; i < sizeof(Event) / 8; i++) {
-        dst[i] = src[i];
-    }
+    // Копируем событие из буфера (по 8 байт)
+    ring_copy_qwords(out_event, &ring->events[index], sizeof(Event));
 
     // Memory barrier
     COMPILER_BARRIER();
@@ -145,34 +285,148 @@ static inline int event_ring_pop(EventRingBuffer* ring, Event* out_event) {
     return 1;  // Успех
 }
 
+// MPMC pop - безопасен для любого числа consumers
+static inline int event_ring_pop_mpmc(EventRingBuffer* ring, Event* out_event) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_pop(&ring->head, ring->seq, RING_BUFFER_SIZE, &pos)) {
+        return 0;  // Буфер пуст
+    }
+
+    ring_copy_qwords(out_event, &ring->events[pos & RING_BUFFER_MASK], sizeof(Event));
+    ring_mpmc_release(ring->seq, RING_BUFFER_SIZE, pos);
+
+    return 1;
+}
+
+// Pop event из ring buffer (режим выбран при init)
+static inline int event_ring_pop(EventRingBuffer* ring, Event* out_event) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return event_ring_pop_mpmc(ring, out_event);
+    }
+    return event_ring_pop_spsc(ring, out_event);
+}
+
 // Peek event без удаления (для проверки)
+// NOTE: для MPMC результат - только подсказка, другой consumer может забрать слот
 static inline int event_ring_peek(EventRingBuffer* ring, Event* out_event) {
+    uint64_t current_head = atomic_load_u64(&ring->head);
+    uint64_t index = current_head & RING_BUFFER_MASK;
+
+    if (ring->mode == RING_MODE_MPMC) {
+        if (atomic_load_u64(&ring->seq[index]) != current_head + 1) {
+            return 0;
+        }
+    } else if (current_head == atomic_load_u64(&ring->tail)) {
+        return 0;
+    }
+
+    ring_copy_qwords(out_event, &ring->events[index], sizeof(Event));
+
+    return 1;
+}
+
+// ============================================================================
+// ZERO-COPY API - Построение/обработка событий прямо в слоте ring buffer
+// ============================================================================
+//
+// Producer:  slot = event_ring_reserve(ring, &pos); ...заполнить slot...;
+//            event_ring_commit(ring, pos);
+// Consumer:  slot = event_ring_peek_slot(ring, &pos); ...обработать slot...;
+//            event_ring_release(ring, pos);
+//
+// Между reserve и commit (peek_slot и release) слот принадлежит только
+// вызывающему. В SPSC режиме повторный reserve без commit вернёт тот же слот;
+// в MPMC позиция уже захвачена и ДОЛЖНА быть закоммичена (или отменена через
+// event_ring_cancel), иначе consumers остановятся на ней.
+
+// Зарезервировать слот для записи (0 если буфер полон)
+static inline Event* event_ring_reserve(EventRingBuffer* ring, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        if (!ring_mpmc_claim_push(&ring->tail, ring->seq, RING_BUFFER_SIZE, out_pos)) {
+            return 0;
+        }
+        return &ring->events[*out_pos & RING_BUFFER_MASK];
+    }
+
+    uint64_t current_tail = atomic_load_u64(&ring->tail);
+    uint64_t current_head = atomic_load_u64(&ring->head);
+
+    if ((current_tail - current_head) >= RING_BUFFER_SIZE) {
+        return 0;  // Буфер полон
+    }
+
+    *out_pos = current_tail;
+    return &ring->events[current_tail & RING_BUFFER_MASK];
+}
+
+// Опубликовать заполненный слот
+static inline void event_ring_commit(EventRingBuffer* ring, uint64_t pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        ring_mpmc_publish(ring->seq, RING_BUFFER_SIZE, pos);
+        return;
+    }
+
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->tail, pos + 1);
+}
+
+// Отказаться от зарезервированного слота.
+// SPSC: слот просто не публикуется. MPMC: позицию нельзя вернуть, поэтому
+// слот публикуется как пустышка (type = EVENT_NONE) - consumer её пропускает.
+static inline void event_ring_cancel(EventRingBuffer* ring, uint64_t pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        ring->events[pos & RING_BUFFER_MASK].type = EVENT_NONE;
+        ring_mpmc_publish(ring->seq, RING_BUFFER_SIZE, pos);
+    }
+}
+
+// Получить указатель на следующий слот для чтения (0 если буфер пуст)
+static inline Event* event_ring_peek_slot(EventRingBuffer* ring, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        if (!ring_mpmc_claim_pop(&ring->head, ring->seq, RING_BUFFER_SIZE, out_pos)) {
+            return 0;
+        }
+        return &ring->events[*out_pos & RING_BUFFER_MASK];
+    }
+
     uint64_t current_head = atomic_load_u64(&ring->head);
     uint64_t current_tail = atomic_load_u64(&ring->tail);
 
     if (current_head == current_tail) {
-        return 0;
+        return 0;  // Буфер пуст
     }
 
-    uint64_t index = current_head & RING_BUFFER_MASK;
-    Event* slot = &ring->events[index];
+    *out_pos = current_head;
+    return &ring->events[current_head & RING_BUFFER_MASK];
+}
 
-    uint64_t* src = (uint64_t*)slot;
-    uint64_t* dst = (uint64_t*)out_event;
-    for (int i = 0; i < sizeof(Event) / 8; i++) {
-        dst[i] = src[i];
+// Освободить прочитанный слот
+static inline void event_ring_release(EventRingBuffer* ring, uint64_t pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        ring_mpmc_release(ring->seq, RING_BUFFER_SIZE, pos);
+        return;
     }
 
-    return 1;
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->head, pos + 1);
 }
 
 // ============================================================================
 // RESPONSE RING BUFFER OPERATIONS (идентично, но для Response)
 // ============================================================================
 
-static inline void response_ring_init(ResponseRingBuffer* ring) {
+static inline void response_ring_init_mode(ResponseRingBuffer* ring, uint32_t mode) {
     atomic_store_u64(&ring->head, 0);
     atomic_store_u64(&ring->tail, 0);
+    atomic_store_u64(&ring->freed, 0);
+    ring->mode = mode;
+    if (mode == RING_MODE_MPMC) {
+        ring_mpmc_init_seq(ring->seq, RING_BUFFER_SIZE);
+    }
+}
+
+static inline void response_ring_init(ResponseRingBuffer* ring) {
+    response_ring_init_mode(ring, RING_MODE_SPSC);
 }
 
 static inline int response_ring_is_empty(ResponseRingBuffer* ring) {
@@ -181,6 +435,39 @@ static inline int response_ring_is_empty(ResponseRingBuffer* ring) {
     return head == tail;
 }
 
+// Ответов в ring (для MPMC - приблизительно, как event_ring_count)
+static inline uint64_t response_ring_count(ResponseRingBuffer* ring) {
+    uint64_t tail = atomic_load_u64(&ring->tail);
+    uint64_t head = atomic_load_u64(&ring->head);
+    return tail - head;
+}
+
+// Занятые слоты с точки зрения producer'а: MPMC считает и слоты, которые
+// consumer захватил, но ещё не освободил (ответ в них пока не положить)
+static inline uint64_t response_ring_used(ResponseRingBuffer* ring) {
+    uint64_t tail = atomic_load_u64(&ring->tail);
+    if (ring->mode == RING_MODE_MPMC) {
+        return tail - atomic_load_u64(&ring->freed);
+    }
+    return tail - atomic_load_u64(&ring->head);
+}
+
+// MPMC: освободить слот и продвинуть freed через освобождённые подряд
+// позиции. Consumer, освободивший слот последним, доводит freed до конца
+// серии; seq только растёт, поэтому >= - слот мог уже взять producer
+static inline void response_ring_mpmc_release(ResponseRingBuffer* ring, uint64_t pos) {
+    ring_mpmc_release(ring->seq, RING_BUFFER_SIZE, pos);
+
+    for (;;) {
+        uint64_t freed = atomic_load_u64(&ring->freed);
+        uint64_t slot_seq = atomic_load_u64(&ring->seq[freed & RING_BUFFER_MASK]);
+        if ((int64_t)(slot_seq - (freed + RING_BUFFER_SIZE)) < 0) {
+            return;  // Следующий слот ещё читают (или ещё не прочитан)
+        }
+        atomic_cas_u64(&ring->freed, freed, freed + 1);
+    }
+}
+
 static inline int response_ring_is_full(ResponseRingBuffer* ring) {
     uint64_t tail = atomic_load_u64(&ring->tail);
     uint64_t head = atomic_load_u64(&ring->head);
@@ -188,7 +475,7 @@ static inline int response_ring_is_full(ResponseRingBuffer* ring) {
 }
 
 // KERNEL pushes responses
-static inline int response_ring_push(ResponseRingBuffer* ring, Response* response) {
+static inline int response_ring_push_spsc(ResponseRingBuffer* ring, Response* response) {
     uint64_t current_tail = atomic_load_u64(&ring->tail);
     uint64_t current_head = atomic_load_u64(&ring->head);
 
@@ -197,14 +484,7 @@ static inline int response_ring_push(ResponseRingBuffer* ring, Response* respons
     }
 
     uint64_t index = current_tail & RING_BUFFER_MASK;
-    Response* slot = &ring->responses[index];
-
-    // Копируем по 8 байт
-    uint64_t* src = (uint64_t*)response;
-    uint64_t* dst = (uint64_t*)slot;
-    for (int i = 0; i < sizeof(Response) / 8; i++) {
-        dst[i] = src[i];
-    }
+    ring_copy_qwords(&ring->responses[index], response, sizeof(Response));
 
     COMPILER_BARRIER();
     atomic_store_u64(&ring->tail, current_tail + 1);
@@ -212,8 +492,27 @@ static inline int response_ring_push(ResponseRingBuffer* ring, Response* respons
     return 1;
 }
 
+static inline int response_ring_push_mpmc(ResponseRingBuffer* ring, Response* response) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_push(&ring->tail, ring->seq, RING_BUFFER_SIZE, &pos)) {
+        return 0;
+    }
+
+    ring_copy_qwords(&ring->responses[pos & RING_BUFFER_MASK], response, sizeof(Response));
+    ring_mpmc_publish(ring->seq, RING_BUFFER_SIZE, pos);
+
+    return 1;
+}
+
+static inline int response_ring_push(ResponseRingBuffer* ring, Response* response) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return response_ring_push_mpmc(ring, response);
+    }
+    return response_ring_push_spsc(ring, response);
+}
+
 // USER pops responses
-static inline int response_ring_pop(ResponseRingBuffer* ring, Response* out_response) {
+static inline int response_ring_pop_spsc(ResponseRingBuffer* ring, Response* out_response) {
     uint64_t current_head = atomic_load_u64(&ring->head);
     uint64_t current_tail = atomic_load_u64(&ring->tail);
 
@@ -222,13 +521,7 @@ static inline int response_ring_pop(ResponseRingBuffer* ring, Response* out_resp
     }
 
     uint64_t index = current_head & RING_BUFFER_MASK;
-    Response* slot = &ring->responses[index];
-
-    uint64_t* src = (uint64_t*)slot;
-    uint64_t* dst = (uint64_t*)out_response;
-    for (int i = 0; i < sizeof(Response) / 8; i++) {
-        dst[i] = src[i];
-    }
+    ring_copy_qwords(out_response, &ring->responses[index], sizeof(Response));
 
     COMPILER_BARRIER();
     atomic_store_u64(&ring->head, current_head + 1);
@@ -236,32 +529,263 @@ static inline int response_ring_pop(ResponseRingBuffer* ring, Response* out_resp
     return 1;
 }
 
+static inline int response_ring_pop_mpmc(ResponseRingBuffer* ring, Response* out_response) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_pop(&ring->head, ring->seq, RING_BUFFER_SIZE, &pos)) {
+        return 0;
+    }
+
+    ring_copy_qwords(out_response, &ring->responses[pos & RING_BUFFER_MASK], sizeof(Response));
+    response_ring_mpmc_release(ring, pos);
+
+    return 1;
+}
+
+static inline int response_ring_pop(ResponseRingBuffer* ring, Response* out_response) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return response_ring_pop_mpmc(ring, out_response);
+    }
+    return response_ring_pop_spsc(ring, out_response);
+}
+
+// Zero-copy для Response (семантика как у event_ring_reserve/commit/...)
+static inline Response* response_ring_reserve(ResponseRingBuffer* ring, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        if (!ring_mpmc_claim_push(&ring->tail, ring->seq, RING_BUFFER_SIZE, out_pos)) {
+            return 0;
+        }
+        return &ring->responses[*out_pos & RING_BUFFER_MASK];
+    }
+
+    uint64_t current_tail = atomic_load_u64(&ring->tail);
+    uint64_t current_head = atomic_load_u64(&ring->head);
+
+    if ((current_tail - current_head) >= RING_BUFFER_SIZE) {
+        return 0;
+    }
+
+    *out_pos = current_tail;
+    return &ring->responses[current_tail & RING_BUFFER_MASK];
+}
+
+static inline void response_ring_commit(ResponseRingBuffer* ring, uint64_t pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        ring_mpmc_publish(ring->seq, RING_BUFFER_SIZE, pos);
+        return;
+    }
+
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->tail, pos + 1);
+}
+
+static inline Response* response_ring_peek_slot(ResponseRingBuffer* ring, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        if (!ring_mpmc_claim_pop(&ring->head, ring->seq, RING_BUFFER_SIZE, out_pos)) {
+            return 0;
+        }
+        return &ring->responses[*out_pos & RING_BUFFER_MASK];
+    }
+
+    uint64_t current_head = atomic_load_u64(&ring->head);
+    uint64_t current_tail = atomic_load_u64(&ring->tail);
+
+    if (current_head == current_tail) {
+        return 0;
+    }
+
+    *out_pos = current_head;
+    return &ring->responses[current_head & RING_BUFFER_MASK];
+}
+
+static inline void response_ring_release(ResponseRingBuffer* ring, uint64_t pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        response_ring_mpmc_release(ring, pos);
+        return;
+    }
+
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->head, pos + 1);
+}
+
 // ============================================================================
 // BATCH OPERATIONS - Для высокой пропускной способности
 // ============================================================================
 
+//
+// Capacity проверяется один раз, N слотов копируются, индекс публикуется
+// ОДНИМ store (SPSC) или ОДНИМ CAS (MPMC). Так cache line с head/tail
+// переходит между ядрами один раз на пачку, а не на каждый элемент.
+// В MPMC sequence counters по-прежнему пишутся для каждого слота - это
+// собственная cache line слота, её трогают только producer и consumer.
+
+// MPMC: захватить до max позиций для записи одним CAS на tail. Пачка -
+// только подряд идущие свободные слоты (seq == позиция): слот, который
+// consumer захватил, но ещё не дочитал, её обрывает, и после CAS ждать нечего
+static inline uint64_t ring_mpmc_claim_push_batch(volatile uint64_t* tail, volatile uint64_t* seq,
+                                                  uint64_t size, uint64_t max, uint64_t* out_pos) {
+    for (;;) {
+        uint64_t pos = atomic_load_u64(tail);
+
+        uint64_t n = 0;
+        while (n < max &&
+               atomic_load_u64(&seq[(pos + n) & (size - 1)]) == pos + n) {
+            n++;
+        }
+
+        if (n == 0) {
+            int64_t dif = (int64_t)(atomic_load_u64(&seq[pos & (size - 1)]) - pos);
+            if (dif < 0) {
+                return 0;  // Слот прошлого круга не освобождён - полон
+            }
+            cpu_pause();   // tail устарел - другой producer уже ушёл дальше
+            continue;
+        }
+
+        if (atomic_cas_u64(tail, pos, pos + n)) {
+            *out_pos = pos;
+            return n;
+        }
+    }
+}
+
+// MPMC: захватить до max опубликованных позиций для чтения одним CAS на head
+static inline uint64_t ring_mpmc_claim_pop_batch(volatile uint64_t* head, volatile uint64_t* seq,
+                                                 uint64_t size, uint64_t max, uint64_t* out_pos) {
+    for (;;) {
+        uint64_t pos = atomic_load_u64(head);
+
+        // Считаем подряд идущие опубликованные слоты
+        uint64_t n = 0;
+        while (n < max &&
+               atomic_load_u64(&seq[(pos + n) & (size - 1)]) == pos + n + 1) {
+            n++;
+        }
+        if (n == 0) {
+            return 0;  // Пусто
+        }
+
+        if (atomic_cas_u64(head, pos, pos + n)) {
+            *out_pos = pos;
+            return n;
+        }
+    }
+}
+
+// Слот по позиции (для обхода пачки, полученной reserve_batch/peek_batch)
+static inline Event* event_ring_slot(EventRingBuffer* ring, uint64_t pos) {
+    return &ring->events[pos & RING_BUFFER_MASK];
+}
+
+// Зарезервировать до max слотов подряд (возвращает количество, 0 если полон)
+static inline uint64_t event_ring_reserve_batch(EventRingBuffer* ring, uint64_t max, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return ring_mpmc_claim_push_batch(&ring->tail, ring->seq, RING_BUFFER_SIZE, max, out_pos);
+    }
+
+    uint64_t current_tail = atomic_load_u64(&ring->tail);
+    uint64_t free = RING_BUFFER_SIZE - (current_tail - atomic_load_u64(&ring->head));
+
+    *out_pos = current_tail;
+    return free < max ? free : max;
+}
+
+// Опубликовать n слотов начиная с pos.
+// SPSC: можно закоммитить меньше, чем зарезервировано. MPMC: n должно
+// совпадать с числом зарезервированных слотов (лишние - через type = EVENT_NONE).
+static inline void event_ring_commit_batch(EventRingBuffer* ring, uint64_t pos, uint64_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    if (ring->mode == RING_MODE_MPMC) {
+        COMPILER_BARRIER();
+        for (uint64_t i = 0; i < n; i++) {
+            atomic_store_u64(&ring->seq[(pos + i) & RING_BUFFER_MASK], pos + i + 1);
+        }
+        return;
+    }
+
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->tail, pos + n);
+}
+
+// Закоммитить первые used из reserved зарезервированных слотов.
+// SPSC: остаток просто не публикуется. MPMC: остаток публикуется как
+// пустышки (type = EVENT_NONE), как в event_ring_cancel.
+static inline void event_ring_commit_partial(EventRingBuffer* ring, uint64_t pos,
+                                             uint64_t used, uint64_t reserved) {
+    if (ring->mode == RING_MODE_MPMC) {
+        for (uint64_t i = used; i < reserved; i++) {
+            event_ring_slot(ring, pos + i)->type = EVENT_NONE;
+        }
+        used = reserved;
+    }
+    event_ring_commit_batch(ring, pos, used);
+}
+
+// Получить до max готовых слотов подряд для обработки на месте
+static inline uint64_t event_ring_peek_batch(EventRingBuffer* ring, uint64_t max, uint64_t* out_pos) {
+    if (ring->mode == RING_MODE_MPMC) {
+        return ring_mpmc_claim_pop_batch(&ring->head, ring->seq, RING_BUFFER_SIZE, max, out_pos);
+    }
+
+    uint64_t current_head = atomic_load_u64(&ring->head);
+    uint64_t avail = atomic_load_u64(&ring->tail) - current_head;
+
+    *out_pos = current_head;
+    return avail < max ? avail : max;
+}
+
+// Освободить n прочитанных слотов начиная с pos
+static inline void event_ring_release_batch(EventRingBuffer* ring, uint64_t pos, uint64_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    if (ring->mode == RING_MODE_MPMC) {
+        COMPILER_BARRIER();
+        for (uint64_t i = 0; i < n; i++) {
+            atomic_store_u64(&ring->seq[(pos + i) & RING_BUFFER_MASK], pos + i + RING_BUFFER_SIZE);
+        }
+        return;
+    }
+
+    COMPILER_BARRIER();
+    atomic_store_u64(&ring->head, pos + n);
+}
+
 // Batch push (возвращает количество успешно добавленных событий)
 static inline int event_ring_push_batch(EventRingBuffer* ring, Event* events, int count) {
-    int pushed = 0;
-    for (int i = 0; i < count; i++) {
-        if (!event_ring_push(ring, &events[i])) {
-            break;
-        }
-        pushed++;
+    if (count <= 0) {
+        return 0;
+    }
+
+    uint64_t pos;
+    uint64_t n = event_ring_reserve_batch(ring, (uint64_t)count, &pos);
+
+    for (uint64_t i = 0; i < n; i++) {
+        ring_copy_qwords(event_ring_slot(ring, pos + i), &events[i], sizeof(Event));
     }
-    return pushed;
+
+    event_ring_commit_batch(ring, pos, n);
+    return (int)n;
 }
 
 // Batch pop (возвращает количество успешно извлечённых событий)
 static inline int event_ring_pop_batch(EventRingBuffer* ring, Event* events, int max_count) {
-    int popped = 0;
-    for (int i = 0; i < max_count; i++) {
-        if (!event_ring_pop(ring, &events[i])) {
-            break;
-        }
-        popped++;
+    if (max_count <= 0) {
+        return 0;
     }
-    return popped;
+
+    uint64_t pos;
+    uint64_t n = event_ring_peek_batch(ring, (uint64_t)max_count, &pos);
+
+    for (uint64_t i = 0; i < n; i++) {
+        ring_copy_qwords(&events[i], event_ring_slot(ring, pos + i), sizeof(Event));
+    }
+
+    event_ring_release_batch(ring, pos, n);
+    return (int)n;
 }
 
 #endif // RINGBUFFER_H
@@ -0,0 +1,246 @@
+#include "task_rings.h"
+#include "user_buffers.h"
+#include "../center/chain.h"
+#include "credits.h"
+#include "idle.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+TaskRingSlot task_ring_slots[TASK_RINGS_MAX + 1];
+TaskRingsState task_rings_state;
+
+// Register/unregister редкие - достаточно одного lock. Receiver его не
+// берёт: ему хватает маски active
+static spinlock_t task_rings_lock;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void task_rings_init(void) {
+    spinlock_init(&task_rings_lock);
+    memset(task_ring_slots, 0, sizeof(task_ring_slots));
+    memset(&task_rings_state, 0, sizeof(task_rings_state));
+    for (uint32_t id = 1; id <= TASK_RINGS_MAX; id++) {
+        spinlock_init(&task_ring_slots[id].cq_lock);
+    }
+
+    kprintf("[TASK RINGS] Initialized (%u pairs, %lu pages each: SQ %s / CQ %s)\n",
+            TASK_RINGS_MAX, (uint64_t)TASK_RINGS_PAGES, "SPSC", "SPSC");
+}
+
+// ============================================================================
+// REGISTRATION
+// ============================================================================
+
+static void task_rings_clear_active(uint32_t ring_id) {
+    uint32_t bit = 1u << (ring_id - 1);
+    uint32_t mask = atomic_load_u32(&task_rings_state.active);
+    while (!atomic_cas_u32(&task_rings_state.active, mask, mask & ~bit)) {
+        mask = atomic_load_u32(&task_rings_state.active);
+    }
+}
+
+uint32_t task_rings_register(uint64_t task_id) {
+    if (task_id == 0) {
+        return TASK_RING_GLOBAL;
+    }
+
+    spin_lock(&task_rings_lock);
+
+    // Slot с in-flight событиями прошлого владельца ещё получает их ответы
+    uint32_t ring_id = TASK_RING_GLOBAL;
+    uint32_t draining = 0;
+    for (uint32_t id = 1; id <= TASK_RINGS_MAX; id++) {
+        if (task_ring_slots[id].task_id != 0) {
+            continue;
+        }
+        if (atomic_load_u64(&credit_rings[id].inflight) != 0) {
+            draining++;
+            continue;
+        }
+        ring_id = id;
+        break;
+    }
+
+    if (ring_id == TASK_RING_GLOBAL) {
+        spin_unlock(&task_rings_lock);
+        atomic_increment_u64(draining ? &task_rings_state.draining : &task_rings_state.full);
+        kprintf("[TASK RINGS] No free pair for task %lu (%u draining) - using global ring\n",
+                task_id, draining);
+        return TASK_RING_GLOBAL;
+    }
+
+    TaskRingSlot* slot = &task_ring_slots[ring_id];
+    if (!slot->rings) {
+        slot->rings = (TaskRingPair*)pmm_alloc_zero(TASK_RINGS_PAGES);
+        if (!slot->rings) {
+            spin_unlock(&task_rings_lock);
+            kprintf("[TASK RINGS] Out of memory for task %lu - using global ring\n", task_id);
+            return TASK_RING_GLOBAL;
+        }
+    }
+
+    // Повторно используемая пара: in-flight событий прошлого владельца
+    // нет, неразобранные им ответы сбрасываются вместе с индексами.
+    // SQ продолжает нумерацию slot'а (позиция = seq event ID) - ID не
+    // повторяются и после смены владельца
+    event_ring_init_mode(&slot->rings->sq, RING_MODE_SPSC);
+    slot->rings->sq.head = slot->events;
+    slot->rings->sq.tail = slot->events;
+    slot->rings->sq.id_base = event_id_make(ring_id, 0);
+    response_ring_init_mode(&slot->rings->cq, RING_MODE_SPSC);
+    slot->user_addr = 0;
+    slot->context = 0;
+    slot->cq_tail = 0;
+    slot->cq_broken = 0;
+    slot->cq_dropped = 0;
+    slot->task_id = task_id;
+
+    // Бит - последним: Receiver видит только готовую пару
+    atomic_fetch_or_u32(&task_rings_state.active, 1u << (ring_id - 1));
+    spin_unlock(&task_rings_lock);
+
+    atomic_increment_u64(&task_rings_state.registered);
+    return ring_id;
+}
+
+void task_rings_unregister(uint64_t task_id) {
+    uint32_t ring_id = task_rings_find(task_id);
+    if (ring_id == TASK_RING_GLOBAL) {
+        return;
+    }
+
+    spin_lock(&task_rings_lock);
+    task_rings_clear_active(ring_id);
+
+    // Проход Receiver, начатый до снятия бита, ещё может читать SQ,
+    // task_id владельца и писать BUSY в CQ - дожидаемся его конца (проход
+    // конечен: не больше burst'а событий). Вне прохода (счётчик чётный,
+    // в т.ч. синхронный режим на этом же ядре) ждать нечего
+    uint64_t pass = atomic_load_u64(&task_rings_state.passes);
+    while ((pass & 1) && atomic_load_u64(&task_rings_state.passes) == pass) {
+        cpu_pause();
+    }
+
+    task_ring_slots[ring_id].user_addr = 0;
+    task_ring_slots[ring_id].context = 0;
+    task_ring_slots[ring_id].task_id = 0;
+    spin_unlock(&task_rings_lock);
+
+    // Буферы задачи (core/user_buffers.h): её страницы больше не наши
+    user_buffers_release_ring(ring_id);
+
+    // Цепочки, которые задача начала и не завершила (center/chain.h), -
+    // иначе слот пула висит, а звенья следующего владельца пары прилипли бы к ним
+    chain_release_ring(ring_id);
+
+    atomic_increment_u64(&task_rings_state.unregistered);
+}
+
+uint32_t task_rings_find(uint64_t task_id) {
+    if (task_id == 0) {
+        return TASK_RING_GLOBAL;
+    }
+    for (uint32_t id = 1; id <= TASK_RINGS_MAX; id++) {
+        if (task_ring_slots[id].task_id == task_id) {
+            return id;
+        }
+    }
+    return TASK_RING_GLOBAL;
+}
+
+// ============================================================================
+// CQ PRODUCER - kernel tail, head задачи читается один раз
+// ============================================================================
+
+uint64_t task_rings_cq_count(uint32_t ring_id) {
+    TaskRingSlot* slot = &task_ring_slots[ring_id];
+    if (atomic_load_u32(&slot->cq_broken)) {
+        return RING_BUFFER_SIZE;
+    }
+    uint64_t used = atomic_load_u64(&slot->cq_tail) - atomic_load_u64(&slot->rings->cq.head);
+    return used < RING_BUFFER_SIZE ? used : RING_BUFFER_SIZE;
+}
+
+Response* task_rings_cq_reserve(uint32_t ring_id, uint64_t* out_pos) {
+    TaskRingSlot* slot = &task_ring_slots[ring_id];
+    spin_lock(&slot->cq_lock);
+
+    // head пишет задача: consumer не может обогнать tail ядра или отстать
+    // больше чем на ring
+    uint64_t tail = slot->cq_tail;
+    uint64_t used = tail - atomic_load_u64(&slot->rings->cq.head);
+    if (!slot->cq_broken && used > RING_BUFFER_SIZE) {
+        atomic_store_u32(&slot->cq_broken, 1);
+        kprintf("[TASK RINGS] ring %u: CQ head corrupted by task %lu - dropping responses\n",
+                ring_id, slot->task_id);
+    }
+    if (slot->cq_broken || used == RING_BUFFER_SIZE) {
+        spin_unlock(&slot->cq_lock);
+        atomic_increment_u64(&slot->cq_dropped);
+        return 0;
+    }
+
+    *out_pos = tail;
+    return &slot->rings->cq.responses[tail & RING_BUFFER_MASK];
+}
+
+void task_rings_cq_commit(uint32_t ring_id, uint64_t pos) {
+    TaskRingSlot* slot = &task_ring_slots[ring_id];
+    COMPILER_BARRIER();  // x86 TSO: слот виден задаче раньше tail
+    atomic_store_u64(&slot->rings->cq.tail, pos + 1);
+    slot->cq_tail = pos + 1;
+    spin_unlock(&slot->cq_lock);
+}
+
+uint64_t task_rings_pending(void) {
+    uint32_t active = atomic_load_u32(&task_rings_state.active);
+    uint64_t pending = 0;
+    for (uint32_t id = 1; id <= TASK_RINGS_MAX; id++) {
+        if (active & (1u << (id - 1))) {
+            pending += event_ring_count(&task_ring_slots[id].rings->sq);
+        }
+    }
+    return pending;
+}
+
+void task_rings_timer_tick(void) {
+    // Пока Receiver не спит, tick - одна загрузка
+    IdleWaiter* waiter = idle_stage_waiters[EVENTDRIVEN_STAGE_RECEIVER];
+    if (!waiter || !atomic_load_u32(&waiter->sleeping) ||
+        !atomic_load_u32(&task_rings_state.active)) {
+        return;
+    }
+    if (task_rings_pending()) {
+        atomic_increment_u64(&task_rings_state.timer_wakeups);
+        idle_wake(waiter);
+    }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void task_rings_print_stats(void) {
+    kprintf("[TASK RINGS] Stats: registered=%lu unregistered=%lu full=%lu draining=%lu "
+            "timer_wakeups=%lu active=0x%x\n",
+            task_rings_state.registered,
+            task_rings_state.unregistered,
+            task_rings_state.full,
+            task_rings_state.draining,
+            task_rings_state.timer_wakeups,
+            task_rings_state.active);
+
+    for (uint32_t id = 1; id <= TASK_RINGS_MAX; id++) {
+        TaskRingSlot* slot = &task_ring_slots[id];
+        if (slot->task_id) {
+            kprintf("[TASK RINGS]   ring %u: task %lu user=0x%lx events=%lu dropped=%lu%s\n",
+                    id, slot->task_id, (uint64_t)slot->user_addr, slot->events,
+                    slot->cq_dropped, slot->cq_broken ? " BROKEN" : "");
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef TASK_RINGS_H
+#define TASK_RINGS_H
+
+#include "events.h"
+#include "ringbuffer.h"
+#include "atomics.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "klib.h"
+
+// ============================================================================
+// TASK RINGS - своя пара SQ/CQ у каждой user задачи
+// ============================================================================
+//
+// Вместо одного общего user→kernel ring (MPMC, все задачи дерутся за tail)
+// каждая задача из usermode_create_task() получает:
+//   SQ  task → Receiver   (SPSC: один producer - задача, один consumer - Receiver)
+//   CQ  kernel → task     (SPSC: producer - ядро, один consumer - задача)
+//
+// Пара - одни и те же физические страницы (PMM), видимые дважды:
+//   kernel  - по identity map (TaskRingSlot.rings), так работает pipeline
+//   task    - в её vmm_context_t по TaskRingSlot.user_addr (VMM_FLAGS_USER_RW)
+// Событие задача строит прямо в слоте SQ, ответ Execution - прямо в слоте
+// CQ: копий между kernel и user нет.
+//
+// Вся пара доступна задаче на запись, поэтому ядро не крутится ни на одном
+// её слове. Producer'ы CQ (Center, Execution, Receiver - BUSY) пишут по
+// очереди под TaskRingSlot.cq_lock, позиция - kernel копия tail; из пары
+// ядро только читает head один раз на ответ. head, который не сходится с
+// kernel tail, делает CQ сломанной: её ответы отбрасываются, задача
+// тормозит только себя.
+//
+// Doorbell'а у задачи нет: Receiver, уснувший в MWAIT/HLT, будит
+// прерывание таймера, если в SQ пар что-то лежит (task_rings_timer_tick).
+//
+// Ring id события (Event.flags, event_ring_id()) ставит только Receiver:
+// 0 - глобальный ring (kernel задачи, демо), 1..TASK_RINGS_MAX - слот пары.
+// По нему Center и Execution выбирают CQ для ответа. user_id события из
+// SQ Receiver переписывает на владельца пары - чужим PID не подписаться.
+//
+// ============================================================================
+
+#define TASK_RINGS_MAX          16      // Пар одновременно (ring id 1..16)
+#define TASK_RING_GLOBAL        0       // Ring id глобального user→kernel ring
+
+// Где пара появляется в адресном пространстве задачи (ниже user стека,
+// вдали от VMM_USER_BASE, куда ляжет код)
+#define TASK_RINGS_USER_BASE    0x00007F0000000000ULL
+
+_Static_assert(TASK_RINGS_MAX < (EVENT_FLAGS_RING_MASK >> EVENT_RING_SHIFT),
+               "ring id must fit Event.flags ring field");
+
+typedef struct {
+    EventRingBuffer sq;                 // Task → Receiver
+    ResponseRingBuffer cq;              // Center / Execution → task
+} TaskRingPair;
+
+#define TASK_RINGS_PAGES ((sizeof(TaskRingPair) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+typedef struct {
+    TaskRingPair* rings;                // Kernel адрес; страницы остаются за slot'ом
+    uintptr_t user_addr;                // Адрес в контексте задачи (0 = не отображена)
+    vmm_context_t* context;             // Контекст задачи (0 = ядра) - для user buffers
+    volatile uint64_t task_id;          // Владелец (0 = slot свободен)
+    volatile uint64_t events;           // Забрано Receiver'ом из SQ за жизнь slot'а (seq следующего ID)
+
+    // Producer CQ - только в памяти ядра
+    spinlock_t cq_lock;                 // Center / Execution / Receiver по очереди
+    volatile uint64_t cq_tail;          // Kernel копия tail (в паре tail - только для задачи)
+    volatile uint32_t cq_broken;        // head CQ испорчен задачей - ответы отбрасываются
+    volatile uint64_t cq_dropped;       // Ответов отброшено
+} TaskRingSlot;
+
+typedef struct {
+    volatile uint32_t active;           // Битовая маска занятых slot'ов (bit = id - 1)
+    volatile uint64_t passes;           // Нечётное = Receiver внутри прохода по SQ
+    volatile uint64_t registered;
+    volatile uint64_t unregistered;
+    volatile uint64_t full;             // Все TASK_RINGS_MAX slot'ов заняты
+    volatile uint64_t draining;         // Свободные slot'ы ещё ждут ответов прошлых владельцев
+    volatile uint64_t timer_wakeups;    // Receiver разбужен tick'ом (task_rings_timer_tick)
+} TaskRingsState;
+
+extern TaskRingSlot task_ring_slots[TASK_RINGS_MAX + 1];  // [0] не используется
+extern TaskRingsState task_rings_state;
+
+void task_rings_init(void);
+
+// Новая пара для задачи task_id. Slot прошлого владельца выдаётся снова
+// только без его in-flight событий (credit_rings[id].inflight == 0) - иначе
+// поздний ответ попал бы в CQ новой задачи.
+// Возвращает ring id (1..TASK_RINGS_MAX) или TASK_RING_GLOBAL, если
+// slot'ов/памяти нет - задача тогда остаётся на
+// глобальном ring. Отображает пару в контекст задачи сам вызывающий
+// (usermode_create_task: vmm_map_pages + TaskRingSlot.user_addr / context)
+uint32_t task_rings_register(uint64_t task_id);
+
+// Освободить пару задачи (task_kill). Ждёт, пока Receiver закончит проход,
+// начатый до снятия бита - страницы остаются за slot'ом для следующей задачи.
+// Снимает буферы (user_buffers.h) и недособранные цепочки (center/chain.h)
+void task_rings_unregister(uint64_t task_id);
+
+// Ring id пары задачи (TASK_RING_GLOBAL = пары нет)
+uint32_t task_rings_find(uint64_t task_id);
+
+// Событий в SQ всех активных пар (eventdriven_pipeline_idle)
+uint64_t task_rings_pending(void);
+
+// Прерывание таймера (BSP, где работают задачи): Receiver уснул
+// (MWAIT/HLT), а в SQ пар есть события - будим его. Задача пишет в SQ без
+// syscall и idle_notify не вызывает, поэтому её событие ждёт не дольше tick
+void task_rings_timer_tick(void);
+
+static inline TaskRingPair* task_rings_get(uint32_t ring_id) {
+    return (ring_id && ring_id <= TASK_RINGS_MAX) ? task_ring_slots[ring_id].rings : 0;
+}
+
+// Ответов в CQ пары по kernel tail; сломанная CQ - всегда полна
+uint64_t task_rings_cq_count(uint32_t ring_id);
+
+// Слот CQ пары под ответ: на успехе cq_lock захвачен до task_rings_cq_commit.
+// 0 - CQ полна или сломана, ответ отброшен (учтён в cq_dropped)
+Response* task_rings_cq_reserve(uint32_t ring_id, uint64_t* out_pos);
+void task_rings_cq_commit(uint32_t ring_id, uint64_t pos);
+
+void task_rings_print_stats(void);
+
+#endif // TASK_RINGS_H
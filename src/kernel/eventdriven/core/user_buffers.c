@@ -0,0 +1,222 @@
+#include "user_buffers.h"
+#include "task_rings.h"
+#include "pmm.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+#define USER_BUFFER_STATE_FREE      0
+#define USER_BUFFER_STATE_ACTIVE    1
+#define USER_BUFFER_STATE_CLOSING   2   // unregister ждёт refs == 0
+
+UserBufferStats user_buffer_stats;
+
+static UserBuffer user_buffers[TASK_RINGS_MAX + 1][USER_BUFFERS_MAX];
+
+// get/put/register/unregister - короткие секции; сами копии идут без lock
+static spinlock_t user_buffers_lock;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void user_buffers_init(void) {
+    spinlock_init(&user_buffers_lock);
+    memset(user_buffers, 0, sizeof(user_buffers));
+    memset(&user_buffer_stats, 0, sizeof(user_buffer_stats));
+
+    kprintf("[USER BUFFERS] Initialized (%u per ring, up to %u pages each)\n",
+            USER_BUFFERS_MAX, USER_BUFFER_MAX_PAGES);
+}
+
+// ============================================================================
+// REGISTRATION
+// ============================================================================
+
+// Pin страницы page задачи, её физический адрес (0 = не отображена, не
+// user RW или pin'ов слишком много)
+static uintptr_t user_buffers_pin(vmm_context_t* ctx, uintptr_t page) {
+    if (!ctx) {
+        return page;  // Контекст ядра: identity map, pin не нужен
+    }
+    return vmm_pin_page(ctx, page, VMM_FLAGS_USER_RW);
+}
+
+static void user_buffers_unpin(vmm_context_t* ctx, uintptr_t first, uint64_t page_count) {
+    if (!ctx) {
+        return;
+    }
+    for (uint64_t i = 0; i < page_count; i++) {
+        vmm_unpin_page(ctx, first + i * PMM_PAGE_SIZE);
+    }
+}
+
+uint32_t user_buffers_register(uint32_t ring_id, uint64_t user_id, vmm_context_t* ctx,
+                               uintptr_t addr, uint64_t size, uint32_t* error) {
+    uintptr_t first = addr & ~(uintptr_t)(PMM_PAGE_SIZE - 1);
+    uint64_t page_count = (addr + size - first + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+
+    if (ring_id > TASK_RINGS_MAX || size == 0 || addr + size < addr ||
+        page_count > USER_BUFFER_MAX_PAGES) {
+        *error = USER_BUFFER_ERROR_RANGE;
+        atomic_increment_u64(&user_buffer_stats.rejected);
+        return USER_BUFFER_NONE;
+    }
+
+    uintptr_t* pages = (uintptr_t*)pmm_alloc(1);
+    if (!pages) {
+        *error = USER_BUFFER_ERROR_NO_MEMORY;
+        atomic_increment_u64(&user_buffer_stats.rejected);
+        return USER_BUFFER_NONE;
+    }
+
+    // Обход страниц - один раз здесь, а не на каждое чтение. Pin: пока
+    // буфер зарегистрирован, frame'ы не уйдут в PMM (vmm_free_pages /
+    // vmm_destroy_context их не отдают)
+    for (uint64_t i = 0; i < page_count; i++) {
+        pages[i] = user_buffers_pin(ctx, first + i * PMM_PAGE_SIZE);
+        if (!pages[i]) {
+            user_buffers_unpin(ctx, first, i);
+            pmm_free(pages, 1);
+            *error = USER_BUFFER_ERROR_UNMAPPED;
+            atomic_increment_u64(&user_buffer_stats.rejected);
+            return USER_BUFFER_NONE;
+        }
+    }
+
+    spin_lock(&user_buffers_lock);
+    for (uint32_t i = 0; i < USER_BUFFERS_MAX; i++) {
+        UserBuffer* buffer = &user_buffers[ring_id][i];
+        if (buffer->state == USER_BUFFER_STATE_FREE) {
+            buffer->pages = pages;
+            buffer->context = ctx;
+            buffer->user_addr = addr;
+            buffer->size = size;
+            buffer->user_id = user_id;
+            buffer->page_offset = (uint32_t)(addr - first);
+            buffer->refs = 0;
+            buffer->state = USER_BUFFER_STATE_ACTIVE;
+            spin_unlock(&user_buffers_lock);
+
+            atomic_increment_u64(&user_buffer_stats.registered);
+            return i + 1;
+        }
+    }
+    spin_unlock(&user_buffers_lock);
+
+    user_buffers_unpin(ctx, first, page_count);
+    pmm_free(pages, 1);
+    *error = USER_BUFFER_ERROR_FULL;
+    atomic_increment_u64(&user_buffer_stats.rejected);
+    return USER_BUFFER_NONE;
+}
+
+// Снять буфер (lock взят, state ACTIVE): дождаться in-flight копий
+static void user_buffers_close(UserBuffer* buffer) {
+    buffer->state = USER_BUFFER_STATE_CLOSING;
+    while (atomic_load_u32(&buffer->refs)) {
+        spin_unlock(&user_buffers_lock);
+        cpu_pause();
+        spin_lock(&user_buffers_lock);
+    }
+
+    uint64_t page_count = (buffer->page_offset + buffer->size + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+    user_buffers_unpin(buffer->context, buffer->user_addr - buffer->page_offset, page_count);
+
+    pmm_free(buffer->pages, 1);
+    buffer->pages = 0;
+    buffer->context = 0;
+    buffer->state = USER_BUFFER_STATE_FREE;
+    atomic_increment_u64(&user_buffer_stats.unregistered);
+}
+
+static UserBuffer* user_buffers_lookup(uint32_t ring_id, uint64_t user_id, uint32_t id) {
+    if (ring_id > TASK_RINGS_MAX || id == USER_BUFFER_NONE || id > USER_BUFFERS_MAX) {
+        return 0;
+    }
+    UserBuffer* buffer = &user_buffers[ring_id][id - 1];
+    if (buffer->state != USER_BUFFER_STATE_ACTIVE || buffer->user_id != user_id) {
+        return 0;
+    }
+    return buffer;
+}
+
+uint32_t user_buffers_unregister(uint32_t ring_id, uint64_t user_id, uint32_t id) {
+    spin_lock(&user_buffers_lock);
+    UserBuffer* buffer = user_buffers_lookup(ring_id, user_id, id);
+    if (!buffer) {
+        spin_unlock(&user_buffers_lock);
+        return USER_BUFFER_ERROR_ID;
+    }
+    user_buffers_close(buffer);
+    spin_unlock(&user_buffers_lock);
+    return 0;
+}
+
+void user_buffers_release_ring(uint32_t ring_id) {
+    if (ring_id > TASK_RINGS_MAX) {
+        return;
+    }
+    spin_lock(&user_buffers_lock);
+    for (uint32_t i = 0; i < USER_BUFFERS_MAX; i++) {
+        if (user_buffers[ring_id][i].state == USER_BUFFER_STATE_ACTIVE) {
+            user_buffers_close(&user_buffers[ring_id][i]);
+        }
+    }
+    spin_unlock(&user_buffers_lock);
+}
+
+// ============================================================================
+// ACCESS
+// ============================================================================
+
+UserBuffer* user_buffers_get(uint32_t ring_id, uint64_t user_id, uint32_t id,
+                             uint64_t offset, uint64_t length) {
+    spin_lock(&user_buffers_lock);
+    UserBuffer* buffer = user_buffers_lookup(ring_id, user_id, id);
+    if (buffer && (offset > buffer->size || length > buffer->size - offset)) {
+        buffer = 0;
+    }
+    if (buffer) {
+        atomic_increment_u32(&buffer->refs);
+    }
+    spin_unlock(&user_buffers_lock);
+    return buffer;
+}
+
+void user_buffers_put(UserBuffer* buffer) {
+    atomic_decrement_u32(&buffer->refs);
+}
+
+void* user_buffers_span(UserBuffer* buffer, uint64_t offset, uint64_t* contig) {
+    uint64_t pos = buffer->page_offset + offset;
+    uint64_t page = pos / PMM_PAGE_SIZE;
+    uint64_t last = (buffer->page_offset + buffer->size - 1) / PMM_PAGE_SIZE;
+
+    uint64_t end = page + 1;
+    while (end <= last && buffer->pages[end] == buffer->pages[end - 1] + PMM_PAGE_SIZE) {
+        end++;
+    }
+
+    uint64_t limit = buffer->page_offset + buffer->size;
+    if (end * PMM_PAGE_SIZE < limit) {
+        limit = end * PMM_PAGE_SIZE;
+    }
+    *contig = limit - pos;
+    return (void*)(buffer->pages[page] + pos % PMM_PAGE_SIZE);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void user_buffers_print_stats(void) {
+    kprintf("[USER BUFFERS] Stats: registered=%lu unregistered=%lu rejected=%lu read=%lu written=%lu bytes\n",
+            user_buffer_stats.registered,
+            user_buffer_stats.unregistered,
+            user_buffer_stats.rejected,
+            user_buffer_stats.bytes_read,
+            user_buffer_stats.bytes_written);
+}
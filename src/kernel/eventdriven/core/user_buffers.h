@@ -0,0 +1,90 @@
+#ifndef USER_BUFFERS_H
+#define USER_BUFFERS_H
+
+#include "events.h"
+#include "atomics.h"
+#include "vmm.h"
+
+// ============================================================================
+// USER BUFFERS - зарегистрированные буферы задачи для FILE_READ / FILE_WRITE
+// ============================================================================
+//
+// EVENT_MEMORY_REGISTER один раз проходит по страницам user буфера в
+// контексте задачи-отправителя (vmm_pin_page) и запоминает их
+// физические адреса. Ядро видит их по identity map, поэтому дальше
+// FILE_READ / FILE_WRITE с EVENT_FLAG_FIXED_BUF ссылаются на (id, offset,
+// length), и TagFS копирует прямо в / из страниц задачи: ни payload arena,
+// ни копии в 224 байта Event.data, ни ограничения PAYLOAD_MAX_SIZE.
+//
+// Страницы pinned (счётчик в software битах PTE, core/memory/vmm/vmm.h):
+// пока буфер зарегистрирован, vmm_unmap_page / vmm_free_pages их не
+// снимают, а vmm_destroy_context не отдаёт PMM. Unregister / release снимают
+// pin. Teardown задачи (usermode_destroy_task) сначала вызывает
+// task_rings_unregister - все буферы пары сняты, in-flight копии дождались -
+// и только потом разрушает контекст.
+//
+// Таблица - на ring id (core/task_rings.h): пара задачи или глобальный ring
+// (kernel задачи, контекст ядра - identity, страницы не обходятся).
+// Буфер помнит user_id регистратора - чужой id на глобальном ring не пройдёт.
+//
+// ============================================================================
+
+#define USER_BUFFERS_MAX        8       // Буферов на ring (id 1..8)
+#define USER_BUFFER_MAX_PAGES   512     // Страниц в буфере (2MB) - одна страница списка
+#define USER_BUFFER_NONE        0
+
+// Код ошибки (Response.error_code) EVENT_MEMORY_REGISTER / UNREGISTER
+#define USER_BUFFER_ERROR_RANGE     20  // size 0 или больше USER_BUFFER_MAX_PAGES
+#define USER_BUFFER_ERROR_UNMAPPED  21  // Страница не отображена / не user RW
+#define USER_BUFFER_ERROR_FULL      22  // Все USER_BUFFERS_MAX slot'ов заняты
+#define USER_BUFFER_ERROR_NO_MEMORY 23  // Нет страницы под список
+#define USER_BUFFER_ERROR_ID        24  // Нет такого буфера у отправителя
+
+typedef struct {
+    uintptr_t* pages;                   // Физические адреса страниц (PMM страница)
+    vmm_context_t* context;             // Где страницы pinned (0 = контекст ядра)
+    uintptr_t user_addr;
+    uint64_t size;
+    uint64_t user_id;                   // Кто зарегистрировал
+    uint32_t page_offset;               // user_addr внутри первой страницы
+    volatile uint32_t refs;             // In-flight копий (unregister ждёт 0)
+    volatile uint32_t state;            // USER_BUFFER_STATE_*
+} UserBuffer;
+
+typedef struct {
+    volatile uint64_t registered;
+    volatile uint64_t unregistered;
+    volatile uint64_t rejected;         // Регистрация не прошла
+    volatile uint64_t bytes_read;       // TagFS → буфер
+    volatile uint64_t bytes_written;    // Буфер → TagFS
+} UserBufferStats;
+
+extern UserBufferStats user_buffer_stats;
+
+void user_buffers_init(void);
+
+// Зарегистрировать [addr, addr + size) задачи. ctx - её контекст (0 =
+// контекст ядра). Возвращает id (1..USER_BUFFERS_MAX) или USER_BUFFER_NONE,
+// *error - USER_BUFFER_ERROR_*
+uint32_t user_buffers_register(uint32_t ring_id, uint64_t user_id, vmm_context_t* ctx,
+                               uintptr_t addr, uint64_t size, uint32_t* error);
+
+// 0 = снят, иначе USER_BUFFER_ERROR_ID. Ждёт in-flight копии буфера
+uint32_t user_buffers_unregister(uint32_t ring_id, uint64_t user_id, uint32_t id);
+
+// Снять все буферы ring (задача ушла - task_rings_unregister)
+void user_buffers_release_ring(uint32_t ring_id);
+
+// Взять буфер для копии [offset, offset + length): 0 - нет буфера или
+// диапазон за его пределами. Каждый успешный get - ровно один put
+UserBuffer* user_buffers_get(uint32_t ring_id, uint64_t user_id, uint32_t id,
+                             uint64_t offset, uint64_t length);
+void user_buffers_put(UserBuffer* buffer);
+
+// Kernel указатель на байт offset буфера; *contig - сколько байт подряд
+// за ним физически непрерывно (соседние страницы склеиваются)
+void* user_buffers_span(UserBuffer* buffer, uint64_t offset, uint64_t* contig);
+
+void user_buffers_print_stats(void);
+
+#endif // USER_BUFFERS_H
@@ -0,0 +1,61 @@
+#ifndef DECK_HANDLERS_H
+#define DECK_HANDLERS_H
+
+#include "../core/events.h"
+
+// ============================================================================
+// DECK HANDLERS - по функции на тип события (вызываются через event_registry)
+// ============================================================================
+//
+// Handler обязан завершить свой шаг через deck_complete*() или deck_error().
+// Возвращает: 1 = success, 0 = error
+//
+// ============================================================================
+
+// ===== OPERATIONS DECK =====
+int operations_handle_proc_create(RoutingEntry* entry);
+int operations_handle_proc_exit(RoutingEntry* entry);
+int operations_handle_proc_kill(RoutingEntry* entry);
+int operations_handle_proc_wait(RoutingEntry* entry);
+int operations_handle_proc_getpid(RoutingEntry* entry);
+int operations_handle_proc_signal(RoutingEntry* entry);
+int operations_handle_ipc(RoutingEntry* entry);
+int operations_handle_sys_probe(RoutingEntry* entry);
+
+// ===== STORAGE DECK =====
+int storage_handle_memory_alloc(RoutingEntry* entry);
+int storage_handle_memory_free(RoutingEntry* entry);
+int storage_handle_memory_map(RoutingEntry* entry);
+int storage_handle_memory_register(RoutingEntry* entry);
+int storage_handle_memory_unregister(RoutingEntry* entry);
+int storage_handle_file_open(RoutingEntry* entry);
+int storage_handle_file_close(RoutingEntry* entry);
+int storage_handle_file_read(RoutingEntry* entry);
+int storage_handle_file_write(RoutingEntry* entry);
+int storage_handle_file_stat(RoutingEntry* entry);
+int storage_handle_file_create_tagged(RoutingEntry* entry);
+int storage_handle_file_query(RoutingEntry* entry);
+int storage_handle_file_tag_add(RoutingEntry* entry);
+int storage_handle_file_tag_remove(RoutingEntry* entry);
+int storage_handle_file_tag_get(RoutingEntry* entry);
+int storage_handle_sys_probe(RoutingEntry* entry);
+
+// ===== HARDWARE DECK =====
+int hardware_handle_timer_create(RoutingEntry* entry);
+int hardware_handle_timer_cancel(RoutingEntry* entry);
+int hardware_handle_timer_sleep(RoutingEntry* entry);
+int hardware_handle_timer_getticks(RoutingEntry* entry);
+int hardware_handle_dev_open(RoutingEntry* entry);
+int hardware_handle_dev_ioctl(RoutingEntry* entry);
+int hardware_handle_dev_read(RoutingEntry* entry);
+int hardware_handle_dev_write(RoutingEntry* entry);
+int hardware_handle_sys_probe(RoutingEntry* entry);
+
+// ===== NETWORK DECK (stub в v1) =====
+int network_handle_socket(RoutingEntry* entry);
+int network_handle_connect(RoutingEntry* entry);
+int network_handle_send(RoutingEntry* entry);
+int network_handle_recv(RoutingEntry* entry);
+int network_handle_sys_probe(RoutingEntry* entry);
+
+#endif // DECK_HANDLERS_H
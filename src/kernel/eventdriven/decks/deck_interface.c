@@ -1,66 +1,344 @@
 #include "deck_interface.h"
+#include "../core/latency.h"
+#include "pmm.h"
 #include "klib.h"
 
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
 
-void deck_init(DeckContext* ctx, const char* name, uint8_t prefix, DeckProcessFunc func) {
+// prefix -> deck (для hand-off из Guide)
+static DeckContext* deck_registry[5];
+
+#define DECK_PAGES(size) (((size) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+void deck_init(DeckContext* ctx, const char* name, uint8_t prefix, DeckPollFunc poll,
+               uint32_t workers) {
+    if (workers == 0) {
+        workers = 1;
+    }
+    if (workers > DECK_MAX_WORKERS) {
+        workers = DECK_MAX_WORKERS;
+    }
+
+    memset(&ctx->stats, 0, sizeof(DeckStats));
     ctx->stats.name = name;
     ctx->stats.prefix = prefix;
-    ctx->stats.events_processed = 0;
-    ctx->stats.errors = 0;
+    ctx->stats.worker_count = workers;
 
-    ctx->process_func = func;
+    ctx->poll_func = poll;
     ctx->deck_prefix = prefix;
 
-    // Получаем input queue от Guide
-    ctx->input_queue = guide_get_deck_queue(prefix);
+    // Inboxes (~64KB на lane), DRR и deque каждого worker'а - из PMM, не из BSS
+    for (uint32_t i = 0; i < workers; i++) {
+        DeckWorker* worker = &ctx->workers[i];
+        worker->deck = ctx;
+        worker->index = i;
+        worker->stage = EVENTDRIVEN_STAGE_DECK_WORKERS + (prefix - 1) * DECK_MAX_WORKERS + i;
+        worker->busy = 0;
+        worker->lanes = (DeckLaneScheduler*)pmm_alloc_zero(
+            DECK_PAGES(EVENT_LANE_COUNT * sizeof(DeckLaneScheduler)));
+        worker->deque = (WorkDeque*)pmm_alloc_zero(DECK_PAGES(sizeof(WorkDeque)));
+        if (!worker->lanes || !worker->deque) {
+            panic("[DECK:%s] Out of memory for worker %u queues", name, i);
+        }
+        for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+            worker->inbox[lane] = (DeckQueue*)pmm_alloc_zero(DECK_PAGES(sizeof(DeckQueue)));
+            if (!worker->inbox[lane]) {
+                panic("[DECK:%s] Out of memory for worker %u queues", name, i);
+            }
+            deck_queue_init(worker->inbox[lane]);
+        }
+        work_deque_init(worker->deque);
+    }
+
+    deck_registry[prefix] = ctx;
 
-    kprintf("[DECK:%s] Initialized (prefix=%d)\n", name, prefix);
+    kprintf("[DECK:%s] Initialized (prefix=%d, workers=%u)\n", name, prefix, workers);
+}
+
+DeckContext* deck_get_context(uint8_t prefix) {
+    if (prefix >= 1 && prefix <= 4) {
+        return deck_registry[prefix];
+    }
+    return 0;
+}
+
+// ============================================================================
+// HAND-OFF (вызывается из Guide)
+// ============================================================================
+
+static uint64_t deck_worker_load(DeckWorker* worker) {
+    uint64_t load = work_deque_size(worker->deque) + worker->busy;
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        DeckQueue* inbox = worker->inbox[lane];
+        load += atomic_load_u64(&inbox->tail) - atomic_load_u64(&inbox->head);
+        load += worker->lanes[lane].backlog;
+    }
+    return load;
+}
+
+int deck_submit(uint8_t deck_prefix, RoutingHandle handle) {
+    DeckContext* ctx = deck_get_context(deck_prefix);
+    if (!ctx) {
+        return 0;
+    }
+
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (!entry) {
+        return 1;  // Stale handle (entry отменена) - доставлять некому
+    }
+    uint32_t lane = event_lane(entry->event_copy.flags);
+
+    // Наименее загруженный worker (оценка без lock'ов - гонка лишь
+    // немного ухудшает баланс, остальное выравнивает кража)
+    DeckWorker* target = &ctx->workers[0];
+    uint64_t best = deck_worker_load(target);
+    for (uint32_t i = 1; i < ctx->stats.worker_count && best > 0; i++) {
+        uint64_t load = deck_worker_load(&ctx->workers[i]);
+        if (load < best) {
+            best = load;
+            target = &ctx->workers[i];
+        }
+    }
+
+    if (!deck_queue_push(target->inbox[lane], handle)) {
+        return 0;
+    }
+    atomic_increment_u64(&guide_stats.lanes[lane].queued);
+    idle_notify(target->stage);
+    return 1;
 }
 
 // ============================================================================
 // GENERIC MAIN LOOP
 // ============================================================================
 
-// Обработать одно событие (для синхронной обработки в демо)
-int deck_run_once(DeckContext* ctx) {
-    // Получаем событие из очереди
-    RoutingEntry* entry = deck_queue_pop(ctx->input_queue);
+static void deck_process_handle(DeckWorker* worker, RoutingHandle handle) {
+    DeckContext* ctx = worker->deck;
+
+    // Устаревший handle (entry уже освобождена) или entry забрал reaper
+    // (дедлайн истёк, TIMEOUT отвечает Execution) - пропускаем
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (!entry || !routing_entry_enter(entry, handle, 0)) {
+        return;
+    }
+
+    // Волна, в которой эта ветка - читаем до join (потом entry не наша)
+    uint32_t wave = entry->wave_decks;
+    uint32_t flag = 1u << (ctx->deck_prefix - 1);
+    int success;
+
+    // Handler - одна загрузка из event_registry по (type, deck)
+    uint32_t type = entry->event_copy.type;
+    EventHandler handler = event_registry_handler(type, ctx->deck_prefix);
+    LatencyShard* latency = latency_shard(worker->stage);
+
+    worker->busy = 1;
+    uint64_t start = rdtsc();
+    latency_record(latency, type, LATENCY_SLOT_FIRST, start - entry->deck_timestamps[ctx->deck_prefix - 1]);
 
-    if (entry) {
-        // Обрабатываем событие - deck сам вызовет deck_complete() или deck_error()
-        int success = ctx->process_func(entry);
+    if (handler) {
+        // Handler сам вызовет deck_complete() или deck_error()
+        success = handler(entry);
+    } else {
+        kprintf("[DECK:%s] No handler for event type %d\n",
+                ctx->stats.name, entry->event_copy.type);
+        deck_error(entry, ctx->deck_prefix, DECK_ERROR_NO_HANDLER);
+        success = 0;
+    }
+
+    DeckWorkerStats* stats = &ctx->stats.workers[worker->index];
+    uint64_t service = rdtsc() - start;
+    stats->busy_cycles += service;
+    latency_record(latency, type, LATENCY_SLOT_SECOND, service);
+    stats->events_processed++;
+    worker->busy = 0;
+
+    // Deck обязан затереть свой prefix (deck_complete/deck_error).
+    // Если не затёр - считаем ошибкой, иначе entry вернётся в этот же deck
+    if (routing_entry_wave_step(entry, ctx->deck_prefix) >= 0) {
+        deck_error(entry, ctx->deck_prefix, 0);
+        success = 0;
+    }
+
+    if (success) {
+        atomic_increment_u64((volatile uint64_t*)&ctx->stats.events_processed);
+    } else {
+        atomic_increment_u64((volatile uint64_t*)&ctx->stats.errors);
+    }
 
-        if (success) {
-            atomic_increment_u64((volatile uint64_t*)&ctx->stats.events_processed);
-        } else {
-            atomic_increment_u64((volatile uint64_t*)&ctx->stats.errors);
+    // Join: ветки волны ставят свои биты, последняя (её бит закрыл
+    // wave_decks) передаёт entry следующей волне / Execution. Делается
+    // здесь, а не в deck_complete(): после передачи entry может забрать
+    // другое ядро.
+    uint32_t done = atomic_fetch_or_u32(&entry->completion_flags, flag) | flag;
+    if ((done & wave) == wave) {
+        guide_route_entry(entry);
+    } else {
+        routing_entry_leave(entry, handle);
+    }
+}
+
+// ============================================================================
+// BATCH SCHEDULING - QoS lanes + deficit round robin по user_id
+// ============================================================================
+
+// 0 = flow этого user полон (handle остаётся у вызывающего)
+static int deck_lane_enqueue(DeckLaneScheduler* sched, RoutingHandle handle) {
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (!entry) {
+        return 1;  // Stale handle - просто отбрасываем
+    }
+
+    DeckFlow* flow = &sched->flows[entry->event_copy.user_id & (DECK_DRR_FLOWS - 1)];
+    if (flow->tail - flow->head == DECK_DRR_DEPTH) {
+        return 0;
+    }
+
+    flow->handles[flow->tail++ & (DECK_DRR_DEPTH - 1)] = handle;
+    sched->backlog++;
+    return 1;
+}
+
+// Переносит handles из inbox lane в flows, пока есть место
+static void deck_lane_fill(DeckLaneScheduler* sched, DeckQueue* inbox, uint32_t lane) {
+    if (sched->overflow != ROUTING_HANDLE_NONE) {
+        if (!deck_lane_enqueue(sched, sched->overflow)) {
+            return;
+        }
+        sched->overflow = ROUTING_HANDLE_NONE;
+    }
+
+    while (sched->backlog < DECK_DRR_FLOWS * DECK_DRR_DEPTH) {
+        RoutingHandle handle = deck_queue_pop(inbox);
+        if (handle == ROUTING_HANDLE_NONE) {
+            break;
+        }
+        atomic_decrement_u64(&guide_stats.lanes[lane].queued);
+
+        if (!deck_lane_enqueue(sched, handle)) {
+            sched->overflow = handle;  // Flow полон - ждёт, пока его разберут
+            break;
         }
-        return 1;  // Обработано событие
     }
-    return 0;  // Очередь пуста
 }
 
-void deck_run(DeckContext* ctx) {
-    kprintf("[DECK:%s] Starting main loop...\n", ctx->stats.name);
+// DRR: визит flow добавляет quantum к deficit, каждое событие стоит 1.
+// Визит, прерванный по budget, продолжается со следующей пачки
+static int deck_lane_dequeue(DeckLaneScheduler* sched, RoutingHandle* out, int budget) {
+    int taken = 0;
+
+    while (taken < budget && sched->backlog > 0) {
+        DeckFlow* flow = &sched->flows[sched->cursor];
 
-    uint64_t iterations = 0;
+        if (flow->head != flow->tail) {
+            if (!sched->visiting) {
+                flow->deficit += DECK_DRR_QUANTUM;
+                sched->visiting = 1;
+            }
+            while (taken < budget && flow->head != flow->tail && flow->deficit > 0) {
+                out[taken++] = flow->handles[flow->head++ & (DECK_DRR_DEPTH - 1)];
+                flow->deficit--;
+                sched->backlog--;
+            }
+        }
 
-    while (1) {
-        if (!deck_run_once(ctx)) {
-            // Очередь пуста - делаем паузу
-            cpu_pause();
+        if (flow->head == flow->tail || flow->deficit <= 0) {
+            if (flow->head == flow->tail) {
+                flow->deficit = 0;  // Пустой flow не копит кредит
+            }
+            sched->visiting = 0;
+            sched->cursor = (sched->cursor + 1) & (DECK_DRR_FLOWS - 1);
         }
+    }
+
+    return taken;
+}
+
+// Пустая deque: планировщик собирает пачку по lanes. Первый handle
+// обрабатываем сразу, остальные кладём в deque в обратном порядке -
+// владелец снимает их с bottom в порядке планирования (realtime раньше),
+// а воры забирают с top самые поздние
+static RoutingHandle deck_worker_refill(DeckWorker* worker) {
+    RoutingHandle batch[DECK_WORKER_BATCH];
+    int count = 0;
+
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        DeckLaneScheduler* sched = &worker->lanes[lane];
+        deck_lane_fill(sched, worker->inbox[lane], lane);
+        count += deck_lane_dequeue(sched, batch + count, DECK_WORKER_BATCH >> (lane + 1));
+    }
+
+    if (count == 0) {
+        return ROUTING_HANDLE_NONE;
+    }
 
-        // Периодическая статистика
-        iterations++;
-        if (iterations % 10000000 == 0) {
-            kprintf("[DECK:%s] processed=%lu errors=%lu\n",
-                    ctx->stats.name,
-                    ctx->stats.events_processed,
-                    ctx->stats.errors);
+    for (int i = count - 1; i > 0; i--) {
+        work_deque_push(worker->deque, batch[i]);
+    }
+    return batch[0];
+}
+
+static RoutingHandle deck_worker_steal(DeckWorker* worker) {
+    DeckContext* ctx = worker->deck;
+    uint32_t count = ctx->stats.worker_count;
+
+    for (uint32_t i = 1; i < count; i++) {
+        DeckWorker* victim = &ctx->workers[(worker->index + i) % count];
+        RoutingHandle handle = work_deque_steal(victim->deque);
+        if (handle != ROUTING_HANDLE_NONE) {
+            ctx->stats.workers[worker->index].steals++;
+            return handle;
         }
     }
+    return ROUTING_HANDLE_NONE;
+}
+
+int deck_worker_run_once(DeckWorker* worker) {
+    if (worker->index == 0 && worker->deck->poll_func) {
+        worker->deck->poll_func();
+    }
+
+    RoutingHandle handle = work_deque_pop(worker->deque);
+    if (handle == ROUTING_HANDLE_NONE) {
+        handle = deck_worker_refill(worker);
+    }
+    if (handle == ROUTING_HANDLE_NONE) {
+        handle = deck_worker_steal(worker);
+    }
+    if (handle == ROUTING_HANDLE_NONE) {
+        return 0;  // Работы нет ни у нас, ни у соседей
+    }
+
+    deck_process_handle(worker, handle);
+    return 1;
+}
+
+// Обработать по событию каждым worker'ом (для синхронной обработки в демо)
+int deck_run_once(DeckContext* ctx) {
+    int work = 0;
+    for (uint32_t i = 0; i < ctx->stats.worker_count; i++) {
+        work |= deck_worker_run_once(&ctx->workers[i]);
+    }
+    return work;
+}
+
+void deck_print_stats(DeckContext* ctx) {
+    kprintf("[DECK:%s] processed=%lu errors=%lu\n",
+            ctx->stats.name,
+            ctx->stats.events_processed,
+            ctx->stats.errors);
+
+    if (ctx->stats.worker_count < 2) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < ctx->stats.worker_count; i++) {
+        DeckWorkerStats* stats = &ctx->stats.workers[i];
+        uint64_t per_event = stats->events_processed ?
+                             stats->busy_cycles / stats->events_processed : 0;
+        kprintf("[DECK:%s]   worker %u: processed=%lu steals=%lu cycles/event=%lu\n",
+                ctx->stats.name, i, stats->events_processed, stats->steals, per_event);
+    }
 }
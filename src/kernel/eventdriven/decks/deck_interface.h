@@ -3,47 +3,143 @@
 
 #include "../core/events.h"
 #include "../guide/guide.h"
+#include "../routing/event_registry.h"
+#include "../core/idle.h"
+#include "work_deque.h"
 #include "klib.h"
 
 // ============================================================================
 // DECK INTERFACE - Общий интерфейс для всех Processing Decks
 // ============================================================================
 
+// ============================================================================
+// DECK WORKERS - пул workers на каждый deck
+// ============================================================================
+//
+// Guide кладёт handle в inbox (по одному на QoS lane) наименее загруженного
+// worker'а (load = inboxes + DRR backlog + deque + занят ли сейчас). Worker
+// выбирает пачку планировщиком (ниже) в свою Chase-Lev deque (work_deque.h)
+// и обрабатывает её с bottom; простаивающий worker крадёт с top deque
+// соседа. Так медленная операция (TagFS) не держит очередь остальных
+// событий deck'а.
+//
+// Планировщик пачки: lane l получает до DECK_WORKER_BATCH >> (l + 1) слотов
+// (realtime первым), внутри lane - deficit round robin по user_id: handles
+// раскладываются по DECK_DRR_FLOWS flows (user_id & mask), каждый визит flow
+// добавляет DECK_DRR_QUANTUM к его deficit, событие стоит 1. Один user,
+// засыпавший lane записью файлов, получает свою долю, а не всю очередь.
+//
+// В SMP режиме каждый worker - отдельная стадия pipeline (своё ядро, если
+// ядер хватает). В синхронном режиме deck_run_once() обходит всех workers.
+
+#define DECK_MAX_WORKERS        4
+#define DECK_WORKER_BATCH       32      // Сколько handles за раз переносить из inbox в deque
+
+// Workers по умолчанию (не больше DECK_MAX_WORKERS). Handlers deck'а с
+// несколькими workers обязаны быть безопасны для параллельного вызова:
+// Operations - task system под своими locks, Storage - fd table и TagFS
+// под storage_fs_lock (storage_deck.c). Hardware (таблица таймеров) и
+// Network (stubs) - по одному
+#define OPERATIONS_DECK_WORKERS 2
+#define STORAGE_DECK_WORKERS    2       // TagFS I/O - основной источник head-of-line
+#define HARDWARE_DECK_WORKERS   1
+#define NETWORK_DECK_WORKERS    1
+
+#define DECK_DRR_FLOWS          8       // Flows на lane (коллизии user_id делят flow)
+#define DECK_DRR_DEPTH          32      // Handles в одном flow
+#define DECK_DRR_QUANTUM        4       // Событий за визит flow
+
+_Static_assert((DECK_DRR_FLOWS & (DECK_DRR_FLOWS - 1)) == 0 &&
+               (DECK_DRR_DEPTH & (DECK_DRR_DEPTH - 1)) == 0,
+               "DRR flows/depth must be power of 2");
+_Static_assert(DECK_WORKER_BATCH <= WORK_DEQUE_SIZE,
+               "inbox batch must fit into an empty deque");
+_Static_assert(EVENTDRIVEN_STAGE_DECK_WORKERS + 4 * DECK_MAX_WORKERS <= EVENTDRIVEN_MAX_STAGES,
+               "every deck worker needs its own stage id");
+
+typedef struct {
+    volatile uint64_t events_processed;
+    volatile uint64_t steals;           // Handles, украденные у соседей
+    volatile uint64_t busy_cycles;      // TSC cycles в handlers (throughput)
+} DeckWorkerStats;
+
 typedef struct {
     const char* name;                  // Название deck
     uint8_t prefix;                    // Уникальный prefix
     volatile uint64_t events_processed;
     volatile uint64_t errors;
+    uint32_t worker_count;
+    DeckWorkerStats workers[DECK_MAX_WORKERS];
 } DeckStats;
 
-// Функция обработки события (реализуется каждым deck)
-// Deck должен вызвать deck_complete() в конце обработки
-// Возвращает: 1 = success, 0 = error
-typedef int (*DeckProcessFunc)(RoutingEntry* entry);
+// Обработка события - handler типа из event_registry (decks/deck_handlers.h),
+// switch по типу в deck'ах нет. Тип без handler'а в этом deck -> ошибка
+#define DECK_ERROR_NO_HANDLER   255
+
+// Периодическая работа deck'а вне событий (таймеры hardware deck).
+// Вызывается worker'ом 0 на каждом проходе - и в SMP, и в синхронном режиме
+typedef void (*DeckPollFunc)(void);
+
+typedef struct DeckContext DeckContext;
+
+typedef struct {
+    int32_t deficit;
+    uint32_t head;
+    uint32_t tail;
+    RoutingHandle handles[DECK_DRR_DEPTH];
+} DeckFlow;
+
+// DRR одной lane одного worker'а (трогает только владелец)
+typedef struct {
+    DeckFlow flows[DECK_DRR_FLOWS];
+    uint32_t cursor;                    // Flow, который сейчас обслуживается
+    uint32_t visiting;                  // Quantum за этот визит уже добавлен
+    volatile uint32_t backlog;          // Handles во всех flows
+    RoutingHandle overflow;             // Взят из inbox, но его flow был полон
+} DeckLaneScheduler;
+
+typedef struct {
+    DeckContext* deck;
+    uint32_t index;
+    uint32_t stage;                     // id стадии для idle_notify()
+    DeckQueue* inbox[EVENT_LANE_COUNT]; // Guide → worker (MPMC), по lane
+    DeckLaneScheduler* lanes;           // [EVENT_LANE_COUNT]
+    WorkDeque* deque;                   // Bottom - владелец, top - воры
+    volatile uint32_t busy;             // Сейчас в handler
+} DeckWorker;
 
 // ============================================================================
 // DECK CONTEXT - Контекст для каждого deck
 // ============================================================================
 
-typedef struct {
+struct DeckContext {
     DeckStats stats;
-    DeckProcessFunc process_func;
-    DeckQueue* input_queue;
+    DeckPollFunc poll_func;             // 0 = нет периодической работы
     uint8_t deck_prefix;
-} DeckContext;
+    DeckWorker workers[DECK_MAX_WORKERS];
+};
 
 // ============================================================================
 // GENERIC DECK OPERATIONS
 // ============================================================================
 
-// Инициализация deck
-void deck_init(DeckContext* ctx, const char* name, uint8_t prefix, DeckProcessFunc func);
+// Инициализация deck с пулом из workers (1..DECK_MAX_WORKERS)
+void deck_init(DeckContext* ctx, const char* name, uint8_t prefix, DeckPollFunc poll,
+               uint32_t workers);
 
-// Обработать одно событие (для синхронной обработки)
+// Deck по prefix (1-4), 0 если не инициализирован
+DeckContext* deck_get_context(uint8_t prefix);
+
+// Одно событие одним worker'ом: своя deque, затем inboxes (через DRR),
+// затем кража.
+// 0 = работы не нашлось
+int deck_worker_run_once(DeckWorker* worker);
+
+// Обработать по событию каждым worker'ом (для синхронной обработки)
 int deck_run_once(DeckContext* ctx);
 
-// Главный цикл deck (generic)
-void deck_run(DeckContext* ctx);
+// processed/errors + по каждому worker'у: processed, steals, cycles/event
+void deck_print_stats(DeckContext* ctx);
 
 // ============================================================================
 // DECK HELPERS - Завершение обработки
@@ -58,11 +154,25 @@ static inline void deck_complete(RoutingEntry* entry, uint8_t deck_prefix, void*
     // 2. ЗАТИРАЕМ prefix (это ключевой момент!)
     routing_entry_clear_prefix(entry, deck_prefix);
 
-    // 3. Устанавливаем completion flag
-    uint32_t flag = 1 << (deck_prefix - 1);
-    atomic_store_u32(&entry->completion_flags, entry->completion_flags | flag);
+    // 3. Completion flag ставит deck_worker_run_once после возврата из deck'а:
+    //    это join параллельных веток, последняя ветка передаёт entry дальше
+}
+
+// Deck вызывает эту функцию, если результат лежит в payload arena
+// (смещение уйдёт в Response.payload_offset, освобождает consumer).
+// В fan-out маршруте payload может вернуть только одна ветка
+static inline void deck_complete_payload(RoutingEntry* entry, uint8_t deck_prefix,
+                                         uint32_t payload_offset, uint32_t payload_size) {
+    entry->payload_offset = payload_offset;
+    entry->payload_size = payload_size;
+    deck_complete(entry, deck_prefix, 0);
+}
 
-    // 4. Entry теперь готов для следующего шага (Guide его подхватит)
+// EVENT_SYS_PROBE (диагностика route DAG): результат = decks, идущие
+// параллельно с нами. wave_decks ещё наша - join делается после handler'а
+static inline int deck_complete_probe(RoutingEntry* entry, uint8_t deck_prefix) {
+    deck_complete(entry, deck_prefix, (void*)(uint64_t)entry->wave_decks);
+    return 1;
 }
 
 // Deck вызывает эту функцию при ОШИБКЕ обработки
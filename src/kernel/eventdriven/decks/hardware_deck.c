@@ -1,4 +1,5 @@
 #include "deck_interface.h"
+#include "deck_handlers.h"
 #include "klib.h"
 #include "../task/task.h"  // NEW: Task system integration
 
@@ -76,7 +77,7 @@ static uint64_t timer_get_ticks(void) {
     return rdtsc();
 }
 
-// Проверка истёкших таймеров (вызывается периодически)
+// Проверка истёкших таймеров (poll_func deck: каждый проход worker 0)
 static void timer_check_expired(void) {
     uint64_t now = rdtsc();
 
@@ -125,105 +126,117 @@ static int device_write(int device_id, const void* buffer, uint64_t size) {
 }
 
 // ============================================================================
-// PROCESSING FUNCTION
+// HANDLERS (dispatch через event_registry)
 // ============================================================================
 
-int hardware_deck_process(RoutingEntry* entry) {
+// === TIMER OPERATIONS ===
+
+int hardware_handle_timer_create(RoutingEntry* entry) {
     Event* event = &entry->event_copy;
 
-    switch (event->type) {
-        // === TIMER OPERATIONS ===
-        case EVENT_TIMER_CREATE: {
-            // Payload: [delay_ms:8][interval_ms:8]
-            uint64_t delay_ms = *(uint64_t*)event->data;
-            uint64_t interval_ms = *(uint64_t*)(event->data + 8);
+    // Payload: [delay_ms:8][interval_ms:8]
+    uint64_t delay_ms = *(uint64_t*)event->data;
+    uint64_t interval_ms = *(uint64_t*)(event->data + 8);
 
-            Timer* timer = timer_create(delay_ms, interval_ms);
+    Timer* timer = timer_create(delay_ms, interval_ms);
 
-            if (timer) {
-                deck_complete(entry, DECK_PREFIX_HARDWARE, timer);
-                kprintf("[HARDWARE] Event %lu: created timer %lu\n",
-                        event->id, timer->id);
-                return 1;
-            }
-            deck_error(entry, DECK_PREFIX_HARDWARE, 1);
-            return 0;
-        }
+    if (timer) {
+        deck_complete(entry, DECK_PREFIX_HARDWARE, timer);
+        kprintf("[HARDWARE] Event %lu: created timer %lu\n",
+                event->id, timer->id);
+        return 1;
+    }
+    deck_error(entry, DECK_PREFIX_HARDWARE, 1);
+    return 0;
+}
 
-        case EVENT_TIMER_CANCEL: {
-            uint64_t timer_id = *(uint64_t*)event->data;
-            int success = timer_cancel(timer_id);
-            if (success) {
-                deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
-            } else {
-                deck_error(entry, DECK_PREFIX_HARDWARE, 2);
-            }
-            kprintf("[HARDWARE] Event %lu: cancelled timer %lu (status=%d)\n",
-                    event->id, timer_id, success);
-            return success;
-        }
+int hardware_handle_timer_cancel(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
 
-        case EVENT_TIMER_SLEEP: {
-            uint64_t ms = *(uint64_t*)event->data;
-            timer_sleep(ms);
-            deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
-            kprintf("[HARDWARE] Event %lu: sleep %lu ms\n", event->id, ms);
-            return 1;
-        }
+    uint64_t timer_id = *(uint64_t*)event->data;
+    int success = timer_cancel(timer_id);
+    if (success) {
+        deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
+    } else {
+        deck_error(entry, DECK_PREFIX_HARDWARE, 2);
+    }
+    kprintf("[HARDWARE] Event %lu: cancelled timer %lu (status=%d)\n",
+            event->id, timer_id, success);
+    return success;
+}
 
-        case EVENT_TIMER_GETTICKS: {
-            uint64_t ticks = timer_get_ticks();
-            deck_complete(entry, DECK_PREFIX_HARDWARE, (void*)ticks);
-            kprintf("[HARDWARE] Event %lu: getticks = %lu\n", event->id, ticks);
-            return 1;
-        }
+int hardware_handle_timer_sleep(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
 
-        // === DEVICE OPERATIONS (STUBS) ===
-        case EVENT_DEV_OPEN: {
-            const char* name = (const char*)event->data;
-            int device_id = device_open(name);
-            deck_complete(entry, DECK_PREFIX_HARDWARE, (void*)(uint64_t)device_id);
-            kprintf("[HARDWARE] Event %lu: device open '%s'\n", event->id, name);
-            return 1;
-        }
+    uint64_t ms = *(uint64_t*)event->data;
+    timer_sleep(ms);
+    deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
+    kprintf("[HARDWARE] Event %lu: sleep %lu ms\n", event->id, ms);
+    return 1;
+}
 
-        case EVENT_DEV_IOCTL: {
-            // Payload: [device_id:4][command:8][arg:...]
-            int device_id = *(int*)event->data;
-            uint64_t command = *(uint64_t*)(event->data + 4);
-            void* arg = event->data + 12;
-            device_ioctl(device_id, command, arg);
-            deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
-            kprintf("[HARDWARE] Event %lu: device ioctl\n", event->id);
-            return 1;
-        }
+int hardware_handle_timer_getticks(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
 
-        case EVENT_DEV_READ: {
-            // Payload: [device_id:4][size:8]
-            int device_id = *(int*)event->data;
-            uint64_t size = *(uint64_t*)(event->data + 4);
-            device_read(device_id, 0, size);
-            deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
-            kprintf("[HARDWARE] Event %lu: device read\n", event->id);
-            return 1;
-        }
+    uint64_t ticks = timer_get_ticks();
+    deck_complete(entry, DECK_PREFIX_HARDWARE, (void*)ticks);
+    kprintf("[HARDWARE] Event %lu: getticks = %lu\n", event->id, ticks);
+    return 1;
+}
 
-        case EVENT_DEV_WRITE: {
-            // Payload: [device_id:4][size:8][data:...]
-            int device_id = *(int*)event->data;
-            uint64_t size = *(uint64_t*)(event->data + 4);
-            void* data = event->data + 12;
-            device_write(device_id, data, size);
-            deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
-            kprintf("[HARDWARE] Event %lu: device write\n", event->id);
-            return 1;
-        }
+// === DEVICE OPERATIONS (STUBS) ===
 
-        default:
-            kprintf("[HARDWARE] Unknown event type %d\n", event->type);
-            deck_error(entry, DECK_PREFIX_HARDWARE, 3);
-            return 0;
-    }
+int hardware_handle_dev_open(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    const char* name = (const char*)event->data;
+    int device_id = device_open(name);
+    deck_complete(entry, DECK_PREFIX_HARDWARE, (void*)(uint64_t)device_id);
+    kprintf("[HARDWARE] Event %lu: device open '%s'\n", event->id, name);
+    return 1;
+}
+
+int hardware_handle_dev_ioctl(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [device_id:4][command:8][arg:...]
+    int device_id = *(int*)event->data;
+    uint64_t command = *(uint64_t*)(event->data + 4);
+    void* arg = event->data + 12;
+    device_ioctl(device_id, command, arg);
+    deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
+    kprintf("[HARDWARE] Event %lu: device ioctl\n", event->id);
+    return 1;
+}
+
+int hardware_handle_dev_read(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [device_id:4][size:8]
+    int device_id = *(int*)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 4);
+    device_read(device_id, 0, size);
+    deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
+    kprintf("[HARDWARE] Event %lu: device read\n", event->id);
+    return 1;
+}
+
+int hardware_handle_dev_write(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [device_id:4][size:8][data:...]
+    int device_id = *(int*)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 4);
+    void* data = event->data + 12;
+    device_write(device_id, data, size);
+    deck_complete(entry, DECK_PREFIX_HARDWARE, 0);
+    kprintf("[HARDWARE] Event %lu: device write\n", event->id);
+    return 1;
+}
+
+// Диагностика route DAG (EVENT_SYS_PROBE)
+int hardware_handle_sys_probe(RoutingEntry* entry) {
+    return deck_complete_probe(entry, DECK_PREFIX_HARDWARE);
 }
 
 // ============================================================================
@@ -238,17 +251,11 @@ void hardware_deck_init(void) {
         timers[i].active = 0;
     }
 
-    deck_init(&hardware_deck_context, "Hardware", DECK_PREFIX_HARDWARE, hardware_deck_process);
+    deck_init(&hardware_deck_context, "Hardware", DECK_PREFIX_HARDWARE, timer_check_expired,
+              HARDWARE_DECK_WORKERS);
 }
 
 int hardware_deck_run_once(void) {
-    // Проверяем истёкшие таймеры
-    timer_check_expired();
-
-    // Обрабатываем события
+    // Истёкшие таймеры проверяет worker 0 (poll_func) - и на AP ядре
     return deck_run_once(&hardware_deck_context);
 }
-
-void hardware_deck_run(void) {
-    deck_run(&hardware_deck_context);
-}
@@ -1,8 +1,12 @@
 #include "deck_interface.h"
+#include "deck_handlers.h"
 #include "pmm.h"  // Physical memory manager
 #include "vmm.h"  // Virtual memory manager
 #include "klib.h"
 #include "../storage/tagfs.h"  // TagFS - Tag-based filesystem
+#include "../payload/payload_arena.h"  // Out-of-line результаты
+#include "../core/user_buffers.h"  // Зарегистрированные user буферы
+#include "../core/task_rings.h"    // Контекст задачи для регистрации буфера
 
 // ============================================================================
 // STORAGE DECK - Memory & Filesystem Operations
@@ -28,7 +32,14 @@ typedef struct {
 // Глобальная таблица открытых файлов
 #define MAX_OPEN_FILES 256
 static FileDescriptor fd_table[MAX_OPEN_FILES];
-static spinlock_t fd_table_lock;
+
+// fd table и TagFS. У Storage несколько workers, а TagFS (bitmap блоков,
+// inodes, tag index) и позиция fd не рассчитаны на параллельные вызовы:
+// каждый файловый handler держит lock на всю операцию (fs_open - поиск и
+// создание одной операцией). Memory handlers идут без него - пока один
+// worker занят TagFS, остальные разбирают их. Порядок операций над одним
+// fd задаёт цепочка (EVENT_FLAG_LINK), а не очередь deck'а
+static spinlock_t storage_fs_lock;
 
 // Глобальный счетчик FD
 static volatile uint64_t next_fd = 100;
@@ -75,9 +86,8 @@ static void memory_free(void* addr, uint64_t size) {
 // FILE DESCRIPTOR TABLE MANAGEMENT
 // ============================================================================
 
+// allocate_fd / find_fd / free_fd - под storage_fs_lock
 static int allocate_fd(uint64_t inode_id, const char* path, int flags) {
-    spin_lock(&fd_table_lock);
-
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         if (!fd_table[i].in_use) {
             // Found free slot
@@ -99,46 +109,37 @@ static int allocate_fd(uint64_t inode_id, const char* path, int flags) {
             FileInode* inode = tagfs_get_inode(inode_id);
             fd_table[i].size = inode ? inode->size : 0;
 
-            int fd = fd_table[i].fd;
-            spin_unlock(&fd_table_lock);
-            return fd;
+            return fd_table[i].fd;
         }
     }
 
-    spin_unlock(&fd_table_lock);
     return -1;  // No free slots
 }
 
 static FileDescriptor* find_fd(int fd) {
-    spin_lock(&fd_table_lock);
-
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         if (fd_table[i].in_use && fd_table[i].fd == fd) {
-            spin_unlock(&fd_table_lock);
             return &fd_table[i];
         }
     }
 
-    spin_unlock(&fd_table_lock);
     return NULL;  // Not found
 }
 
 static void free_fd(int fd) {
-    spin_lock(&fd_table_lock);
-
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         if (fd_table[i].in_use && fd_table[i].fd == fd) {
             fd_table[i].in_use = 0;
             break;
         }
     }
-
-    spin_unlock(&fd_table_lock);
 }
 
 // ============================================================================
 // REAL FILESYSTEM OPERATIONS - Using TagFS!
 // ============================================================================
+//
+// fs_* вызываются под storage_fs_lock (см. handlers ниже)
 
 // Open file: search by name tag, return FD
 static int fs_open(const char* path) {
@@ -152,7 +153,7 @@ static int fs_open(const char* path) {
 
     int ret = tagfs_query_single(&search_tag, result_inodes, &count, 10);
 
-    if (ret == 0 && count > 0) {
+    if (ret && count > 0) {
         // Found file - open first match
         uint64_t inode_id = result_inodes[0];
         int fd = allocate_fd(inode_id, path, 0);  // flags=0 for now
@@ -231,6 +232,67 @@ static int fs_read(int fd, void* buffer, uint64_t size) {
     }
 }
 
+// Read/write через зарегистрированный буфер: TagFS копирует прямо в
+// страницы задачи, по физически непрерывным кускам
+static int fs_read_fixed(int fd, UserBuffer* buffer, uint64_t offset, uint64_t size) {
+    FileDescriptor* fd_info = find_fd(fd);
+    if (!fd_info) {
+        kprintf("[STORAGE] ERROR: Read: invalid fd=%d\n", fd);
+        return -1;
+    }
+
+    uint64_t done = 0;
+    while (done < size) {
+        uint64_t contig;
+        uint8_t* span = (uint8_t*)user_buffers_span(buffer, offset + done, &contig);
+        uint64_t chunk = contig < size - done ? contig : size - done;
+
+        int bytes_read = tagfs_read_file(fd_info->inode_id, fd_info->position, span, chunk);
+        if (bytes_read < 0) {
+            return done ? (int)done : -1;
+        }
+        fd_info->position += bytes_read;
+        done += bytes_read;
+        if ((uint64_t)bytes_read < chunk) {
+            break;  // EOF
+        }
+    }
+    atomic_fetch_add_u64(&user_buffer_stats.bytes_read, done);
+    return (int)done;
+}
+
+static int fs_write_fixed(int fd, UserBuffer* buffer, uint64_t offset, uint64_t size) {
+    FileDescriptor* fd_info = find_fd(fd);
+    if (!fd_info) {
+        kprintf("[STORAGE] ERROR: Write: invalid fd=%d\n", fd);
+        return -1;
+    }
+
+    uint64_t done = 0;
+    while (done < size) {
+        uint64_t contig;
+        const uint8_t* span = (const uint8_t*)user_buffers_span(buffer, offset + done, &contig);
+        uint64_t chunk = contig < size - done ? contig : size - done;
+
+        int bytes_written = tagfs_write_file(fd_info->inode_id, fd_info->position, span, chunk);
+        if (bytes_written < 0) {
+            return done ? (int)done : -1;
+        }
+        fd_info->position += bytes_written;
+        done += bytes_written;
+        if ((uint64_t)bytes_written < chunk) {
+            break;  // Нет места
+        }
+    }
+
+    FileInode* inode = tagfs_get_inode(fd_info->inode_id);
+    if (inode) {
+        fd_info->size = inode->size;
+    }
+    atomic_fetch_add_u64(&user_buffer_stats.bytes_written, done);
+    return (int)done;
+}
+
 // Write to file: use TagFS
 static int fs_write(int fd, const void* buffer, uint64_t size) {
     FileDescriptor* fd_info = find_fd(fd);
@@ -278,7 +340,7 @@ static int fs_stat(const char* path, FileStat* stat_buf) {
 
     int ret = tagfs_query_single(&search_tag, result_inodes, &count, 10);
 
-    if (ret == 0 && count > 0) {
+    if (ret && count > 0) {
         // Found file - get inode info
         uint64_t inode_id = result_inodes[0];
         FileInode* inode = tagfs_get_inode(inode_id);
@@ -306,295 +368,436 @@ static int fs_stat(const char* path, FileStat* stat_buf) {
 }
 
 // ============================================================================
-// PROCESSING FUNCTION
+// HANDLERS (dispatch через event_registry)
 // ============================================================================
 
-int storage_deck_process(RoutingEntry* entry) {
+// === MEMORY OPERATIONS ===
+
+int storage_handle_memory_alloc(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    uint64_t size = *(uint64_t*)event->data;
+    void* addr = memory_alloc(size);
+
+    if (addr) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, addr);
+        kprintf("[STORAGE] Event %lu: allocated %lu bytes\n",
+                event->id, size);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 1);
+        kprintf("[STORAGE] Event %lu: allocation failed\n", event->id);
+        return 0;
+    }
+}
+
+int storage_handle_memory_free(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    void* addr = *(void**)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 8);
+    memory_free(addr, size);
+    deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+    kprintf("[STORAGE] Event %lu: freed memory at %p\n", event->id, addr);
+    return 1;
+}
+
+int storage_handle_memory_register(RoutingEntry* entry) {
     Event* event = &entry->event_copy;
 
-    switch (event->type) {
-        // === MEMORY OPERATIONS ===
-        case EVENT_MEMORY_ALLOC: {
-            uint64_t size = *(uint64_t*)event->data;
-            void* addr = memory_alloc(size);
-
-            if (addr) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, addr);
-                kprintf("[STORAGE] Event %lu: allocated %lu bytes\n",
-                        event->id, size);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 1);
-                kprintf("[STORAGE] Event %lu: allocation failed\n", event->id);
-                return 0;
+    // Payload: [size:8][addr:8] (size первым - его проверяет Security)
+    uint64_t size = *(uint64_t*)event->data;
+    uintptr_t addr = *(uint64_t*)(event->data + 8);
+
+    uint32_t ring_id = event_ring_id(event->flags);
+    TaskRingPair* pair = task_rings_get(ring_id);
+    vmm_context_t* ctx = pair ? task_ring_slots[ring_id].context : 0;
+
+    uint32_t error = 0;
+    uint32_t id = user_buffers_register(ring_id, event->user_id, ctx, addr, size, &error);
+    if (id == USER_BUFFER_NONE) {
+        kprintf("[STORAGE] Event %lu: buffer %p (%lu bytes) not registered (error %u)\n",
+                event->id, (void*)addr, size, error);
+        deck_error(entry, DECK_PREFIX_STORAGE, error);
+        return 0;
+    }
+
+    deck_complete(entry, DECK_PREFIX_STORAGE, (void*)(uint64_t)id);
+    kprintf("[STORAGE] Event %lu: registered buffer %u (%p, %lu bytes)\n",
+            event->id, id, (void*)addr, size);
+    return 1;
+}
+
+int storage_handle_memory_unregister(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [buffer id:4]
+    uint32_t id = *(uint32_t*)event->data;
+    uint32_t error = user_buffers_unregister(event_ring_id(event->flags), event->user_id, id);
+    if (error) {
+        deck_error(entry, DECK_PREFIX_STORAGE, error);
+        return 0;
+    }
+
+    deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+    return 1;
+}
+
+int storage_handle_memory_map(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [size:8][flags:4][fd:4] (fd can be -1 for anonymous mapping)
+    uint64_t size = *(uint64_t*)event->data;
+    uint32_t flags = *(uint32_t*)(event->data + 8);
+    int fd = *(int*)(event->data + 12);
+
+    // Real memory mapping implementation
+    // For now, implement anonymous mapping (fd == -1)
+    // File-backed mapping can be added later
+
+    if (fd == -1) {
+        // Anonymous mapping - allocate virtual memory
+        void* mapped_addr = vmalloc(size);
+
+        if (mapped_addr) {
+            // Zero-initialize if requested
+            if (flags & 0x01) {  // MAP_ZERO flag
+                memset(mapped_addr, 0, size);
             }
-        }
 
-        case EVENT_MEMORY_FREE: {
-            void* addr = *(void**)event->data;
-            uint64_t size = *(uint64_t*)(event->data + 8);
-            memory_free(addr, size);
-            deck_complete(entry, DECK_PREFIX_STORAGE, 0);
-            kprintf("[STORAGE] Event %lu: freed memory at %p\n", event->id, addr);
+            kprintf("[STORAGE] Memory mapped %lu bytes at %p (anonymous)\n",
+                    size, mapped_addr);
+            deck_complete(entry, DECK_PREFIX_STORAGE, mapped_addr);
             return 1;
+        } else {
+            kprintf("[STORAGE] ERROR: Memory mapping failed for %lu bytes\n", size);
+            deck_error(entry, DECK_PREFIX_STORAGE, 9);
+            return 0;
         }
+    } else {
+        // File-backed mapping - TODO: implement later
+        kprintf("[STORAGE] ERROR: File-backed memory mapping not yet supported (fd=%d)\n", fd);
+        deck_error(entry, DECK_PREFIX_STORAGE, 10);
+        return 0;
+    }
+}
 
-        case EVENT_MEMORY_MAP: {
-            // Payload: [size:8][flags:4][fd:4] (fd can be -1 for anonymous mapping)
-            uint64_t size = *(uint64_t*)event->data;
-            uint32_t flags = *(uint32_t*)(event->data + 8);
-            int fd = *(int*)(event->data + 12);
-
-            // Real memory mapping implementation
-            // For now, implement anonymous mapping (fd == -1)
-            // File-backed mapping can be added later
-
-            if (fd == -1) {
-                // Anonymous mapping - allocate virtual memory
-                void* mapped_addr = vmalloc(size);
-
-                if (mapped_addr) {
-                    // Zero-initialize if requested
-                    if (flags & 0x01) {  // MAP_ZERO flag
-                        memset(mapped_addr, 0, size);
-                    }
-
-                    kprintf("[STORAGE] Memory mapped %lu bytes at %p (anonymous)\n",
-                            size, mapped_addr);
-                    deck_complete(entry, DECK_PREFIX_STORAGE, mapped_addr);
-                    return 1;
-                } else {
-                    kprintf("[STORAGE] ERROR: Memory mapping failed for %lu bytes\n", size);
-                    deck_error(entry, DECK_PREFIX_STORAGE, 9);
-                    return 0;
-                }
-            } else {
-                // File-backed mapping - TODO: implement later
-                kprintf("[STORAGE] ERROR: File-backed memory mapping not yet supported (fd=%d)\n", fd);
-                deck_error(entry, DECK_PREFIX_STORAGE, 10);
-                return 0;
-            }
-        }
+// === FILESYSTEM OPERATIONS ===
 
-        // === FILESYSTEM OPERATIONS ===
-        case EVENT_FILE_OPEN: {
-            const char* path = (const char*)event->data;
-            int fd = fs_open(path);
-
-            if (fd >= 0) {
-                // Return FD as result
-                int* fd_result = (int*)kmalloc(sizeof(int));
-                *fd_result = fd;
-                deck_complete(entry, DECK_PREFIX_STORAGE, fd_result);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 2);
-                return 0;
-            }
-        }
+int storage_handle_file_open(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
 
-        case EVENT_FILE_CLOSE: {
-            int fd = *(int*)event->data;
-            int result = fs_close(fd);
+    const char* path = (const char*)event->data;
+    spin_lock(&storage_fs_lock);
+    int fd = fs_open(path);
+    spin_unlock(&storage_fs_lock);
 
-            if (result == 0) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, 0);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 3);
-                return 0;
-            }
-        }
+    if (fd >= 0) {
+        // Return FD as result (inline в Response)
+        deck_complete(entry, DECK_PREFIX_STORAGE, (void*)(uint64_t)fd);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 2);
+        return 0;
+    }
+}
 
-        case EVENT_FILE_READ: {
-            // Payload: [fd:4 bytes][size:8 bytes]
-            int fd = *(int*)event->data;
-            uint64_t size = *(uint64_t*)(event->data + 4);
+int storage_handle_file_close(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
 
-            // Allocate buffer and read
-            uint8_t* buffer = (uint8_t*)kmalloc(size);
-            if (!buffer) {
-                deck_error(entry, DECK_PREFIX_STORAGE, 4);
-                return 0;
-            }
+    int fd = *(int*)event->data;
+    spin_lock(&storage_fs_lock);
+    int result = fs_close(fd);
+    spin_unlock(&storage_fs_lock);
 
-            int bytes_read = fs_read(fd, buffer, size);
-            if (bytes_read >= 0) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, buffer);
-                return 1;
-            } else {
-                kfree(buffer);
-                deck_error(entry, DECK_PREFIX_STORAGE, 5);
-                return 0;
-            }
-        }
+    if (result == 0) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 3);
+        return 0;
+    }
+}
 
-        case EVENT_FILE_WRITE: {
-            // Payload: [fd:4 bytes][size:8 bytes][data:...]
-            int fd = *(int*)event->data;
-            uint64_t size = *(uint64_t*)(event->data + 4);
-            void* data = event->data + 12;
-
-            // Real write
-            int bytes_written = fs_write(fd, data, size);
-            if (bytes_written >= 0) {
-                int* result = (int*)kmalloc(sizeof(int));
-                *result = bytes_written;
-                deck_complete(entry, DECK_PREFIX_STORAGE, result);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 6);
-                return 0;
-            }
-        }
+// FILE_READ / FILE_WRITE с EVENT_FLAG_FIXED_BUF:
+// [fd:4][size:8][buffer id:4][buffer offset:8], результат inline - байт
+static int storage_handle_file_fixed(RoutingEntry* entry, int write) {
+    Event* event = &entry->event_copy;
 
-        case EVENT_FILE_STAT: {
-            const char* path = (const char*)event->data;
+    int fd = *(int*)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 4);
+    uint32_t id = *(uint32_t*)(event->data + 12);
+    uint64_t offset = *(uint64_t*)(event->data + 16);
 
-            // Allocate stat buffer to return to caller
-            FileStat* stat_buf = (FileStat*)kmalloc(sizeof(FileStat));
-            if (!stat_buf) {
-                kprintf("[STORAGE] ERROR: Failed to allocate stat buffer\n");
-                deck_error(entry, DECK_PREFIX_STORAGE, 7);
-                return 0;
-            }
+    UserBuffer* buffer = user_buffers_get(event_ring_id(event->flags), event->user_id,
+                                          id, offset, size);
+    if (!buffer) {
+        deck_error(entry, DECK_PREFIX_STORAGE, USER_BUFFER_ERROR_ID);
+        return 0;
+    }
 
-            // Real stat implementation
-            int ret = fs_stat(path, stat_buf);
-            if (ret == 0) {
-                // Success - return stat buffer
-                deck_complete(entry, DECK_PREFIX_STORAGE, stat_buf);
-                return 1;
-            } else {
-                // Failed - free buffer and return error
-                kfree(stat_buf);
-                deck_error(entry, DECK_PREFIX_STORAGE, 8);  // File not found
-                return 0;
-            }
-        }
+    spin_lock(&storage_fs_lock);
+    int bytes = write ? fs_write_fixed(fd, buffer, offset, size) :
+                        fs_read_fixed(fd, buffer, offset, size);
+    spin_unlock(&storage_fs_lock);
+    user_buffers_put(buffer);
 
-        // === TAGFS OPERATIONS ===
-        case EVENT_FILE_CREATE_TAGGED: {
-            // Payload: [tag_count:4][tags:Tag[]...]
-            uint32_t tag_count = *(uint32_t*)event->data;
-            Tag* tags = (Tag*)(event->data + 4);
-
-            // TODO: Get actual user_id from event sender
-            uint32_t owner_id = 0;  // Wizard for now
-            uint32_t capabilities = TAGFS_CAP_DEFAULT;
-            uint8_t access_scope = TAGFS_ACCESS_PUBLIC;
-
-            uint64_t inode_id = tagfs_create_file(tags, tag_count, owner_id, capabilities, access_scope);
-            if (inode_id != TAGFS_INVALID_INODE) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, (void*)inode_id);
-                kprintf("[STORAGE] Event %lu: created file inode=%lu with %u tags\n",
-                        event->id, inode_id, tag_count);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 10);
-                kprintf("[STORAGE] Event %lu: failed to create tagged file\n", event->id);
-                return 0;
-            }
-        }
+    if (bytes >= 0) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, (void*)(uint64_t)bytes);
+        return 1;
+    }
+    deck_error(entry, DECK_PREFIX_STORAGE, write ? 6 : 5);
+    return 0;
+}
 
-        case EVENT_FILE_QUERY: {
-            // Payload: [tag_count:4][operator:1][tags:Tag[]...]
-            uint32_t tag_count = *(uint32_t*)event->data;
-            uint8_t op = *(uint8_t*)(event->data + 4);
-            Tag* tags = (Tag*)(event->data + 8);
-
-            // Allocate result arrays
-            uint64_t* result_inodes = (uint64_t*)kmalloc(256 * sizeof(uint64_t));
-            TagQuery query;
-            query.tags = tags;
-            query.tag_count = tag_count;
-            query.op = (QueryOperator)op;
-            query.result_inodes = result_inodes;
-            query.result_count = 0;
-            query.result_capacity = 256;
-
-            int success = tagfs_query(&query);
-            if (success) {
-                // Pass results back (will be in Response)
-                deck_complete(entry, DECK_PREFIX_STORAGE, result_inodes);
-                kprintf("[STORAGE] Event %lu: query found %u files\n",
-                        event->id, query.result_count);
-                return 1;
-            } else {
-                kfree(result_inodes);
-                deck_error(entry, DECK_PREFIX_STORAGE, 11);
-                kprintf("[STORAGE] Event %lu: query failed\n", event->id);
-                return 0;
-            }
-        }
+int storage_handle_file_read(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+    if (event->flags & EVENT_FLAG_FIXED_BUF) {
+        return storage_handle_file_fixed(entry, 0);
+    }
 
-        case EVENT_FILE_TAG_ADD: {
-            // Payload: [inode_id:8][tag:Tag]
-            uint64_t inode_id = *(uint64_t*)event->data;
-            Tag* tag = (Tag*)(event->data + 8);
-
-            int success = tagfs_add_tag(inode_id, tag);
-            if (success) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, 0);
-                kprintf("[STORAGE] Event %lu: added tag %s:%s to inode=%lu\n",
-                        event->id, tag->key, tag->value, inode_id);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 12);
-                kprintf("[STORAGE] Event %lu: failed to add tag to inode=%lu\n",
-                        event->id, inode_id);
-                return 0;
-            }
-        }
+    // Payload: [fd:4 bytes][size:8 bytes]
+    int fd = *(int*)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 4);
 
-        case EVENT_FILE_TAG_REMOVE: {
-            // Payload: [inode_id:8][key:32]
-            uint64_t inode_id = *(uint64_t*)event->data;
-            const char* key = (const char*)(event->data + 8);
-
-            int success = tagfs_remove_tag(inode_id, key);
-            if (success) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, 0);
-                kprintf("[STORAGE] Event %lu: removed tag '%s' from inode=%lu\n",
-                        event->id, key, inode_id);
-                return 1;
-            } else {
-                deck_error(entry, DECK_PREFIX_STORAGE, 13);
-                kprintf("[STORAGE] Event %lu: failed to remove tag from inode=%lu\n",
-                        event->id, inode_id);
-                return 0;
-            }
-        }
+    if (size == 0) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+        return 1;
+    }
+    if (size > PAYLOAD_MAX_SIZE) {
+        size = PAYLOAD_MAX_SIZE;  // Короткое чтение, result_size покажет сколько
+    }
 
-        case EVENT_FILE_TAG_GET: {
-            // Payload: [inode_id:8]
-            uint64_t inode_id = *(uint64_t*)event->data;
-
-            Tag* tags = (Tag*)kmalloc(TAGFS_MAX_TAGS_PER_FILE * sizeof(Tag));
-            uint32_t count = 0;
-
-            int success = tagfs_get_tags(inode_id, tags, &count);
-            if (success) {
-                deck_complete(entry, DECK_PREFIX_STORAGE, tags);
-                kprintf("[STORAGE] Event %lu: retrieved %u tags from inode=%lu\n",
-                        event->id, count, inode_id);
-                return 1;
-            } else {
-                kfree(tags);
-                deck_error(entry, DECK_PREFIX_STORAGE, 14);
-                kprintf("[STORAGE] Event %lu: failed to get tags from inode=%lu\n",
-                        event->id, inode_id);
-                return 0;
-            }
-        }
+    // Читаем прямо в payload arena (без промежуточного буфера)
+    uint32_t payload = payload_arena_alloc(size);
+    if (payload == PAYLOAD_OFFSET_NONE) {
+        deck_error(entry, DECK_PREFIX_STORAGE, 4);
+        return 0;
+    }
 
-        default:
-            kprintf("[STORAGE] Unknown event type %d\n", event->type);
-            deck_error(entry, DECK_PREFIX_STORAGE, 3);
-            return 0;
+    spin_lock(&storage_fs_lock);
+    int bytes_read = fs_read(fd, payload_arena_ptr(payload), size);
+    spin_unlock(&storage_fs_lock);
+    if (bytes_read >= 0) {
+        deck_complete_payload(entry, DECK_PREFIX_STORAGE, payload, (uint32_t)bytes_read);
+        return 1;
+    } else {
+        payload_arena_release(payload);
+        deck_error(entry, DECK_PREFIX_STORAGE, 5);
+        return 0;
+    }
+}
+
+int storage_handle_file_write(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+    if (event->flags & EVENT_FLAG_FIXED_BUF) {
+        return storage_handle_file_fixed(entry, 1);
+    }
+
+    // Payload: [fd:4 bytes][size:8 bytes][data:...]
+    int fd = *(int*)event->data;
+    uint64_t size = *(uint64_t*)(event->data + 4);
+    void* data = event->data + 12;
+
+    // Real write
+    spin_lock(&storage_fs_lock);
+    int bytes_written = fs_write(fd, data, size);
+    spin_unlock(&storage_fs_lock);
+    if (bytes_written >= 0) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, (void*)(uint64_t)bytes_written);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 6);
+        return 0;
+    }
+}
+
+int storage_handle_file_stat(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    const char* path = (const char*)event->data;
+
+    // Stat buffer в payload arena - его получит caller
+    uint32_t payload = payload_arena_alloc(sizeof(FileStat));
+    if (payload == PAYLOAD_OFFSET_NONE) {
+        kprintf("[STORAGE] ERROR: Failed to allocate stat buffer\n");
+        deck_error(entry, DECK_PREFIX_STORAGE, 7);
+        return 0;
+    }
+
+    // Real stat implementation
+    spin_lock(&storage_fs_lock);
+    int ret = fs_stat(path, (FileStat*)payload_arena_ptr(payload));
+    spin_unlock(&storage_fs_lock);
+    if (ret == 0) {
+        // Success - return stat buffer
+        deck_complete_payload(entry, DECK_PREFIX_STORAGE, payload, sizeof(FileStat));
+        return 1;
+    } else {
+        // Failed - free buffer and return error
+        payload_arena_release(payload);
+        deck_error(entry, DECK_PREFIX_STORAGE, 8);  // File not found
+        return 0;
     }
 }
 
+// === TAGFS OPERATIONS ===
+
+int storage_handle_file_create_tagged(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [tag_count:4][tags:Tag[]...]
+    uint32_t tag_count = *(uint32_t*)event->data;
+    Tag* tags = (Tag*)(event->data + 4);
+
+    // TODO: Get actual user_id from event sender
+    uint32_t owner_id = 0;  // Wizard for now
+    uint32_t capabilities = TAGFS_CAP_DEFAULT;
+    uint8_t access_scope = TAGFS_ACCESS_PUBLIC;
+
+    spin_lock(&storage_fs_lock);
+    uint64_t inode_id = tagfs_create_file(tags, tag_count, owner_id, capabilities, access_scope);
+    spin_unlock(&storage_fs_lock);
+    if (inode_id != TAGFS_INVALID_INODE) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, (void*)inode_id);
+        kprintf("[STORAGE] Event %lu: created file inode=%lu with %u tags\n",
+                event->id, inode_id, tag_count);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 10);
+        kprintf("[STORAGE] Event %lu: failed to create tagged file\n", event->id);
+        return 0;
+    }
+}
+
+int storage_handle_file_query(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [tag_count:4][operator:1][tags:Tag[]...]
+    uint32_t tag_count = *(uint32_t*)event->data;
+    uint8_t op = *(uint8_t*)(event->data + 4);
+    Tag* tags = (Tag*)(event->data + 8);
+
+    // Payload: [result_count:4][reserved:4][inodes:8 * result_count]
+    uint32_t payload = payload_arena_alloc(8 + 256 * sizeof(uint64_t));
+    if (payload == PAYLOAD_OFFSET_NONE) {
+        deck_error(entry, DECK_PREFIX_STORAGE, 11);
+        return 0;
+    }
+    uint8_t* payload_ptr = (uint8_t*)payload_arena_ptr(payload);
+    uint64_t* result_inodes = (uint64_t*)(payload_ptr + 8);
+    TagQuery query;
+    query.tags = tags;
+    query.tag_count = tag_count;
+    query.op = (QueryOperator)op;
+    query.result_inodes = result_inodes;
+    query.result_count = 0;
+    query.result_capacity = 256;
+
+    spin_lock(&storage_fs_lock);
+    int success = tagfs_query(&query);
+    spin_unlock(&storage_fs_lock);
+    if (success) {
+        // Pass results back (payload arena -> Response.payload_offset)
+        *(uint32_t*)payload_ptr = query.result_count;
+        deck_complete_payload(entry, DECK_PREFIX_STORAGE, payload,
+                              8 + query.result_count * sizeof(uint64_t));
+        kprintf("[STORAGE] Event %lu: query found %u files\n",
+                event->id, query.result_count);
+        return 1;
+    } else {
+        payload_arena_release(payload);
+        deck_error(entry, DECK_PREFIX_STORAGE, 11);
+        kprintf("[STORAGE] Event %lu: query failed\n", event->id);
+        return 0;
+    }
+}
+
+int storage_handle_file_tag_add(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [inode_id:8][tag:Tag]
+    uint64_t inode_id = *(uint64_t*)event->data;
+    Tag* tag = (Tag*)(event->data + 8);
+
+    spin_lock(&storage_fs_lock);
+    int success = tagfs_add_tag(inode_id, tag);
+    spin_unlock(&storage_fs_lock);
+    if (success) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+        kprintf("[STORAGE] Event %lu: added tag %s:%s to inode=%lu\n",
+                event->id, tag->key, tag->value, inode_id);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 12);
+        kprintf("[STORAGE] Event %lu: failed to add tag to inode=%lu\n",
+                event->id, inode_id);
+        return 0;
+    }
+}
+
+int storage_handle_file_tag_remove(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [inode_id:8][key:32]
+    uint64_t inode_id = *(uint64_t*)event->data;
+    const char* key = (const char*)(event->data + 8);
+
+    spin_lock(&storage_fs_lock);
+    int success = tagfs_remove_tag(inode_id, key);
+    spin_unlock(&storage_fs_lock);
+    if (success) {
+        deck_complete(entry, DECK_PREFIX_STORAGE, 0);
+        kprintf("[STORAGE] Event %lu: removed tag '%s' from inode=%lu\n",
+                event->id, key, inode_id);
+        return 1;
+    } else {
+        deck_error(entry, DECK_PREFIX_STORAGE, 13);
+        kprintf("[STORAGE] Event %lu: failed to remove tag from inode=%lu\n",
+                event->id, inode_id);
+        return 0;
+    }
+}
+
+int storage_handle_file_tag_get(RoutingEntry* entry) {
+    Event* event = &entry->event_copy;
+
+    // Payload: [inode_id:8]
+    uint64_t inode_id = *(uint64_t*)event->data;
+
+    // Payload: [count:4][reserved:4][tags:Tag * count]
+    uint32_t payload = payload_arena_alloc(8 + TAGFS_MAX_TAGS_PER_FILE * sizeof(Tag));
+    if (payload == PAYLOAD_OFFSET_NONE) {
+        deck_error(entry, DECK_PREFIX_STORAGE, 14);
+        return 0;
+    }
+    uint8_t* payload_ptr = (uint8_t*)payload_arena_ptr(payload);
+    Tag* tags = (Tag*)(payload_ptr + 8);
+    uint32_t count = 0;
+
+    spin_lock(&storage_fs_lock);
+    int success = tagfs_get_tags(inode_id, tags, &count);
+    spin_unlock(&storage_fs_lock);
+    if (success) {
+        *(uint32_t*)payload_ptr = count;
+        deck_complete_payload(entry, DECK_PREFIX_STORAGE, payload, 8 + count * sizeof(Tag));
+        kprintf("[STORAGE] Event %lu: retrieved %u tags from inode=%lu\n",
+                event->id, count, inode_id);
+        return 1;
+    } else {
+        payload_arena_release(payload);
+        deck_error(entry, DECK_PREFIX_STORAGE, 14);
+        kprintf("[STORAGE] Event %lu: failed to get tags from inode=%lu\n",
+                event->id, inode_id);
+        return 0;
+    }
+}
+
+// Диагностика route DAG (EVENT_SYS_PROBE)
+int storage_handle_sys_probe(RoutingEntry* entry) {
+    return deck_complete_probe(entry, DECK_PREFIX_STORAGE);
+}
+
 // ============================================================================
 // INITIALIZATION & RUN
 // ============================================================================
@@ -602,11 +805,12 @@ int storage_deck_process(RoutingEntry* entry) {
 DeckContext storage_deck_context;
 
 void storage_deck_init(void) {
-    deck_init(&storage_deck_context, "Storage", DECK_PREFIX_STORAGE, storage_deck_process);
+    deck_init(&storage_deck_context, "Storage", DECK_PREFIX_STORAGE, 0,
+              STORAGE_DECK_WORKERS);
 
     // Initialize FD table
     memset(fd_table, 0, sizeof(fd_table));
-    spinlock_init(&fd_table_lock);
+    spinlock_init(&storage_fs_lock);
     kprintf("[STORAGE] FD table initialized (%d slots)\n", MAX_OPEN_FILES);
 
     // Initialize TagFS
@@ -617,7 +821,3 @@ void storage_deck_init(void) {
 int storage_deck_run_once(void) {
     return deck_run_once(&storage_deck_context);
 }
-
-void storage_deck_run(void) {
-    deck_run(&storage_deck_context);
-}
@@ -0,0 +1,105 @@
+#ifndef WORK_DEQUE_H
+#define WORK_DEQUE_H
+
+#include "ktypes.h"
+#include "atomics.h"
+#include "../routing/routing_pool.h"
+
+// ============================================================================
+// WORK DEQUE - Chase-Lev work-stealing deque для deck workers
+// ============================================================================
+//
+// Владелец (worker) кладёт и забирает с bottom без lock'ов, чужие workers
+// крадут с top одним CAS. Гонка за последний элемент решается CAS на top
+// и у владельца (pop), и у вора (steal).
+//
+// x86-64 (TSO): единственный нужный fence - StoreLoad в pop между
+// записью bottom и чтением top. Ёмкость фиксирована: deque пополняется
+// только пустой, пачкой не больше WORK_DEQUE_SIZE.
+//
+// top/bottom монотонно растут, сравнения - через знаковую разность.
+//
+// ============================================================================
+
+#define WORK_DEQUE_SIZE 256
+#define WORK_DEQUE_MASK (WORK_DEQUE_SIZE - 1)
+
+_Static_assert((WORK_DEQUE_SIZE & (WORK_DEQUE_SIZE - 1)) == 0,
+               "WORK_DEQUE_SIZE must be power of 2");
+
+typedef struct {
+    volatile uint64_t top __attribute__((aligned(64)));      // Воры
+    volatile uint64_t bottom __attribute__((aligned(64)));   // Владелец
+    volatile RoutingHandle items[WORK_DEQUE_SIZE] __attribute__((aligned(64)));
+} WorkDeque;
+
+static inline void work_deque_init(WorkDeque* deque) {
+    deque->top = 0;
+    deque->bottom = 0;
+}
+
+// Приблизительный размер (для выбора наименее загруженного worker'а)
+static inline uint64_t work_deque_size(WorkDeque* deque) {
+    int64_t size = (int64_t)(atomic_load_u64(&deque->bottom) - atomic_load_u64(&deque->top));
+    return size > 0 ? (uint64_t)size : 0;
+}
+
+// Владелец: положить в bottom. 0 = deque полна
+static inline int work_deque_push(WorkDeque* deque, RoutingHandle handle) {
+    uint64_t b = deque->bottom;
+    uint64_t t = atomic_load_u64(&deque->top);
+    if ((int64_t)(b - t) >= WORK_DEQUE_SIZE) {
+        return 0;
+    }
+
+    deque->items[b & WORK_DEQUE_MASK] = handle;
+    COMPILER_BARRIER();
+    atomic_store_u64(&deque->bottom, b + 1);
+    return 1;
+}
+
+// Владелец: забрать из bottom (LIFO)
+static inline RoutingHandle work_deque_pop(WorkDeque* deque) {
+    uint64_t b = deque->bottom - 1;
+    deque->bottom = b;
+    MEMORY_BARRIER();  // StoreLoad: вор должен увидеть новый bottom
+    uint64_t t = deque->top;
+
+    if ((int64_t)(b - t) < 0) {
+        // Пусто
+        deque->bottom = b + 1;
+        return ROUTING_HANDLE_NONE;
+    }
+
+    RoutingHandle handle = deque->items[b & WORK_DEQUE_MASK];
+    if (b != t) {
+        return handle;  // Больше одного элемента - воры сюда не дотянутся
+    }
+
+    // Последний элемент: соревнуемся с ворами за top
+    if (!atomic_cas_u64(&deque->top, t, t + 1)) {
+        handle = ROUTING_HANDLE_NONE;
+    }
+    deque->bottom = b + 1;
+    return handle;
+}
+
+// Вор: забрать из top (самый старый элемент).
+// ROUTING_HANDLE_NONE = пусто или проиграли гонку
+static inline RoutingHandle work_deque_steal(WorkDeque* deque) {
+    uint64_t t = atomic_load_u64(&deque->top);
+    COMPILER_BARRIER();  // LoadLoad (на x86 порядок load'ов сохраняется)
+    uint64_t b = atomic_load_u64(&deque->bottom);
+
+    if ((int64_t)(b - t) <= 0) {
+        return ROUTING_HANDLE_NONE;
+    }
+
+    RoutingHandle handle = deque->items[t & WORK_DEQUE_MASK];
+    if (!atomic_cas_u64(&deque->top, t, t + 1)) {
+        return ROUTING_HANDLE_NONE;
+    }
+    return handle;
+}
+
+#endif // WORK_DEQUE_H
@@ -124,6 +124,7 @@ void eventdriven_demo_run(void) {
         } else {
             kprintf("[DEMO] FAILED: status=%d\n", resp1->status);
         }
+        eventapi_release_response(resp1);
     } else {
         kprintf("[DEMO] Response not ready yet (would continue polling in real app)\n");
     }
@@ -149,10 +150,11 @@ void eventdriven_demo_run(void) {
 
     if (resp2) {
         if (resp2->status == EVENT_STATUS_SUCCESS) {
-            kprintf("[DEMO] SUCCESS! File opened\n");
+            kprintf("[DEMO] SUCCESS! File opened (fd=%d)\n", *(int*)resp2->result);
         } else {
             kprintf("[DEMO] FAILED\n");
         }
+        eventapi_release_response(resp2);
     } else {
         kprintf("[DEMO] Response not ready yet\n");
     }
@@ -180,6 +182,37 @@ void eventdriven_demo_run(void) {
 
     kprintf("\n");
 
+    // ========================================================================
+    // ТЕСТ 3b: Fan-out Route (route DAG)
+    // ========================================================================
+
+    kprintf("--- TEST 3b: Parallel Fan-out Route ---\n");
+    kprintf("[DEMO] Submitting SYS_PROBE (routed to all 4 decks in one wave)...\n");
+
+    uint64_t probe_id = eventapi_sys_probe();
+    eventdriven_process_events(100);
+
+    Response* probe = eventapi_poll_response(probe_id);
+    if (probe && probe->status == EVENT_STATUS_SUCCESS) {
+        // Каждый deck вернул маску decks, в очередях которых событие
+        // лежало одновременно с ним: 0xF у всех = 4 ветки параллельно
+        uint64_t* waves = (uint64_t*)probe->result;
+        int concurrent = 1;
+        for (int i = 0; i < 4; i++) {
+            kprintf("[DEMO] Deck %d saw wave mask 0x%lx\n", i + 1, waves[i]);
+            if (waves[i] != 0xF) {
+                concurrent = 0;
+            }
+        }
+        kprintf("[DEMO] %s\n", concurrent ? "PASS: all decks ran as concurrent branches"
+                                            : "FAIL: decks ran sequentially");
+        eventapi_release_response(probe);
+    } else {
+        kprintf("[DEMO] FAIL: probe response missing\n");
+    }
+
+    kprintf("\n");
+
     // ========================================================================
     // СТАТИСТИКА
     // ========================================================================
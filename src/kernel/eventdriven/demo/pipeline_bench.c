@@ -0,0 +1,197 @@
+#include "pipeline_bench.h"
+#include "../eventdriven_system.h"
+#include "../core/latency.h"
+#include "../core/idle.h"
+#include "../payload/payload_arena.h"
+#include "../storage/tagfs.h"
+#include "pit.h"
+#include "klib.h"
+
+// ============================================================================
+// MIXES
+// ============================================================================
+
+#define BENCH_MIX_MAX_TYPES     4
+#define BENCH_USER_ID           1
+#define BENCH_STAT_PATH         "bench"
+#define BENCH_STALL_CYCLES      10000000000ULL  // Нет ответов так долго - timeout
+
+typedef struct {
+    const char* name;
+    uint32_t count;
+    uint32_t types[BENCH_MIX_MAX_TYPES];
+} BenchMix;
+
+// Только события без побочных эффектов: bench можно гонять сколько угодно
+static const BenchMix bench_mixes[] = {
+    { "getpid", 1, { EVENT_PROC_GETPID } },
+    { "ticks",  1, { EVENT_TIMER_GETTICKS } },
+    { "stat",   1, { EVENT_FILE_STAT } },
+    { "probe",  1, { EVENT_SYS_PROBE } },
+    { "mix",    4, { EVENT_PROC_GETPID, EVENT_TIMER_GETTICKS, EVENT_FILE_STAT, EVENT_SYS_PROBE } },
+};
+
+#define BENCH_MIX_COUNT (sizeof(bench_mixes) / sizeof(bench_mixes[0]))
+
+const char* pipeline_bench_mixes(void) {
+    return "getpid ticks stat probe mix";
+}
+
+static const BenchMix* bench_find_mix(const char* name) {
+    for (uint32_t i = 0; i < BENCH_MIX_COUNT; i++) {
+        if (strcmp(bench_mixes[i].name, name) == 0) {
+            return &bench_mixes[i];
+        }
+    }
+    return 0;
+}
+
+// stat меряет попадание: файл "bench" создаём один раз, до прогона
+static void bench_prepare_stat_file(void) {
+    Tag tags[2];
+    uint64_t inode;
+    uint32_t count = 0;
+
+    strcpy(tags[0].key, "name");
+    strcpy(tags[0].value, BENCH_STAT_PATH);
+    if (tagfs_query_single(&tags[0], &inode, &count, 1) && count > 0) {
+        return;
+    }
+
+    strcpy(tags[1].key, "type");
+    strcpy(tags[1].value, "bench");
+    tagfs_create_file(tags, 2, 0, TAGFS_CAP_DEFAULT, TAGFS_ACCESS_PUBLIC);
+}
+
+// ============================================================================
+// SUBMIT / DRAIN
+// ============================================================================
+
+// 0 = user→kernel ring полон (повторим после drain)
+static int bench_submit(const BenchMix* mix, uint64_t seq) {
+    uint64_t pos;
+    Event* event = event_ring_reserve(global_event_system.user_to_kernel_ring, &pos);
+    if (!event) {
+        return 0;
+    }
+
+    uint32_t type = mix->types[seq % mix->count];
+    event_init(event, type, BENCH_USER_ID);
+    if (type == EVENT_FILE_STAT) {
+        strncpy((char*)event->data, BENCH_STAT_PATH, EVENT_DATA_SIZE - 1);
+    }
+
+    event_ring_commit(global_event_system.user_to_kernel_ring, pos);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+    return 1;
+}
+
+// Забрать все готовые ответы. Возвращает сколько, ошибки - в *errors
+static uint64_t bench_drain(uint64_t* errors) {
+    uint64_t drained = 0;
+    Response response;
+
+    while (response_ring_pop(global_event_system.kernel_to_user_ring, &response)) {
+        if (response.status != EVENT_STATUS_SUCCESS) {
+            (*errors)++;
+        }
+        payload_arena_release(response.payload_offset);
+        drained++;
+    }
+    return drained;
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+static void bench_report_stages(void) {
+    LatencyHistogram hist;
+
+    for (uint32_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        latency_collect_all(&hist, stage);
+        if (hist.count == 0) {
+            continue;
+        }
+
+        kprintf("BENCH stage name=%s count=%lu avg=%lu p50=%lu p90=%lu p99=%lu max=%lu\n",
+                latency_stage_name(stage), hist.count, hist.total / hist.count,
+                latency_percentile(&hist, 50), latency_percentile(&hist, 90),
+                latency_percentile(&hist, 99), hist.max);
+    }
+}
+
+int pipeline_bench_run(uint64_t events, uint32_t depth, const char* mix_name) {
+    const BenchMix* mix = bench_find_mix(mix_name);
+    if (!mix || !global_event_system.running) {
+        kprintf("BENCH error reason=%s\n", mix ? "not-running" : "unknown-mix");
+        return -1;
+    }
+    if (events == 0) {
+        events = PIPELINE_BENCH_EVENTS;
+    }
+    if (depth == 0) {
+        depth = PIPELINE_BENCH_DEPTH;
+    }
+
+    kprintf("BENCH begin mix=%s events=%lu depth=%u cores=%u\n",
+            mix->name, events, depth, global_event_system.worker_cores);
+
+    bench_prepare_stat_file();
+
+    // Старые ответы (demo, shell) не должны попасть в счёт
+    uint64_t stale_errors = 0;
+    eventdriven_process_events(1000);
+    bench_drain(&stale_errors);
+    latency_reset();
+
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    int timed_out = 0;
+
+    kprintf_set_quiet(1);
+
+    uint64_t start_ticks = pit_get_ticks();
+    uint64_t start = rdtsc();
+    uint64_t last_progress = start;
+
+    while (completed < events) {
+        while (submitted < events && submitted - completed < depth &&
+               bench_submit(mix, submitted)) {
+            submitted++;
+        }
+
+        // Синхронный режим: pipeline крутит вызывающее ядро
+        eventdriven_process_one_iteration();
+
+        uint64_t drained = bench_drain(&errors);
+        uint64_t now = rdtsc();
+        if (drained) {
+            completed += drained;
+            last_progress = now;
+        } else if (now - last_progress > BENCH_STALL_CYCLES) {
+            timed_out = 1;
+            break;
+        }
+    }
+
+    uint64_t cycles = rdtsc() - start;
+    uint64_t ticks = pit_get_ticks() - start_ticks;
+
+    kprintf_set_quiet(0);
+
+    uint64_t per_second = 0;
+    if (ticks) {
+        per_second = completed * pit_get_frequency() / ticks;
+    }
+
+    kprintf("BENCH result events=%lu errors=%lu cycles=%lu cycles_per_event=%lu "
+            "events_per_sec=%lu ticks=%lu\n",
+            completed, errors, cycles, completed ? cycles / completed : 0,
+            per_second, ticks);
+    bench_report_stages();
+    kprintf("BENCH end status=%s\n", timed_out ? "timeout" : "ok");
+
+    return timed_out ? -1 : 0;
+}
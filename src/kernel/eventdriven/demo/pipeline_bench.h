@@ -0,0 +1,36 @@
+#ifndef PIPELINE_BENCH_H
+#define PIPELINE_BENCH_H
+
+#include "ktypes.h"
+
+// ============================================================================
+// PIPELINE BENCHMARK - поток событий через global_event_system
+// ============================================================================
+//
+// Отправляет events событий из смеси типов (mix), держа в pipeline не
+// больше depth неотвеченных. Ответы забирает прямо из kernel→user ring.
+// kprintf на время прогона выключен (per-event логи decks/Execution
+// иначе меряются вместо pipeline), latency histograms сбрасываются.
+//
+// Результат - строки "BENCH ..." (key=value) на serial/console:
+//   BENCH begin mix=... events=... depth=... cores=...
+//   BENCH result events=... errors=... cycles=... cycles_per_event=... events_per_sec=...
+//   BENCH stage name=... count=... avg=... p50=... p90=... p99=... max=...
+//   BENCH end status=ok|timeout
+//
+// Boot flag: make BENCH=1 (или make bench) - прогон с настройками по
+// умолчанию сразу после demo, без shell.
+//
+// ============================================================================
+
+#define PIPELINE_BENCH_EVENTS       10000
+#define PIPELINE_BENCH_DEPTH        32
+#define PIPELINE_BENCH_MIX          "mix"
+
+// 0 = готово, -1 = неизвестный mix / pipeline не запущен / timeout
+int pipeline_bench_run(uint64_t events, uint32_t depth, const char* mix);
+
+// Названия смесей через пробел (для usage)
+const char* pipeline_bench_mixes(void);
+
+#endif // PIPELINE_BENCH_H
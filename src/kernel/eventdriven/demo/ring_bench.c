@@ -0,0 +1,124 @@
+#include "ring_bench.h"
+#include "../core/ringbuffer.h"
+#include "klib.h"
+
+// ============================================================================
+// BENCH STATE
+// ============================================================================
+
+static EventRingBuffer bench_ring;
+
+typedef struct {
+    uint64_t push_cycles;
+    uint64_t pop_cycles;
+    uint64_t ops;
+    uint64_t order_errors;
+} RingBenchResult;
+
+// ============================================================================
+// ONE RUN: N producers, 1 consumer
+// ============================================================================
+
+static void ring_bench_one(uint32_t mode, int producers, RingBenchResult* result) {
+    uint64_t next_seq[RING_BENCH_MAX_PRODUCERS];
+    uint64_t expect_seq[RING_BENCH_MAX_PRODUCERS];
+    Event event;
+    Event out;
+
+    event_ring_init_mode(&bench_ring, mode);
+    event_init(&event, EVENT_PROC_GETPID, 1);
+
+    for (int p = 0; p < producers; p++) {
+        next_seq[p] = 0;
+        expect_seq[p] = 0;
+    }
+
+    result->push_cycles = 0;
+    result->pop_cycles = 0;
+    result->ops = 0;
+    result->order_errors = 0;
+
+    uint64_t per_producer = RING_BENCH_OPS / producers;
+    uint64_t remaining = per_producer * producers;
+
+    while (remaining > 0) {
+        // Producers по очереди кладут пачки событий
+        uint64_t t0 = rdtsc();
+        uint64_t pushed = 0;
+        for (int p = 0; p < producers; p++) {
+            for (int b = 0; b < RING_BENCH_BURST && next_seq[p] < per_producer; b++) {
+                event.user_id = p + 1;
+                event.id = next_seq[p];
+                if (!event_ring_push(&bench_ring, &event)) {
+                    break;
+                }
+                next_seq[p]++;
+                pushed++;
+            }
+        }
+        uint64_t t1 = rdtsc();
+
+        // Consumer забирает всё и проверяет порядок
+        uint64_t popped = 0;
+        while (event_ring_pop(&bench_ring, &out)) {
+            uint64_t p = out.user_id - 1;
+            if (p >= (uint64_t)producers || out.id != expect_seq[p]) {
+                result->order_errors++;
+            } else {
+                expect_seq[p]++;
+            }
+            popped++;
+        }
+        uint64_t t2 = rdtsc();
+
+        result->push_cycles += t1 - t0;
+        result->pop_cycles += t2 - t1;
+        result->ops += popped;
+        remaining -= popped;
+
+        if (pushed == 0 && popped == 0) {
+            result->order_errors++;  // Не должно случаться - ring застрял
+            break;
+        }
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void ring_bench_run(int max_producers) {
+    if (max_producers < 1) {
+        max_producers = 1;
+    }
+    if (max_producers > RING_BENCH_MAX_PRODUCERS) {
+        max_producers = RING_BENCH_MAX_PRODUCERS;
+    }
+
+    kprintf("[RINGBENCH] %d events per run, burst=%d, slot=%lu bytes\n",
+            RING_BENCH_OPS, RING_BENCH_BURST, (uint64_t)sizeof(Event));
+    kprintf("[RINGBENCH] producers | SPSC push/pop (cyc/op) | MPMC push/pop (cyc/op)\n");
+
+    for (int producers = 1; producers <= max_producers; producers++) {
+        RingBenchResult spsc;
+        RingBenchResult mpmc;
+
+        ring_bench_one(RING_MODE_SPSC, producers, &spsc);
+        ring_bench_one(RING_MODE_MPMC, producers, &mpmc);
+
+        uint64_t spsc_ops = spsc.ops ? spsc.ops : 1;
+        uint64_t mpmc_ops = mpmc.ops ? mpmc.ops : 1;
+
+        kprintf("[RINGBENCH] %d | %lu / %lu | %lu / %lu%s\n",
+                producers,
+                spsc.push_cycles / spsc_ops, spsc.pop_cycles / spsc_ops,
+                mpmc.push_cycles / mpmc_ops, mpmc.pop_cycles / mpmc_ops,
+                (spsc.order_errors || mpmc.order_errors) ? " ORDER ERRORS!" : "");
+    }
+
+    // NOTE: пока все producers чередуются на одном ядре, здесь меряется
+    // стоимость самих операций (lock cmpxchg + sequence store против
+    // простого store), а не contention. SPSC с несколькими producers
+    // корректен только в таком чередовании. Contention - make host-bench:
+    // 1..N producers на pthreads одновременно (host/host_main.c)
+}
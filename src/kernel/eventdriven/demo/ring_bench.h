@@ -0,0 +1,20 @@
+#ifndef RING_BENCH_H
+#define RING_BENCH_H
+
+// ============================================================================
+// RING BENCHMARK - Сравнение SPSC и MPMC EventRingBuffer
+// ============================================================================
+//
+// Для каждого числа producers 1..max_producers прогоняет RING_BENCH_OPS
+// событий через ring в обоих режимах и печатает стоимость push/pop в тактах.
+// Producers чередуются пачками по RING_BENCH_BURST событий; consumer
+// проверяет FIFO-порядок каждого producer'а (целостность данных).
+// Конкурентные producers на настоящих потоках - host bench (make host-bench).
+
+#define RING_BENCH_OPS          65536
+#define RING_BENCH_BURST        16
+#define RING_BENCH_MAX_PRODUCERS 8
+
+void ring_bench_run(int max_producers);
+
+#endif // RING_BENCH_H
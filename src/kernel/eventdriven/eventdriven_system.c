@@ -2,8 +2,15 @@
 #include "receiver/receiver.h"
 #include "center/center.h"
 #include "guide/guide.h"
+#include "guide/reaper.h"
 #include "execution/execution_deck.h"
 #include "decks/deck_interface.h"
+#include "payload/payload_arena.h"
+#include "core/task_rings.h"
+#include "core/user_buffers.h"
+#include "core/credits.h"
+#include "smp.h"
+#include "pmm.h"
 #include "klib.h"
 
 // Forward declarations для deck init/run функций (НОВАЯ АРХИТЕКТУРА v1)
@@ -24,15 +31,20 @@ extern int network_deck_run_once(void);
 EventDrivenSystem global_event_system;
 
 // ============================================================================
-// MEMORY ALLOCATION для Ring Buffers (shared memory)
+// MEMORY ALLOCATION для Ring Buffers
 // ============================================================================
-
-// TODO: использовать vmm_alloc для выделения shared memory
-// Сейчас используем статические буферы
-
-static EventRingBuffer user_to_kernel_buffer;
-static EventRingBuffer receiver_to_center_buffer;
-static ResponseRingBuffer kernel_to_user_buffer;
+//
+// Глобальная пара user→kernel / kernel→user - для kernel задач и демо.
+// User задачи (usermode_create_task) получают свою SQ/CQ пару в shared
+// memory, отображённую в их vmm_context_t (core/task_rings.h).
+
+static void* eventdriven_alloc_ring(uint64_t size, const char* name) {
+    void* ring = pmm_alloc_zero((size + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE);
+    if (!ring) {
+        panic("[SYSTEM] Out of memory for %s ring", name);
+    }
+    return ring;
+}
 
 // ============================================================================
 // INITIALIZATION
@@ -47,18 +59,41 @@ void eventdriven_system_init(void) {
 
     // 1. Инициализируем ring buffers
     kprintf("[SYSTEM] Initializing ring buffers...\n");
-    event_ring_init(&user_to_kernel_buffer);
-    event_ring_init(&receiver_to_center_buffer);
-    response_ring_init(&kernel_to_user_buffer);
+    EventRingBuffer* user_ring = (EventRingBuffer*)eventdriven_alloc_ring(sizeof(EventRingBuffer), "user");
+    ResponseRingBuffer* response_ring =
+        (ResponseRingBuffer*)eventdriven_alloc_ring(sizeof(ResponseRingBuffer), "response");
+    event_ring_init_mode(user_ring, EVENTDRIVEN_USER_RING_MODE);
+    user_ring->id_base = event_id_make(TASK_RING_GLOBAL, 0);
+    response_ring_init_mode(response_ring, EVENTDRIVEN_RESPONSE_RING_MODE);
+
+    global_event_system.user_to_kernel_ring = user_ring;
+
+    // Receiver → Center: по ring на QoS lane (~68KB каждый - из PMM, не BSS)
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        EventRingBuffer* ring = (EventRingBuffer*)eventdriven_alloc_ring(sizeof(EventRingBuffer),
+                                                                         event_lane_name(lane));
+        event_ring_init_mode(ring, EVENTDRIVEN_CENTER_RING_MODE);
+        global_event_system.receiver_to_center_rings[lane] = ring;
+    }
+    global_event_system.kernel_to_user_ring = response_ring;
+
+    // SQ/CQ пары user задач (регистрирует usermode_create_task)
+    task_rings_init();
+    user_buffers_init();
+    credits_init(response_ring);
 
-    global_event_system.user_to_kernel_ring = &user_to_kernel_buffer;
-    global_event_system.receiver_to_center_ring = &receiver_to_center_buffer;
-    global_event_system.kernel_to_user_ring = &kernel_to_user_buffer;
+    kprintf("[SYSTEM] Ring buffers initialized (user:%s center:%u lanes %s response:%s)\n",
+            EVENTDRIVEN_USER_RING_MODE == RING_MODE_MPMC ? "MPMC" : "SPSC",
+            EVENT_LANE_COUNT,
+            EVENTDRIVEN_CENTER_RING_MODE == RING_MODE_MPMC ? "MPMC" : "SPSC",
+            EVENTDRIVEN_RESPONSE_RING_MODE == RING_MODE_MPMC ? "MPMC" : "SPSC");
 
-    kprintf("[SYSTEM] Ring buffers initialized\n");
+    // Payload arena для больших результатов (Response хранит только смещение)
+    payload_arena_init();
 
     // 2. Инициализируем routing table
     kprintf("[SYSTEM] Initializing routing table...\n");
+    routing_pool_init();
     routing_table_init(&global_routing_table);
     global_event_system.routing_table = &global_routing_table;
 
@@ -79,7 +114,7 @@ void eventdriven_system_init(void) {
 
     // 5. Инициализируем execution deck
     kprintf("[SYSTEM] Initializing execution deck...\n");
-    execution_deck_init(&kernel_to_user_buffer, &global_routing_table);
+    execution_deck_init(global_event_system.kernel_to_user_ring, &global_routing_table);
 
     global_event_system.initialized = 1;
     global_event_system.running = 0;
@@ -94,11 +129,167 @@ void eventdriven_system_init(void) {
 }
 
 // ============================================================================
-// START SYSTEM (для демонстрации - запускаем только один компонент)
+// STAGES - таблица стадий pipeline (порядок = порядок pipeline)
 // ============================================================================
 
-// NOTE: В реальной системе каждый компонент должен работать на отдельном CPU core
-// Сейчас мы создадим демонстрационную версию, которая запускает только Receiver
+typedef struct {
+    const char* name;
+    int (*run_once)(void* arg);  // 0 = работы не было
+    void* arg;
+    uint32_t id;                 // Стадия для idle_notify (core/idle.h)
+    DeckWorker* worker;          // Для deck workers, иначе 0
+} EventdrivenStage;
+
+static int receiver_stage_run_once(void* arg) {
+    (void)arg;
+    return receiver_drain_all(global_event_system.user_to_kernel_ring,
+                              global_event_system.receiver_to_center_rings,
+                              RECEIVER_BURST_SIZE) != 0;
+}
+
+static int center_stage_run_once(void* arg) {
+    (void)arg;
+    return center_drain_burst(global_event_system.receiver_to_center_rings,
+                              global_event_system.routing_table,
+                              global_event_system.kernel_to_user_ring,
+                              CENTER_BURST_SIZE) != 0;
+}
+
+static int guide_stage_run_once(void* arg) {
+    (void)arg;
+    return guide_dispatch_retries() | reaper_run();
+}
+
+static int deck_worker_stage_run_once(void* arg) {
+    return deck_worker_run_once((DeckWorker*)arg);
+}
+
+static int execution_stage_run_once(void* arg) {
+    (void)arg;
+    return execution_deck_run_once();
+}
+
+static EventdrivenStage eventdriven_stages[EVENTDRIVEN_MAX_STAGES];
+static uint32_t eventdriven_stage_count;
+
+static void eventdriven_add_stage(const char* name, int (*run_once)(void*), void* arg,
+                                  uint32_t id, DeckWorker* worker) {
+    EventdrivenStage* stage = &eventdriven_stages[eventdriven_stage_count++];
+    stage->name = name;
+    stage->run_once = run_once;
+    stage->arg = arg;
+    stage->id = id;
+    stage->worker = worker;
+}
+
+// Порядок = порядок pipeline: Receiver, Center, Guide, workers всех decks,
+// Execution
+static void eventdriven_build_stages(void) {
+    eventdriven_stage_count = 0;
+    eventdriven_add_stage("Receiver", receiver_stage_run_once, 0, EVENTDRIVEN_STAGE_RECEIVER, 0);
+    eventdriven_add_stage("Center", center_stage_run_once, 0, EVENTDRIVEN_STAGE_CENTER, 0);
+    eventdriven_add_stage("Guide", guide_stage_run_once, 0, EVENTDRIVEN_STAGE_GUIDE, 0);
+
+    // Сначала worker 0 каждого deck, потом worker 1 и т.д.: соседние
+    // стадии делят ядро, и workers одного deck попадают на разные ядра
+    for (uint32_t i = 0; i < DECK_MAX_WORKERS; i++) {
+        for (uint8_t prefix = 1; prefix <= 4; prefix++) {
+            DeckContext* deck = deck_get_context(prefix);
+            if (!deck || i >= deck->stats.worker_count) {
+                continue;
+            }
+            DeckWorker* worker = &deck->workers[i];
+            eventdriven_add_stage(deck->stats.name, deck_worker_stage_run_once, worker,
+                                  worker->stage, worker);
+        }
+    }
+
+    eventdriven_add_stage("Execution", execution_stage_run_once, 0, EVENTDRIVEN_STAGE_EXECUTION, 0);
+}
+
+static void eventdriven_print_stage_name(EventdrivenStage* stage) {
+    if (stage->worker && stage->worker->deck->stats.worker_count > 1) {
+        kprintf(" %s/%u", stage->name, stage->worker->index);
+    } else {
+        kprintf(" %s", stage->name);
+    }
+}
+
+// Непрерывный диапазон стадий, который крутит одно AP ядро
+typedef struct {
+    uint32_t first;
+    uint32_t count;
+    IdleWaiter* waiter;
+} EventdrivenCoreStages;
+
+static EventdrivenCoreStages core_stages[SMP_MAX_CPUS];
+static IdleWaiter core_waiters[SMP_MAX_CPUS];
+static IdleStats stage_idle_stats[EVENTDRIVEN_MAX_STAGES];
+
+static int eventdriven_core_pass(EventdrivenCoreStages* stages) {
+    int work = 0;
+    for (uint32_t i = 0; i < stages->count; i++) {
+        EventdrivenStage* stage = &eventdriven_stages[stages->first + i];
+        work |= stage->run_once(stage->arg);
+    }
+    return work;
+}
+
+static void eventdriven_core_loop(void* arg) {
+    EventdrivenCoreStages* stages = (EventdrivenCoreStages*)arg;
+    uint64_t idle_since = 0;
+
+    idle_waiter_init(stages->waiter);
+
+    while (1) {
+        if (!global_event_system.running) {
+            cpu_pause();
+            continue;
+        }
+
+        if (eventdriven_core_pass(stages)) {
+            idle_since = 0;
+            continue;
+        }
+
+        // 1. Короткий простой: spin с pause (без задержки на пробуждение)
+        uint64_t now = rdtsc();
+        if (!idle_since) {
+            idle_since = now;
+        }
+        if (now - idle_since < IDLE_SPIN_CYCLES) {
+            cpu_pause();
+            continue;
+        }
+
+        // 2. Долгий простой: объявляем сон, последний проход, спим
+        idle_prepare(stages->waiter);
+        if (eventdriven_core_pass(stages)) {
+            idle_cancel(stages->waiter);
+            idle_since = 0;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < stages->count; i++) {
+            atomic_increment_u64(&stage_idle_stats[stages->first + i].sleeps);
+        }
+
+        int notified;
+        uint64_t slept = idle_sleep(stages->waiter, &notified);
+        for (uint32_t i = 0; i < stages->count; i++) {
+            IdleStats* stats = &stage_idle_stats[stages->first + i];
+            if (notified) {
+                atomic_increment_u64(&stats->wakeups);
+            }
+            atomic_fetch_add_u64(&stats->idle_cycles, slept);
+        }
+        idle_since = 0;
+    }
+}
+
+// ============================================================================
+// START SYSTEM
+// ============================================================================
 
 void eventdriven_system_start(void) {
     if (!global_event_system.initialized) {
@@ -108,14 +299,55 @@ void eventdriven_system_start(void) {
 
     kprintf("[SYSTEM] Starting event-driven system...\n");
     global_event_system.running = 1;
+    global_event_system.worker_cores = 0;
+
+    // BSP (CPU 0) остаётся за shell/user tasks - стадии только на AP
+    eventdriven_build_stages();
+
+    uint32_t workers = smp_get_cpu_count() - 1;
+    if (workers > eventdriven_stage_count) {
+        workers = eventdriven_stage_count;
+    }
+
+    if (workers == 0) {
+        kprintf("[SYSTEM] Single core: using synchronous pipeline processing\n");
+        return;
+    }
+
+    idle_init();
+
+    // Стадия s -> ядро s * workers / stage_count: соседние стадии pipeline
+    // делят ядро, пока ядер меньше, чем стадий
+    for (uint32_t s = 0; s < eventdriven_stage_count; s++) {
+        uint32_t core = s * workers / eventdriven_stage_count;
+        EventdrivenCoreStages* stages = &core_stages[core];
+        if (stages->count == 0) {
+            stages->first = s;
+            stages->waiter = &core_waiters[core];
+        }
+        stages->count++;
+
+        // Producers будят ядро стадии через idle_notify()
+        idle_stage_waiters[eventdriven_stages[s].id] = stages->waiter;
+        stage_idle_stats[s].start_tsc = rdtsc();
+    }
+
+    for (uint32_t core = 0; core < workers; core++) {
+        EventdrivenCoreStages* stages = &core_stages[core];
+
+        kprintf("[SYSTEM] CPU %u:", core + 1);
+        for (uint32_t i = 0; i < stages->count; i++) {
+            eventdriven_print_stage_name(&eventdriven_stages[stages->first + i]);
+        }
+        kprintf("\n");
 
-    // TODO: В реальной системе здесь должны быть:
-    // 1. CPU core pinning для каждого компонента
-    // 2. Создание kernel threads для каждого компонента
-    // 3. Запуск всех компонентов параллельно
+        if (!smp_start_cpu(core + 1, eventdriven_core_loop, stages)) {
+            panic("[SYSTEM] Failed to start pipeline on CPU %u", core + 1);
+        }
+    }
 
-    kprintf("[SYSTEM] System is ready to process events!\n");
-    kprintf("[SYSTEM] NOTE: Using synchronous processing for demo\n");
+    global_event_system.worker_cores = workers;
+    kprintf("[SYSTEM] Pipeline running on %u cores\n", workers);
 }
 
 // ============================================================================
@@ -124,20 +356,31 @@ void eventdriven_system_start(void) {
 
 // Обработка одной итерации всего pipeline
 void eventdriven_process_one_iteration(void) {
-    Event event;
-
-    // 1. Receiver: забираем событие из user→kernel
-    if (event_ring_pop(global_event_system.user_to_kernel_ring, &event)) {
-        receiver_process_event(&event, global_event_system.receiver_to_center_ring);
-    }
-
-    // 2. Center: забираем из receiver→center, проверяем Security и определяем маршрут
-    if (event_ring_pop(global_event_system.receiver_to_center_ring, &event)) {
-        center_process_event(&event, global_event_system.routing_table, global_event_system.kernel_to_user_ring);
+    // SMP: стадии уже крутятся на своих ядрах (и SPSC rings не терпят
+    // второго consumer'а) - BSP только уступает
+    if (global_event_system.worker_cores) {
+        cpu_pause();
+        return;
     }
 
-    // 3. Guide: сканируем routing table и раздаём по deck'ам
-    guide_scan_and_dispatch(global_event_system.routing_table);
+    // 1. Receiver: забираем пачку событий прямо из слотов user→kernel ring и
+    //    SQ задач (одна копия - в слоты receiver→center ring, одно обновление индекса)
+    receiver_drain_all(global_event_system.user_to_kernel_ring,
+                       global_event_system.receiver_to_center_rings,
+                       RECEIVER_BURST_SIZE);
+
+    // 2. Center: обрабатываем слоты receiver→center на месте, проверяем Security
+    //    и строим RoutingEntry прямо в routing table
+    center_drain_burst(global_event_system.receiver_to_center_rings,
+                       global_event_system.routing_table,
+                       global_event_system.kernel_to_user_ring,
+                       CENTER_BURST_SIZE);
+
+    // 3. Guide: Center/decks отдают entries напрямую, здесь только
+    //    повторный hand-off для тех, что не влезли в очередь deck, и
+    //    TIMEOUT для просроченных
+    guide_dispatch_retries();
+    reaper_run();
 
     // 4. Decks: обрабатываем события в каждом deck (НОВАЯ АРХИТЕКТУРА: 4 decks)
     operations_deck_run_once();
@@ -151,11 +394,33 @@ void eventdriven_process_one_iteration(void) {
 
 // Обработка N итераций pipeline для полной обработки событий
 void eventdriven_process_events(int iterations) {
+    if (global_event_system.worker_cores) {
+        // Ждём, пока AP ядра доведут всё до ответов
+        uint64_t spins = (uint64_t)iterations * EVENTDRIVEN_IDLE_SPINS_PER_ITER;
+        while (spins-- && !eventdriven_pipeline_idle()) {
+            cpu_pause();
+        }
+        return;
+    }
+
     for (int i = 0; i < iterations; i++) {
         eventdriven_process_one_iteration();
     }
 }
 
+int eventdriven_pipeline_idle(void) {
+    // Receiver/Center отпускают слот только после передачи дальше, а
+    // Execution удаляет entry после отправки ответа - "дыр" между ними нет
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        if (!event_ring_is_empty(global_event_system.receiver_to_center_rings[lane])) {
+            return 0;
+        }
+    }
+    return event_ring_is_empty(global_event_system.user_to_kernel_ring) &&
+           task_rings_pending() == 0 &&
+           atomic_load_u64(&global_event_system.routing_table->total_entries) == 0;
+}
+
 // ============================================================================
 // STOP SYSTEM
 // ============================================================================
@@ -189,30 +454,31 @@ void eventdriven_print_full_stats(void) {
     kprintf("============================================================\n");
 
     receiver_print_stats();
+    task_rings_print_stats();
+    credits_print_stats();
     center_print_stats();
     guide_print_stats();
     routing_table_print_stats(&global_routing_table);
-
-    // Статистика decks (НОВАЯ АРХИТЕКТУРА)
-    extern DeckContext operations_deck_context;
-    extern DeckContext storage_deck_context;
-    extern DeckContext hardware_deck_context;
-    extern DeckContext network_deck_context;
-
-    kprintf("[DECK:Operations] processed=%lu errors=%lu\n",
-            operations_deck_context.stats.events_processed,
-            operations_deck_context.stats.errors);
-    kprintf("[DECK:Storage] processed=%lu errors=%lu\n",
-            storage_deck_context.stats.events_processed,
-            storage_deck_context.stats.errors);
-    kprintf("[DECK:Hardware] processed=%lu errors=%lu\n",
-            hardware_deck_context.stats.events_processed,
-            hardware_deck_context.stats.errors);
-    kprintf("[DECK:Network] processed=%lu errors=%lu\n",
-            network_deck_context.stats.events_processed,
-            network_deck_context.stats.errors);
+    routing_pool_print_stats();
+
+    // Статистика decks (НОВАЯ АРХИТЕКТУРА) + по workers
+    for (uint8_t prefix = 1; prefix <= 4; prefix++) {
+        DeckContext* deck = deck_get_context(prefix);
+        if (deck) {
+            deck_print_stats(deck);
+        }
+    }
 
     execution_deck_print_stats();
+    payload_arena_print_stats();
+    user_buffers_print_stats();
+
+    // Adaptive idle стадий на AP ядрах
+    if (global_event_system.worker_cores) {
+        for (uint32_t s = 0; s < eventdriven_stage_count; s++) {
+            idle_print_stats(eventdriven_stages[s].name, &stage_idle_stats[s]);
+        }
+    }
 
     kprintf("============================================================\n");
     kprintf("\n");
@@ -4,6 +4,7 @@
 #include "core/events.h"
 #include "core/ringbuffer.h"
 #include "routing/routing_table.h"
+#include "core/idle.h"
 
 // ============================================================================
 // EVENT-DRIVEN SYSTEM - Главный интегратор
@@ -16,6 +17,40 @@
 //
 // ============================================================================
 
+// ============================================================================
+// RING MODES - выбор SPSC/MPMC для каждого ring при инициализации
+// ============================================================================
+//
+// User → Kernel:     пишут все submitting задачи, читает Receiver    -> MPMC
+// Receiver → Center: один Receiver, один Center (ring на lane)       -> SPSC
+// Kernel → User:     пишет Execution, забирают ответы все задачи     -> MPMC
+// Task SQ:           пишет одна user задача, читает Receiver         -> SPSC
+// Task CQ:           пишут Center и Execution, читает задача         -> MPMC
+//                    (пары задач - core/task_rings.h)
+//
+// SPSC быстрее (нет lock cmpxchg на каждый слот), поэтому используется
+// везде, где producer и consumer гарантированно единственные.
+
+#define EVENTDRIVEN_USER_RING_MODE      RING_MODE_MPMC
+#define EVENTDRIVEN_CENTER_RING_MODE    RING_MODE_SPSC
+#define EVENTDRIVEN_RESPONSE_RING_MODE  RING_MODE_MPMC
+
+// ============================================================================
+// SMP - стадии pipeline на отдельных ядрах
+// ============================================================================
+//
+// eventdriven_system_start() раздаёт стадии (Receiver, Center, Guide,
+// каждый worker каждого deck, Execution) по AP ядрам: если AP хватает - по
+// стадии на ядро, иначе соседние стадии делят ядро (round-robin их
+// *_run_once). BSP остаётся за
+// shell и user tasks. Без AP (1 ядро) - синхронный режим, как раньше:
+// pipeline крутит eventdriven_process_one_iteration().
+// Пустое ядро засыпает по adaptive idle политике (core/idle.h).
+
+// eventdriven_process_events(N) в SMP режиме: ждать опустошения pipeline
+// не дольше N * столько pause
+#define EVENTDRIVEN_IDLE_SPINS_PER_ITER  10000
+
 // ============================================================================
 // GLOBAL SYSTEM STATE
 // ============================================================================
@@ -23,7 +58,7 @@
 typedef struct {
     // === RING BUFFERS ===
     EventRingBuffer* user_to_kernel_ring;     // User → Kernel события
-    EventRingBuffer* receiver_to_center_ring; // Receiver → Center
+    EventRingBuffer* receiver_to_center_rings[EVENT_LANE_COUNT]; // Receiver → Center, по QoS lane
     ResponseRingBuffer* kernel_to_user_ring;  // Kernel → User ответы
 
     // === ROUTING TABLE ===
@@ -32,6 +67,7 @@ typedef struct {
     // === SYSTEM STATUS ===
     volatile int initialized;
     volatile int running;
+    uint32_t worker_cores;  // AP ядра со стадиями pipeline (0 = синхронный режим)
 
 } EventDrivenSystem;
 
@@ -44,8 +80,8 @@ extern EventDrivenSystem global_event_system;
 // Инициализация всей event-driven системы
 void eventdriven_system_init(void);
 
-// Запуск всех компонентов (должно вызываться после инициализации)
-// NOTE: Это блокирующая функция - запускает бесконечные циклы компонентов
+// Запуск всех компонентов (должно вызываться после инициализации и smp_init)
+// Стадии уходят на AP ядра; на одном ядре - синхронный режим
 void eventdriven_system_start(void);
 
 // Остановка системы (graceful shutdown)
@@ -62,12 +98,17 @@ ResponseRingBuffer* eventdriven_get_kernel_to_user_ring(void);
 // SYNCHRONOUS PROCESSING (для демонстрации)
 // ============================================================================
 
-// Обработать одну итерацию всего pipeline (все компоненты)
+// Обработать одну итерацию всего pipeline (все компоненты).
+// В SMP режиме стадии крутятся на своих ядрах - здесь только pause
 void eventdriven_process_one_iteration(void);
 
-// Обработать N итераций для полной обработки событий
+// Обработать N итераций для полной обработки событий.
+// В SMP режиме - дождаться, пока pipeline опустеет (с ограничением)
 void eventdriven_process_events(int iterations);
 
+// Нет событий ни в rings, ни в routing table
+int eventdriven_pipeline_idle(void);
+
 // ============================================================================
 // STATISTICS & MONITORING
 // ============================================================================
@@ -0,0 +1,247 @@
+#include "completion.h"
+#include "../task/task.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+typedef struct {
+    uint64_t event_id;                  // 0 = slot свободен (ID 0 kernel не выдаёт)
+    uint32_t group;
+} CompletionSlot;
+
+typedef struct {
+    uint64_t task_id;                   // 0 = группа свободна
+    uint32_t generation;                // Защищает handle от переиспользования
+    uint32_t remaining;                 // Завершений до wakeup
+    uint32_t count;
+    uint64_t event_ids[COMPLETION_GROUP_EVENTS];
+} CompletionGroup;
+
+CompletionStats completion_stats;
+
+static CompletionSlot completion_slots[COMPLETION_SLOTS];
+static CompletionGroup completion_groups[COMPLETION_MAX_GROUPS];
+static volatile uint32_t completion_active = 0;     // Занятых slots
+static spinlock_t completion_lock;
+
+#define COMPLETION_SLOT_MASK        (COMPLETION_SLOTS - 1)
+#define COMPLETION_MAX_ACTIVE       (COMPLETION_SLOTS / 2)  // Короткие probe-цепочки
+
+#define COMPLETION_HANDLE(index, gen)   ((index) | (((gen) & 0xFFFFFF) << 8))
+#define COMPLETION_HANDLE_INDEX(handle) ((handle) & 0xFF)
+#define COMPLETION_HANDLE_GEN(handle)   ((handle) >> 8)
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void completion_init(void) {
+    memset(&completion_stats, 0, sizeof(completion_stats));
+    memset(completion_slots, 0, sizeof(completion_slots));
+    memset(completion_groups, 0, sizeof(completion_groups));
+    completion_active = 0;
+    spinlock_init(&completion_lock);
+}
+
+// ============================================================================
+// EVENT TABLE (под completion_lock)
+// ============================================================================
+
+static inline uint32_t completion_hash(uint64_t event_id) {
+    return (uint32_t)((event_id * 0x9E3779B97F4A7C15ULL) >> (64 - COMPLETION_SLOT_BITS));
+}
+
+static uint32_t completion_find(uint64_t event_id) {
+    for (uint32_t i = completion_hash(event_id); ; i = (i + 1) & COMPLETION_SLOT_MASK) {
+        if (completion_slots[i].event_id == event_id) {
+            return i;
+        }
+        if (completion_slots[i].event_id == 0) {
+            return COMPLETION_NONE;
+        }
+    }
+}
+
+static int completion_insert(uint64_t event_id, uint32_t group) {
+    uint32_t i = completion_hash(event_id);
+    while (completion_slots[i].event_id != 0) {
+        if (completion_slots[i].event_id == event_id) {
+            return 0;  // Событие уже ждёт другая группа
+        }
+        i = (i + 1) & COMPLETION_SLOT_MASK;
+    }
+
+    completion_slots[i].event_id = event_id;
+    completion_slots[i].group = group;
+    completion_active++;
+    return 1;
+}
+
+// Удаление со сдвигом назад: цепочки probe остаются без дыр (без tombstones)
+static void completion_remove(uint32_t i) {
+    uint32_t j = i;
+    completion_slots[i].event_id = 0;
+    completion_active--;
+
+    while (1) {
+        j = (j + 1) & COMPLETION_SLOT_MASK;
+        if (completion_slots[j].event_id == 0) {
+            return;
+        }
+
+        // Элемент j остаётся, если его home лежит циклически в (i, j]
+        uint32_t home = completion_hash(completion_slots[j].event_id);
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+            continue;
+        }
+
+        completion_slots[i] = completion_slots[j];
+        completion_slots[j].event_id = 0;
+        i = j;
+    }
+}
+
+// Снять все ещё не завершённые события группы и освободить её
+static void completion_group_free(uint32_t index) {
+    CompletionGroup* group = &completion_groups[index];
+
+    for (uint32_t k = 0; k < group->count; k++) {
+        uint32_t slot = completion_find(group->event_ids[k]);
+        if (slot != COMPLETION_NONE && completion_slots[slot].group == index) {
+            completion_remove(slot);
+        }
+    }
+
+    group->task_id = 0;
+    group->count = 0;
+    group->generation++;
+}
+
+// ============================================================================
+// WAITER SIDE
+// ============================================================================
+
+uint32_t completion_wait_register(uint64_t task_id, const uint64_t* event_ids,
+                                  uint32_t count, uint32_t need) {
+    if (task_id == 0 || count == 0 || count > COMPLETION_GROUP_EVENTS) {
+        return COMPLETION_NONE;
+    }
+    if (need == 0 || need > count) {
+        need = count;
+    }
+
+    spin_lock(&completion_lock);
+
+    uint32_t index = COMPLETION_NONE;
+    if (completion_active + count <= COMPLETION_MAX_ACTIVE) {
+        for (uint32_t g = 0; g < COMPLETION_MAX_GROUPS; g++) {
+            if (completion_groups[g].task_id == 0) {
+                index = g;
+                break;
+            }
+        }
+    }
+
+    if (index == COMPLETION_NONE) {
+        spin_unlock(&completion_lock);
+        completion_stats.rejected++;
+        return COMPLETION_NONE;
+    }
+
+    CompletionGroup* group = &completion_groups[index];
+    group->task_id = task_id;
+    group->remaining = need;
+    group->count = 0;
+
+    for (uint32_t k = 0; k < count; k++) {
+        if (!completion_insert(event_ids[k], index)) {
+            completion_group_free(index);
+            spin_unlock(&completion_lock);
+            completion_stats.rejected++;
+            return COMPLETION_NONE;
+        }
+        group->event_ids[group->count++] = event_ids[k];
+    }
+
+    uint32_t handle = COMPLETION_HANDLE(index, group->generation);
+    spin_unlock(&completion_lock);
+
+    atomic_increment_u64(&completion_stats.waits);
+    return handle;
+}
+
+int completion_wait_cancel(uint32_t handle) {
+    if (handle == COMPLETION_NONE) {
+        return 0;
+    }
+
+    uint32_t index = COMPLETION_HANDLE_INDEX(handle);
+    if (index >= COMPLETION_MAX_GROUPS) {
+        return 0;
+    }
+
+    spin_lock(&completion_lock);
+
+    CompletionGroup* group = &completion_groups[index];
+    if (group->task_id == 0 ||
+        (group->generation & 0xFFFFFF) != COMPLETION_HANDLE_GEN(handle)) {
+        spin_unlock(&completion_lock);
+        return 0;  // Уже сработала - wakeup в пути или пришёл
+    }
+
+    completion_group_free(index);
+    spin_unlock(&completion_lock);
+
+    atomic_increment_u64(&completion_stats.cancelled);
+    return 1;
+}
+
+// ============================================================================
+// EXECUTION SIDE
+// ============================================================================
+
+void completion_signal(uint64_t event_id) {
+    // Частый случай: никто не ждёт
+    if (completion_active == 0) {
+        return;
+    }
+
+    spin_lock(&completion_lock);
+
+    uint32_t slot = completion_find(event_id);
+    if (slot == COMPLETION_NONE) {
+        spin_unlock(&completion_lock);
+        return;
+    }
+
+    uint32_t index = completion_slots[slot].group;
+    CompletionGroup* group = &completion_groups[index];
+    completion_remove(slot);
+
+    uint64_t task_id = 0;
+    if (--group->remaining == 0) {
+        task_id = group->task_id;
+        completion_group_free(index);
+    }
+
+    spin_unlock(&completion_lock);
+
+    // Будим вне lock: task_wake_event берёт locks планировщика
+    if (task_id) {
+        task_wake_event(task_id);
+        atomic_increment_u64(&completion_stats.wakeups);
+    }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void completion_print_stats(void) {
+    kprintf("[COMPLETION] Stats: waits=%lu wakeups=%lu cancelled=%lu rejected=%lu active=%u\n",
+            completion_stats.waits, completion_stats.wakeups,
+            completion_stats.cancelled, completion_stats.rejected,
+            completion_active);
+}
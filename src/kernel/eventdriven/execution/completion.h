@@ -0,0 +1,61 @@
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include "../core/events.h"
+#include "klib.h"
+
+// ============================================================================
+// COMPLETION WAITS - задача спит, пока её события в pipeline
+// ============================================================================
+//
+// Задача регистрирует wait на набор event_id (группа) и уходит из
+// планировщика (task_block_event). Кто положил Response в CQ - Execution,
+// Center (DENIED / INVALID / BUSY) или Receiver (BUSY, credits_reject) -
+// вызывает completion_signal(event_id): группа считает завершения и,
+// когда набралось need, будит ровно свою задачу (task_wake_event) и
+// освобождается - wait одноразовый.
+//
+// Гонки:
+//   - ответ пришёл ДО регистрации: signal никого не нашёл, поэтому после
+//     register ожидающий ещё раз проверяет ответы и снимает wait
+//     (completion_wait_cancel)
+//   - signal между register и task_block_event: wakeup запоминается в
+//     Task.event_wakeups, блокировка возвращается сразу
+//
+// Таблица event_id -> группа - open addressing с линейным probe; пока
+// wait'ов нет, completion_signal - одна загрузка счётчика.
+//
+// ============================================================================
+
+#define COMPLETION_SLOT_BITS        8
+#define COMPLETION_SLOTS            (1u << COMPLETION_SLOT_BITS)
+#define COMPLETION_MAX_GROUPS       32
+#define COMPLETION_GROUP_EVENTS     16      // Максимум событий в wait-for-N
+#define COMPLETION_NONE             0xFFFFFFFF
+
+typedef struct {
+    volatile uint64_t waits;            // Зарегистрировано групп
+    volatile uint64_t wakeups;          // Групп, разбуженных completion
+    volatile uint64_t cancelled;        // Снято ожидающим (ответ уже был)
+    volatile uint64_t rejected;         // Нет места / event_id уже ждут - остаётся polling
+} CompletionStats;
+
+extern CompletionStats completion_stats;
+
+void completion_init(void);
+
+// Wait задачи task_id на count событий, разбудить после need завершений
+// (need = count - все, 1 - любое). Возвращает handle группы или
+// COMPLETION_NONE (нет места)
+uint32_t completion_wait_register(uint64_t task_id, const uint64_t* event_ids,
+                                  uint32_t count, uint32_t need);
+
+// Снять wait. 1 = снят, wakeup не придёт; 0 = группа уже сработала
+int completion_wait_cancel(uint32_t handle);
+
+// Execution / Center / Receiver: Response для event_id уже в ring
+void completion_signal(uint64_t event_id);
+
+void completion_print_stats(void);
+
+#endif // COMPLETION_H
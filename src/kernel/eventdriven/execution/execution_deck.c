@@ -1,4 +1,11 @@
 #include "execution_deck.h"
+#include "../payload/payload_arena.h"
+#include "../center/coalesce.h"
+#include "../center/chain.h"
+#include "completion.h"
+#include "../core/latency.h"
+#include "../core/task_rings.h"
+#include "../core/credits.h"
 #include "klib.h"
 
 // ============================================================================
@@ -22,6 +29,11 @@ void execution_deck_init(ResponseRingBuffer* resp_ring, RoutingTable* rtable) {
     execution_stats.events_executed = 0;
     execution_stats.responses_sent = 0;
     execution_stats.errors = 0;
+    execution_stats.latency_total = 0;
+    execution_stats.latency_max = 0;
+    execution_stats.latency_samples = 0;
+
+    completion_init();
 
     kprintf("[EXECUTION] Initialized\n");
 }
@@ -30,10 +42,49 @@ void execution_deck_init(ResponseRingBuffer* resp_ring, RoutingTable* rtable) {
 // RESULT COLLECTION
 // ============================================================================
 
+// Coalesced waiter: не хватило payload arena под копию результата лидера
+#define EXECUTION_ERROR_NO_PAYLOAD  1
+
+// Результатов в inline Response после join (по одному на deck)
+#define EXECUTION_JOIN_RESULTS 4
+
+_Static_assert(EXECUTION_JOIN_RESULTS * sizeof(uint64_t) <= RESPONSE_INLINE_SIZE,
+               "join results must fit inline");
+
 static void collect_results(RoutingEntry* entry, Response* response) {
-    // Собираем результаты от всех decks, которые обработали событие
-    response_init(response, entry->event_id, EVENT_STATUS_SUCCESS);
+    // Собираем результаты от всех decks, которые обработали событие.
+    // ID - текущего звена: у цепочки entry живёт под ID первого
+    EventStatus status = EVENT_STATUS_SUCCESS;
+    if (entry->abort_flag) {
+        status = entry->state == EVENT_STATUS_TIMEOUT ? EVENT_STATUS_TIMEOUT : EVENT_STATUS_ERROR;
+    }
+    response_init(response, entry->event_copy.id, status);
     response->timestamp = rdtsc();
+    response->error_code = entry->error_code;
+
+    // Большой результат: отдаём смещение в payload arena, без копирования
+    if (entry->payload_offset != RESPONSE_PAYLOAD_NONE) {
+        if (entry->abort_flag) {
+            // Событие прервано после того, как deck создал payload
+            payload_arena_release(entry->payload_offset);
+        } else {
+            response->payload_offset = entry->payload_offset;
+            response->result_size = entry->payload_size;
+        }
+        entry->payload_offset = RESPONSE_PAYLOAD_NONE;
+        return;
+    }
+
+    // Fan-out маршрут: join результатов всех веток - inline результат
+    // каждого deck на своём месте (index = prefix - 1)
+    if (entry->max_wave > 1) {
+        uint64_t* results = (uint64_t*)response->result;
+        for (int i = 0; i < EXECUTION_JOIN_RESULTS; i++) {
+            results[i] = (uint64_t)entry->deck_results[i];
+        }
+        response->result_size = EXECUTION_JOIN_RESULTS * sizeof(uint64_t);
+        return;
+    }
 
     // TODO: более сложная логика сборки результатов
     // Сейчас просто берём результат от последнего deck
@@ -47,12 +98,8 @@ static void collect_results(RoutingEntry* entry, Response* response) {
     }
 
     if (result_index >= 0) {
-        // Копируем результат в response
-        void* deck_result = entry->deck_results[result_index];
-
-        // TODO: правильное копирование результата
-        // Сейчас просто копируем указатель (небезопасно!)
-        *(void**)response->result = deck_result;
+        // Маленький результат (значение или handle) - inline в Response
+        *(void**)response->result = entry->deck_results[result_index];
         response->result_size = sizeof(void*);
 
         kprintf("[EXECUTION] Collected result from deck at index %d for event %lu\n",
@@ -68,17 +115,111 @@ static void collect_results(RoutingEntry* entry, Response* response) {
 // EVENT PROCESSING
 // ============================================================================
 
+static void execution_record_response(uint64_t latency) {
+    atomic_increment_u64((volatile uint64_t*)&execution_stats.responses_sent);
+
+    atomic_fetch_add_u64(&execution_stats.latency_total, latency);
+    atomic_increment_u64(&execution_stats.latency_samples);
+    uint64_t max = atomic_load_u64(&execution_stats.latency_max);
+    while (latency > max && !atomic_cas_u64(&execution_stats.latency_max, max, latency)) {
+        max = atomic_load_u64(&execution_stats.latency_max);
+    }
+}
+
+// Готовый Response -> слот CQ отправителя (flags - его Event.flags).
+// Слот зарезервирован кредитом события (core/credits.h) - ждать нечего.
+// Отброшенный ответ (CQ полна или сломана) - его payload освобождаем сами
+static void execution_post_response(const Response* source, uint32_t flags) {
+    CreditResponse slot;
+    Response* response = credits_reserve_response(flags, response_ring, &slot);
+    if (!response) {
+        payload_arena_release(source->payload_offset);
+        return;
+    }
+    *response = *source;
+    credits_commit_response(&slot);
+}
+
+// Coalescing: каждый waiter получает копию ответа лидера со своим event_id.
+// Payload копируется - его освобождает каждый consumer сам
+static void execution_fan_out(const Response* leader, uint32_t waiters, LatencyShard* latency,
+                              uint32_t type) {
+    for (uint32_t i = waiters; i != COALESCE_NONE; i = coalesce_waiter(i)->next) {
+        CoalesceWaiter* waiter = coalesce_waiter(i);
+
+        Response response = *leader;
+        response.event_id = waiter->event_id;
+
+        if (leader->payload_offset != RESPONSE_PAYLOAD_NONE) {
+            uint32_t copy = payload_arena_alloc(leader->result_size ? leader->result_size : 1);
+            if (copy == PAYLOAD_OFFSET_NONE) {
+                response.status = EVENT_STATUS_ERROR;
+                response.error_code = EXECUTION_ERROR_NO_PAYLOAD;
+                response.result_size = 0;
+                response.payload_offset = RESPONSE_PAYLOAD_NONE;
+                atomic_increment_u64((volatile uint64_t*)&execution_stats.errors);
+            } else {
+                memcpy(payload_arena_ptr(copy), payload_arena_ptr(leader->payload_offset),
+                       leader->result_size);
+                response.payload_offset = copy;
+            }
+        }
+
+        execution_post_response(&response, waiter->flags);
+        execution_record_response(response.timestamp - waiter->timestamp);
+        latency_record(latency, type, LATENCY_SLOT_SECOND, response.timestamp - waiter->timestamp);
+        completion_signal(response.event_id);
+    }
+
+    coalesce_release_waiters(waiters);
+}
+
 static void process_completed_event(RoutingEntry* entry) {
-    // 1. Собираем результаты
-    Response response;
-    collect_results(entry, &response);
+    // Звено цепочки: следующее звено ушло в decks, ответ - только в конце
+    if (entry->chain_slot != ROUTING_CHAIN_NONE && chain_advance(entry)) {
+        return;
+    }
 
-    // 2. Отправляем response в user space
-    while (!response_ring_push(response_ring, &response)) {
-        cpu_pause();  // Busy-wait если буфер полон
+    // Снимаем лидера coalescing до сборки ответа: новых waiters больше не будет
+    uint32_t waiters = coalesce_detach(entry);
+    uint32_t type = entry->event_copy.type;
+    LatencyShard* histograms = latency_shard(EVENTDRIVEN_STAGE_EXECUTION);
+    uint64_t latency;
+    uint64_t done;
+
+    if (waiters == COALESCE_NONE) {
+        // 1. Резервируем слот в CQ отправителя (response строится на месте)
+        CreditResponse slot;
+        Response dropped;
+        Response* response = credits_reserve_response(entry->event_copy.flags, response_ring, &slot);
+
+        // 2. Собираем результаты прямо в слот и отправляем в user space.
+        //    Ответ отброшен (CQ полна или сломана) - результаты собираются и освобождаются
+        collect_results(entry, response ? response : &dropped);
+        if (response) {
+            done = response->timestamp;
+            credits_commit_response(&slot);
+        } else {
+            done = dropped.timestamp;
+            payload_arena_release(dropped.payload_offset);
+        }
+    } else {
+        // Waiters копируют ответ лидера - до того, как его payload
+        // станет доступен (и освобождаем) user space
+        Response response;
+        collect_results(entry, &response);
+        execution_fan_out(&response, waiters, histograms, type);
+        execution_post_response(&response, entry->event_copy.flags);
+        done = response.timestamp;
     }
 
-    atomic_increment_u64((volatile uint64_t*)&execution_stats.responses_sent);
+    latency = done - entry->event_copy.timestamp;
+    execution_record_response(latency);
+    latency_record(histograms, type, LATENCY_SLOT_FIRST, done - entry->completed_at);
+    latency_record(histograms, type, LATENCY_SLOT_SECOND, latency);
+
+    // Ответ уже в ring - будим задачу, которая ждёт это событие
+    completion_signal(entry->event_copy.id);
 
     kprintf("[EXECUTION] Sent response for event %lu to user space\n", entry->event_id);
 
@@ -94,34 +235,20 @@ static void process_completed_event(RoutingEntry* entry) {
 
 // Обработать одно завершённое событие (для синхронной обработки)
 int execution_deck_run_once(void) {
-    // Получаем завершённое событие от Guide
-    RoutingEntry* entry = deck_queue_pop(execution_queue);
+    // Получаем завершённое событие (hand-off от Center/decks)
+    RoutingHandle handle = deck_queue_pop(execution_queue);
+    if (handle == ROUTING_HANDLE_NONE) {
+        return 0;  // Очередь пуста
+    }
 
-    if (entry) {
+    // Устаревший handle (entry уже освобождена) не даёт двойного ответа.
+    // Entry reaper'а Execution берёт - ответ TIMEOUT за ней
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (entry && routing_entry_enter(entry, handle, 1)) {
         // Обрабатываем завершённое событие
         process_completed_event(entry);
-        return 1;  // Обработано
-    }
-    return 0;  // Очередь пуста
-}
-
-void execution_deck_run(void) {
-    kprintf("[EXECUTION] Starting main loop...\n");
-
-    uint64_t iterations = 0;
-
-    while (1) {
-        if (!execution_deck_run_once()) {
-            // Очередь пуста
-            cpu_pause();
-        }
-
-        // Периодическая статистика
-        iterations++;
-        if (iterations % 10000000 == 0) {
-            execution_deck_print_stats();
-        }
     }
+    return 1;  // Обработано
 }
 
 // ============================================================================
@@ -133,4 +260,12 @@ void execution_deck_print_stats(void) {
             execution_stats.events_executed,
             execution_stats.responses_sent,
             execution_stats.errors);
+
+    uint64_t samples = execution_stats.latency_samples;
+    kprintf("[EXECUTION] Latency: avg=%lu max=%lu cycles (samples=%lu)\n",
+            samples ? execution_stats.latency_total / samples : 0,
+            execution_stats.latency_max,
+            samples);
+
+    completion_print_stats();
 }
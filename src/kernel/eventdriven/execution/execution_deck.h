@@ -10,11 +10,13 @@
 // ============================================================================
 //
 // Функции:
-// 1. Получает завершённые routing entries от Guide
+// 1. Получает завершённые routing entries (hand-off от последнего deck)
 // 2. Собирает результаты от всех decks
 // 3. Формирует Response
-// 4. Отправляет Response в kernel→user ring buffer
-// 5. Очищает routing entry из таблицы
+// 4. Отправляет Response в kernel→user ring buffer (копию - каждому
+//    coalesced waiter'у лидера, см. center/coalesce.h)
+// 5. Будит задачу, ждущую это событие (completion.h)
+// 6. Очищает routing entry из таблицы
 //
 // ============================================================================
 
@@ -22,6 +24,11 @@ typedef struct {
     volatile uint64_t events_executed;
     volatile uint64_t responses_sent;
     volatile uint64_t errors;
+
+    // End-to-end латентность (TSC): Receiver timestamp -> Response в ring
+    volatile uint64_t latency_total;
+    volatile uint64_t latency_max;
+    volatile uint64_t latency_samples;
 } ExecutionStats;
 
 extern ExecutionStats execution_stats;
@@ -39,8 +46,6 @@ void execution_deck_init(ResponseRingBuffer* response_ring, RoutingTable* routin
 // Обработать одно завершённое событие (для синхронной обработки)
 int execution_deck_run_once(void);
 
-void execution_deck_run(void);
-
 // ============================================================================
 // STATS
 // ============================================================================
@@ -1,4 +1,6 @@
 #include "guide.h"
+#include "reaper.h"
+#include "../core/idle.h"
 #include "klib.h"
 
 // ============================================================================
@@ -16,66 +18,207 @@ void guide_init(RoutingTable* routing_table) {
     kprintf("[GUIDE] Initializing...\n");
 
     guide_context.routing_table = routing_table;
-    guide_context.scan_position = 0;
-
-    // Инициализируем все deck queues (НОВАЯ АРХИТЕКТУРА: 5 queues вместо 11)
-    for (int i = 0; i < 5; i++) {
-        deck_queue_init(&guide_context.deck_queues[i]);
-    }
 
+    // Очереди decks создаёт deck_init() (по inbox на worker)
     deck_queue_init(&guide_context.execution_queue);
+    guide_retry_init(&guide_context.retry_queue);
 
     guide_stats.events_routed = 0;
     guide_stats.events_completed = 0;
     guide_stats.routing_iterations = 0;
+    guide_stats.dispatch_retries = 0;
+    guide_stats.fanout_waves = 0;
+    memset((void*)guide_stats.lanes, 0, sizeof(guide_stats.lanes));
+
+    reaper_init(routing_table);
 
     kprintf("[GUIDE] Initialized (4 decks: OPERATIONS, STORAGE, HARDWARE, NETWORK)\n");
 }
 
 // ============================================================================
-// MAIN LOOP
+// ROUTING LOGIC
 // ============================================================================
 
-// Обёртка для синхронной обработки
-void guide_scan_and_dispatch(RoutingTable* routing_table) {
-    guide_scan_and_route(&guide_context);
-    atomic_increment_u64((volatile uint64_t*)&guide_stats.routing_iterations);
+// Retry item = handle + очередь-получатель (0 = Execution, 1-4 = deck):
+// в fan-out одна entry ждёт повтора в нескольких очередях
+#define GUIDE_RETRY_TARGET_SHIFT 24
+
+_Static_assert(ROUTING_MAX_ENTRIES <= (1 << GUIDE_RETRY_TARGET_SHIFT),
+               "pool slot must leave room for the retry target");
+
+static void guide_push(uint32_t target, RoutingHandle handle) {
+    if (target == 0) {
+        if (deck_queue_push(&guide_context.execution_queue, handle)) {
+            idle_notify(EVENTDRIVEN_STAGE_EXECUTION);
+            return;
+        }
+    } else if (deck_submit((uint8_t)target, handle)) {
+        return;
+    }
+
+    // Очередь переполнена - Guide повторит hand-off позже.
+    // retry_queue вмещает все items (guide.h): item, который Guide взял, но
+    // ещё не освободил, тоже входит в этот счёт. Провал push - нарушенный
+    // инвариант (лишние items на entry), а не временное состояние: ждать
+    // нечего, молча терять entry нельзя
+    atomic_increment_u64((volatile uint64_t*)&guide_stats.dispatch_retries);
+    uint64_t item = handle | ((uint64_t)target << GUIDE_RETRY_TARGET_SHIFT);
+    if (!guide_retry_push(&guide_context.retry_queue, item)) {
+        panic("[GUIDE] Retry queue full (head=%lu tail=%lu, capacity %u): more than %u items per routing entry",
+              atomic_load_u64(&guide_context.retry_queue.head),
+              atomic_load_u64(&guide_context.retry_queue.tail),
+              GUIDE_RETRY_QUEUE_SIZE, GUIDE_RETRY_ITEMS_PER_ENTRY);
+    }
+    idle_notify(EVENTDRIVEN_STAGE_GUIDE);
 }
 
-void guide_run(void) {
-    kprintf("[GUIDE] Starting main loop...\n");
+// Entry уходит в Execution: latency её lane
+static void guide_complete(RoutingEntry* entry) {
+    GuideLaneStats* lane = &guide_stats.lanes[event_lane(entry->event_copy.flags)];
+    entry->completed_at = rdtsc();
+    atomic_increment_u64((volatile uint64_t*)&guide_stats.events_completed);
+    atomic_increment_u64(&lane->completed);
+    atomic_fetch_add_u64(&lane->latency_cycles, entry->completed_at - entry->event_copy.timestamp);
+}
+
+void guide_execute(RoutingHandle handle) {
+    guide_push(0, handle);
+}
+
+// Прямой hand-off: отправляет следующую волну route DAG в decks или entry в
+// Execution. Вызывается Center'ом после публикации entry и последней веткой
+// волны (join в deck_run_once). После вызова entry принадлежит получателям -
+// вызывающий её больше не трогает (hold отпускается перед первым push).
+void guide_route_entry(RoutingEntry* entry) {
+    RoutingHandle handle = routing_entry_handle(entry);
+
+    // Завершённые шаги: deck затёр prefix (несуществующие шаги тоже = 0)
+    uint32_t done = 0;
+    for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
+        if (entry->prefixes[i] == DECK_PREFIX_NONE) {
+            done |= 1u << i;
+        }
+    }
+
+    // Волна = все шаги, чьи зависимости выполнены (один шаг на deck)
+    uint32_t wave_steps = 0;
+    uint32_t wave_decks = 0;
+    if (!entry->abort_flag && done != (1u << MAX_ROUTING_STEPS) - 1) {
+        for (int i = 0; i < MAX_ROUTING_STEPS; i++) {
+            uint8_t prefix = entry->prefixes[i];
+            if (prefix == DECK_PREFIX_NONE || (entry->depends[i] & ~done)) {
+                continue;
+            }
+            if (prefix < 1 || prefix > 4) {
+                // Неизвестный deck - прерываем, иначе entry зависнет навсегда
+                atomic_store_u32(&entry->abort_flag, 1);
+                break;
+            }
+            uint32_t deck_bit = 1u << (prefix - 1);
+            if (!(wave_decks & deck_bit)) {
+                wave_steps |= 1u << i;
+                wave_decks |= deck_bit;
+            }
+        }
+
+        if (!wave_steps && !entry->abort_flag) {
+            // Остались шаги, но ни один не готов: цикл в графе маршрута
+            atomic_store_u32(&entry->abort_flag, 1);
+        }
+    }
 
-    uint64_t iterations = 0;
+    if (entry->abort_flag) {
+        // Прерываем обработку - очищаем все префиксы и отправляем в Execution
+        for (int j = 0; j < MAX_ROUTING_STEPS; j++) {
+            entry->prefixes[j] = DECK_PREFIX_NONE;
+        }
+        entry->state = EVENT_STATUS_ERROR;
+        guide_complete(entry);
+        routing_entry_leave(entry, handle);
+        guide_push(0, handle);
+        return;
+    }
 
-    while (1) {
-        // Сканируем routing table и маршрутизируем события
-        guide_scan_and_route(&guide_context);
+    if (!wave_steps) {
+        // Все префиксы обработаны! Отправляем в Execution Deck
+        entry->state = EVENT_STATUS_SUCCESS;
+        guide_complete(entry);
+        routing_entry_leave(entry, handle);
+        guide_push(0, handle);
+        return;
+    }
 
-        atomic_increment_u64((volatile uint64_t*)&guide_stats.routing_iterations);
+    // Готовим join до первого push: ветки могут завершиться сразу.
+    // NOTE: prefix НЕ затираем - deck сам затрет после обработки
+    uint32_t branches = 0;
+    for (uint32_t bits = wave_decks; bits; bits &= bits - 1) {
+        branches++;
+    }
+    entry->wave_steps = wave_steps;
+    entry->wave_decks = wave_decks;
+    if (branches > entry->max_wave) {
+        entry->max_wave = branches;
+    }
+    atomic_store_u32(&entry->completion_flags, entry->completion_flags & ~wave_decks);
+    atomic_fetch_add_u64((volatile uint64_t*)&guide_stats.events_routed, branches);
+    if (branches > 1) {
+        atomic_increment_u64((volatile uint64_t*)&guide_stats.fanout_waves);
+    }
 
-        // Пауза для снижения нагрузки на CPU
-        cpu_pause();
+    // Время hand-off - для queue-wait (core/latency.h); deck_complete
+    // перепишет его временем завершения
+    uint64_t now = rdtsc();
+    for (uint32_t prefix = 1; prefix <= 4; prefix++) {
+        if (wave_decks & (1u << (prefix - 1))) {
+            entry->deck_timestamps[prefix - 1] = now;
+        }
+    }
 
-        // Периодическая статистика
-        iterations++;
-        if (iterations % 10000000 == 0) {
-            guide_print_stats();
+    // Рассылаем по локальной маске: entry уже может принадлежать веткам
+    // (или reaper'у - тогда ветки отбросят handle)
+    routing_entry_leave(entry, handle);
+    for (uint32_t prefix = 1; prefix <= 4; prefix++) {
+        if (wave_decks & (1u << (prefix - 1))) {
+            guide_push(prefix, handle);
         }
     }
 }
 
 // ============================================================================
-// GETTERS
+// MAIN LOOP
 // ============================================================================
 
-DeckQueue* guide_get_deck_queue(uint8_t deck_prefix) {
-    // НОВАЯ АРХИТЕКТУРА: префиксы 1-4
-    if (deck_prefix >= 1 && deck_prefix <= 4) {
-        return &guide_context.deck_queues[deck_prefix];
+// Повторяет hand-off для entries из retry_queue. Берём не больше, чем лежало
+// на момент входа: entry, снова не влезшая в очередь deck, ждёт следующего прохода.
+int guide_dispatch_retries(void) {
+    GuideRetryQueue* retry = &guide_context.retry_queue;
+    uint64_t pending = atomic_load_u64(&retry->tail) - atomic_load_u64(&retry->head);
+    int dispatched = 0;
+
+    while (pending-- > 0) {
+        uint64_t item = guide_retry_pop(retry);
+        if (item == ROUTING_HANDLE_NONE) {
+            break;
+        }
+
+        uint32_t target = (uint32_t)(item >> GUIDE_RETRY_TARGET_SHIFT) & 0xFF;
+        RoutingHandle handle = item & ~(0xFFULL << GUIDE_RETRY_TARGET_SHIFT);
+
+        // Stale handle (entry отменена/освобождена) просто отбрасываем
+        if (routing_pool_resolve(handle)) {
+            guide_push(target, handle);
+        }
+        dispatched++;
     }
-    return 0;
+
+    atomic_increment_u64((volatile uint64_t*)&guide_stats.routing_iterations);
+    return dispatched;
 }
 
+// ============================================================================
+// GETTERS
+// ============================================================================
+
 DeckQueue* guide_get_execution_queue(void) {
     return &guide_context.execution_queue;
 }
@@ -85,8 +228,19 @@ DeckQueue* guide_get_execution_queue(void) {
 // ============================================================================
 
 void guide_print_stats(void) {
-    kprintf("[GUIDE] Stats: routed=%lu completed=%lu iterations=%lu\n",
+    kprintf("[GUIDE] Stats: routed=%lu completed=%lu iterations=%lu retries=%lu fanout=%lu\n",
             guide_stats.events_routed,
             guide_stats.events_completed,
-            guide_stats.routing_iterations);
+            guide_stats.routing_iterations,
+            guide_stats.dispatch_retries,
+            guide_stats.fanout_waves);
+
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        GuideLaneStats* stats = &guide_stats.lanes[lane];
+        kprintf("[GUIDE]   lane %s: queued=%lu completed=%lu avg_latency=%lu cycles\n",
+                event_lane_name(lane), stats->queued, stats->completed,
+                stats->completed ? stats->latency_cycles / stats->completed : 0);
+    }
+
+    reaper_print_stats();
 }
@@ -9,87 +9,159 @@
 // GUIDE - Динамическая маршрутизация событий к Decks
 // ============================================================================
 //
-// Функции:
-// 1. Сканирует routing table для событий, ожидающих обработки
-// 2. Читает следующий prefix из routing entry
-// 3. Отправляет событие в соответствующий Deck
-// 4. Проверяет завершение обработки decks (префикс затёрт?)
-// 5. Если все префиксы = 0, отправляет в Execution Deck
+// Маршрутизация event-driven (прямой hand-off, без сканирования таблицы):
+// 1. Center публикует entry и сразу вызывает guide_route_entry()
+// 2. guide_route_entry() берёт волну - все шаги route DAG, чьи depends
+//    выполнены - и кладёт entry в очереди этих decks (параллельные ветки)
+// 3. Deck после обработки (prefix затёрт) ставит бит в completion_flags;
+//    последняя ветка волны снова вызывает guide_route_entry() (join)
+// 4. Если все префиксы = 0 (или abort), entry уходит в Execution Deck
+//
+// Routing table используется только для lookup/отмены. Сам Guide лишь
+// повторяет hand-off для entries, которые не влезли в переполненную
+// очередь deck (retry_queue), и отменяет просроченные (guide/reaper.h).
 //
 // ============================================================================
 
 // Forward declarations для deck queues
 typedef struct DeckQueue DeckQueue;
 
+// Статистика QoS lane
+typedef struct {
+    volatile uint64_t queued;             // Handles в inboxes deck workers (глубина lane)
+    volatile uint64_t completed;
+    volatile uint64_t latency_cycles;     // Receiver timestamp -> hand-off в Execution
+} GuideLaneStats;
+
 // Статистика
 typedef struct {
     volatile uint64_t events_routed;
     volatile uint64_t events_completed;
     volatile uint64_t routing_iterations;
+    volatile uint64_t dispatch_retries;   // Hand-off отложен: очередь deck была полна
+    volatile uint64_t fanout_waves;       // Волны с несколькими параллельными ветками
+    GuideLaneStats lanes[EVENT_LANE_COUNT];
 } GuideStats;
 
 extern GuideStats guide_stats;
 
 // ============================================================================
-// DECK QUEUE - Очередь событий для каждого deck
+// DECK QUEUE - Очередь событий для каждого deck (MPMC)
 // ============================================================================
+//
+// Producers: Center + любой deck, завершивший предыдущий шаг + Guide (retry)
+// Consumers: deck (или Execution). Поэтому очередь MPMC - sequence counters
+// как у RING_MODE_MPMC (см. ring_mpmc_* в ringbuffer.h).
 
-// Уменьшено для экономии памяти
-#define DECK_QUEUE_SIZE 128
+// Ёмкость routing table: переполнение inbox - не потеря, а retry_queue
+#define DECK_QUEUE_SIZE ROUTING_MAX_ENTRIES
 #define DECK_QUEUE_MASK (DECK_QUEUE_SIZE - 1)
 
+_Static_assert((DECK_QUEUE_SIZE & (DECK_QUEUE_SIZE - 1)) == 0,
+               "DECK_QUEUE_SIZE must be power of 2");
+
 struct DeckQueue {
     volatile uint64_t head __attribute__((aligned(64)));
     volatile uint64_t tail __attribute__((aligned(64)));
 
-    // Вместо копирования Event, храним указатели на RoutingEntry
-    RoutingEntry* entries[DECK_QUEUE_SIZE] __attribute__((aligned(64)));
+    volatile uint64_t seq[DECK_QUEUE_SIZE] __attribute__((aligned(64)));
+
+    // Вместо копирования Event, храним handles RoutingEntry (см. routing_pool.h)
+    RoutingHandle handles[DECK_QUEUE_SIZE] __attribute__((aligned(64)));
 };
 
 // Операции с deck queue
 static inline void deck_queue_init(DeckQueue* queue) {
     atomic_store_u64(&queue->head, 0);
     atomic_store_u64(&queue->tail, 0);
+    ring_mpmc_init_seq(queue->seq, DECK_QUEUE_SIZE);
 }
 
-static inline int deck_queue_push(DeckQueue* queue, RoutingEntry* entry) {
-    uint64_t current_tail = atomic_load_u64(&queue->tail);
-    uint64_t current_head = atomic_load_u64(&queue->head);
-
-    if ((current_tail - current_head) >= DECK_QUEUE_SIZE) {
+static inline int deck_queue_push(DeckQueue* queue, RoutingHandle handle) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_push(&queue->tail, queue->seq, DECK_QUEUE_SIZE, &pos)) {
         return 0;  // Queue full
     }
 
-    uint64_t index = current_tail & DECK_QUEUE_MASK;
-    queue->entries[index] = entry;
-
-    COMPILER_BARRIER();
-    atomic_store_u64(&queue->tail, current_tail + 1);
+    queue->handles[pos & DECK_QUEUE_MASK] = handle;
+    ring_mpmc_publish(queue->seq, DECK_QUEUE_SIZE, pos);
 
     return 1;
 }
 
-static inline RoutingEntry* deck_queue_pop(DeckQueue* queue) {
-    uint64_t current_head = atomic_load_u64(&queue->head);
-    uint64_t current_tail = atomic_load_u64(&queue->tail);
-
-    if (current_head == current_tail) {
-        return 0;  // Queue empty
+static inline RoutingHandle deck_queue_pop(DeckQueue* queue) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_pop(&queue->head, queue->seq, DECK_QUEUE_SIZE, &pos)) {
+        return ROUTING_HANDLE_NONE;  // Queue empty
     }
 
-    uint64_t index = current_head & DECK_QUEUE_MASK;
-    RoutingEntry* entry = queue->entries[index];
+    RoutingHandle handle = queue->handles[pos & DECK_QUEUE_MASK];
+    ring_mpmc_release(queue->seq, DECK_QUEUE_SIZE, pos);
 
-    COMPILER_BARRIER();
-    atomic_store_u64(&queue->head, current_head + 1);
-
-    return entry;
+    return handle;
 }
 
 static inline int deck_queue_is_empty(DeckQueue* queue) {
     return atomic_load_u64(&queue->head) == atomic_load_u64(&queue->tail);
 }
 
+// ============================================================================
+// RETRY QUEUE - Отложенные hand-off'ы (MPMC, consumer - только Guide)
+// ============================================================================
+//
+// Item = handle + получатель. У живой entry не больше 4 items: по одному на
+// deck волны (fan-out) или один в Execution. Reaper (тоже Guide) может
+// отменить entry, чьи items ещё в очереди, - они становятся stale и уходят
+// на ближайшем guide_dispatch_retries, раньше, чем reaper снова заберёт
+// этот slot: ещё до 4 items на slot. Поэтому push в retry_queue всегда
+// находит место, и Guide, повторяя hand-off, не ждёт сам себя.
+// Провал push - нарушенный инвариант: guide_push паникует, а не крутится.
+
+#define GUIDE_RETRY_ITEMS_PER_ENTRY 4
+#define GUIDE_RETRY_QUEUE_SIZE      (2 * GUIDE_RETRY_ITEMS_PER_ENTRY * ROUTING_MAX_ENTRIES)
+#define GUIDE_RETRY_QUEUE_MASK      (GUIDE_RETRY_QUEUE_SIZE - 1)
+
+_Static_assert((GUIDE_RETRY_QUEUE_SIZE & (GUIDE_RETRY_QUEUE_SIZE - 1)) == 0,
+               "GUIDE_RETRY_QUEUE_SIZE must be power of 2");
+_Static_assert(GUIDE_RETRY_QUEUE_SIZE >= 2 * GUIDE_RETRY_ITEMS_PER_ENTRY * ROUTING_MAX_ENTRIES,
+               "retry queue must hold live and stale items of every routing entry");
+
+typedef struct {
+    volatile uint64_t head __attribute__((aligned(64)));
+    volatile uint64_t tail __attribute__((aligned(64)));
+
+    volatile uint64_t seq[GUIDE_RETRY_QUEUE_SIZE] __attribute__((aligned(64)));
+    uint64_t items[GUIDE_RETRY_QUEUE_SIZE] __attribute__((aligned(64)));
+} GuideRetryQueue;
+
+static inline void guide_retry_init(GuideRetryQueue* queue) {
+    atomic_store_u64(&queue->head, 0);
+    atomic_store_u64(&queue->tail, 0);
+    ring_mpmc_init_seq(queue->seq, GUIDE_RETRY_QUEUE_SIZE);
+}
+
+static inline int guide_retry_push(GuideRetryQueue* queue, uint64_t item) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_push(&queue->tail, queue->seq, GUIDE_RETRY_QUEUE_SIZE, &pos)) {
+        return 0;
+    }
+
+    queue->items[pos & GUIDE_RETRY_QUEUE_MASK] = item;
+    ring_mpmc_publish(queue->seq, GUIDE_RETRY_QUEUE_SIZE, pos);
+    return 1;
+}
+
+static inline uint64_t guide_retry_pop(GuideRetryQueue* queue) {
+    uint64_t pos;
+    if (!ring_mpmc_claim_pop(&queue->head, queue->seq, GUIDE_RETRY_QUEUE_SIZE, &pos)) {
+        return ROUTING_HANDLE_NONE;
+    }
+
+    uint64_t item = queue->items[pos & GUIDE_RETRY_QUEUE_MASK];
+    ring_mpmc_release(queue->seq, GUIDE_RETRY_QUEUE_SIZE, pos);
+    return item;
+}
+
 // ============================================================================
 // GUIDE CONTEXT - Глобальное состояние Guide
 // ============================================================================
@@ -97,14 +169,13 @@ static inline int deck_queue_is_empty(DeckQueue* queue) {
 typedef struct {
     RoutingTable* routing_table;
 
-    // Очереди для каждого deck (НОВАЯ АРХИТЕКТУРА v1)
-    DeckQueue deck_queues[5];  // 0 = unused, 1-4 = deck prefixes (OPERATIONS, STORAGE, HARDWARE, NETWORK)
+    // Очереди decks - inbox'ы их workers (decks/deck_interface.h)
 
     // Очередь для Execution Deck (завершённые события)
     DeckQueue execution_queue;
 
-    // Scan position в routing table (для round-robin)
-    volatile uint64_t scan_position;
+    // Entries, чей hand-off не прошёл (очередь deck/execution была полна)
+    GuideRetryQueue retry_queue;
 } GuideContext;
 
 extern GuideContext guide_context;
@@ -119,91 +190,40 @@ void guide_init(RoutingTable* routing_table);
 // ROUTING LOGIC
 // ============================================================================
 
-// Сканирует routing table и маршрутизирует события
-static inline void guide_scan_and_route(GuideContext* ctx) {
-    RoutingTable* table = ctx->routing_table;
-
-    // Сканируем несколько buckets за один проход (batch processing)
-    for (int batch = 0; batch < 16; batch++) {
-        uint64_t pos = atomic_load_u64(&ctx->scan_position);
-        uint64_t bucket_index = pos % ROUTING_TABLE_SIZE;
-
-        RoutingBucket* bucket = &table->buckets[bucket_index];
-
-        // Lock bucket
-        bucket_lock(bucket);
-
-        // Проверяем каждую entry в bucket
-        for (int i = 0; i < BUCKET_CAPACITY; i++) {
-            RoutingEntry* entry = &bucket->entries[i];
-
-            if (entry->event_id == 0) {
-                continue;  // Empty slot
-            }
-
-            if (entry->state != EVENT_STATUS_PROCESSING) {
-                continue;  // Не в состоянии обработки
-            }
-
-            // Получаем следующий prefix
-            uint8_t next_prefix = routing_entry_get_next_prefix(entry);
-
-            if (next_prefix == DECK_PREFIX_NONE) {
-                // Все префиксы обработаны! Отправляем в Execution Deck
-                if (deck_queue_push(&ctx->execution_queue, entry)) {
-                    entry->state = EVENT_STATUS_SUCCESS;
-                    atomic_increment_u64((volatile uint64_t*)&guide_stats.events_completed);
-                }
-            } else {
-                // Проверяем abort_flag - если установлен, пропускаем обработку
-                if (entry->abort_flag) {
-                    // Прерываем обработку - очищаем все префиксы и отправляем в Execution
-                    for (int j = 0; j < MAX_ROUTING_STEPS; j++) {
-                        entry->prefixes[j] = DECK_PREFIX_NONE;
-                    }
-                    if (deck_queue_push(&ctx->execution_queue, entry)) {
-                        entry->state = EVENT_STATUS_ERROR;
-                        atomic_increment_u64((volatile uint64_t*)&guide_stats.events_completed);
-                    }
-                } else {
-                    // Отправляем в соответствующий deck (НОВАЯ АРХИТЕКТУРА: префиксы 1-4)
-                    if (next_prefix >= 1 && next_prefix <= 4) {
-                        if (deck_queue_push(&ctx->deck_queues[next_prefix], entry)) {
-                            // ИСПРАВЛЕНО: НЕ затираем prefix! Deck сам затрет после обработки!
-                            atomic_increment_u64((volatile uint64_t*)&guide_stats.events_routed);
-                        }
-                    }
-                }
-            }
-        }
-
-        bucket_unlock(bucket);
-
-        // Двигаем scan position
-        atomic_increment_u64(&ctx->scan_position);
-    }
-}
+// Прямой hand-off: отправляет следующую волну route DAG в decks или entry
+// в Execution. Вызывается Center'ом после публикации entry и последней
+// веткой волны. После вызова entry принадлежит получателям.
+void guide_route_entry(RoutingEntry* entry);
+
+// Entry сразу в Execution, минуя decks (reaper: дедлайн истёк)
+void guide_execute(RoutingHandle handle);
 
 // ============================================================================
 // MAIN LOOP
 // ============================================================================
 
-// Обработать один проход сканирования (для синхронной обработки)
-void guide_scan_and_dispatch(RoutingTable* routing_table);
+// Повторить hand-off для отложенных entries (для синхронной обработки).
+// Возвращает количество entries, взятых из retry_queue.
+int guide_dispatch_retries(void);
+
+// ============================================================================
+// GETTERS
+// ============================================================================
 
-void guide_run(void);
+DeckQueue* guide_get_execution_queue(void);
 
 // ============================================================================
-// STATS
+// DECK HAND-OFF (реализовано в decks/deck_interface.c)
 // ============================================================================
 
-void guide_print_stats(void);
+// Кладёт handle в inbox наименее загруженного worker'а deck и будит его.
+// 0 = inbox полон (Guide повторит hand-off через retry_queue)
+int deck_submit(uint8_t deck_prefix, RoutingHandle handle);
 
 // ============================================================================
-// GETTERS для deck queues (используется decks)
+// STATS
 // ============================================================================
 
-DeckQueue* guide_get_deck_queue(uint8_t deck_prefix);
-DeckQueue* guide_get_execution_queue(void);
+void guide_print_stats(void);
 
 #endif // GUIDE_H
@@ -0,0 +1,132 @@
+#include "reaper.h"
+#include "guide.h"
+#include "pit.h"
+#include "../core/idle.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+ReaperStats reaper_stats;
+
+static RoutingTable* reaper_table = 0;
+static volatile uint64_t reaper_next_scan;     // PIT tick следующего прохода
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void reaper_init(RoutingTable* table) {
+    memset(&reaper_stats, 0, sizeof(reaper_stats));
+    reaper_next_scan = 0;
+    reaper_table = table;
+
+    kprintf("[REAPER] Initialized (default timeout %u ms, scan every %u ms)\n",
+            EVENT_TIMEOUT_DEFAULT_MS, REAPER_PERIOD_MS);
+}
+
+// ============================================================================
+// DEADLINES
+// ============================================================================
+
+// ms -> PIT ticks с округлением вверх; +1 - текущий tick уже идёт
+static inline uint64_t reaper_ticks(uint64_t ms) {
+    uint64_t frequency = pit_get_frequency();
+    return (ms * frequency + 999) / 1000 + 1;
+}
+
+uint64_t reaper_deadline(const Event* event) {
+    uint32_t ms = event_timeout_ms(event->flags);
+    if (!ms) {
+        ms = event_registry_lookup(event->type)->timeout_ms;
+        if (!ms) {
+            ms = EVENT_TIMEOUT_DEFAULT_MS;
+        }
+    }
+    if (ms == EVENT_TIMEOUT_NONE || !pit_get_frequency()) {
+        return 0;
+    }
+    return pit_get_ticks() + reaper_ticks(ms);
+}
+
+// ============================================================================
+// REAPING (Guide)
+// ============================================================================
+
+void reaper_timer_tick(void) {
+    if (reaper_table && atomic_load_u64(&reaper_table->total_entries) &&
+        pit_get_ticks() >= reaper_next_scan) {
+        idle_notify(EVENTDRIVEN_STAGE_GUIDE);
+    }
+}
+
+// Забрать просроченную entry без держателей. Поколение читается до
+// дедлайна: если entry за это время выдали заново, CAS по нему не пройдёт
+static int reaper_try_reap(RoutingEntry* entry, uint64_t now) {
+    uint32_t generation = atomic_load_u32(&entry->generation);
+    uint64_t deadline = entry->deadline;
+    if (!deadline || now < deadline ||
+        atomic_load_u32(&entry->state) != EVENT_STATUS_PROCESSING) {
+        return 0;  // Не просрочена или уже идёт к ответу
+    }
+
+    if (!atomic_cas_u64(&entry->hold, routing_hold_make(generation, 0),
+                        routing_hold_make(generation, ROUTING_HOLD_REAPED))) {
+        if ((uint32_t)(entry->hold >> 32) == generation) {
+            atomic_increment_u64(&reaper_stats.held);
+        }
+        return 0;
+    }
+
+    // Entry наша: стадии её handle отбросят, ответ даст Execution
+    uint32_t type = entry->event_copy.type;
+    entry->state = EVENT_STATUS_TIMEOUT;
+    entry->error_code = 0;
+    atomic_store_u32(&entry->abort_flag, 1);
+
+    atomic_increment_u64(&reaper_stats.timeouts);
+    atomic_increment_u64(&reaper_stats.per_type[type & (EVENT_REGISTRY_SIZE - 1)]);
+    kprintf("[REAPER] Event %lu (type %u): deadline passed, TIMEOUT\n", entry->event_id, type);
+
+    guide_execute(routing_handle_make(entry->pool_slot, generation));
+    return 1;
+}
+
+int reaper_run(void) {
+    uint64_t now = pit_get_ticks();
+    uint64_t next = atomic_load_u64(&reaper_next_scan);
+    if (!reaper_table || now < next ||
+        !atomic_cas_u64(&reaper_next_scan, next, now + reaper_ticks(REAPER_PERIOD_MS) - 1)) {
+        return 0;
+    }
+    if (!atomic_load_u64(&reaper_table->total_entries)) {
+        return 0;
+    }
+
+    atomic_increment_u64(&reaper_stats.scans);
+    int reaped = 0;
+    uint32_t slots = routing_pool_slots();
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        RoutingEntry* entry = routing_pool_peek(slot);
+        if (entry) {
+            reaped += reaper_try_reap(entry, now);
+        }
+    }
+    return reaped;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void reaper_print_stats(void) {
+    kprintf("[REAPER] Stats: scans=%lu timeouts=%lu held=%lu\n",
+            reaper_stats.scans, reaper_stats.timeouts, reaper_stats.held);
+
+    for (uint32_t type = 0; type < EVENT_REGISTRY_SIZE; type++) {
+        if (reaper_stats.per_type[type]) {
+            kprintf("[REAPER]   type %u: timeouts=%lu\n", type, reaper_stats.per_type[type]);
+        }
+    }
+}
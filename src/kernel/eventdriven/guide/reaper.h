@@ -0,0 +1,52 @@
+#ifndef REAPER_H
+#define REAPER_H
+
+#include "../core/events.h"
+#include "../routing/routing_table.h"
+#include "../routing/event_registry.h"
+
+// ============================================================================
+// REAPER - дедлайны событий и отмена застрявших routing entries
+// ============================================================================
+//
+// Center (и chain_advance для каждого звена) ставит RoutingEntry.deadline -
+// PIT tick из таймаута события (Event.flags, event_timeout_ms) или типа
+// (event_registry .timeout_ms). Без reaper entry, чей hand-off потерян или
+// чья очередь стоит за зависшим deck, занимала бы slot таблицы навсегда.
+//
+// Прерывание таймера (reaper_timer_tick) будит Guide, когда пора проходить
+// по pool; Guide (reaper_run) раз в REAPER_PERIOD_MS забирает просроченные
+// entries без держателей (routing_pool.h, HOLD) и отдаёт их в Execution
+// со статусом EVENT_STATUS_TIMEOUT. Ответ, waiters coalescing, отмена
+// остатка цепочки, кредит и освобождение slot'а - обычный путь Execution.
+//
+// Entry, которую держит стадия (handler ещё выполняется), reaper не
+// трогает: ответ на неё даст сам deck.
+//
+// ============================================================================
+
+#define REAPER_PERIOD_MS        10      // Проход по pool не чаще
+
+typedef struct {
+    volatile uint64_t scans;
+    volatile uint64_t timeouts;
+    volatile uint64_t held;             // Просрочена, но её держит стадия (за проход)
+    volatile uint64_t per_type[EVENT_REGISTRY_SIZE];  // timeouts по EventType
+} ReaperStats;
+
+extern ReaperStats reaper_stats;
+
+void reaper_init(RoutingTable* table);
+
+// Center / chain_advance: дедлайн события (PIT tick), 0 = без дедлайна
+uint64_t reaper_deadline(const Event* event);
+
+// Прерывание таймера: будит Guide, если пора проход и entries есть
+void reaper_timer_tick(void);
+
+// Guide: проход по pool, если пора. Возвращает число отменённых entries
+int reaper_run(void);
+
+void reaper_print_stats(void);
+
+#endif // REAPER_H
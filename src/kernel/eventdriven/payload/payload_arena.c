@@ -0,0 +1,141 @@
+#include "payload_arena.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+static uint8_t payload_arena_memory[PAYLOAD_ARENA_SIZE] __attribute__((aligned(4096)));
+
+// Бит i = блок i занят
+static volatile uint64_t payload_bitmap;
+
+// Длина run для первого блока каждой аллокации (нужна при release)
+static volatile uint8_t payload_run_length[PAYLOAD_BLOCK_COUNT];
+
+PayloadArenaStats payload_arena_stats;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void payload_arena_init(void) {
+    atomic_store_u64(&payload_bitmap, 0);
+    for (int i = 0; i < PAYLOAD_BLOCK_COUNT; i++) {
+        payload_run_length[i] = 0;
+    }
+
+    payload_arena_stats.allocations = 0;
+    payload_arena_stats.releases = 0;
+    payload_arena_stats.failures = 0;
+    payload_arena_stats.bad_releases = 0;
+
+    kprintf("[PAYLOAD] Arena initialized (%d blocks x %d bytes)\n",
+            PAYLOAD_BLOCK_COUNT, PAYLOAD_BLOCK_SIZE);
+}
+
+// ============================================================================
+// ALLOC / RELEASE
+// ============================================================================
+
+// Маска из blocks единиц начиная с бита first
+static inline uint64_t payload_run_mask(uint32_t first, uint32_t blocks) {
+    uint64_t ones = (blocks >= 64) ? ~0ULL : ((1ULL << blocks) - 1);
+    return ones << first;
+}
+
+uint32_t payload_arena_alloc(uint64_t size) {
+    if (size == 0 || size > PAYLOAD_MAX_SIZE) {
+        atomic_increment_u64(&payload_arena_stats.failures);
+        return PAYLOAD_OFFSET_NONE;
+    }
+
+    uint32_t blocks = (uint32_t)((size + PAYLOAD_BLOCK_SIZE - 1) / PAYLOAD_BLOCK_SIZE);
+
+    for (;;) {
+        uint64_t bitmap = atomic_load_u64(&payload_bitmap);
+        int found = -1;
+
+        // Ищем первый непрерывный run свободных блоков
+        for (uint32_t first = 0; first + blocks <= PAYLOAD_BLOCK_COUNT; first++) {
+            if ((bitmap & payload_run_mask(first, blocks)) == 0) {
+                found = (int)first;
+                break;
+            }
+        }
+
+        if (found < 0) {
+            atomic_increment_u64(&payload_arena_stats.failures);
+            return PAYLOAD_OFFSET_NONE;
+        }
+
+        uint64_t mask = payload_run_mask((uint32_t)found, blocks);
+        if (atomic_cas_u64(&payload_bitmap, bitmap, bitmap | mask)) {
+            payload_run_length[found] = (uint8_t)blocks;
+            atomic_increment_u64(&payload_arena_stats.allocations);
+            return (uint32_t)found * PAYLOAD_BLOCK_SIZE;
+        }
+        // Bitmap изменился - повторяем
+    }
+}
+
+void* payload_arena_ptr(uint32_t offset) {
+    if (offset == PAYLOAD_OFFSET_NONE || offset >= PAYLOAD_ARENA_SIZE) {
+        return 0;
+    }
+    return &payload_arena_memory[offset];
+}
+
+void payload_arena_release(uint32_t offset) {
+    if (offset == PAYLOAD_OFFSET_NONE) {
+        return;
+    }
+
+    uint32_t first = offset / PAYLOAD_BLOCK_SIZE;
+    if ((offset % PAYLOAD_BLOCK_SIZE) != 0 || first >= PAYLOAD_BLOCK_COUNT ||
+        payload_run_length[first] == 0) {
+        atomic_increment_u64(&payload_arena_stats.bad_releases);
+        return;
+    }
+
+    uint64_t mask = payload_run_mask(first, payload_run_length[first]);
+    payload_run_length[first] = 0;
+
+    for (;;) {
+        uint64_t bitmap = atomic_load_u64(&payload_bitmap);
+        if ((bitmap & mask) != mask) {
+            atomic_increment_u64(&payload_arena_stats.bad_releases);
+            return;  // Двойное освобождение
+        }
+        if (atomic_cas_u64(&payload_bitmap, bitmap, bitmap & ~mask)) {
+            break;
+        }
+    }
+
+    atomic_increment_u64(&payload_arena_stats.releases);
+}
+
+void* payload_arena_base(void) {
+    return payload_arena_memory;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void payload_arena_print_stats(void) {
+    uint64_t bitmap = atomic_load_u64(&payload_bitmap);
+    int used = 0;
+    for (int i = 0; i < PAYLOAD_BLOCK_COUNT; i++) {
+        if (bitmap & (1ULL << i)) {
+            used++;
+        }
+    }
+
+    kprintf("[PAYLOAD] Stats: allocs=%lu releases=%lu failures=%lu bad_releases=%lu blocks_used=%d/%d\n",
+            payload_arena_stats.allocations,
+            payload_arena_stats.releases,
+            payload_arena_stats.failures,
+            payload_arena_stats.bad_releases,
+            used, PAYLOAD_BLOCK_COUNT);
+}
@@ -0,0 +1,63 @@
+#ifndef PAYLOAD_ARENA_H
+#define PAYLOAD_ARENA_H
+
+#include "../core/atomics.h"
+#include "ktypes.h"
+
+// ============================================================================
+// PAYLOAD ARENA - Out-of-line результаты для компактных Response
+// ============================================================================
+//
+// Response в ring теперь 64 байта: всё, что не помещается в inline result
+// (RESPONSE_INLINE_SIZE), deck кладёт в общую arena и передаёт смещение
+// через Response.payload_offset. Consumer (user) читает payload по смещению
+// и ЯВНО освобождает его через payload_arena_release().
+//
+// Arena = PAYLOAD_BLOCK_COUNT блоков по PAYLOAD_BLOCK_SIZE байт.
+// Занятость - 64-битный bitmap, захват непрерывного run блоков одним CAS.
+//
+// ============================================================================
+
+#define PAYLOAD_BLOCK_SIZE   4096
+#define PAYLOAD_BLOCK_COUNT  64
+#define PAYLOAD_ARENA_SIZE   (PAYLOAD_BLOCK_SIZE * PAYLOAD_BLOCK_COUNT)  // 256KB
+
+// Максимальный размер одного payload (не даём одному ответу занять всю arena)
+#define PAYLOAD_MAX_SIZE     (PAYLOAD_ARENA_SIZE / 4)
+
+// Смещение "нет payload" (результат inline)
+#define PAYLOAD_OFFSET_NONE  0xFFFFFFFF
+
+_Static_assert(PAYLOAD_BLOCK_COUNT == 64, "bitmap is a single uint64_t");
+
+typedef struct {
+    volatile uint64_t allocations;
+    volatile uint64_t releases;
+    volatile uint64_t failures;       // Нет непрерывного места
+    volatile uint64_t bad_releases;   // Освобождение неверного смещения
+} PayloadArenaStats;
+
+extern PayloadArenaStats payload_arena_stats;
+
+// ============================================================================
+// API
+// ============================================================================
+
+void payload_arena_init(void);
+
+// Выделить payload размером size байт.
+// Возвращает смещение от начала arena или PAYLOAD_OFFSET_NONE.
+uint32_t payload_arena_alloc(uint64_t size);
+
+// Указатель на payload по смещению (0 если смещение неверное)
+void* payload_arena_ptr(uint32_t offset);
+
+// Освободить payload (вызывает consumer после чтения результата)
+void payload_arena_release(uint32_t offset);
+
+// Базовый адрес arena (для отображения в user space)
+void* payload_arena_base(void);
+
+void payload_arena_print_stats(void);
+
+#endif // PAYLOAD_ARENA_H
@@ -1,11 +1,12 @@
 #include "receiver.h"
+#include "../core/credits.h"
+#include "../core/idle.h"
 #include "klib.h"  // Для kprintf
 
 // ============================================================================
 // GLOBAL STATE
 // ============================================================================
 
-volatile uint64_t global_event_id_counter = 1;  // Начинаем с 1 (0 = invalid)
 ReceiverStats receiver_stats;
 
 // ============================================================================
@@ -13,42 +14,153 @@ ReceiverStats receiver_stats;
 // ============================================================================
 
 void receiver_init(void) {
-    global_event_id_counter = 1;
-
     receiver_stats.events_received = 0;
     receiver_stats.events_validated = 0;
     receiver_stats.events_rejected = 0;
     receiver_stats.events_forwarded = 0;
 
-    kprintf("[RECEIVER] Initialized (ID counter = %lu)\n", global_event_id_counter);
+    kprintf("[RECEIVER] Initialized (per-ring IDs, first global ID = 0x%lx)\n",
+            event_id_make(TASK_RING_GLOBAL, 0));
 }
 
 // ============================================================================
-// MAIN LOOP - Polling events from user space
+// BURST PROCESSING
 // ============================================================================
 
-void receiver_run(EventRingBuffer* from_user_ring, EventRingBuffer* to_center_ring) {
-    kprintf("[RECEIVER] Starting main loop...\n");
+uint64_t receiver_drain_burst(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                              uint64_t max) {
+    return receiver_drain_ring(from_user_ring, to_center_rings, max, TASK_RING_GLOBAL, 0, 0);
+}
+
+uint64_t receiver_drain_ring(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                             uint64_t max, uint32_t ring_id, uint64_t owner,
+                             volatile uint64_t* taken) {
+    // Не резервируем в Center больше, чем лежит в user ring
+    // (в MPMC захваченные, но пустые позиции пришлось бы публиковать пустышками)
+    uint64_t pending = event_ring_count(from_user_ring);
+    if (pending == 0) {
+        return 0;
+    }
+    if (pending < max) {
+        max = pending;
+    }
+
+    // Каждому забранному событию - кредит или ответ BUSY: без места в CQ
+    // события остаются в SQ (backpressure до самого submitter'а)
+    uint64_t room = credits_room(ring_id);
+    if (room < max) {
+        max = room;
+    }
+
+    // 1. Сначала место в Center rings - чтобы не забрать из user ring больше,
+    //    чем сможем отдать (лишние события остаются у user). Lane события
+    //    известна только после peek, поэтому каждая lane должна вместить всю
+    //    пачку: переполненная lane останавливает приём, пока Center её не разгрузит
+    uint64_t out_pos[EVENT_LANE_COUNT];
+    uint64_t reserved[EVENT_LANE_COUNT];
+    uint64_t used[EVENT_LANE_COUNT];
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        reserved[lane] = event_ring_reserve_batch(to_center_rings[lane], max, &out_pos[lane]);
+        used[lane] = 0;
+        if (reserved[lane] < max) {
+            max = reserved[lane];
+        }
+    }
+
+    uint64_t n = 0;
+    uint64_t in_pos = 0;
+    if (max > 0) {
+        n = event_ring_peek_batch(from_user_ring, max, &in_pos);
+    }
+
+    // 2. ID (ring + номер события в нём) и timestamp - один раз на пачку.
+    //    Индексы SQ пары задача может испортить - номер из kernel счётчика
+    uint64_t first_id = event_id_make(ring_id, taken ? *taken : in_pos);
+    if (taken) {
+        *taken += n;
+    }
+    uint64_t now = rdtsc();
+
+    uint64_t validated = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        Event* user_slot = event_ring_slot(from_user_ring, in_pos + i);
+        uint32_t lane = event_lane(user_slot->flags);  // Читаем user память один раз
+        Event* slot = event_ring_slot(to_center_rings[lane], out_pos[lane] + used[lane]);
+        used[lane]++;
+
+        // Единственная копия: user slot -> kernel-owned slot, валидируем копию
+        ring_copy_qwords(slot, user_slot, sizeof(Event));
+        slot->flags = (slot->flags & ~(EVENT_FLAGS_LANE_MASK | EVENT_FLAGS_RING_MASK)) |
+                      event_lane_flags(lane) | event_ring_id_flags(ring_id);
+        if (owner) {
+            slot->user_id = owner;  // Пара принадлежит одной задаче
+        }
 
-    Event event;
-    uint64_t iterations = 0;
+        if (!receiver_validate_event(slot)) {
+            slot->type = EVENT_NONE;  // Center пропустит
+            continue;
+        }
 
-    while (1) {
-        // Пытаемся получить событие из user→kernel ring buffer
-        if (event_ring_pop(from_user_ring, &event)) {
-            // Событие получено - обрабатываем
-            receiver_process_event(&event, to_center_ring);
-        } else {
-            // Буфер пуст - делаем паузу для снижения нагрузки на CPU
-            cpu_pause();
+        slot->id = first_id + i;
+        slot->timestamp = now;
+        if (!credits_acquire(ring_id)) {
+            credits_reject(ring_id, slot->id);
+            slot->type = EVENT_NONE;
+            continue;
         }
+        validated++;
+    }
+
+    // 3. Публикуем lanes в Center и освобождаем слоты user ring
+    for (uint32_t lane = 0; lane < EVENT_LANE_COUNT; lane++) {
+        event_ring_commit_partial(to_center_rings[lane], out_pos[lane], used[lane], reserved[lane]);
+    }
+    if (n == 0) {
+        return 0;
+    }
+    event_ring_release_batch(from_user_ring, in_pos, n);
+    if (validated) {
+        idle_notify(EVENTDRIVEN_STAGE_CENTER);  // Пустышки Center заберёт со следующими
+    }
+
+    atomic_fetch_add_u64(&receiver_stats.events_received, n);
+    atomic_fetch_add_u64(&receiver_stats.events_validated, validated);
+    atomic_fetch_add_u64(&receiver_stats.events_rejected, n - validated);
+    atomic_fetch_add_u64(&receiver_stats.events_forwarded, validated);
 
-        // Периодически выводим статистику (каждые 10 млн итераций)
-        iterations++;
-        if (iterations % 10000000 == 0) {
-            receiver_print_stats();
+    return n;
+}
+
+// Ring, с которого начнётся следующий проход (0 = глобальный)
+static uint32_t receiver_next_ring;
+
+uint64_t receiver_drain_all(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                            uint64_t max) {
+    uint32_t active = atomic_load_u32(&task_rings_state.active);
+    if (!active) {
+        return receiver_drain_burst(from_user_ring, to_center_rings, max);
+    }
+
+    // Нечётный счётчик = проход идёт (task_rings_unregister ждёт его конца)
+    atomic_increment_u64(&task_rings_state.passes);
+
+    uint32_t start = receiver_next_ring;
+    receiver_next_ring = (start + 1) % (TASK_RINGS_MAX + 1);
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i <= TASK_RINGS_MAX && total < max; i++) {
+        uint32_t id = (start + i) % (TASK_RINGS_MAX + 1);
+        if (id == TASK_RING_GLOBAL) {
+            total += receiver_drain_burst(from_user_ring, to_center_rings, max - total);
+        } else if (active & (1u << (id - 1))) {
+            TaskRingSlot* slot = &task_ring_slots[id];
+            total += receiver_drain_ring(&slot->rings->sq, to_center_rings, max - total,
+                                         id, slot->task_id, &slot->events);
         }
     }
+
+    atomic_increment_u64(&task_rings_state.passes);
+    return total;
 }
 
 // ============================================================================
@@ -4,6 +4,9 @@
 #include "../core/events.h"
 #include "../core/ringbuffer.h"
 #include "../core/atomics.h"
+#include "../core/task_rings.h"
+#include "../routing/event_registry.h"
+#include "smp.h"
 #include "klib.h"
 
 // ============================================================================
@@ -11,16 +14,18 @@
 // ============================================================================
 //
 // Функции:
-// 1. Получает события из user→kernel ring buffer
-// 2. Генерирует уникальные ID (SECURITY: только kernel может это делать!)
+// 1. Получает события из user→kernel ring buffer и SQ задач (core/task_rings.h)
+// 2. Назначает ID (events.h: ring + номер события в нём). SECURITY: номер
+//    для SQ пары - из kernel счётчика, индексам задачи не доверяем
 // 3. Валидирует события (проверка корректности полей)
 // 4. Добавляет timestamp
-// 5. Отправляет в Center для определения маршрута
+// 5. Отправляет в Center для определения маршрута - в ring своей QoS lane
+//    (Event.flags, см. event_lane())
 //
 // ============================================================================
 
-// Глобальный счётчик событий (atomic)
-extern volatile uint64_t global_event_id_counter;
+// Максимум событий, забираемых за одно пробуждение (burst)
+#define RECEIVER_BURST_SIZE 32
 
 // Статистика receiver
 typedef struct {
@@ -39,23 +44,14 @@ extern ReceiverStats receiver_stats;
 
 void receiver_init(void);
 
-// ============================================================================
-// ID GENERATION - Генерация уникальных ID
-// ============================================================================
-
-static inline uint64_t receiver_generate_event_id(void) {
-    // Атомарно инкрементируем глобальный счётчик
-    uint64_t id = atomic_increment_u64(&global_event_id_counter);
-    return id;
-}
-
 // ============================================================================
 // EVENT VALIDATION - Валидация события
 // ============================================================================
 
 static inline int receiver_validate_event(Event* event) {
-    // 1. Проверяем тип события
-    if (event->type == EVENT_NONE || event->type >= EVENT_MAX) {
+    // 1. Проверяем тип события: только типы из event_registry
+    //    (неизвестный тип не доходит до Center и decks)
+    if (event->type >= EVENT_MAX || !event_registry_lookup(event->type)->valid) {
         return 0;  // Invalid type
     }
 
@@ -107,49 +103,24 @@ static inline int receiver_validate_event(Event* event) {
     return 1;  // Событие валидно
 }
 
-// ============================================================================
-// EVENT PROCESSING - Обработка события
-// ============================================================================
-
-static inline void receiver_process_event(Event* event, EventRingBuffer* to_center_ring) {
-    // 1. Инкрементируем счётчик полученных событий
-    atomic_increment_u64((volatile uint64_t*)&receiver_stats.events_received);
-
-    // 2. Валидация
-    if (!receiver_validate_event(event)) {
-        atomic_increment_u64((volatile uint64_t*)&receiver_stats.events_rejected);
-        return;  // Отклоняем невалидное событие
-    }
-
-    atomic_increment_u64((volatile uint64_t*)&receiver_stats.events_validated);
-
-    // 3. Генерируем уникальный ID (ПЕРЕПИСЫВАЕМ поле id!)
-    event->id = receiver_generate_event_id();
-
-    // 4. Добавляем timestamp
-    event->timestamp = rdtsc();
-
-    // 5. Отправляем в Center для определения маршрута
-    // FIXED: Добавлен timeout чтобы избежать бесконечного зависания
-    uint64_t timeout = 1000000;  // ~1млн итераций
-    while (!event_ring_push(to_center_ring, event)) {
-        cpu_pause();
-        if (--timeout == 0) {
-            // Timeout - буфер переполнен слишком долго!
-            kprintf("[RECEIVER] ERROR: Center ring buffer timeout for event %lu\n", event->id);
-            atomic_increment_u64((volatile uint64_t*)&receiver_stats.events_rejected);
-            return;  // Отбрасываем событие
-        }
-    }
-
-    atomic_increment_u64((volatile uint64_t*)&receiver_stats.events_forwarded);
-}
-
-// ============================================================================
-// RECEIVER MAIN LOOP - Главный цикл (запускается на отдельном core)
-// ============================================================================
-
-void receiver_run(EventRingBuffer* from_user_ring, EventRingBuffer* to_center_ring);
+// Забирает до max событий из user ring одной пачкой и раскладывает их по
+// Center rings lanes (to_center_rings[EVENT_LANE_COUNT]), каждый ring -
+// одним обновлением индекса. Возвращает количество забранных событий.
+uint64_t receiver_drain_burst(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                              uint64_t max);
+
+// То же для SQ пары задачи: ring id ставится в Event.flags (ответ уйдёт в
+// CQ пары), user_id переписывается на owner. taken - kernel счётчик
+// забранных из SQ событий (seq первого ID пачки), 0 = позиции ring'а
+// принадлежат ядру (глобальный ring) и seq - сама позиция
+uint64_t receiver_drain_ring(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                             uint64_t max, uint32_t ring_id, uint64_t owner,
+                             volatile uint64_t* taken);
+
+// Глобальный ring + SQ всех зарегистрированных пар round-robin: каждый
+// вызов начинает со следующего ring, бюджет max - на весь проход
+uint64_t receiver_drain_all(EventRingBuffer* from_user_ring, EventRingBuffer** to_center_rings,
+                            uint64_t max);
 
 // ============================================================================
 // STATS & MONITORING
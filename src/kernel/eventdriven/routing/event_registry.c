@@ -0,0 +1,142 @@
+#include "event_registry.h"
+#include "../decks/deck_handlers.h"
+
+// ============================================================================
+// REGISTRY TABLE
+// ============================================================================
+
+// Маршрут из одного deck, handler только в нём. Дальше - необязательные
+// поля (.coalesce = ..., .timeout_ms = ...)
+#define EVENT_ROUTE_OPERATIONS(sec, handler, ...) \
+    { 1, (sec), 1, { { DECK_PREFIX_OPERATIONS, 0 } }, { (handler), 0, 0, 0 }, __VA_ARGS__ }
+#define EVENT_ROUTE_STORAGE(sec, handler, ...) \
+    { 1, (sec), 1, { { DECK_PREFIX_STORAGE, 0 } }, { 0, (handler), 0, 0 }, __VA_ARGS__ }
+#define EVENT_ROUTE_HARDWARE(sec, handler, ...) \
+    { 1, (sec), 1, { { DECK_PREFIX_HARDWARE, 0 } }, { 0, 0, (handler), 0 }, __VA_ARGS__ }
+#define EVENT_ROUTE_NETWORK(sec, handler, ...) \
+    { 1, (sec), 1, { { DECK_PREFIX_NETWORK, 0 } }, { 0, 0, 0, (handler) }, __VA_ARGS__ }
+
+const EventTypeInfo event_registry[EVENT_REGISTRY_SIZE] = {
+    // ===== STORAGE DECK: Memory Operations =====
+    [EVENT_MEMORY_ALLOC] = EVENT_ROUTE_STORAGE(EVENT_SECURITY_MEMORY, storage_handle_memory_alloc),
+    [EVENT_MEMORY_FREE]  = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE,   storage_handle_memory_free),
+    [EVENT_MEMORY_MAP]   = EVENT_ROUTE_STORAGE(EVENT_SECURITY_MEMORY, storage_handle_memory_map),
+    [EVENT_MEMORY_REGISTER]   = EVENT_ROUTE_STORAGE(EVENT_SECURITY_MEMORY, storage_handle_memory_register),
+    [EVENT_MEMORY_UNREGISTER] = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE,   storage_handle_memory_unregister),
+
+    // ===== STORAGE DECK: File Operations =====
+    [EVENT_FILE_OPEN]  = EVENT_ROUTE_STORAGE(EVENT_SECURITY_PATH, storage_handle_file_open),
+    [EVENT_FILE_CLOSE] = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_close),
+    [EVENT_FILE_READ]  = EVENT_ROUTE_STORAGE(EVENT_SECURITY_PATH, storage_handle_file_read,
+                                             .timeout_ms = EVENT_TIMEOUT_BULK_MS),
+    [EVENT_FILE_WRITE] = EVENT_ROUTE_STORAGE(EVENT_SECURITY_PATH, storage_handle_file_write,
+                                             .timeout_ms = EVENT_TIMEOUT_BULK_MS),
+    [EVENT_FILE_STAT]  = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_stat,
+                                             .coalesce = EVENT_COALESCE_PATH),
+
+    // TagFS operations
+    [EVENT_FILE_CREATE_TAGGED] = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_create_tagged),
+    [EVENT_FILE_QUERY]         = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_query),
+    [EVENT_FILE_TAG_ADD]       = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_tag_add),
+    [EVENT_FILE_TAG_REMOVE]    = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_tag_remove),
+    [EVENT_FILE_TAG_GET]       = EVENT_ROUTE_STORAGE(EVENT_SECURITY_NONE, storage_handle_file_tag_get,
+                                                       .coalesce = EVENT_COALESCE_U64),
+
+    // ===== NETWORK DECK: Network Operations (stub в v1) =====
+    [EVENT_NET_SOCKET]  = EVENT_ROUTE_NETWORK(EVENT_SECURITY_NETWORK, network_handle_socket),
+    [EVENT_NET_CONNECT] = EVENT_ROUTE_NETWORK(EVENT_SECURITY_NETWORK, network_handle_connect),
+    [EVENT_NET_SEND]    = EVENT_ROUTE_NETWORK(EVENT_SECURITY_NETWORK, network_handle_send),
+    [EVENT_NET_RECV]    = EVENT_ROUTE_NETWORK(EVENT_SECURITY_NETWORK, network_handle_recv),
+
+    // ===== OPERATIONS DECK: Process Operations =====
+    [EVENT_PROC_CREATE] = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_PROCESS, operations_handle_proc_create),
+    [EVENT_PROC_EXIT]   = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE,    operations_handle_proc_exit),
+    [EVENT_PROC_SIGNAL] = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_PROCESS, operations_handle_proc_signal),
+    [EVENT_PROC_KILL]   = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_PROCESS, operations_handle_proc_kill),
+    [EVENT_PROC_WAIT]   = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE,    operations_handle_proc_wait,
+                                               .timeout_ms = EVENT_TIMEOUT_NONE),
+    [EVENT_PROC_GETPID] = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE,    operations_handle_proc_getpid,
+                                               .coalesce = EVENT_COALESCE_TYPE | EVENT_COALESCE_PER_USER),
+
+    // ===== HARDWARE DECK: Device Operations =====
+    [EVENT_DEV_OPEN]  = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_dev_open),
+    [EVENT_DEV_IOCTL] = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_dev_ioctl),
+    [EVENT_DEV_READ]  = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_dev_read),
+    [EVENT_DEV_WRITE] = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_dev_write),
+
+    // ===== HARDWARE DECK: Timer Operations =====
+    [EVENT_TIMER_CREATE]   = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_timer_create),
+    [EVENT_TIMER_CANCEL]   = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_timer_cancel),
+    [EVENT_TIMER_SLEEP]    = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_timer_sleep,
+                                                  .timeout_ms = EVENT_TIMEOUT_NONE),
+    [EVENT_TIMER_GETTICKS] = EVENT_ROUTE_HARDWARE(EVENT_SECURITY_NONE, hardware_handle_timer_getticks,
+                                                  .coalesce = EVENT_COALESCE_TYPE),
+
+    // ===== OPERATIONS DECK: IPC Operations =====
+    [EVENT_IPC_SEND]        = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE, operations_handle_ipc),
+    [EVENT_IPC_RECV]        = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE, operations_handle_ipc,
+                                                     .timeout_ms = EVENT_TIMEOUT_NONE),
+    [EVENT_IPC_SHM_CREATE]  = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE, operations_handle_ipc),
+    [EVENT_IPC_SHM_ATTACH]  = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE, operations_handle_ipc),
+    [EVENT_IPC_PIPE_CREATE] = EVENT_ROUTE_OPERATIONS(EVENT_SECURITY_NONE, operations_handle_ipc),
+
+    // ===== DIAGNOSTICS =====
+    // Одна волна во все 4 deck, join в Execution
+    [EVENT_SYS_PROBE] = { 1, EVENT_SECURITY_NONE, 4, {
+        { DECK_PREFIX_OPERATIONS, 0 },
+        { DECK_PREFIX_STORAGE,    0 },
+        { DECK_PREFIX_HARDWARE,   0 },
+        { DECK_PREFIX_NETWORK,    0 },
+    }, {
+        operations_handle_sys_probe,
+        storage_handle_sys_probe,
+        hardware_handle_sys_probe,
+        network_handle_sys_probe,
+    } },
+};
+
+// ============================================================================
+// VALIDATION
+// ============================================================================
+
+// Маршрут корректен, если depends ссылаются только на предыдущие шаги
+// (нет циклов) и у каждого deck маршрута есть handler
+static int event_registry_route_valid(const EventTypeInfo* info) {
+    if (info->step_count == 0 || info->step_count > MAX_ROUTING_STEPS) {
+        return 0;
+    }
+    for (int i = 0; i < info->step_count; i++) {
+        uint8_t prefix = info->steps[i].prefix;
+        if (prefix < DECK_PREFIX_OPERATIONS || prefix > DECK_PREFIX_NETWORK) {
+            return 0;
+        }
+        if (!info->handlers[prefix - 1]) {
+            return 0;
+        }
+        if (info->steps[i].depends & ~((1u << i) - 1)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+uint32_t event_registry_validate(void) {
+    for (uint32_t type = 0; type < EVENT_REGISTRY_SIZE; type++) {
+        const EventTypeInfo* info = &event_registry[type];
+        if (!info->valid) {
+            continue;
+        }
+        if (type == EVENT_NONE || type >= EVENT_MAX || !event_registry_route_valid(info)) {
+            return type ? type : EVENT_MAX;
+        }
+    }
+    return 0;
+}
+
+uint32_t event_registry_count(void) {
+    uint32_t count = 0;
+    for (uint32_t type = 0; type < EVENT_REGISTRY_SIZE; type++) {
+        count += event_registry[type].valid;
+    }
+    return count;
+}
@@ -0,0 +1,88 @@
+#ifndef EVENT_REGISTRY_H
+#define EVENT_REGISTRY_H
+
+#include "../core/events.h"
+#include "ktypes.h"
+
+// ============================================================================
+// EVENT REGISTRY - всё, что pipeline знает о типе события, одной строкой
+// ============================================================================
+//
+// Статическая таблица (rodata), индекс = EventType (0..255):
+//   - valid:          тип поддерживается (иначе Receiver отклоняет событие)
+//   - security_class: какая проверка Center нужна до маршрутизации
+//   - steps:          готовый маршрут (route DAG, см. RouteStep)
+//   - handlers:       функция обработки в каждом deck ([prefix - 1])
+//   - coalesce:       ключ склейки одинаковых in-flight запросов
+//   - timeout_ms:     дедлайн по умолчанию (guide/reaper.h)
+//
+// Center копирует маршрут, deck вызывает handler - одна индексированная
+// загрузка вместо switch по типу в каждой стадии. Новый тип события =
+// новая строка здесь + handler в deck (decks/deck_handlers.h).
+//
+// ============================================================================
+
+// Route step: шаги без взаимных зависимостей уходят в decks параллельно
+// одной волной, Execution срабатывает после завершения всех веток.
+// depends - битовая маска индексов шагов, которые должны завершиться
+// раньше; ссылаться можно только на предыдущие шаги.
+typedef struct {
+    uint8_t prefix;
+    uint8_t depends;
+} RouteStep;
+
+// Проверка Security перед маршрутизацией (security_check_event)
+typedef enum {
+    EVENT_SECURITY_NONE = 0,    // Разрешено всегда
+    EVENT_SECURITY_MEMORY,      // data = [size:8], лимит размера
+    EVENT_SECURITY_PATH,        // data = путь, запрещённые файлы
+    EVENT_SECURITY_NETWORK,     // Права на сеть (TODO)
+    EVENT_SECURITY_PROCESS      // Права на процессы (TODO)
+} EventSecurityClass;
+
+// Coalescing in-flight дубликатов (center/coalesce.h): вид ключа
+// (type + ...) и флаг "только для того же user"
+#define EVENT_COALESCE_NONE         0
+#define EVENT_COALESCE_TYPE         1       // Payload не важен
+#define EVENT_COALESCE_PATH         2       // Строка в data
+#define EVENT_COALESCE_U64          3       // Первые 8 байт data
+#define EVENT_COALESCE_KEY_MASK     0x7F
+#define EVENT_COALESCE_PER_USER     0x80    // Результат зависит от отправителя
+
+// Дедлайн типа, если событие не задало свой (Event.flags, event_timeout_ms)
+#define EVENT_TIMEOUT_DEFAULT_MS    5000    // .timeout_ms = 0
+#define EVENT_TIMEOUT_BULK_MS       30000   // Файловый I/O произвольного размера
+
+// Handler шага в deck (decks/deck_handlers.h)
+typedef int (*EventHandler)(RoutingEntry* entry);
+
+typedef struct {
+    uint8_t valid;
+    uint8_t security_class;             // EventSecurityClass
+    uint8_t step_count;
+    RouteStep steps[MAX_ROUTING_STEPS];
+    EventHandler handlers[4];           // [deck_prefix - 1], 0 = deck не обслуживает тип
+    uint8_t coalesce;                   // EVENT_COALESCE_* (только read-only типы)
+    uint16_t timeout_ms;                // 0 = EVENT_TIMEOUT_DEFAULT_MS, EVENT_TIMEOUT_NONE - нет
+} EventTypeInfo;
+
+#define EVENT_REGISTRY_SIZE 256
+
+extern const EventTypeInfo event_registry[EVENT_REGISTRY_SIZE];
+
+static inline const EventTypeInfo* event_registry_lookup(uint32_t type) {
+    return &event_registry[type & (EVENT_REGISTRY_SIZE - 1)];
+}
+
+static inline EventHandler event_registry_handler(uint32_t type, uint8_t deck_prefix) {
+    return event_registry_lookup(type)->handlers[deck_prefix - 1];
+}
+
+// Проверка маршрутов таблицы (вызывается из center_init):
+// 0 = всё корректно, иначе - первый тип с битым маршрутом
+uint32_t event_registry_validate(void);
+
+// Количество поддерживаемых типов
+uint32_t event_registry_count(void);
+
+#endif // EVENT_REGISTRY_H
@@ -0,0 +1,184 @@
+#include "routing_pool.h"
+#include "klib.h"
+#include "pmm.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+static RoutingEntry* volatile routing_chunks[ROUTING_MAX_CHUNKS];
+
+// Бит i = entry i в chunk занята
+static volatile uint64_t routing_chunk_bitmap[ROUTING_MAX_CHUNKS];
+
+static volatile uint64_t routing_chunk_count;
+static volatile uint64_t routing_alloc_hint;
+static volatile uint32_t routing_chunk_lock;
+
+RoutingPoolStats routing_pool_stats;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void routing_pool_init(void) {
+    for (int i = 0; i < ROUTING_MAX_CHUNKS; i++) {
+        routing_chunks[i] = 0;
+        routing_chunk_bitmap[i] = 0;
+    }
+    routing_chunk_count = 0;
+    routing_alloc_hint = 0;
+    routing_chunk_lock = 0;
+
+    routing_pool_stats.allocations = 0;
+    routing_pool_stats.releases = 0;
+    routing_pool_stats.failures = 0;
+    routing_pool_stats.stale_handles = 0;
+    routing_pool_stats.chunks = 0;
+
+    kprintf("[ROUTING_POOL] Initialized (max %d entries, %d per chunk)\n",
+            ROUTING_MAX_ENTRIES, ROUTING_CHUNK_ENTRIES);
+}
+
+// Добавить chunk (редкий путь, под локом). 0 = предел или нет памяти
+static int routing_pool_grow(uint64_t seen_count) {
+    if (seen_count >= ROUTING_MAX_CHUNKS) {
+        return 0;
+    }
+
+    while (!atomic_cas_u32(&routing_chunk_lock, 0, 1)) {
+        cpu_pause();
+    }
+
+    int ok = 1;
+    if (atomic_load_u64(&routing_chunk_count) == seen_count) {
+        uint64_t pages = (ROUTING_CHUNK_ENTRIES * sizeof(RoutingEntry) + PMM_PAGE_SIZE - 1)
+                         / PMM_PAGE_SIZE;
+        RoutingEntry* chunk = (RoutingEntry*)pmm_alloc_zero(pages);
+
+        if (chunk) {
+            // Generation стартует с 1: handle 0 никогда не валиден
+            for (int i = 0; i < ROUTING_CHUNK_ENTRIES; i++) {
+                chunk[i].generation = 1;
+            }
+            routing_chunks[seen_count] = chunk;
+            COMPILER_BARRIER();
+            atomic_store_u64(&routing_alloc_hint, seen_count);
+            atomic_store_u64(&routing_chunk_count, seen_count + 1);
+            atomic_increment_u64(&routing_pool_stats.chunks);
+        } else {
+            ok = 0;
+        }
+    }
+
+    atomic_store_u32(&routing_chunk_lock, 0);
+    return ok;
+}
+
+// ============================================================================
+// ALLOC / FREE
+// ============================================================================
+
+RoutingEntry* routing_pool_alloc(void) {
+    for (;;) {
+        uint64_t count = atomic_load_u64(&routing_chunk_count);
+        uint64_t hint = atomic_load_u64(&routing_alloc_hint);
+
+        for (uint64_t n = 0; n < count; n++) {
+            uint64_t c = (hint + n) % count;
+            uint64_t bitmap = atomic_load_u64(&routing_chunk_bitmap[c]);
+
+            while (bitmap != ~0ULL) {
+                uint64_t bit = (uint64_t)__builtin_ctzll(~bitmap);
+                if (atomic_cas_u64(&routing_chunk_bitmap[c], bitmap, bitmap | (1ULL << bit))) {
+                    if (c != hint) {
+                        atomic_store_u64(&routing_alloc_hint, c);
+                    }
+                    RoutingEntry* entry = &routing_chunks[c][bit];
+                    entry->pool_slot = (uint32_t)(c * ROUTING_CHUNK_ENTRIES + bit);
+                    atomic_increment_u64(&routing_pool_stats.allocations);
+                    return entry;
+                }
+                bitmap = atomic_load_u64(&routing_chunk_bitmap[c]);
+            }
+        }
+
+        // Все chunks заняты - добавляем новый
+        if (!routing_pool_grow(count)) {
+            atomic_increment_u64(&routing_pool_stats.failures);
+            return 0;
+        }
+    }
+}
+
+void routing_pool_free(RoutingEntry* entry) {
+    uint64_t c = entry->pool_slot / ROUTING_CHUNK_ENTRIES;
+    uint64_t bit = entry->pool_slot % ROUTING_CHUNK_ENTRIES;
+
+    entry->event_id = 0;
+    entry->state = 0;
+
+    // Новое поколение до освобождения slot'а: старые handles уже stale
+    uint32_t generation = entry->generation + 1;
+    if (generation == 0) {
+        generation = 1;
+    }
+    atomic_store_u32(&entry->generation, generation);
+
+    for (;;) {
+        uint64_t bitmap = atomic_load_u64(&routing_chunk_bitmap[c]);
+        if (atomic_cas_u64(&routing_chunk_bitmap[c], bitmap, bitmap & ~(1ULL << bit))) {
+            break;
+        }
+    }
+    atomic_increment_u64(&routing_pool_stats.releases);
+}
+
+// ============================================================================
+// RESOLVE
+// ============================================================================
+
+RoutingEntry* routing_pool_resolve(RoutingHandle handle) {
+    uint32_t slot = routing_handle_slot(handle);
+    uint32_t c = slot / ROUTING_CHUNK_ENTRIES;
+
+    if (handle == ROUTING_HANDLE_NONE || c >= ROUTING_MAX_CHUNKS || !routing_chunks[c]) {
+        atomic_increment_u64(&routing_pool_stats.stale_handles);
+        return 0;
+    }
+
+    RoutingEntry* entry = &routing_chunks[c][slot % ROUTING_CHUNK_ENTRIES];
+    if (atomic_load_u32(&entry->generation) != routing_handle_generation(handle)) {
+        atomic_increment_u64(&routing_pool_stats.stale_handles);
+        return 0;
+    }
+    return entry;
+}
+
+uint32_t routing_pool_slots(void) {
+    return (uint32_t)atomic_load_u64(&routing_chunk_count) * ROUTING_CHUNK_ENTRIES;
+}
+
+RoutingEntry* routing_pool_peek(uint32_t slot) {
+    uint32_t c = slot / ROUTING_CHUNK_ENTRIES;
+    uint32_t bit = slot % ROUTING_CHUNK_ENTRIES;
+
+    if (c >= ROUTING_MAX_CHUNKS || !routing_chunks[c] ||
+        !(atomic_load_u64(&routing_chunk_bitmap[c]) & (1ULL << bit))) {
+        return 0;
+    }
+    return &routing_chunks[c][bit];
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void routing_pool_print_stats(void) {
+    kprintf("[ROUTING_POOL] alloc=%lu free=%lu failures=%lu stale=%lu chunks=%lu\n",
+            routing_pool_stats.allocations,
+            routing_pool_stats.releases,
+            routing_pool_stats.failures,
+            routing_pool_stats.stale_handles,
+            routing_pool_stats.chunks);
+}
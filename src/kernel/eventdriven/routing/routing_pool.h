@@ -0,0 +1,132 @@
+#ifndef ROUTING_POOL_H
+#define ROUTING_POOL_H
+
+#include "../core/events.h"
+#include "../core/atomics.h"
+#include "ktypes.h"
+
+// ============================================================================
+// ROUTING POOL - Slab для RoutingEntry + generation-tagged handles
+// ============================================================================
+//
+// Entries живут в chunks по ROUTING_CHUNK_ENTRIES (pmm, выделяются по мере
+// нужды), адрес entry не меняется. Занятость chunk - 64-битный bitmap (CAS).
+//
+// Между стадиями (Center -> decks -> Execution) передаётся не указатель, а
+// handle = [generation:32][slot:32]. При освобождении generation entry
+// увеличивается, поэтому устаревший handle не резолвится (stale) -
+// проверка стоит одно сравнение.
+//
+// ============================================================================
+
+#define ROUTING_CHUNK_ENTRIES 64
+#define ROUTING_MAX_CHUNKS    64
+#define ROUTING_MAX_ENTRIES   (ROUTING_CHUNK_ENTRIES * ROUTING_MAX_CHUNKS)
+
+typedef uint64_t RoutingHandle;
+
+// Generation никогда не 0, поэтому 0 - "нет handle"
+#define ROUTING_HANDLE_NONE 0ULL
+
+static inline RoutingHandle routing_handle_make(uint32_t slot, uint32_t generation) {
+    return ((uint64_t)generation << 32) | slot;
+}
+
+static inline uint32_t routing_handle_slot(RoutingHandle handle) {
+    return (uint32_t)handle;
+}
+
+static inline uint32_t routing_handle_generation(RoutingHandle handle) {
+    return (uint32_t)(handle >> 32);
+}
+
+// Handle живой entry
+static inline RoutingHandle routing_entry_handle(RoutingEntry* entry) {
+    return routing_handle_make(entry->pool_slot, entry->generation);
+}
+
+// ============================================================================
+// HOLD - кто работает с entry прямо сейчас (для reaper, guide/reaper.h)
+// ============================================================================
+//
+// RoutingEntry.hold = [generation:32][REAPED:1][держателей:31]. Стадия
+// держит entry от момента, когда достала её handle из очереди, до hand-off
+// дальше (guide_route_entry отпускает перед push). Center держит новую
+// entry с routing_entry_hold_init.
+//
+// Reaper забирает только entry без держателей - её handle лежит в
+// очереди: CAS 0 -> REAPED. Стадия, достающая такой handle позже, его
+// отбрасывает (routing_entry_enter = 0), ответ TIMEOUT даёт Execution.
+// Поколение в слове: CAS по старому поколению (entry освобождена и выдана
+// заново) не пройдёт.
+
+#define ROUTING_HOLD_REAPED     (1ULL << 31)
+
+static inline uint64_t routing_hold_make(uint32_t generation, uint64_t bits) {
+    return ((uint64_t)generation << 32) | bits;
+}
+
+static inline void routing_entry_hold_init(RoutingEntry* entry) {
+    atomic_store_u64(&entry->hold, routing_hold_make(entry->generation, 1));
+}
+
+// Взять entry по handle. 0 = её забрал reaper (или handle устарел) -
+// handle отбросить. final = Execution: берёт и entry reaper'а
+static inline int routing_entry_enter(RoutingEntry* entry, RoutingHandle handle, int final) {
+    uint64_t hold;
+    do {
+        hold = atomic_load_u64(&entry->hold);
+        if ((uint32_t)(hold >> 32) != routing_handle_generation(handle) ||
+            ((hold & ROUTING_HOLD_REAPED) && !final)) {
+            return 0;
+        }
+    } while (!atomic_cas_u64(&entry->hold, hold, hold + 1));
+    return 1;
+}
+
+// Отпустить entry. Ветка fan-out отпускает после join - entry к этому
+// моменту могла уйти в Execution и освободиться: чужое поколение не трогаем
+static inline void routing_entry_leave(RoutingEntry* entry, RoutingHandle handle) {
+    uint64_t hold;
+    do {
+        hold = atomic_load_u64(&entry->hold);
+        if ((uint32_t)(hold >> 32) != routing_handle_generation(handle)) {
+            return;
+        }
+    } while (!atomic_cas_u64(&entry->hold, hold, hold - 1));
+}
+
+typedef struct {
+    volatile uint64_t allocations;
+    volatile uint64_t releases;
+    volatile uint64_t failures;        // Все entries в работе / нет памяти
+    volatile uint64_t stale_handles;   // Resolve устаревшего handle
+    volatile uint64_t chunks;          // Выделено chunks
+} RoutingPoolStats;
+
+extern RoutingPoolStats routing_pool_stats;
+
+// ============================================================================
+// API
+// ============================================================================
+
+void routing_pool_init(void);
+
+// Выделить entry. pool_slot и generation уже выставлены, остальное - мусор
+// от прошлого владельца (заполняется routing_entry_init). 0 = нет места
+RoutingEntry* routing_pool_alloc(void);
+
+// Вернуть entry в pool: generation++, все старые handles становятся stale
+void routing_pool_free(RoutingEntry* entry);
+
+// Handle -> entry. 0 если handle неверный или устарел
+RoutingEntry* routing_pool_resolve(RoutingHandle handle);
+
+// Обход всех entries (reaper): slots во всех выделенных chunks и entry
+// slot'а, если она занята (0 = свободна). Её могут освободить в любой момент
+uint32_t routing_pool_slots(void);
+RoutingEntry* routing_pool_peek(uint32_t slot);
+
+void routing_pool_print_stats(void);
+
+#endif // ROUTING_POOL_H
@@ -1,5 +1,6 @@
 #include "routing_table.h"
 #include "klib.h"
+#include "pmm.h"
 
 // ============================================================================
 // GLOBAL ROUTING TABLE
@@ -7,6 +8,262 @@
 
 RoutingTable global_routing_table;
 
+_Static_assert(ROUTING_INDEX_MAX_CAPACITY >= 4 * ROUTING_MAX_ENTRIES,
+               "index must stay sparse even with every entry in flight");
+
+// Номер поколения состояния active/migrating: lookup/remove, не нашедшие
+// ключ, повторяют попытку, если за время probe начался/закончился resize
+static volatile uint64_t routing_epoch;
+
+// migrate_pos до открытия переноса: steps не берут работу, пока active не
+// переключён и epoch не увеличен. Счётчики переноса живут в самом index:
+// запоздавший step от прошлого resize не заберёт работу у следующего
+#define ROUTING_MIGRATE_CLOSED (~0ULL >> 1)
+
+// ============================================================================
+// INDEX HELPERS
+// ============================================================================
+
+static RoutingIndex* routing_index_alloc(uint64_t capacity) {
+    uint64_t bytes = sizeof(RoutingIndex) + capacity * sizeof(RoutingSlot);
+    uint64_t pages = (bytes + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+
+    RoutingIndex* idx = (RoutingIndex*)pmm_alloc_zero(pages);
+    if (!idx) {
+        return 0;
+    }
+
+    idx->capacity = capacity;
+    idx->mask = capacity - 1;
+    idx->pages = pages;
+    idx->migrate_pos = ROUTING_MIGRATE_CLOSED;
+    return idx;
+}
+
+// Очистить index для повторного использования (вызывается при users == 0)
+static void routing_index_reset(RoutingIndex* idx) {
+    memset(idx->slots, 0, idx->capacity * sizeof(RoutingSlot));
+    idx->used = 0;
+    idx->inserters = 0;
+    idx->migrate_pos = ROUTING_MIGRATE_CLOSED;
+    idx->migrate_done = 0;
+}
+
+// Закрепить index: пока users != 0, его память не будет переиспользована
+static RoutingIndex* routing_index_acquire(RoutingIndex* volatile* ptr) {
+    for (;;) {
+        RoutingIndex* idx = *ptr;
+        if (!idx) {
+            return 0;
+        }
+        atomic_increment_u64(&idx->users);
+        if (*ptr == idx) {
+            return idx;
+        }
+        atomic_decrement_u64(&idx->users);
+    }
+}
+
+static inline void routing_index_put(RoutingIndex* idx) {
+    if (idx) {
+        atomic_decrement_u64(&idx->users);
+    }
+}
+
+static inline int routing_key_is_live(uint64_t key) {
+    return key != ROUTING_KEY_EMPTY && key != ROUTING_KEY_TOMBSTONE &&
+           key != ROUTING_KEY_RESERVED;
+}
+
+// Lock-free поиск slot'а. Handle читается между двумя проверками key:
+// slot мог быть освобождён и занят другим событием
+static RoutingHandle routing_index_find(RoutingIndex* idx, uint64_t key) {
+    uint64_t home = hash_event_id(key) & idx->mask;
+
+    for (uint64_t i = 0; i < idx->capacity; i++) {
+        RoutingSlot* slot = &idx->slots[(home + i) & idx->mask];
+        uint64_t k = atomic_load_u64(&slot->key);
+
+        if (k == ROUTING_KEY_EMPTY) {
+            return ROUTING_HANDLE_NONE;  // Конец цепочки probe
+        }
+        if (k == key) {
+            RoutingHandle handle = slot->handle;
+            COMPILER_BARRIER();
+            if (atomic_load_u64(&slot->key) == key) {
+                return handle;
+            }
+        }
+    }
+    return ROUTING_HANDLE_NONE;
+}
+
+// Insert: CAS EMPTY/TOMBSTONE -> RESERVED, запись handle, публикация key
+static int routing_index_insert(RoutingTable* table, RoutingIndex* idx,
+                                uint64_t key, RoutingHandle handle) {
+    uint64_t home = hash_event_id(key) & idx->mask;
+
+    for (uint64_t i = 0; i < idx->capacity; ) {
+        RoutingSlot* slot = &idx->slots[(home + i) & idx->mask];
+        uint64_t k = atomic_load_u64(&slot->key);
+
+        if (k == ROUTING_KEY_EMPTY || k == ROUTING_KEY_TOMBSTONE) {
+            if (!atomic_cas_u64(&slot->key, k, ROUTING_KEY_RESERVED)) {
+                continue;  // Slot заняли - перечитываем тот же slot
+            }
+            if (k == ROUTING_KEY_EMPTY) {
+                atomic_increment_u64(&idx->used);
+            }
+            if (i > 0) {
+                atomic_increment_u64(&table->collisions);
+            }
+
+            slot->handle = handle;
+            COMPILER_BARRIER();
+            atomic_store_u64(&slot->key, key);
+            return 1;
+        }
+        i++;
+    }
+    return 0;  // Index полон
+}
+
+// Remove: CAS key -> TOMBSTONE. Возвращает handle или ROUTING_HANDLE_NONE
+static RoutingHandle routing_index_remove(RoutingIndex* idx, uint64_t key) {
+    uint64_t home = hash_event_id(key) & idx->mask;
+
+    for (uint64_t i = 0; i < idx->capacity; i++) {
+        RoutingSlot* slot = &idx->slots[(home + i) & idx->mask];
+        uint64_t k = atomic_load_u64(&slot->key);
+
+        if (k == ROUTING_KEY_EMPTY) {
+            return ROUTING_HANDLE_NONE;
+        }
+        if (k == key) {
+            RoutingHandle handle = slot->handle;
+            if (atomic_cas_u64(&slot->key, key, ROUTING_KEY_TOMBSTONE)) {
+                return handle;
+            }
+            return ROUTING_HANDLE_NONE;  // Кто-то удалил/перенёс раньше нас
+        }
+    }
+    return ROUTING_HANDLE_NONE;
+}
+
+// ============================================================================
+// RESIZE - Онлайн перенос index
+// ============================================================================
+
+// Старый index после переноса. Память не возвращается в pmm: lock-free
+// читатель мог прочитать указатель и ещё не закрепить его. Index того же
+// размера переиспользуется (rehash от tombstones), остальные остаются
+// (суммарно меньше текущего index)
+static RoutingIndex* routing_index_take_spare(RoutingTable* table, uint64_t capacity) {
+    RoutingIndex* spare = table->retired;
+    if (spare && spare->capacity == capacity && atomic_load_u64(&spare->users) == 0) {
+        table->retired = 0;
+        routing_index_reset(spare);
+        return spare;
+    }
+    return routing_index_alloc(capacity);
+}
+
+static void routing_table_start_resize(RoutingTable* table, RoutingIndex* seen) {
+    if (!atomic_cas_u32(&table->resize_lock, 0, 1)) {
+        return;  // Resize уже начинает другое ядро
+    }
+
+    RoutingIndex* old = table->active;
+    if (old != seen || table->migrating) {
+        atomic_store_u32(&table->resize_lock, 0);
+        return;
+    }
+
+    // Новый размер: live entries занимают не больше 1/4. Если live мало,
+    // а used высокий из-за tombstones - rehash в том же размере
+    uint64_t live = atomic_load_u64(&table->total_entries);
+    uint64_t capacity = old->capacity;
+    while (capacity < ROUTING_INDEX_MAX_CAPACITY && live * 4 >= capacity) {
+        capacity <<= 1;
+    }
+
+    RoutingIndex* idx = routing_index_take_spare(table, capacity);
+    if (!idx) {
+        atomic_store_u32(&table->resize_lock, 0);
+        return;  // Нет памяти - остаёмся на старом index
+    }
+
+    table->migrating = old;
+    COMPILER_BARRIER();
+    table->active = idx;
+    atomic_increment_u64(&routing_epoch);
+    atomic_increment_u64(&table->resizes);
+
+    // Открываем перенос: lookup, промахнувшийся из-за него, увидит новый epoch
+    atomic_store_u64(&old->migrate_pos, 0);
+
+    atomic_store_u32(&table->resize_lock, 0);
+}
+
+// Перенести до ROUTING_MIGRATE_CHUNK slots старого index
+static void routing_table_migrate_step(RoutingTable* table) {
+    if (!table->migrating) {
+        return;
+    }
+
+    RoutingIndex* old = routing_index_acquire(&table->migrating);
+    if (!old) {
+        return;
+    }
+
+    // Insert'ы, начавшиеся до переключения active, должны закончиться
+    if (atomic_load_u64(&old->inserters) != 0) {
+        routing_index_put(old);
+        return;
+    }
+
+    RoutingIndex* idx = routing_index_acquire(&table->active);
+    uint64_t pos = old->capacity;
+    if (idx != old) {
+        pos = atomic_fetch_add_u64(&old->migrate_pos, ROUTING_MIGRATE_CHUNK);
+    }
+
+    if (pos < old->capacity) {
+        uint64_t end = pos + ROUTING_MIGRATE_CHUNK;
+        if (end > old->capacity) {
+            end = old->capacity;
+        }
+
+        for (uint64_t i = pos; i < end; i++) {
+            RoutingSlot* slot = &old->slots[i];
+            uint64_t k = atomic_load_u64(&slot->key);
+            if (!routing_key_is_live(k)) {
+                continue;
+            }
+
+            // Сначала копия в новый index, затем tombstone в старом:
+            // в любой момент ключ виден хотя бы в одном из них.
+            // Если remove успел раньше - убираем свою копию
+            routing_index_insert(table, idx, k, slot->handle);
+            if (!atomic_cas_u64(&slot->key, k, ROUTING_KEY_TOMBSTONE)) {
+                routing_index_remove(idx, k);
+            }
+        }
+
+        uint64_t done = atomic_fetch_add_u64(&old->migrate_done, end - pos) + (end - pos);
+        if (done == old->capacity) {
+            // Перенос завершён
+            table->retired = old;
+            COMPILER_BARRIER();
+            table->migrating = 0;
+            atomic_increment_u64(&routing_epoch);
+        }
+    }
+
+    routing_index_put(idx);
+    routing_index_put(old);
+}
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -16,65 +273,128 @@ void routing_table_init(RoutingTable* table) {
 
     // Быстрая инициализация через memset
     memset(table, 0, sizeof(RoutingTable));
+    routing_epoch = 0;
+
+    table->active = routing_index_alloc(ROUTING_INDEX_INITIAL_CAPACITY);
+    if (!table->active) {
+        panic("[ROUTING_TABLE] Failed to allocate index");
+    }
 
-    kprintf("[ROUTING_TABLE] Initialized (size=%d buckets, capacity=%d entries)\n",
-            ROUTING_TABLE_SIZE, ROUTING_TABLE_SIZE * BUCKET_CAPACITY);
+    kprintf("[ROUTING_TABLE] Initialized (index=%d slots, max entries=%d)\n",
+            ROUTING_INDEX_INITIAL_CAPACITY, ROUTING_MAX_ENTRIES);
 }
 
 // ============================================================================
-// INSERT - Вставка routing entry
+// RESERVE - Занять entry для заполнения на месте
 // ============================================================================
 
-int routing_table_insert(RoutingTable* table, RoutingEntry* entry) {
-    uint64_t index = routing_table_index(entry->event_id);
-    RoutingBucket* bucket = &table->buckets[index];
-
-    bucket_lock(bucket);
+RoutingEntry* routing_table_reserve(RoutingTable* table, uint64_t event_id) {
+    if (!routing_key_is_live(event_id)) {
+        return 0;
+    }
 
-    // Проверяем, есть ли место в bucket
-    if (bucket->count >= BUCKET_CAPACITY) {
-        bucket_unlock(bucket);
-        atomic_increment_u64(&table->collisions);
-        return 0;  // Bucket полон (коллизия!)
+    RoutingEntry* entry = routing_pool_alloc();
+    if (!entry) {
+        atomic_increment_u64(&table->failures);
+        return 0;  // Все entries в работе
     }
 
-    // Ищем свободный slot
-    for (int i = 0; i < BUCKET_CAPACITY; i++) {
-        if (bucket->entries[i].event_id == 0) {
-            // Копируем entry
-            bucket->entries[i] = *entry;
-            bucket->count++;
-            atomic_increment_u64(&table->total_entries);
-            bucket_unlock(bucket);
-            return 1;  // Успех
+    // Entry в состоянии PENDING, пока её не опубликуют
+    entry->state = EVENT_STATUS_PENDING;
+    entry->event_id = event_id;
+
+    RoutingIndex* idx;
+    int inserted;
+    for (;;) {
+        idx = routing_index_acquire(&table->active);
+        atomic_increment_u64(&idx->inserters);
+        if (table->active == idx) {
+            break;
         }
+        // Resize переключил index между acquire и inserters++
+        atomic_decrement_u64(&idx->inserters);
+        routing_index_put(idx);
     }
 
-    bucket_unlock(bucket);
-    return 0;  // Не должно произойти
+    inserted = routing_index_insert(table, idx, event_id, routing_entry_handle(entry));
+    atomic_decrement_u64(&idx->inserters);
+
+    int need_resize = atomic_load_u64(&idx->used) * 2 >= idx->capacity;
+    routing_index_put(idx);
+
+    if (need_resize) {
+        routing_table_start_resize(table, idx);
+    }
+    routing_table_migrate_step(table);
+
+    if (!inserted) {
+        routing_pool_free(entry);
+        atomic_increment_u64(&table->failures);
+        return 0;
+    }
+
+    atomic_increment_u64(&table->total_entries);
+    return entry;
+}
+
+// ============================================================================
+// INSERT - Вставка копии routing entry
+// ============================================================================
+
+int routing_table_insert(RoutingTable* table, RoutingEntry* entry) {
+    RoutingEntry* slot = routing_table_reserve(table, entry->event_id);
+    if (!slot) {
+        return 0;
+    }
+
+    uint32_t pool_slot = slot->pool_slot;
+    uint32_t generation = slot->generation;
+    *slot = *entry;
+    slot->pool_slot = pool_slot;
+    slot->generation = generation;
+    return 1;
 }
 
 // ============================================================================
 // LOOKUP - Поиск routing entry
 // ============================================================================
 
-RoutingEntry* routing_table_lookup(RoutingTable* table, uint64_t event_id) {
-    uint64_t index = routing_table_index(event_id);
-    RoutingBucket* bucket = &table->buckets[index];
+RoutingHandle routing_table_lookup_handle(RoutingTable* table, uint64_t event_id) {
+    for (;;) {
+        uint64_t epoch = atomic_load_u64(&routing_epoch);
+        RoutingIndex* idx = routing_index_acquire(&table->active);
+        RoutingIndex* old = routing_index_acquire(&table->migrating);
+
+        // Во время переноса: сначала старый index, потом новый
+        RoutingHandle handle = ROUTING_HANDLE_NONE;
+        if (old && old != idx) {
+            handle = routing_index_find(old, event_id);
+        }
+        if (handle == ROUTING_HANDLE_NONE) {
+            handle = routing_index_find(idx, event_id);
+        }
 
-    bucket_lock(bucket);
+        routing_index_put(old);
+        routing_index_put(idx);
 
-    // Ищем entry с нужным event_id
-    for (int i = 0; i < BUCKET_CAPACITY; i++) {
-        if (bucket->entries[i].event_id == event_id) {
-            RoutingEntry* entry = &bucket->entries[i];
-            bucket_unlock(bucket);
-            return entry;  // Найдено
+        if (handle != ROUTING_HANDLE_NONE || atomic_load_u64(&routing_epoch) == epoch) {
+            return handle;
         }
     }
+}
+
+RoutingEntry* routing_table_lookup(RoutingTable* table, uint64_t event_id) {
+    RoutingHandle handle = routing_table_lookup_handle(table, event_id);
+    if (handle == ROUTING_HANDLE_NONE) {
+        return 0;
+    }
 
-    bucket_unlock(bucket);
-    return 0;  // Не найдено
+    // Entry могли освободить и выдать заново между lookup и resolve
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (entry && entry->event_id != event_id) {
+        return 0;
+    }
+    return entry;
 }
 
 // ============================================================================
@@ -82,25 +402,44 @@ RoutingEntry* routing_table_lookup(RoutingTable* table, uint64_t event_id) {
 // ============================================================================
 
 int routing_table_remove(RoutingTable* table, uint64_t event_id) {
-    uint64_t index = routing_table_index(event_id);
-    RoutingBucket* bucket = &table->buckets[index];
+    RoutingHandle handle = ROUTING_HANDLE_NONE;
+
+    for (;;) {
+        uint64_t epoch = atomic_load_u64(&routing_epoch);
+        RoutingIndex* idx = routing_index_acquire(&table->active);
+        RoutingIndex* old = routing_index_acquire(&table->migrating);
+
+        // Tombstone в старом index, затем в новом (мог уже быть перенесён)
+        if (old && old != idx) {
+            handle = routing_index_remove(old, event_id);
+        }
+        RoutingHandle moved = routing_index_remove(idx, event_id);
+        if (handle == ROUTING_HANDLE_NONE) {
+            handle = moved;
+        }
 
-    bucket_lock(bucket);
+        routing_index_put(old);
+        routing_index_put(idx);
 
-    // Ищем и удаляем entry
-    for (int i = 0; i < BUCKET_CAPACITY; i++) {
-        if (bucket->entries[i].event_id == event_id) {
-            bucket->entries[i].event_id = 0;
-            bucket->entries[i].state = 0;
-            bucket->count--;
-            atomic_decrement_u64(&table->total_entries);
-            bucket_unlock(bucket);
-            return 1;  // Успех
+        if (handle != ROUTING_HANDLE_NONE || atomic_load_u64(&routing_epoch) == epoch) {
+            break;
         }
     }
 
-    bucket_unlock(bucket);
-    return 0;  // Не найдено
+    routing_table_migrate_step(table);
+
+    if (handle == ROUTING_HANDLE_NONE) {
+        return 0;  // Не найдено
+    }
+
+    RoutingEntry* entry = routing_pool_resolve(handle);
+    if (!entry) {
+        return 0;  // Handle устарел: entry уже освобождена
+    }
+
+    routing_pool_free(entry);
+    atomic_decrement_u64(&table->total_entries);
+    return 1;
 }
 
 // ============================================================================
@@ -109,9 +448,14 @@ int routing_table_remove(RoutingTable* table, uint64_t event_id) {
 
 void routing_table_print_stats(RoutingTable* table) {
     uint64_t total = atomic_load_u64(&table->total_entries);
-    uint64_t collisions = atomic_load_u64(&table->collisions);
-    uint64_t utilization = (total * 100) / (ROUTING_TABLE_SIZE * BUCKET_CAPACITY);
+    RoutingIndex* idx = routing_index_acquire(&table->active);
+    uint64_t capacity = idx->capacity;
+    uint64_t load = (total * 100) / capacity;
+    routing_index_put(idx);
 
-    kprintf("[ROUTING_TABLE] entries=%lu collisions=%lu utilization=%lu%%\n",
-            total, collisions, utilization);
+    kprintf("[ROUTING_TABLE] entries=%lu index=%lu load=%lu%% collisions=%lu failures=%lu resizes=%lu\n",
+            total, capacity, load,
+            atomic_load_u64(&table->collisions),
+            atomic_load_u64(&table->failures),
+            atomic_load_u64(&table->resizes));
 }
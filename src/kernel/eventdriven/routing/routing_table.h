@@ -3,65 +3,90 @@
 
 #include "../core/events.h"
 #include "../core/atomics.h"
+#include "routing_pool.h"
 #include "ktypes.h"
 
 // ============================================================================
-// ROUTING TABLE - Hash table для хранения routing entries
+// ROUTING TABLE - Lock-free hash index + стабильное хранилище entries
 // ============================================================================
+//
+// Две части:
+// 1. Entry storage: routing pool (routing_pool.h), entries адресуются
+//    generation-tagged handles - устаревший handle обнаруживается.
+// 2. Index: open addressing (linear probing) event_id -> RoutingHandle.
+//    Lookup без локов, insert/remove - CAS на одном slot.
+//
+// Resize (online, инкрементальный):
+// - при заполнении > 1/2 выделяется новый index и становится active
+// - старый index (migrating) переносится порциями по ROUTING_MIGRATE_CHUNK
+//   slots внутри каждого insert/remove - без stop-the-world
+// - lookup во время переноса: сначала старый index, затем новый
+//
+// ============================================================================
+
+// Начальный размер index (slots, степень 2) и предел роста
+#define ROUTING_INDEX_INITIAL_CAPACITY 512
+#define ROUTING_INDEX_MAX_CAPACITY     65536
+
+_Static_assert((ROUTING_INDEX_INITIAL_CAPACITY & (ROUTING_INDEX_INITIAL_CAPACITY - 1)) == 0,
+               "ROUTING_INDEX_INITIAL_CAPACITY must be power of 2");
 
-// Размер hash table (должен быть степенью 2)
-// Уменьшено до 64 для экономии памяти и быстрой инициализации
-#define ROUTING_TABLE_SIZE 64
-#define ROUTING_TABLE_MASK (ROUTING_TABLE_SIZE - 1)
+// Сколько slots старого index переносит одна операция
+#define ROUTING_MIGRATE_CHUNK 16
 
-_Static_assert((ROUTING_TABLE_SIZE & (ROUTING_TABLE_SIZE - 1)) == 0,
-               "ROUTING_TABLE_SIZE must be power of 2");
+// Специальные ключи slot'а (event_id 0 = invalid, id растут с 1)
+#define ROUTING_KEY_EMPTY     0ULL
+#define ROUTING_KEY_TOMBSTONE 0xFFFFFFFFFFFFFFFFULL  // Удалён, probe продолжается
+#define ROUTING_KEY_RESERVED  0xFFFFFFFFFFFFFFFEULL  // Занят, entry ещё пишется
 
 // ============================================================================
-// ROUTING BUCKET - Bucket в hash table (для разрешения коллизий)
+// INDEX
 // ============================================================================
 
-#define BUCKET_CAPACITY 4  // Количество entries в одном bucket
+typedef struct {
+    volatile uint64_t key;          // event_id или ROUTING_KEY_*
+    volatile RoutingHandle handle;
+} RoutingSlot;
 
 typedef struct {
-    volatile uint32_t lock;  // Spinlock для bucket (0 = unlocked, 1 = locked)
-    uint32_t count;          // Количество занятых slots
-    RoutingEntry entries[BUCKET_CAPACITY];
-} RoutingBucket;
+    uint64_t capacity;
+    uint64_t mask;
+    volatile uint64_t used;         // Когда-либо занятые slots (live + tombstones)
+    volatile uint64_t inserters;    // Insert'ы в процессе (перенос ждёт нуля)
+    volatile uint64_t users;        // Все операции в процессе (reuse ждёт нуля)
+    volatile uint64_t migrate_pos;  // Следующий slot для переноса (пока index - migrating)
+    volatile uint64_t migrate_done; // Перенесено slots
+    uint64_t pages;                 // Размер аллокации в pmm pages
+    RoutingSlot slots[] __attribute__((aligned(64)));
+} RoutingIndex;
 
 // ============================================================================
 // ROUTING TABLE STRUCTURE
 // ============================================================================
 
 typedef struct {
-    RoutingBucket buckets[ROUTING_TABLE_SIZE] __attribute__((aligned(64)));
+    RoutingIndex* volatile active;      // Сюда идут insert'ы
+    RoutingIndex* volatile migrating;   // Старый index (0 = перенос не идёт)
+    RoutingIndex* retired;              // Перенесённый index, запасной для rehash
+    volatile uint32_t resize_lock;
+
     volatile uint64_t total_entries;  // Общее количество entries
-    volatile uint64_t collisions;     // Количество коллизий
+    volatile uint64_t collisions;     // Insert'ы, не попавшие в home slot
+    volatile uint64_t failures;       // Insert не удался (нет места)
+    volatile uint64_t resizes;
 } RoutingTable;
 
 // Глобальная routing table
 extern RoutingTable global_routing_table;
 
-// ============================================================================
-// BUCKET LOCKING - Spinlock для bucket
-// ============================================================================
-
-static inline void bucket_lock(RoutingBucket* bucket) {
-    while (!atomic_cas_u32(&bucket->lock, 0, 1)) {
-        cpu_pause();
-    }
-}
-
-static inline void bucket_unlock(RoutingBucket* bucket) {
-    atomic_store_u32(&bucket->lock, 0);
-}
-
 // ============================================================================
 // HASH FUNCTION - Простая и быстрая hash функция
 // ============================================================================
 
 static inline uint64_t hash_event_id(uint64_t event_id) {
-    // MurmurHash-inspired mixing
+    // MurmurHash-inspired mixing. Event ID = [ring:16][seq:48]: первый
+    // xor-shift опускает ring в младшие биты, так что ID разных rings
+    // с одинаковым номером расходятся по разным slots
     event_id ^= event_id >> 33;
     event_id *= 0xff51afd7ed558ccdULL;
     event_id ^= event_id >> 33;
@@ -70,10 +95,6 @@ static inline uint64_t hash_event_id(uint64_t event_id) {
     return event_id;
 }
 
-static inline uint64_t routing_table_index(uint64_t event_id) {
-    return hash_event_id(event_id) & ROUTING_TABLE_MASK;
-}
-
 // ============================================================================
 // ROUTING TABLE OPERATIONS
 // ============================================================================
@@ -84,7 +105,14 @@ void routing_table_init(RoutingTable* table);
 // Вставка routing entry
 int routing_table_insert(RoutingTable* table, RoutingEntry* entry);
 
-// Поиск routing entry по event_id
+// Zero-copy вставка: занять entry под event_id и заполнить её на месте.
+// Entry остаётся в состоянии PENDING, пока не вызван routing_table_publish().
+RoutingEntry* routing_table_reserve(RoutingTable* table, uint64_t event_id);
+
+// Поиск handle по event_id (lock-free). ROUTING_HANDLE_NONE = не найдено
+RoutingHandle routing_table_lookup_handle(RoutingTable* table, uint64_t event_id);
+
+// Поиск routing entry по event_id (lock-free). Entry проверена по generation
 RoutingEntry* routing_table_lookup(RoutingTable* table, uint64_t event_id);
 
 // Удаление routing entry (после завершения обработки)
@@ -97,8 +125,14 @@ void routing_table_print_stats(RoutingTable* table);
 // INLINE HELPERS
 // ============================================================================
 
+// Делает заполненную entry видимой (lookup/отмена)
+static inline void routing_table_publish(RoutingEntry* entry) {
+    COMPILER_BARRIER();
+    atomic_store_u32(&entry->state, EVENT_STATUS_PROCESSING);
+}
+
 static inline int routing_table_is_full(RoutingTable* table) {
-    return table->total_entries >= (ROUTING_TABLE_SIZE * BUCKET_CAPACITY);
+    return table->total_entries >= ROUTING_MAX_ENTRIES;
 }
 
 #endif // ROUTING_TABLE_H
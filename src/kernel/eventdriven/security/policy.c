@@ -0,0 +1,364 @@
+#include "policy.h"
+#include "../core/atomics.h"
+#include "../routing/event_registry.h"
+#include "pmm.h"
+#include "klib.h"
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+// Decision table: [0] - users без собственных правил, [1 + i] - users[i]
+typedef struct {
+    uint32_t user_count;
+    uint64_t users[POLICY_MAX_USERS];
+    uint8_t verdicts[POLICY_MAX_USERS + 1][EVENT_REGISTRY_SIZE][POLICY_OBJECT_CLASS_COUNT];
+} PolicyTable;
+
+// Защищённый путь: hash + копия для сравнения (hash 0 = пустой слот)
+#define POLICY_PATH_SLOTS       (POLICY_MAX_PROTECTED * 2)
+#define POLICY_PATH_MAX         64
+
+typedef struct {
+    volatile uint64_t hash;
+    char path[POLICY_PATH_MAX];
+} PolicyPath;
+
+PolicyStats policy_stats;
+
+static PolicyRule policy_rules[POLICY_MAX_RULES];
+static uint32_t policy_rule_count = 0;
+static spinlock_t policy_lock;                  // Writers: правила, компиляция
+
+static PolicyTable* policy_tables[2];           // Активная + неактивная половина
+static PolicyTable* volatile policy_active = 0;
+static volatile uint32_t policy_generation = 1; // 0 в кэше = пустая запись
+
+static PolicyPath policy_paths[POLICY_PATH_SLOTS];
+static uint32_t policy_path_count = 0;
+
+static PolicyCache* policy_caches = 0;          // [SMP_MAX_CPUS], из PMM
+
+#define POLICY_PAGES(size) (((size) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE)
+
+// ============================================================================
+// OBJECT CLASSIFICATION
+// ============================================================================
+
+// FNV-1a по пути в event->data (не дальше EVENT_DATA_SIZE). 0 не бывает
+static uint64_t policy_path_hash(const char* path, uint64_t max) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint64_t i = 0; i < max && path[i]; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash ? hash : 1;
+}
+
+static int policy_path_protected(const char* path) {
+    uint64_t hash = policy_path_hash(path, EVENT_DATA_SIZE);
+
+    for (uint32_t i = 0; i < POLICY_PATH_SLOTS; i++) {
+        PolicyPath* slot = &policy_paths[(hash + i) & (POLICY_PATH_SLOTS - 1)];
+        uint64_t slot_hash = atomic_load_u64(&slot->hash);
+        if (slot_hash == 0) {
+            return 0;
+        }
+        // Hash совпал - подтверждаем строкой (коллизия не должна открыть путь)
+        if (slot_hash == hash && strncmp(slot->path, path, POLICY_PATH_MAX) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Что событие трогает - по security_class типа в event_registry
+static uint8_t policy_classify(Event* event) {
+    switch (event_registry_lookup(event->type)->security_class) {
+        case EVENT_SECURITY_MEMORY: {
+            uint64_t size = *(uint64_t*)event->data;
+            return size > POLICY_MEMORY_LIMIT ? POLICY_OBJECT_MEMORY_LARGE : POLICY_OBJECT_MEMORY;
+        }
+
+        case EVENT_SECURITY_PATH:
+            return policy_path_protected((const char*)event->data) ?
+                   POLICY_OBJECT_FILE_PROTECTED : POLICY_OBJECT_FILE;
+
+        case EVENT_SECURITY_NETWORK:
+            return POLICY_OBJECT_NETWORK;
+
+        case EVENT_SECURITY_PROCESS:
+            return POLICY_OBJECT_PROCESS;
+
+        default:
+            return POLICY_OBJECT_NONE;
+    }
+}
+
+const char* policy_object_name(uint8_t object) {
+    switch (object) {
+        case POLICY_OBJECT_NONE:            return "none";
+        case POLICY_OBJECT_MEMORY:          return "memory";
+        case POLICY_OBJECT_MEMORY_LARGE:    return "memory-large";
+        case POLICY_OBJECT_FILE:            return "file";
+        case POLICY_OBJECT_FILE_PROTECTED:  return "file-protected";
+        case POLICY_OBJECT_NETWORK:         return "network";
+        case POLICY_OBJECT_PROCESS:         return "process";
+        case POLICY_OBJECT_ANY:             return "any";
+        default:                            return "?";
+    }
+}
+
+// ============================================================================
+// COMPILATION (под policy_lock)
+// ============================================================================
+
+static int policy_rule_matches_user(const PolicyRule* rule, uint64_t user_id) {
+    return rule->user_id == POLICY_ANY_USER || rule->user_id == user_id;
+}
+
+// Первое совпавшее правило решает: применяем список с конца, раньше
+// стоящие правила перезаписывают поздние
+static void policy_compile_user(uint8_t verdicts[EVENT_REGISTRY_SIZE][POLICY_OBJECT_CLASS_COUNT],
+                                uint64_t user_id) {
+    memset(verdicts, POLICY_ALLOW, EVENT_REGISTRY_SIZE * POLICY_OBJECT_CLASS_COUNT);
+
+    for (int r = (int)policy_rule_count - 1; r >= 0; r--) {
+        const PolicyRule* rule = &policy_rules[r];
+        if (!policy_rule_matches_user(rule, user_id)) {
+            continue;
+        }
+
+        uint32_t type_first = rule->type == POLICY_ANY_TYPE ? 0 : rule->type;
+        uint32_t type_last = rule->type == POLICY_ANY_TYPE ? EVENT_REGISTRY_SIZE - 1 : rule->type;
+        uint32_t object_first = rule->object == POLICY_OBJECT_ANY ? 0 : rule->object;
+        uint32_t object_last = rule->object == POLICY_OBJECT_ANY ?
+                               POLICY_OBJECT_CLASS_COUNT - 1 : rule->object;
+
+        for (uint32_t type = type_first; type <= type_last; type++) {
+            for (uint32_t object = object_first; object <= object_last; object++) {
+                verdicts[type][object] = rule->verdict;
+            }
+        }
+    }
+}
+
+static void policy_compile(void) {
+    PolicyTable* table = policy_tables[policy_active == policy_tables[0] ? 1 : 0];
+
+    table->user_count = 0;
+    for (uint32_t r = 0; r < policy_rule_count; r++) {
+        uint64_t user_id = policy_rules[r].user_id;
+        if (user_id == POLICY_ANY_USER) {
+            continue;
+        }
+        uint32_t known = 0;
+        for (uint32_t i = 0; i < table->user_count; i++) {
+            known |= table->users[i] == user_id;
+        }
+        if (!known) {
+            table->users[table->user_count++] = user_id;  // policy_add_rule держит лимит
+        }
+    }
+
+    policy_compile_user(table->verdicts[0], POLICY_ANY_USER);
+    for (uint32_t i = 0; i < table->user_count; i++) {
+        policy_compile_user(table->verdicts[1 + i], table->users[i]);
+    }
+
+    // Публикация: сначала таблица, потом generation. Center читает в
+    // обратном порядке, поэтому новая generation всегда видит новую таблицу
+    MEMORY_BARRIER();
+    policy_active = table;
+    MEMORY_BARRIER();
+    atomic_increment_u32(&policy_generation);
+    policy_stats.compiles++;
+}
+
+// ============================================================================
+// INITIALIZATION & RULES
+// ============================================================================
+
+void policy_init(void) {
+    memset(&policy_stats, 0, sizeof(policy_stats));
+    memset(policy_paths, 0, sizeof(policy_paths));
+    policy_rule_count = 0;
+    policy_path_count = 0;
+    spinlock_init(&policy_lock);
+
+    policy_tables[0] = (PolicyTable*)pmm_alloc_zero(POLICY_PAGES(sizeof(PolicyTable)));
+    policy_tables[1] = (PolicyTable*)pmm_alloc_zero(POLICY_PAGES(sizeof(PolicyTable)));
+    policy_caches = (PolicyCache*)pmm_alloc_zero(POLICY_PAGES(SMP_MAX_CPUS * sizeof(PolicyCache)));
+    if (!policy_tables[0] || !policy_tables[1] || !policy_caches) {
+        panic("[POLICY] Out of memory for decision tables");
+    }
+
+    // Default policy (то, что раньше было зашито в security_check_event)
+    policy_protect_path("/etc/shadow");
+
+    PolicyRule deny_large_alloc = { POLICY_ANY_USER, POLICY_ANY_TYPE,
+                                    POLICY_OBJECT_MEMORY_LARGE, POLICY_DENY };
+    PolicyRule deny_protected = { POLICY_ANY_USER, POLICY_ANY_TYPE,
+                                  POLICY_OBJECT_FILE_PROTECTED, POLICY_DENY };
+    policy_add_rule(&deny_large_alloc);
+    policy_add_rule(&deny_protected);
+
+    kprintf("[POLICY] Initialized (%u rules, %u protected paths, %u-entry per-core cache)\n",
+            policy_rule_count, policy_path_count, POLICY_CACHE_SIZE);
+}
+
+// Users со своими правилами (без повторов); known = user_id среди них
+static uint32_t policy_count_users(uint64_t user_id, int* known) {
+    uint64_t users[POLICY_MAX_USERS];
+    uint32_t count = 0;
+    *known = 0;
+
+    for (uint32_t r = 0; r < policy_rule_count; r++) {
+        uint64_t rule_user = policy_rules[r].user_id;
+        if (rule_user == POLICY_ANY_USER) {
+            continue;
+        }
+        if (rule_user == user_id) {
+            *known = 1;
+        }
+        int seen = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            seen |= users[i] == rule_user;
+        }
+        if (!seen && count < POLICY_MAX_USERS) {
+            users[count++] = rule_user;
+        }
+    }
+    return count;
+}
+
+int policy_add_rule(const PolicyRule* rule) {
+    if (rule->object != POLICY_OBJECT_ANY && rule->object >= POLICY_OBJECT_CLASS_COUNT) {
+        return 0;
+    }
+
+    spin_lock(&policy_lock);
+
+    if (policy_rule_count >= POLICY_MAX_RULES) {
+        spin_unlock(&policy_lock);
+        return 0;
+    }
+
+    // Новый user со своими правилами - нужна своя таблица
+    if (rule->user_id != POLICY_ANY_USER) {
+        int known = 0;
+        uint32_t users = policy_count_users(rule->user_id, &known);
+        if (!known && users >= POLICY_MAX_USERS) {
+            spin_unlock(&policy_lock);
+            return 0;
+        }
+    }
+
+    policy_rules[policy_rule_count++] = *rule;
+    policy_compile();
+
+    spin_unlock(&policy_lock);
+    return 1;
+}
+
+int policy_protect_path(const char* path) {
+    if (strlen(path) >= POLICY_PATH_MAX) {
+        return 0;
+    }
+
+    spin_lock(&policy_lock);
+
+    if (policy_path_count >= POLICY_MAX_PROTECTED) {
+        spin_unlock(&policy_lock);
+        return 0;
+    }
+
+    uint64_t hash = policy_path_hash(path, POLICY_PATH_MAX);
+    for (uint32_t i = 0; i < POLICY_PATH_SLOTS; i++) {
+        PolicyPath* slot = &policy_paths[(hash + i) & (POLICY_PATH_SLOTS - 1)];
+        if (slot->hash == 0) {
+            strncpy(slot->path, path, POLICY_PATH_MAX);
+            COMPILER_BARRIER();
+            atomic_store_u64(&slot->hash, hash);  // Публикуем после копии пути
+            policy_path_count++;
+            break;
+        }
+        if (slot->hash == hash && strncmp(slot->path, path, POLICY_PATH_MAX) == 0) {
+            break;  // Уже защищён
+        }
+    }
+
+    spin_unlock(&policy_lock);
+    return 1;
+}
+
+// ============================================================================
+// CHECK
+// ============================================================================
+
+PolicyCache* policy_cache_local(void) {
+    return &policy_caches[smp_current_cpu()];
+}
+
+static uint8_t policy_table_lookup(PolicyTable* table, uint64_t user_id, uint8_t type,
+                                   uint8_t object) {
+    uint32_t row = 0;
+    for (uint32_t i = 0; i < table->user_count; i++) {
+        if (table->users[i] == user_id) {
+            row = 1 + i;
+            break;
+        }
+    }
+    return table->verdicts[row][type][object];
+}
+
+int policy_check_event(PolicyCache* cache, Event* event) {
+    uint8_t type = (uint8_t)event->type;
+    uint8_t object = policy_classify(event);
+
+    uint32_t generation = atomic_load_u32(&policy_generation);
+    uint64_t index = ((event->user_id * 0x9E3779B97F4A7C15ULL) >> 40) ^ (type * 7u) ^ object;
+    PolicyCacheEntry* entry = &cache->entries[index & (POLICY_CACHE_SIZE - 1)];
+
+    uint8_t verdict;
+    if (entry->generation == generation && entry->user_id == event->user_id &&
+        entry->type == type && entry->object == object) {
+        cache->hits++;
+        verdict = entry->verdict;
+    } else {
+        cache->misses++;
+        verdict = policy_table_lookup(policy_active, event->user_id, type, object);
+
+        entry->user_id = event->user_id;
+        entry->type = type;
+        entry->object = object;
+        entry->verdict = verdict;
+        entry->generation = generation;
+    }
+
+    if (verdict == POLICY_DENY) {
+        atomic_increment_u64(&policy_stats.denied);
+        kprintf("[POLICY] Denied: event type %u, object %s for user %lu\n",
+                type, policy_object_name(object), event->user_id);
+        return 0;
+    }
+    return 1;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void policy_print_stats(void) {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+        hits += policy_caches[cpu].hits;
+        misses += policy_caches[cpu].misses;
+    }
+
+    kprintf("[POLICY] Stats: checks=%lu denied=%lu cache_hits=%lu cache_misses=%lu "
+            "rules=%u generation=%u compiles=%lu\n",
+            hits + misses, policy_stats.denied, hits, misses,
+            policy_rule_count, policy_generation, policy_stats.compiles);
+}
@@ -0,0 +1,107 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "../core/events.h"
+#include "smp.h"
+#include "klib.h"
+
+// ============================================================================
+// POLICY ENGINE - Security проверка Center до маршрутизации
+// ============================================================================
+//
+// Правила (PolicyRule) - список с порядком, первое совпавшее решает, без
+// совпадений - ALLOW. policy_compile() разворачивает список в decision
+// table: verdict[user][type][object class] (одна таблица для всех users +
+// по таблице на каждого user, упомянутого в правилах).
+//
+// Проверка события:
+//   1. object class - что событие трогает (размер аллокации, защищённый
+//      путь - probe в hash set путей, ...), по security_class типа в
+//      event_registry
+//   2. per-core cache (user, type, object class) -> verdict, direct-mapped.
+//      Запись валидна, пока её generation == policy generation: любое
+//      изменение правил инвалидирует все кэши одним инкрементом
+//   3. miss - decision table, результат кладётся в кэш
+//
+// Частый случай (разрешённое событие того же user) - один probe в кэш.
+// Таблицы компилируются в неактивную половину и публикуются одной записью
+// указателя, так что Center никогда не видит полусобранную таблицу.
+//
+// ============================================================================
+
+#define POLICY_MAX_RULES        32
+#define POLICY_MAX_USERS        8       // Users с собственными правилами
+#define POLICY_MAX_PROTECTED    16      // Защищённые пути
+#define POLICY_CACHE_SIZE       64      // Записей per-core кэша (direct-mapped)
+#define POLICY_MEMORY_LIMIT     (1ULL << 30)  // Больше - POLICY_OBJECT_MEMORY_LARGE
+
+_Static_assert((POLICY_CACHE_SIZE & (POLICY_CACHE_SIZE - 1)) == 0,
+               "POLICY_CACHE_SIZE must be power of 2");
+
+#define POLICY_ANY_USER         0       // user_id 0 отклоняет Receiver
+#define POLICY_ANY_TYPE         EVENT_NONE
+
+typedef enum {
+    POLICY_OBJECT_NONE = 0,         // Объекта нет (getpid, ticks, ...)
+    POLICY_OBJECT_MEMORY,
+    POLICY_OBJECT_MEMORY_LARGE,     // size > POLICY_MEMORY_LIMIT
+    POLICY_OBJECT_FILE,
+    POLICY_OBJECT_FILE_PROTECTED,   // Путь из policy_protect_path()
+    POLICY_OBJECT_NETWORK,
+    POLICY_OBJECT_PROCESS,
+    POLICY_OBJECT_CLASS_COUNT,
+    POLICY_OBJECT_ANY = 0xFF        // Только в правилах
+} PolicyObjectClass;
+
+#define POLICY_ALLOW    1
+#define POLICY_DENY     0
+
+typedef struct {
+    uint64_t user_id;               // POLICY_ANY_USER = все
+    uint8_t type;                   // POLICY_ANY_TYPE = все
+    uint8_t object;                 // PolicyObjectClass / POLICY_OBJECT_ANY
+    uint8_t verdict;                // POLICY_ALLOW / POLICY_DENY
+} PolicyRule;
+
+typedef struct {
+    uint64_t user_id;
+    uint32_t generation;            // 0 = пусто (policy generation начинается с 1)
+    uint8_t type;
+    uint8_t object;
+    uint8_t verdict;
+} PolicyCacheEntry;
+
+// Кэш одного ядра - трогает только это ядро
+typedef struct {
+    PolicyCacheEntry entries[POLICY_CACHE_SIZE];
+    volatile uint64_t hits;
+    volatile uint64_t misses;
+} __attribute__((aligned(64))) PolicyCache;
+
+typedef struct {
+    volatile uint64_t denied;
+    volatile uint64_t compiles;
+} PolicyStats;
+
+extern PolicyStats policy_stats;
+
+// Default правила (лимит памяти, /etc/shadow) + компиляция
+void policy_init(void);
+
+// Добавить правило в конец списка (перекомпилирует таблицы). 0 = нет места
+int policy_add_rule(const PolicyRule* rule);
+
+// Путь получает object class POLICY_OBJECT_FILE_PROTECTED. 0 = нет места
+int policy_protect_path(const char* path);
+
+// Кэш текущего ядра (smp_current_cpu) - брать раз на burst
+PolicyCache* policy_cache_local(void);
+
+// 1 = разрешено, 0 = отказано
+int policy_check_event(PolicyCache* cache, Event* event);
+
+const char* policy_object_name(uint8_t object);
+
+void policy_print_stats(void);
+
+#endif // POLICY_H
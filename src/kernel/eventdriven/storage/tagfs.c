@@ -1047,12 +1047,17 @@ int tagfs_write_file(uint64_t inode_id, uint64_t offset, const uint8_t* buffer,
 // ============================================================================
 
 int tagfs_add_tag(uint64_t inode_id, const Tag* tag) {
+    // Несколько storage workers могут менять теги одного inode параллельно
+    spin_lock(&global_tagfs.lock);
+
     FileInode* inode = tagfs_get_inode(inode_id);
     if (!inode) {
+        spin_unlock(&global_tagfs.lock);
         return 0;
     }
 
     if (inode->tag_count >= TAGFS_MAX_TAGS_PER_FILE) {
+        spin_unlock(&global_tagfs.lock);
         kprintf("[TAGFS] Error: max tags reached for inode=%lu\n", inode_id);
         return 0;
     }
@@ -1060,6 +1065,7 @@ int tagfs_add_tag(uint64_t inode_id, const Tag* tag) {
     // Check if tag already exists
     for (uint32_t i = 0; i < inode->tag_count; i++) {
         if (tagfs_tag_equal(&inode->tags[i], tag)) {
+            spin_unlock(&global_tagfs.lock);
             kprintf("[TAGFS] Tag already exists on inode=%lu\n", inode_id);
             return 1;  // Already exists - success
         }
@@ -1073,13 +1079,18 @@ int tagfs_add_tag(uint64_t inode_id, const Tag* tag) {
     // Update index
     tagfs_index_add_file(inode_id, tag, 1);
 
+    spin_unlock(&global_tagfs.lock);
+
     atomic_increment_u64(&global_tagfs.tags_added);
     return 1;
 }
 
 int tagfs_remove_tag(uint64_t inode_id, const char* key) {
+    spin_lock(&global_tagfs.lock);
+
     FileInode* inode = tagfs_get_inode(inode_id);
     if (!inode) {
+        spin_unlock(&global_tagfs.lock);
         return 0;
     }
 
@@ -1093,6 +1104,7 @@ int tagfs_remove_tag(uint64_t inode_id, const char* key) {
             inode->tag_count--;
             inode->modification_time = rdtsc();
 
+            spin_unlock(&global_tagfs.lock);
             atomic_increment_u64(&global_tagfs.tags_removed);
 
             // NOTE: Индекс не обновляем - произойдет при следующем rebuild
@@ -1100,6 +1112,7 @@ int tagfs_remove_tag(uint64_t inode_id, const char* key) {
         }
     }
 
+    spin_unlock(&global_tagfs.lock);
     return 0;
 }
 
@@ -3,6 +3,8 @@
 #include "pmm.h"
 #include "vmm.h"
 #include "cpu.h"
+#include "task_rings.h"
+#include "usermode.h"
 
 // ============================================================================
 // GLOBAL STATE
@@ -31,6 +33,9 @@ static Task* scheduler_head = NULL;
 static Task* scheduler_tail = NULL;
 static spinlock_t scheduler_lock;
 
+// Serializes WAITING_EVENT transitions against completion wakeups
+static spinlock_t task_event_lock;
+
 // Statistics
 static uint64_t tasks_created = 0;
 static uint64_t tasks_destroyed = 0;
@@ -49,6 +54,7 @@ void task_system_init(void) {
     spinlock_init(&task_table_lock);
     spinlock_init(&task_groups_lock);
     spinlock_init(&scheduler_lock);
+    spinlock_init(&task_event_lock);
 
     // Reset counters
     next_task_id = 1;
@@ -148,6 +154,13 @@ static void scheduler_dequeue(Task* task) {
     spin_unlock(&scheduler_lock);
 }
 
+static bool scheduler_queued(Task* task) {
+    spin_lock(&scheduler_lock);
+    bool queued = task->prev != NULL || scheduler_head == task;
+    spin_unlock(&scheduler_lock);
+    return queued;
+}
+
 // ============================================================================
 // TASK CREATION
 // ============================================================================
@@ -272,6 +285,14 @@ int task_kill(uint64_t task_id) {
     // Mark as dead
     task->state = TASK_STATE_DEAD;
 
+    // SQ/CQ пара (если задача её получила) - следующей задаче. User задача:
+    // пара и буферы снимаются до разрушения её контекста (usermode.h)
+    if (task->user_mode) {
+        usermode_destroy_task(task);
+    } else {
+        task_rings_unregister(task_id);
+    }
+
     // Free resources
     if (task->stack_base) {
         vfree(task->stack_base);
@@ -372,6 +393,51 @@ int task_resume(uint64_t task_id) {
     return -1;
 }
 
+int task_block_event(Task* task) {
+    spin_lock(&task_event_lock);
+
+    // Completion raced ahead of us: don't sleep, the response is ready
+    if (task->event_wakeups) {
+        task->event_wakeups--;
+        spin_unlock(&task_event_lock);
+        return 1;
+    }
+
+    task->state = TASK_STATE_WAITING_EVENT;
+    if (scheduler_queued(task)) {
+        scheduler_dequeue(task);
+    }
+
+    spin_unlock(&task_event_lock);
+    return 0;
+}
+
+int task_wake_event(uint64_t task_id) {
+    Task* task = task_get(task_id);
+    if (!task || task->state == TASK_STATE_DEAD) {
+        return -1;
+    }
+
+    spin_lock(&task_event_lock);
+
+    if (task->state != TASK_STATE_WAITING_EVENT) {
+        // Not blocked yet - next task_block_event returns immediately
+        task->event_wakeups++;
+        spin_unlock(&task_event_lock);
+        return 0;
+    }
+
+    // task_scheduler_yield also parks the current task in WAITING_EVENT,
+    // but leaves it queued - don't link it twice
+    task->state = TASK_STATE_RUNNING;
+    if (!scheduler_queued(task)) {
+        scheduler_enqueue(task);
+    }
+
+    spin_unlock(&task_event_lock);
+    return 0;
+}
+
 // ============================================================================
 // ENERGY MANAGEMENT
 // ============================================================================
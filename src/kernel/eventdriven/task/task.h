@@ -113,6 +113,7 @@ typedef struct Task {
     TaskState state;               // Current state
     TaskHealth health;             // Health metrics
     bool user_mode;                // True if Ring 3 user task
+    volatile uint32_t event_wakeups;  // Completion wakeups that arrived before task_block_event
 
     // === TIMING ===
     uint64_t creation_time;        // RDTSC at creation
@@ -190,6 +191,13 @@ int task_wake(uint64_t task_id);
 int task_pause(uint64_t task_id);
 int task_resume(uint64_t task_id);
 
+// === COMPLETION WAITS (execution/completion.h) ===
+// Block until task_wake_event. Returns 1 without blocking if a wakeup
+// already arrived (consumes it), 0 if the task left the scheduler queue
+int task_block_event(Task* task);
+// Wake a task blocked on an event completion (or remember the wakeup)
+int task_wake_event(uint64_t task_id);
+
 // === ENERGY MANAGEMENT ===
 int task_boost(uint64_t task_id, uint8_t extra_energy);  // Temporarily increase energy
 int task_throttle(uint64_t task_id, uint8_t reduction);  // Limit energy
@@ -1,4 +1,8 @@
 #include "eventapi.h"
+#include "../payload/payload_arena.h"
+#include "../core/idle.h"
+#include "../execution/completion.h"
+#include "../task/task.h"
 #include "klib.h"
 
 // ============================================================================
@@ -8,8 +12,10 @@
 static EventRingBuffer* to_kernel_ring = 0;
 static ResponseRingBuffer* from_kernel_ring = 0;
 
-// Локальный кэш ответов (простая реализация)
-// Уменьшено для экономии памяти (Response = 4KB, 32 * 4KB = 128KB)
+// Локальный кэш ответов (полностью ассоциативный, линейный поиск)
+// Response = 64 байта, 32 * 64 = 2KB (payload хранится в arena, не здесь).
+// Занятый слот не вытесняется: вызывающий мог сохранить указатель, а payload
+// ещё не освобождён. Нет свободного слота - ответы остаются в CQ
 #define RESPONSE_CACHE_SIZE 32
 static Response response_cache[RESPONSE_CACHE_SIZE];
 static int response_cache_valid[RESPONSE_CACHE_SIZE];
@@ -17,6 +23,13 @@ static int response_cache_valid[RESPONSE_CACHE_SIZE];
 // PID текущего процесса (для заполнения событий)
 static uint64_t current_user_id = 1;  // TODO: получать реальный PID
 
+// Результат последнего submit (EVENTAPI_OK / EVENTAPI_EAGAIN)
+static int last_error = EVENTAPI_OK;
+
+// QoS lane и таймаут для событий, построенных через eventapi_reserve_event
+static uint32_t current_lane_flags = 0;
+static uint32_t current_timeout_flags = 0;
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -33,6 +46,14 @@ void eventapi_init(EventRingBuffer* to_kernel, ResponseRingBuffer* from_kernel)
     kprintf("[EVENTAPI] Initialized (user_id=%lu)\n", current_user_id);
 }
 
+void eventapi_init_task_rings(TaskRingPair* rings) {
+    eventapi_init(&rings->sq, &rings->cq);
+}
+
+int eventapi_last_error(void) {
+    return last_error;
+}
+
 // ============================================================================
 // EVENT SUBMISSION
 // ============================================================================
@@ -43,23 +64,61 @@ uint64_t eventapi_submit_event(Event* event) {
         return 0;
     }
 
-    // Заполняем метаданные
-    event->id = 0;  // ВАЖНО! User НЕ устанавливает ID
-    event->user_id = current_user_id;
-    event->timestamp = 0;  // Kernel установит timestamp
+    // Копируем в слот ring buffer: полон - ядро не принимает (EAGAIN)
+    uint64_t pos;
+    Event* slot = event_ring_reserve(to_kernel_ring, &pos);
+    if (!slot) {
+        last_error = EVENTAPI_EAGAIN;
+        return 0;
+    }
+    last_error = EVENTAPI_OK;
+
+    *slot = *event;
+    slot->id = 0;  // ВАЖНО! User НЕ устанавливает ID
+    slot->user_id = current_user_id;
+    slot->timestamp = 0;  // Kernel установит timestamp
+
+    return eventapi_commit_event(pos);
+}
+
+// Zero-copy submission: событие строится прямо в слоте user→kernel ring
+// Заголовок события: текущий user, lane и таймаут
+static void eventapi_init_slot(Event* slot, EventType type) {
+    event_init(slot, type, current_user_id);
+    slot->flags = current_lane_flags | current_timeout_flags;
+}
+
+Event* eventapi_reserve_event(EventType type, uint64_t* out_pos) {
+    if (!to_kernel_ring) {
+        kprintf("[EVENTAPI] ERROR: Not initialized!\n");
+        return 0;
+    }
 
-    // Отправляем в ring buffer
-    while (!event_ring_push(to_kernel_ring, event)) {
-        // Busy-wait если буфер полон
-        cpu_pause();
+    Event* slot = event_ring_reserve(to_kernel_ring, out_pos);
+    if (!slot) {
+        last_error = EVENTAPI_EAGAIN;  // Ring полон - сначала забрать ответы
+        return 0;
     }
+    last_error = EVENTAPI_OK;
 
-    // NOTE: Мы НЕ ЗНАЕМ ID события! Kernel его установит.
-    // В реальной системе нужен механизм получения ID обратно.
-    // Сейчас для простоты возвращаем фиктивный ID.
+    eventapi_init_slot(slot, type);
+    return slot;
+}
+
+void eventapi_set_lane(uint32_t lane) {
+    current_lane_flags = event_lane_flags(lane);
+}
 
-    // TODO: правильная синхронизация для получения реального ID
-    return 0;  // Placeholder
+void eventapi_set_timeout(uint32_t ms) {
+    current_timeout_flags = event_timeout_flags(ms);
+}
+
+uint64_t eventapi_commit_event(uint64_t pos) {
+    event_ring_commit(to_kernel_ring, pos);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+    // ID назначит Receiver, но он определяется позицией слота (events.h)
+    return event_ring_event_id(to_kernel_ring, pos);
 }
 
 // ============================================================================
@@ -67,23 +126,56 @@ uint64_t eventapi_submit_event(Event* event) {
 // ============================================================================
 
 uint64_t eventapi_memory_alloc(uint64_t size) {
-    Event event;
-    event_init(&event, EVENT_MEMORY_ALLOC, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_MEMORY_ALLOC, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: размер
-    *(uint64_t*)event.data = size;
+    *(uint64_t*)event->data = size;
 
-    return eventapi_submit_event(&event);
+    return eventapi_commit_event(pos);
 }
 
 uint64_t eventapi_memory_free(void* addr) {
-    Event event;
-    event_init(&event, EVENT_MEMORY_FREE, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_MEMORY_FREE, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: адрес
-    *(void**)event.data = addr;
+    *(void**)event->data = addr;
 
-    return eventapi_submit_event(&event);
+    return eventapi_commit_event(pos);
+}
+
+uint64_t eventapi_buffer_register(void* addr, uint64_t size) {
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_MEMORY_REGISTER, &pos);
+    if (!event) {
+        return 0;
+    }
+
+    // Payload: [size:8][addr:8]
+    *(uint64_t*)event->data = size;
+    *(void**)(event->data + 8) = addr;
+
+    return eventapi_commit_event(pos);
+}
+
+uint64_t eventapi_buffer_unregister(uint32_t buffer_id) {
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_MEMORY_UNREGISTER, &pos);
+    if (!event) {
+        return 0;
+    }
+
+    // Payload: [buffer id:4]
+    *(uint32_t*)event->data = buffer_id;
+
+    return eventapi_commit_event(pos);
 }
 
 // ============================================================================
@@ -91,48 +183,60 @@ uint64_t eventapi_memory_free(void* addr) {
 // ============================================================================
 
 uint64_t eventapi_file_open(const char* path) {
-    Event event;
-    event_init(&event, EVENT_FILE_OPEN, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_FILE_OPEN, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: путь (копируем строку)
     int i = 0;
     while (path[i] && i < EVENT_DATA_SIZE - 1) {
-        event.data[i] = path[i];
+        event->data[i] = path[i];
         i++;
     }
-    event.data[i] = 0;  // null terminator
+    event->data[i] = 0;  // null terminator
 
-    return eventapi_submit_event(&event);
+    return eventapi_commit_event(pos);
 }
 
 uint64_t eventapi_file_close(int fd) {
-    Event event;
-    event_init(&event, EVENT_FILE_CLOSE, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_FILE_CLOSE, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: fd
-    *(int*)event.data = fd;
+    *(int*)event->data = fd;
 
-    return eventapi_submit_event(&event);
+    return eventapi_commit_event(pos);
 }
 
 uint64_t eventapi_file_read(int fd, uint64_t size) {
-    Event event;
-    event_init(&event, EVENT_FILE_READ, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_FILE_READ, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: [fd:4 bytes][size:8 bytes]
-    *(int*)event.data = fd;
-    *(uint64_t*)(event.data + 4) = size;
+    *(int*)event->data = fd;
+    *(uint64_t*)(event->data + 4) = size;
 
-    return eventapi_submit_event(&event);
+    return eventapi_commit_event(pos);
 }
 
 uint64_t eventapi_file_write(int fd, const void* data, uint64_t size) {
-    Event event;
-    event_init(&event, EVENT_FILE_WRITE, current_user_id);
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_FILE_WRITE, &pos);
+    if (!event) {
+        return 0;
+    }
 
     // Payload: [fd:4 bytes][size:8 bytes][data:...]
-    *(int*)event.data = fd;
-    *(uint64_t*)(event.data + 4) = size;
+    *(int*)event->data = fd;
+    *(uint64_t*)(event->data + 4) = size;
 
     // Копируем данные (ограничено размером payload)
     uint64_t copy_size = size;
@@ -141,54 +245,246 @@ uint64_t eventapi_file_write(int fd, const void* data, uint64_t size) {
     }
 
     for (uint64_t i = 0; i < copy_size; i++) {
-        event.data[12 + i] = ((uint8_t*)data)[i];
+        event->data[12 + i] = ((uint8_t*)data)[i];
+    }
+
+    return eventapi_commit_event(pos);
+}
+
+// Payload: [fd:4][size:8][buffer id:4][buffer offset:8]
+static uint64_t eventapi_file_fixed(EventType type, int fd, uint32_t buffer_id,
+                                    uint64_t offset, uint64_t size) {
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(type, &pos);
+    if (!event) {
+        return 0;
+    }
+
+    *(int*)event->data = fd;
+    *(uint64_t*)(event->data + 4) = size;
+    *(uint32_t*)(event->data + 12) = buffer_id;
+    *(uint64_t*)(event->data + 16) = offset;
+    event->flags |= EVENT_FLAG_FIXED_BUF;
+
+    return eventapi_commit_event(pos);
+}
+
+uint64_t eventapi_file_read_fixed(int fd, uint32_t buffer_id, uint64_t offset, uint64_t size) {
+    return eventapi_file_fixed(EVENT_FILE_READ, fd, buffer_id, offset, size);
+}
+
+uint64_t eventapi_file_write_fixed(int fd, uint32_t buffer_id, uint64_t offset, uint64_t size) {
+    return eventapi_file_fixed(EVENT_FILE_WRITE, fd, buffer_id, offset, size);
+}
+
+#define EVENTAPI_READ_PATH_LINKS 3
+
+uint64_t eventapi_file_read_path(const char* path, uint64_t size) {
+    if (!to_kernel_ring) {
+        kprintf("[EVENTAPI] ERROR: Not initialized!\n");
+        return 0;
     }
 
-    return eventapi_submit_event(&event);
+    // Все три звена - или ни одного: недописанная цепочка ждала бы конца.
+    // Один batch reserve - слоты подряд, без ожидания других producer'ов
+    uint64_t pos;
+    uint64_t reserved = event_ring_reserve_batch(to_kernel_ring, EVENTAPI_READ_PATH_LINKS, &pos);
+    if (reserved < EVENTAPI_READ_PATH_LINKS) {
+        event_ring_commit_partial(to_kernel_ring, pos, 0, reserved);
+        last_error = EVENTAPI_EAGAIN;
+        return 0;
+    }
+    last_error = EVENTAPI_OK;
+
+    // 1. open: LINK - следующее событие того же отправителя в той же цепочке
+    Event* event = event_ring_slot(to_kernel_ring, pos);
+    eventapi_init_slot(event, EVENT_FILE_OPEN);
+    int i = 0;
+    while (path[i] && i < EVENT_DATA_SIZE - 1) {
+        event->data[i] = path[i];
+        i++;
+    }
+    event->data[i] = 0;
+    event->flags |= EVENT_FLAG_LINK;
+
+    // 2. read: fd (data[0..3]) - из результата open
+    event = event_ring_slot(to_kernel_ring, pos + 1);
+    eventapi_init_slot(event, EVENT_FILE_READ);
+    *(uint64_t*)(event->data + 4) = size;
+    event->flags |= EVENT_FLAG_LINK | EVENT_FLAG_CHAIN_FD;
+
+    // 3. close: последнее звено, fd - тот же (read его пропускает)
+    event = event_ring_slot(to_kernel_ring, pos + 2);
+    eventapi_init_slot(event, EVENT_FILE_CLOSE);
+    event->flags |= EVENT_FLAG_CHAIN_FD;
+
+    event_ring_commit_batch(to_kernel_ring, pos, EVENTAPI_READ_PATH_LINKS);
+    idle_notify(EVENTDRIVEN_STAGE_RECEIVER);
+
+    // Ответ цепочки приходит с ID первого звена
+    return event_ring_event_id(to_kernel_ring, pos);
+}
+
+// ============================================================================
+// SYSTEM / DIAGNOSTICS
+// ============================================================================
+
+uint64_t eventapi_sys_probe(void) {
+    uint64_t pos;
+    Event* event = eventapi_reserve_event(EVENT_SYS_PROBE, &pos);
+    if (!event) {
+        return 0;
+    }
+
+    return eventapi_commit_event(pos);
 }
 
 // ============================================================================
 // RESPONSE POLLING
 // ============================================================================
 
+static int eventapi_cache_find(uint64_t event_id) {
+    for (int i = 0; i < RESPONSE_CACHE_SIZE; i++) {
+        if (response_cache_valid[i] && response_cache[i].event_id == event_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int eventapi_cache_find_free(void) {
+    for (int i = 0; i < RESPONSE_CACHE_SIZE; i++) {
+        if (!response_cache_valid[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 Response* eventapi_poll_response(uint64_t event_id) {
     if (!from_kernel_ring) {
         return 0;
     }
 
     // Проверяем кэш
-    int cache_index = event_id % RESPONSE_CACHE_SIZE;
-    if (response_cache_valid[cache_index] &&
-        response_cache[cache_index].event_id == event_id) {
-        return &response_cache[cache_index];
-    }
-
-    // Проверяем ring buffer
-    Response temp;
-    while (response_ring_pop(from_kernel_ring, &temp)) {
-        // Сохраняем в кэш
-        int idx = temp.event_id % RESPONSE_CACHE_SIZE;
-        response_cache[idx] = temp;
+    int idx = eventapi_cache_find(event_id);
+    if (idx >= 0) {
+        return &response_cache[idx];
+    }
+
+    // Проверяем ring buffer - только пока есть куда положить ответ
+    while ((idx = eventapi_cache_find_free()) >= 0 &&
+           response_ring_pop(from_kernel_ring, &response_cache[idx])) {
         response_cache_valid[idx] = 1;
 
         // Если это тот ответ, что мы ищем
-        if (temp.event_id == event_id) {
+        if (response_cache[idx].event_id == event_id) {
             return &response_cache[idx];
         }
     }
 
-    return 0;  // Ответ ещё не готов
+    return 0;  // Ответ ещё не готов (или кэш занят неосвобождёнными ответами)
+}
+
+// Сколько из событий уже получили ответ; pending (если не 0) - остальные
+static uint32_t eventapi_ready_count(const uint64_t* event_ids, uint32_t count,
+                                     uint64_t* pending) {
+    uint32_t ready = 0;
+    uint32_t waiting = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (eventapi_poll_response(event_ids[i])) {
+            ready++;
+        } else if (pending) {
+            pending[waiting++] = event_ids[i];
+        }
+    }
+    return ready;
+}
+
+// Уснуть, пока не наберётся need ответов (completion wakeup от Execution).
+// -1 = wait не зарегистрирован, вызывающий остаётся на polling
+static int eventapi_block(Task* task, const uint64_t* event_ids, uint32_t count, uint32_t need) {
+    uint64_t pending[COMPLETION_GROUP_EVENTS];
+    if (count > COMPLETION_GROUP_EVENTS) {
+        return -1;
+    }
+
+    uint32_t ready = eventapi_ready_count(event_ids, count, pending);
+    if (ready >= need) {
+        return 0;
+    }
+
+    // Кэш полон: ответ может уже лежать в CQ, и его signal не повторится.
+    // Спать нельзя - ждём release_response на polling
+    if (eventapi_cache_find_free() < 0) {
+        return -1;
+    }
+
+    uint32_t wait = completion_wait_register(task->task_id, pending, count - ready, need - ready);
+    if (wait == COMPLETION_NONE) {
+        return -1;
+    }
+
+    // Ответ мог прийти до регистрации - его signal уже прошёл мимо
+    if (eventapi_ready_count(event_ids, count, 0) >= need) {
+        completion_wait_cancel(wait);
+        return 0;
+    }
+
+    if (task_block_event(task) == 0) {
+        task_scheduler_yield();
+    }
+    return 0;
 }
 
 Response* eventapi_wait_response(uint64_t event_id) {
-    // Busy-wait (НЕ РЕКОМЕНДУЕТСЯ!)
+    // Без текущей задачи (boot, kernel loop) - busy-wait как раньше
+    Task* task = task_get_current();
     Response* resp;
     while (!(resp = eventapi_poll_response(event_id))) {
-        cpu_pause();
+        if (!task || eventapi_block(task, &event_id, 1, 1) < 0) {
+            cpu_pause();
+        }
     }
     return resp;
 }
 
+uint32_t eventapi_wait_responses(const uint64_t* event_ids, uint32_t count, uint32_t need) {
+    if (need == 0 || need > count) {
+        need = count;
+    }
+
+    Task* task = task_get_current();
+    uint32_t ready;
+    while ((ready = eventapi_ready_count(event_ids, count, 0)) < need) {
+        if (!task || eventapi_block(task, event_ids, count, need) < 0) {
+            cpu_pause();
+        }
+    }
+    return ready;
+}
+
+// ============================================================================
+// PAYLOAD ACCESS
+// ============================================================================
+
+void* eventapi_response_payload(Response* response) {
+    if (response->payload_offset == RESPONSE_PAYLOAD_NONE) {
+        return response->result;  // Результат inline
+    }
+    return payload_arena_ptr(response->payload_offset);
+}
+
+void eventapi_release_response(Response* response) {
+    payload_arena_release(response->payload_offset);
+    response->payload_offset = RESPONSE_PAYLOAD_NONE;
+
+    // Убираем из кэша (указатель на слот, а не копия)
+    if (response >= response_cache && response < response_cache + RESPONSE_CACHE_SIZE) {
+        response_cache_valid[response - response_cache] = 0;
+    }
+}
+
 // ============================================================================
 // HELPERS
 // ============================================================================
@@ -3,6 +3,7 @@
 
 #include "../core/events.h"
 #include "../core/ringbuffer.h"
+#include "../core/task_rings.h"
 
 // ============================================================================
 // USER SPACE EVENT API - Асинхронный интерфейс для user programs
@@ -24,6 +25,7 @@
 //   if (resp) {
 //       void* addr = *(void**)resp->result;
 //       use_memory(addr);
+//       eventapi_release_response(resp);
 //   }
 //
 // ============================================================================
@@ -32,38 +34,106 @@
 // INITIALIZATION
 // ============================================================================
 
-// Инициализирует доступ к kernel ring buffers
-// NOTE: В реальной системе это должно делаться через shared memory mapping
+// Инициализирует доступ к kernel ring buffers (глобальная пара - kernel
+// задачи и демо)
 void eventapi_init(EventRingBuffer* to_kernel, ResponseRingBuffer* from_kernel);
 
+// User задача: своя SQ/CQ пара, отображённая в её адресное пространство
+// (адрес - usermode_get_rings()). События и ответы других задач её не касаются
+void eventapi_init_task_rings(TaskRingPair* rings);
+
+// ============================================================================
+// BACKPRESSURE (core/credits.h)
+// ============================================================================
+//
+// Submit не ждёт места: ring полон (ответы не забираются) - helper
+// возвращает 0, а eventapi_last_error() - EVENTAPI_EAGAIN. Событие сверх
+// кредитов ring ядро принимает, но сразу отвечает EVENT_STATUS_BUSY.
+// В обоих случаях: забрать ответы и повторить.
+
+#define EVENTAPI_OK             0
+#define EVENTAPI_EAGAIN         11
+
+int eventapi_last_error(void);
+
 // ============================================================================
 // EVENT SUBMISSION - Отправка событий (асинхронно!)
 // ============================================================================
+//
+// Helpers возвращают ID события - его назначит Receiver, но ID следует из
+// позиции слота в SQ (core/events.h), поэтому известен сразу. 0 - событие
+// не отправлено (eventapi_last_error)
 
 // Память
 uint64_t eventapi_memory_alloc(uint64_t size);
 uint64_t eventapi_memory_free(void* addr);
 
+// Зарегистрированные буферы (core/user_buffers.h): ответ на register -
+// inline id буфера (1..USER_BUFFERS_MAX), дальше read/write_fixed копируют
+// прямо в / из [addr + offset, + size) без payload arena
+uint64_t eventapi_buffer_register(void* addr, uint64_t size);
+uint64_t eventapi_buffer_unregister(uint32_t buffer_id);
+
 // Файлы
 uint64_t eventapi_file_open(const char* path);
 uint64_t eventapi_file_close(int fd);
 uint64_t eventapi_file_read(int fd, uint64_t size);
 uint64_t eventapi_file_write(int fd, const void* data, uint64_t size);
+uint64_t eventapi_file_read_fixed(int fd, uint32_t buffer_id, uint64_t offset, uint64_t size);
+uint64_t eventapi_file_write_fixed(int fd, uint32_t buffer_id, uint64_t offset, uint64_t size);
 
-// Generic event submission
+// Цепочка open -> read(size) -> close одним submit (center/chain.h): fd
+// подставляет ядро, ответ один - от close, с payload данных read. Если звено
+// упало - ответ от него (inline result = fd, если файл уже открыт)
+uint64_t eventapi_file_read_path(const char* path, uint64_t size);
+
+// Диагностика: EVENT_SYS_PROBE идёт во все decks параллельно (route DAG),
+// inline result = 4 x uint64_t, у каждого deck - маска decks его волны
+uint64_t eventapi_sys_probe(void);
+
+// QoS lane (EVENT_LANE_*) для следующих событий helpers выше.
+// eventapi_submit_event берёт lane из event->flags как есть
+void eventapi_set_lane(uint32_t lane);
+
+// Таймаут (ms) следующих событий helpers выше: не дошедшее до ответа
+// событие получит EVENT_STATUS_TIMEOUT. 0 = по умолчанию типа,
+// EVENT_TIMEOUT_NONE = без дедлайна
+void eventapi_set_timeout(uint32_t ms);
+
+// Generic event submission (копирует готовое событие в ring)
 uint64_t eventapi_submit_event(Event* event);
 
+// Zero-copy submission: зарезервировать слот, заполнить payload на месте,
+// затем eventapi_commit_event(pos). Заголовок (type, user_id) уже заполнен.
+Event* eventapi_reserve_event(EventType type, uint64_t* out_pos);
+uint64_t eventapi_commit_event(uint64_t pos);
+
 // ============================================================================
 // RESPONSE POLLING - Проверка результатов
 // ============================================================================
 
 // Проверяет наличие ответа для данного event_id
-// Возвращает NULL если ответ ещё не готов
+// Возвращает NULL если ответ ещё не готов - или если все слоты кэша ответов
+// заняты: тогда сначала eventapi_release_response на уже полученные
 Response* eventapi_poll_response(uint64_t event_id);
 
-// Ждёт ответа (blocking!) - НЕ РЕКОМЕНДУЕТСЯ
+// Ждёт ответа (blocking). Текущая задача уходит из планировщика до
+// completion wakeup от Execution (execution/completion.h); без задачи -
+// busy-wait
 Response* eventapi_wait_response(uint64_t event_id);
 
+// Wait-for-N: ждёт need ответов из count событий (need = 0 - всех,
+// count <= COMPLETION_GROUP_EVENTS для сна). Возвращает сколько готово,
+// сами ответы - через eventapi_poll_response
+uint32_t eventapi_wait_responses(const uint64_t* event_ids, uint32_t count, uint32_t need);
+
+// Указатель на результат: inline result[] или payload в arena
+void* eventapi_response_payload(Response* response);
+
+// Освобождает payload ответа (если есть) и слот кэша. Вызывать после
+// того, как результат прочитан - иначе arena заполнится.
+void eventapi_release_response(Response* response);
+
 // ============================================================================
 // HELPERS
 // ============================================================================
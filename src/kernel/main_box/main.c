@@ -17,10 +17,12 @@
 #include "eventdriven_demo.h"
 #include "event_ipc.h"
 #include "event_ipc_demo.h"
+#include "pipeline_bench.h"
 #include "auth.h"
 #include "shell.h"
 #include "serial.h"
 #include "usermode.h"
+#include "smp.h"
 
 extern uint8_t user_experience_level;
 
@@ -130,6 +132,11 @@ void kernel_main(e820_entry_t* e820_map, uint64_t e820_count, uint64_t mem_start
     pit_init(100);  // 100 Hz = 10ms per tick
     kprintf("%[S] PIT timer initialized (100 Hz)%[D]\n");
 
+    // === SMP (AP cores for event-driven pipeline) ===
+    kprintf("\n%[H]=== Step 5.5: SMP Bring-up ===%[D]\n");
+    smp_init();
+    kprintf("%[S] SMP initialized (%u CPUs online)%[D]\n", smp_get_cpu_count());
+
     kprintf("\n%[S] All core systems initialized!%[D]\n");
 
     // === EVENT-DRIVEN SYSTEM INITIALIZATION ===
@@ -188,6 +195,11 @@ void kernel_main(e820_entry_t* e820_map, uint64_t e820_count, uint64_t mem_start
     // === EVENT-BASED IPC DEMONSTRATION ===
     event_ipc_demo_run();
 
+#ifdef BOOT_BENCH
+    // === HEADLESS PIPELINE BENCHMARK (make BENCH=1) ===
+    pipeline_bench_run(PIPELINE_BENCH_EVENTS, PIPELINE_BENCH_DEPTH, PIPELINE_BENCH_MIX);
+#endif
+
     // === SHELL INITIALIZATION ===
     kprintf("\n%[H]=== Starting BoxOS Shell ===%[D]\n\n");
     shell_init();
@@ -10,6 +10,9 @@
 #include "io.h"
 #include "auth.h"  // PRODUCTION: Secure authentication system
 #include "system_config.h"  // PRODUCTION: System-wide constants
+#include "ring_bench.h"
+#include "latency.h"
+#include "pipeline_bench.h"
 
 // ============================================================================
 // SHELL STATE
@@ -39,6 +42,9 @@ int cmd_eye(int argc, char** argv);
 int cmd_trash(int argc, char** argv);
 int cmd_erase(int argc, char** argv);
 int cmd_info(int argc, char** argv);
+int cmd_ringbench(int argc, char** argv);
+int cmd_latency(int argc, char** argv);
+int cmd_bench(int argc, char** argv);
 int cmd_tag(int argc, char** argv);
 int cmd_untag(int argc, char** argv);
 int cmd_restore(int argc, char** argv);
@@ -73,6 +79,9 @@ static shell_command_t commands[] = {
     {"say", "Print text to console", cmd_say},
     {"edit", "Open text editor", cmd_edit},
     {"info", "Show system information", cmd_info},
+    {"ringbench", "Compare SPSC/MPMC event rings", cmd_ringbench},
+    {"latency", "Pipeline latency per event type [reset]", cmd_latency},
+    {"bench", "Pipeline benchmark [events] [depth] [mix]", cmd_bench},
     {"whoami", "Show current user", cmd_whoami},
     {"login", "Login as user", cmd_login},
     {"logout", "Logout current user", cmd_logout},
@@ -931,6 +940,61 @@ int cmd_edit(int argc, char** argv) {
     return 0;
 }
 
+// ============================================================================
+// COMMAND: ringbench
+// ============================================================================
+
+int cmd_ringbench(int argc, char** argv) {
+    int producers = 4;
+    if (argc > 1) {
+        producers = atoi(argv[1]);
+    }
+
+    ring_bench_run(producers);
+    return 0;
+}
+
+// ============================================================================
+// COMMAND: latency
+// ============================================================================
+
+int cmd_latency(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        latency_reset();
+        kprintf("Latency histograms reset\n");
+        return 0;
+    }
+
+    latency_print();
+    return 0;
+}
+
+// ============================================================================
+// COMMAND: bench
+// ============================================================================
+
+int cmd_bench(int argc, char** argv) {
+    uint64_t events = PIPELINE_BENCH_EVENTS;
+    uint32_t depth = PIPELINE_BENCH_DEPTH;
+    const char* mix = PIPELINE_BENCH_MIX;
+
+    if (argc > 1) {
+        events = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        depth = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        mix = argv[3];
+    }
+
+    if (pipeline_bench_run(events, depth, mix) != 0) {
+        kprintf("Usage: bench [events] [depth] [%s]\n", pipeline_bench_mixes());
+        return -1;
+    }
+    return 0;
+}
+
 // ============================================================================
 // COMMAND: reboot
 // ============================================================================
@@ -10,6 +10,12 @@ static uint8_t memory_pool[KLIB_MEMORY_POOL_SIZE];
 static mem_block_t* free_list = NULL;
 static spinlock_t heap_lock = {0};
 
+// Консоль общая для всех ядер (SMP): без lock строки с AP перемешиваются.
+// Берётся с выключенными прерываниями - IRQ handler на том же ядре не
+// заблокируется об себя
+static spinlock_t console_lock = {0};
+static volatile int kprintf_quiet = 0;  // kprintf_set_quiet
+
 static uint8_t current_attr = TEXT_ATTR_DEFAULT;
 
 // Символы для преобразования чисел
@@ -174,6 +180,10 @@ __attribute__((noreturn)) void panic(const char* message, ...) {
     va_list args;
     va_start(args, message);
 
+    // Panic мог случиться внутри kprintf - не блокируемся об свой же lock
+    spin_unlock(&console_lock);
+    kprintf_quiet = 0;
+
     kprintf("\nDon't panic, friend! I just broke something, forget it :-)");
 
     kprintf("\n%[E]KERNEL PANIC:%[D] ");
@@ -305,11 +315,23 @@ void kputchar(char c) {
     }
 }
 
+void kprintf_set_quiet(int quiet) {
+    kprintf_quiet = quiet;
+}
+
 int kprintf(const char* format, ...) {
+    if (kprintf_quiet) {
+        return 0;
+    }
+
     va_list args;
     va_start(args, format);
     int count = 0;
 
+    uint64_t irq_flags;
+    asm volatile("pushfq\n\tpop %0\n\tcli" : "=r"(irq_flags) : : "memory");
+    spin_lock(&console_lock);
+
     while (*format) {
         if (*format == '%') {
             ++format;
@@ -575,6 +597,10 @@ int kprintf(const char* format, ...) {
         }
         ++format;
     }
+    spin_unlock(&console_lock);
+    if (irq_flags & (1 << 9)) {
+        asm volatile("sti");
+    }
     va_end(args);
     return count;
 }
@@ -74,6 +74,7 @@ void mem_stats(void);
 // ========== Отладка и вывод ==========
 __attribute__((noreturn)) void panic(const char* message, ...);
 int kprintf(const char* format, ...);
+void kprintf_set_quiet(int quiet);  // 1 = kprintf молчит (бенчмарки), panic снимает
 int ksnprintf(char* buf, size_t size, const char* fmt, ...);
 void kputchar(char c);
 int kputnl(void);